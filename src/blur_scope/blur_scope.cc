@@ -73,7 +73,7 @@ public:
 private:
     void resize (int w, int h);
     void draw_to_cairo (cairo_t * cr);
-    void draw ();
+    void draw (int top, int bottom);
 
     void blur ();
     void draw_vert_line (int x, int y1, int y2);
@@ -88,6 +88,15 @@ private:
     GtkWidget * area = nullptr;
     int width = 0, height = 0, stride = 0, image_size = 0;
     uint32_t * image = nullptr, * corner = nullptr;
+
+    /* rows which may contain something other than black, and rows which have
+     * changed since the last frame */
+    int active_top = 0, active_bottom = 0;
+    int damage_top = 0, damage_bottom = 0;
+
+    /* time spent rendering, logged as an average every 256 frames */
+    int64_t frame_time = 0;
+    int frame_count = 0;
 };
 
 EXPORT BlurScope aud_plugin_instance;
@@ -117,6 +126,7 @@ void BlurScope::resize (int w, int h)
     image = (uint32_t *) g_realloc (image, image_size);
     memset (image, 0, image_size);
     corner = image + stride + 1;
+    active_top = active_bottom = 0;
 }
 
 void BlurScope::draw_to_cairo (cairo_t * cr)
@@ -128,15 +138,20 @@ void BlurScope::draw_to_cairo (cairo_t * cr)
     cairo_surface_destroy (surf);
 }
 
-void BlurScope::draw ()
+void BlurScope::draw (int top, int bottom)
 {
+    if (bottom <= top)
+        return;
+
 #ifdef USE_GTK3
     if (area)
-        gtk_widget_queue_draw (area);
+        gtk_widget_queue_draw_area (area, 0, top, width, bottom - top);
 #else
     if (! area || ! gtk_widget_get_window (area))
         return;
     cairo_t * cr = gdk_cairo_create (gtk_widget_get_window (area));
+    cairo_rectangle (cr, 0, top, width, bottom - top);
+    cairo_clip (cr);
     draw_to_cairo (cr);
     cairo_destroy (cr);
 #endif
@@ -157,7 +172,8 @@ gboolean BlurScope::draw_event (GtkWidget * widget, cairo_t * cr, void * user)
 #else
 gboolean BlurScope::draw_event (GtkWidget * widget, GdkEventExpose * event, void * user)
 {
-    ((BlurScope *) user)->draw ();
+    auto me = (BlurScope *) user;
+    me->draw (0, me->height);
     return true;
 }
 #endif
@@ -179,26 +195,65 @@ void * BlurScope::get_gtk_widget ()
 void BlurScope::clear ()
 {
     memset (image, 0, image_size);
-    draw ();
+    active_top = active_bottom = 0;
+    draw (0, height);
+}
+
+/* We do a quick and dirty average of four color values, first masking off the
+ * lowest two bits.  Over a large area, this masking has the net effect of
+ * subtracting 1.5 from each value, which by a happy chance is just right for a
+ * gradual fade effect.
+ *
+ * The blur is done in place: the row above and the pixel to the left have
+ * already been blurred when a pixel is computed.  The left pixel is carried
+ * in a local rather than read back.  Returns nonzero if any resulting pixel
+ * is not black. */
+static uint32_t blur_row (uint32_t * p, const uint32_t * plast,
+ const uint32_t * pnext, int width)
+{
+    uint32_t left = p[-1], any = 0;
+
+    for (int x = 0; x < width; x ++)
+    {
+        left = ((plast[x] & 0xFCFCFC) + (left & 0xFCFCFC) + (p[x + 1] &
+         0xFCFCFC) + (pnext[x] & 0xFCFCFC)) >> 2;
+        p[x] = left;
+        any |= left;
+    }
+
+    return any;
 }
 
 void BlurScope::blur ()
 {
-    for (int y = 0; y < height; y ++)
+    /* rows above the visible ones stay black; below them, a row only picks up
+     * what was just blurred into the row above it, so stop at the first one
+     * that stays black */
+    int top = aud::max (active_top - 1, 0);
+    int y = top;
+
+    int new_top = height, new_bottom = 0;
+
+    for (; y < height; y ++)
     {
         uint32_t * p = corner + stride * y;
-        uint32_t * end = p + width;
-        uint32_t * plast = p - stride;
-        uint32_t * pnext = p + stride;
-
-        /* We do a quick and dirty average of four color values, first masking
-         * off the lowest two bits.  Over a large area, this masking has the net
-         * effect of subtracting 1.5 from each value, which by a happy chance
-         * is just right for a gradual fade effect. */
-        for (; p < end; p ++)
-            * p = ((* plast ++ & 0xFCFCFC) + (p[-1] & 0xFCFCFC) + (p[1] &
-             0xFCFCFC) + (* pnext ++ & 0xFCFCFC)) >> 2;
+
+        if (blur_row (p, p - stride, p + stride, width))
+        {
+            new_top = aud::min (new_top, y);
+            new_bottom = y + 1;
+        }
+        else if (y >= active_bottom)
+        {
+            y ++;
+            break;
+        }
     }
+
+    damage_top = top;
+    damage_bottom = y;
+    active_top = new_top;
+    active_bottom = new_bottom;
 }
 
 void BlurScope::draw_vert_line (int x, int y1, int y2)
@@ -217,20 +272,44 @@ void BlurScope::draw_vert_line (int x, int y1, int y2)
 
 void BlurScope::render_mono_pcm (const float * pcm)
 {
+    int64_t start = g_get_monotonic_time ();
+
     blur ();
 
     int prev_y = (0.5 + pcm[0]) * height;
     prev_y = aud::clamp (prev_y, 0, height - 1);
 
+    int line_top = prev_y, line_bottom = prev_y + 1;
+
     for (int i = 0; i < width; i ++)
     {
         int y = (0.5 + pcm[i * 512 / width]) * height;
         y = aud::clamp (y, 0, height - 1);
         draw_vert_line (i, prev_y, y);
         prev_y = y;
+
+        line_top = aud::min (line_top, y);
+        line_bottom = aud::max (line_bottom, y + 1);
     }
 
-    draw ();
+    if (width > 0)
+    {
+        active_top = aud::min (active_top, line_top);
+        active_bottom = aud::max (active_bottom, line_bottom);
+        damage_top = aud::min (damage_top, line_top);
+        damage_bottom = aud::max (damage_bottom, line_bottom);
+    }
+
+    draw (damage_top, damage_bottom);
+
+    frame_time += g_get_monotonic_time () - start;
+
+    if (++ frame_count == 256)
+    {
+        AUDDBG ("Average frame time: %d us\n", (int) (frame_time / frame_count));
+        frame_time = 0;
+        frame_count = 0;
+    }
 }
 
 static void color_set_cb (GtkWidget * chooser)
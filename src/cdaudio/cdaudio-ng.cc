@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
 
 /* prevent libcdio from redefining PACKAGE, VERSION, etc. */
 #define EXTERNAL_LIBCDIO_CONFIG_H
@@ -54,6 +55,11 @@
 #define MAX_RETRIES 10
 #define MAX_SKIPS 10
 
+#define SECTOR_SIZE CDIO_CD_FRAMESIZE_RAW
+#define CACHE_SECONDS 10
+#define CACHE_SECTORS (75 * CACHE_SECONDS)
+#define OVERLAP_SECTORS 2  /* re-read and compared when verifying */
+
 static const char * const cdaudio_schemes[] = {"cdda", nullptr};
 
 class CDAudio : public InputPlugin
@@ -120,6 +126,7 @@ const char CDAudio::about[] =
 
 const char * const CDAudio::defaults[] = {
  "disc_speed", "2",
+ "verify_reads", "FALSE",
  "use_cdtext", "TRUE",
 #ifdef HAVE_LIBCDDB
  "use_cddb", "TRUE",
@@ -137,6 +144,8 @@ const PreferencesWidget CDAudio::widgets[] = {
         {MIN_DISC_SPEED, MAX_DISC_SPEED, 1}),
     WidgetEntry (N_("Override device:"),
         WidgetString ("CDDA", "device")),
+    WidgetCheck (N_("Verify reads (slower, for scratched discs)"),
+        WidgetBool ("CDDA", "verify_reads")),
     WidgetLabel (N_("<b>Metadata</b>")),
     WidgetCheck (N_("Use CD-Text"),
         WidgetBool ("CDDA", "use_cdtext")),
@@ -236,6 +245,184 @@ bool CDAudio::is_our_file (const char * filename, VFSFile & file)
     return !strncmp (filename, "cdda://", 7);
 }
 
+/*
+ * Sectors are read ahead of playback by a separate thread into a ring-shaped
+ * cache, so that slow reads, retries and error recovery are hidden behind
+ * the cached audio instead of reaching the output.  A quarter of the cache
+ * is kept behind the playback position so that short backward seeks do not
+ * touch the drive.
+ *
+ * When verification is enabled, each read starts a few sectors before the
+ * end of the cached data, and the overlap must match what was read before
+ * (as in cdparanoia); a mismatch means the drive returned jittered or
+ * garbled data, and the read is repeated.
+ */
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cache_cond = PTHREAD_COND_INITIALIZER;
+
+/* lock cache_mutex to read / set these variables */
+static Index<unsigned char> cache;
+static int cache_head, cache_len;  /* in sectors */
+static int cache_startlsn, play_lsn;
+static int cache_generation;       /* incremented when the cache is reset */
+static bool reader_quit, reader_error;
+
+/* constant while the reader runs */
+static int read_endlsn, read_sectors;
+static bool read_verify;
+
+/* cache_mutex must be locked */
+static int cache_endlsn ()
+{
+    return cache_startlsn + cache_len;
+}
+
+/* cache_mutex must be locked */
+static unsigned char * cache_sector (int lsn)
+{
+    return & cache[(cache_head + lsn - cache_startlsn) % CACHE_SECTORS * SECTOR_SIZE];
+}
+
+/* cache_mutex must be locked */
+static void reset_cache (int lsn)
+{
+    cache_head = cache_len = 0;
+    cache_startlsn = play_lsn = lsn;
+    cache_generation ++;
+    reader_error = false;
+}
+
+/* cache_mutex must be locked; data may be nullptr for silence */
+static void append_to_cache (const unsigned char * data, int sectors)
+{
+    for (int i = 0; i < sectors; i ++)
+    {
+        unsigned char * to = cache_sector (cache_endlsn ());
+
+        if (data)
+            memcpy (to, data + i * SECTOR_SIZE, SECTOR_SIZE);
+        else
+            memset (to, 0, SECTOR_SIZE);
+
+        cache_len ++;
+    }
+}
+
+static void * reader_thread (void *)
+{
+    Index<unsigned char> buffer;
+    buffer.insert (0, SECTOR_SIZE * (read_sectors + OVERLAP_SECTORS));
+
+    int sectors = read_sectors;
+    int retry_count = 0, skip_count = 0;
+    int generation = -1;
+
+    pthread_mutex_lock (& cache_mutex);
+
+    while (! reader_quit)
+    {
+        if (generation != cache_generation)
+        {
+            /* start over after a seek */
+            generation = cache_generation;
+            sectors = read_sectors;
+            retry_count = skip_count = 0;
+        }
+
+        /* drop sectors that have been played, minus those kept for seeking */
+        int keep = CACHE_SECTORS / 4;
+        int behind = play_lsn - cache_startlsn;
+
+        if (behind > keep && cache_len > CACHE_SECTORS - sectors)
+        {
+            int drop = aud::min (behind - keep, cache_len - (CACHE_SECTORS - sectors));
+            cache_head = (cache_head + drop) % CACHE_SECTORS;
+            cache_startlsn += drop;
+            cache_len -= drop;
+        }
+
+        int lsn = cache_endlsn ();
+        int count = aud::min (sectors, read_endlsn + 1 - lsn);
+
+        if (reader_error || count < 1 || CACHE_SECTORS - cache_len < count)
+        {
+            pthread_cond_wait (& cache_cond, & cache_mutex);
+            continue;
+        }
+
+        int overlap = read_verify ? aud::min (OVERLAP_SECTORS, cache_len) : 0;
+
+        /* unlock mutex here to avoid blocking the play thread; the drive
+         * handle is not closed while playing */
+        pthread_mutex_unlock (& cache_mutex);
+
+        int ret = cdio_read_audio_sectors (pcdrom_drive->p_cdio,
+         buffer.begin (), lsn - overlap, count + overlap);
+
+        pthread_mutex_lock (& cache_mutex);
+
+        if (generation != cache_generation)
+            continue;
+
+        bool verified = true;
+
+        if (ret == DRIVER_OP_SUCCESS)
+        {
+            for (int i = 0; i < overlap; i ++)
+            {
+                if (memcmp (buffer.begin () + i * SECTOR_SIZE,
+                 cache_sector (lsn - overlap + i), SECTOR_SIZE))
+                    verified = false;
+            }
+        }
+
+        if (ret == DRIVER_OP_SUCCESS && (verified || retry_count >= MAX_RETRIES))
+        {
+            if (! verified)
+                AUDWARN ("Sectors %d-%d could not be verified.\n", lsn, lsn + count - 1);
+
+            append_to_cache (buffer.begin () + overlap * SECTOR_SIZE, count);
+            retry_count = 0;
+            skip_count = 0;
+        }
+        else if (ret == DRIVER_OP_SUCCESS)
+        {
+            /* read back different data; try again */
+            retry_count ++;
+        }
+        else if (sectors > 16)
+        {
+            /* maybe a smaller read size will help */
+            sectors /= 2;
+        }
+        else if (retry_count < MAX_RETRIES)
+        {
+            /* still failed; retry a few times */
+            retry_count ++;
+        }
+        else if (skip_count < MAX_SKIPS)
+        {
+            /* maybe the disk is scratched; skip ahead, leaving silence */
+            count = aud::min (75, read_endlsn + 1 - lsn);
+            count = aud::min (count, CACHE_SECTORS - cache_len);
+            append_to_cache (nullptr, count);
+            retry_count = 0;
+            skip_count ++;
+        }
+        else
+        {
+            /* still failed; give it up */
+            reader_error = true;
+        }
+
+        pthread_cond_broadcast (& cache_cond);
+    }
+
+    pthread_mutex_unlock (& cache_mutex);
+    return nullptr;
+}
+
 /* play thread only */
 bool CDAudio::play (const char * name, VFSFile & file)
 {
@@ -271,73 +458,94 @@ bool CDAudio::play (const char * name, VFSFile & file)
     int startlsn = trackinfo[trackno].startlsn;
     int endlsn = trackinfo[trackno].endlsn;
 
+    /* the drive handle must stay open until playing is reset */
     playing = true;
 
+    pthread_mutex_unlock (& mutex);
+
     int buffer_size = aud_get_int ("output_buffer_size");
     int speed = aud_get_int ("CDDA", "disc_speed");
     speed = aud::clamp (speed, MIN_DISC_SPEED, MAX_DISC_SPEED);
     int sectors = aud::clamp (buffer_size / 2, 50, 250) * speed * 75 / 1000;
-    int currlsn = startlsn;
-    int retry_count = 0, skip_count = 0;
 
-    Index<unsigned char> buffer;
-    buffer.insert (0, 2352 * sectors);
+    pthread_mutex_lock (& cache_mutex);
+
+    cache.insert (0, SECTOR_SIZE * CACHE_SECTORS);
+    reset_cache (startlsn);
+    reader_quit = false;
+
+    read_endlsn = endlsn;
+    read_sectors = aud::min (sectors, CACHE_SECTORS / 2);
+    read_verify = aud_get_bool ("CDDA", "verify_reads");
+
+    pthread_t reader;
+    pthread_create (& reader, nullptr, reader_thread, nullptr);
 
     while (! check_stop ())
     {
         int seek_time = check_seek ();
         if (seek_time >= 0)
-            currlsn = startlsn + (seek_time * 75 / 1000);
-
-        sectors = aud::min (sectors, endlsn + 1 - currlsn);
-        if (sectors < 1)
-            break;
+        {
+            int lsn = aud::min (startlsn + (seek_time * 75 / 1000), endlsn + 1);
 
-        /* unlock mutex here to avoid blocking
-         * other threads must be careful not to close drive handle */
-        pthread_mutex_unlock (& mutex);
+            /* reuse cached sectors if possible */
+            if (lsn >= cache_startlsn && lsn <= cache_endlsn () && ! reader_error)
+                play_lsn = lsn;
+            else
+                reset_cache (lsn);
 
-        int ret = cdio_read_audio_sectors (pcdrom_drive->p_cdio,
-         buffer.begin (), currlsn, sectors);
+            pthread_cond_broadcast (& cache_cond);
+        }
 
-        if (ret == DRIVER_OP_SUCCESS)
-            write_audio (buffer.begin (), 2352 * sectors);
+        if (play_lsn > endlsn)
+            break;
 
-        pthread_mutex_lock (& mutex);
+        int avail = cache_endlsn () - play_lsn;
 
-        if (ret == DRIVER_OP_SUCCESS)
-        {
-            currlsn += sectors;
-            retry_count = 0;
-            skip_count = 0;
-        }
-        else if (sectors > 16)
-        {
-            /* maybe a smaller read size will help */
-            sectors /= 2;
-        }
-        else if (retry_count < MAX_RETRIES)
-        {
-            /* still failed; retry a few times */
-            retry_count ++;
-        }
-        else if (skip_count < MAX_SKIPS)
-        {
-            /* maybe the disk is scratched; try skipping ahead */
-            currlsn = aud::min (currlsn + 75, endlsn + 1);
-            skip_count ++;
-        }
-        else
+        if (! avail)
         {
-            /* still failed; give it up */
-            cdaudio_error (_("Error reading audio CD."));
-            break;
+            if (reader_error)
+            {
+                cdaudio_error (_("Error reading audio CD."));
+                break;
+            }
+
+            /* wake up now and then to check for stop and seek */
+            timeval now;
+            gettimeofday (& now, nullptr);
+            int64_t usec = now.tv_usec + 50000;
+            timespec until = {(time_t) (now.tv_sec + usec / 1000000), (long) (usec % 1000000 * 1000)};
+
+            pthread_cond_timedwait (& cache_cond, & cache_mutex, & until);
+            continue;
         }
+
+        /* don't wrap around the end of the cache in one write */
+        int offset = (cache_head + play_lsn - cache_startlsn) % CACHE_SECTORS;
+        int count = aud::min (aud::min (avail, sectors), CACHE_SECTORS - offset);
+        unsigned char * data = cache_sector (play_lsn);
+
+        /* the reader never drops sectors at or after play_lsn, so they can
+         * be written without the lock held */
+        pthread_mutex_unlock (& cache_mutex);
+        write_audio (data, SECTOR_SIZE * count);
+        pthread_mutex_lock (& cache_mutex);
+
+        play_lsn += count;
+        pthread_cond_broadcast (& cache_cond);
     }
 
-    playing = false;
+    reader_quit = true;
+    pthread_cond_broadcast (& cache_cond);
+    pthread_mutex_unlock (& cache_mutex);
 
+    pthread_join (reader, nullptr);
+    cache.clear ();
+
+    pthread_mutex_lock (& mutex);
+    playing = false;
     pthread_mutex_unlock (& mutex);
+
     return true;
 }
 
@@ -32,11 +32,21 @@
 #define CHUNKS 5
 #define DECAY 0.3f
 
+/* Limiter mode: release time and true-peak oversampling parameters.  The
+ * interpolation filter is 4x polyphase with LIMITER_TAPS taps per phase,
+ * similar to the one described in ITU-R BS.1770. */
+#define LIMITER_RELEASE 0.05f /* seconds */
+#define LIMITER_PHASES 4
+#define LIMITER_TAPS 12
+
 /* What is a "normal" volume?  Replay Gain stuff claims to use 89 dB, but what
  * does that translate to in our PCM range? */
 static const char * const compressor_defaults[] = {
     "center", "0.5",
     "range", "0.5",
+    "limiter", "FALSE",
+    "lookahead", "5",
+    "ceiling", "-1",
      nullptr
 };
 
@@ -47,7 +57,18 @@ static const PreferencesWidget compressor_widgets[] = {
         {0.1, 1, 0.1}),
     WidgetSpin (N_("Dynamic range:"),
         WidgetFloat ("compressor", "range"),
-        {0.0, 3.0, 0.1})
+        {0.0, 3.0, 0.1}),
+    WidgetLabel (N_("<b>Limiter</b>")),
+    WidgetCheck (N_("Lookahead true-peak limiter"),
+        WidgetBool ("compressor", "limiter")),
+    WidgetSpin (N_("Lookahead:"),
+        WidgetInt ("compressor", "lookahead"),
+        {1, 50, 1, N_("ms")},
+        WIDGET_CHILD),
+    WidgetSpin (N_("Ceiling:"),
+        WidgetFloat ("compressor", "ceiling"),
+        {-12.0, 0.0, 0.1, N_("dBTP")},
+        WIDGET_CHILD)
 };
 
 static const PluginPreferences compressor_prefs = {{compressor_widgets}};
@@ -90,6 +111,7 @@ static Index<float> output;
 static int chunk_size;
 static float current_peak;
 static int current_channels, current_rate;
+static bool limiter_mode;
 
 /* I used to find the maximum sample and take that as the peak, but that doesn't
  * work well on badly clipped tracks.  Now, I use the highly sophisticated
@@ -122,6 +144,200 @@ static void do_ramp (float * data, int length, float peak_a, float peak_b)
     }
 }
 
+/* In limiter mode, the gain required to keep each sample (and the oversampled
+ * points between it and its neighbours) below the ceiling is computed as the
+ * samples come in.  A sliding-window minimum over the lookahead period, kept in
+ * a monotonic deque, gives the gain for each point in time; a box filter of the
+ * same length then turns the steps into ramps.  Every value averaged by the box
+ * filter is no greater than the gain required at the oldest sample in the
+ * window, so the output never exceeds the ceiling. */
+
+struct GainPoint {
+    int64_t pos;
+    float gain;
+};
+
+static float interp_coefs[LIMITER_PHASES - 1][LIMITER_TAPS];
+static Index<float> history;  /* per channel, doubled to avoid wrapping */
+static int history_pos;
+
+static RingBuf<float> delayed;   /* audio waiting for its gain to be known */
+static Index<GainPoint> window;  /* monotonic deque of required gains */
+static int window_head, window_len;
+static RingBuf<float> smoothing; /* box filter contents */
+static double smoothing_sum;
+
+static int lookahead, delay_frames;
+static float ceiling, release, envelope, prev_interp_peak;
+static int64_t frame_pos;
+
+static void calc_interp_coefs ()
+{
+    constexpr int half = LIMITER_TAPS / 2;
+
+    for (int p = 1; p < LIMITER_PHASES; p ++)
+    {
+        float * coefs = interp_coefs[p - 1];
+        float sum = 0;
+
+        for (int j = 0; j < LIMITER_TAPS; j ++)
+        {
+            /* distance from the interpolated point to the tap */
+            double d = j - half + 1 - (double) p / LIMITER_PHASES;
+            double sinc = sin (M_PI * d) / (M_PI * d);
+            double hann = 0.5 * (1 + cos (M_PI * d / half));
+
+            coefs[j] = sinc * hann;
+            sum += coefs[j];
+        }
+
+        for (int j = 0; j < LIMITER_TAPS; j ++)
+            coefs[j] /= sum;
+    }
+}
+
+static void limiter_start ()
+{
+    lookahead = aud::max (1, aud::rescale (aud_get_int ("compressor", "lookahead"), 1000, current_rate));
+    ceiling = powf (10, aud_get_double ("compressor", "ceiling") / 20);
+    release = 1 - expf (-1 / (LIMITER_RELEASE * current_rate));
+
+    /* the interpolation filter looks half its length into the future, and the
+     * box filter holds back another lookahead period minus the current frame */
+    delay_frames = LIMITER_TAPS / 2 + lookahead - 1;
+
+    calc_interp_coefs ();
+
+    history.resize (current_channels * LIMITER_TAPS * 2);
+    delayed.alloc (current_channels * (delay_frames + 1));
+    window.resize (lookahead + 1);
+    smoothing.alloc (lookahead);
+}
+
+static void limiter_flush ()
+{
+    for (float & f : history)
+        f = 0;
+
+    history_pos = 0;
+    delayed.discard ();
+    window_head = window_len = 0;
+    smoothing.discard ();
+    smoothing_sum = 0;
+
+    envelope = 1;
+    prev_interp_peak = 0;
+    frame_pos = 0;
+}
+
+static void limiter_cleanup ()
+{
+    history.clear ();
+    delayed.destroy ();
+    window.clear ();
+    smoothing.destroy ();
+}
+
+/* Stores one frame in the interpolation history and returns the peak of the
+ * sample LIMITER_TAPS / 2 frames back, including the oversampled points on
+ * either side of it. */
+static float push_true_peak (const float * frame)
+{
+    int span = LIMITER_TAPS * 2;
+    float interp_peak = 0, sample_peak = 0;
+
+    for (int c = 0; c < current_channels; c ++)
+    {
+        float * hist = & history[c * span];
+
+        hist[history_pos] = frame[c];
+        hist[history_pos + LIMITER_TAPS] = frame[c];
+
+        /* the last LIMITER_TAPS frames, oldest first */
+        const float * taps = hist + history_pos + 1;
+
+        sample_peak = aud::max (sample_peak, fabsf (taps[LIMITER_TAPS / 2 - 1]));
+
+        for (auto & coefs : interp_coefs)
+        {
+            float sum = 0;
+            for (int j = 0; j < LIMITER_TAPS; j ++)
+                sum += coefs[j] * taps[j];
+
+            interp_peak = aud::max (interp_peak, fabsf (sum));
+        }
+    }
+
+    history_pos = (history_pos + 1) % LIMITER_TAPS;
+
+    float peak = aud::max (sample_peak, aud::max (interp_peak, prev_interp_peak));
+    prev_interp_peak = interp_peak;
+
+    return peak;
+}
+
+/* Returns the gain to be applied to the frame leaving the delay line. */
+static float push_gain (float required)
+{
+    int size = window.len ();
+
+    /* drop values that can never be the minimum again */
+    while (window_len && window[(window_head + window_len - 1) % size].gain >= required)
+        window_len --;
+
+    window[(window_head + window_len) % size] = {frame_pos, required};
+    window_len ++;
+
+    if (window[window_head].pos <= frame_pos - lookahead)
+    {
+        window_head = (window_head + 1) % size;
+        window_len --;
+    }
+
+    frame_pos ++;
+
+    /* release slowly; the envelope never rises above the window minimum */
+    envelope = aud::min (window[window_head].gain, envelope + (1 - envelope) * release);
+
+    if (smoothing.len () == lookahead)
+    {
+        smoothing_sum -= smoothing.head ();
+        smoothing.pop ();
+    }
+
+    smoothing.push (envelope);
+    smoothing_sum += envelope;
+
+    /* before the box filter is full, the missing values count as unity gain */
+    return (smoothing_sum + (lookahead - smoothing.len ())) / lookahead;
+}
+
+static void limiter_process (const float * data, int frames)
+{
+    for (int f = 0; f < frames; f ++)
+    {
+        const float * frame = data + f * current_channels;
+        float peak = push_true_peak (frame);
+        float gain = push_gain ((peak > ceiling) ? ceiling / peak : 1.0f);
+
+        delayed.copy_in (frame, current_channels);
+
+        if (delayed.len () > current_channels * delay_frames)
+        {
+            for (int c = 0; c < current_channels; c ++)
+            {
+                output.append (delayed.head () * gain);
+                delayed.pop ();
+            }
+        }
+    }
+}
+
+static int limiter_delay ()
+{
+    return delayed.len () / current_channels;
+}
+
 bool Compressor::init ()
 {
     aud_config_set_defaults ("compressor", compressor_defaults);
@@ -133,12 +349,22 @@ void Compressor::cleanup ()
     buffer.destroy ();
     peaks.destroy ();
     output.clear ();
+
+    limiter_cleanup ();
 }
 
 void Compressor::start (int & channels, int & rate)
 {
     current_channels = channels;
     current_rate = rate;
+    limiter_mode = aud_get_bool ("compressor", "limiter");
+
+    if (limiter_mode)
+    {
+        limiter_start ();
+        flush (true);
+        return;
+    }
 
     chunk_size = channels * (int) (rate * CHUNK_TIME);
 
@@ -152,6 +378,12 @@ Index<float> & Compressor::process (Index<float> & data)
 {
     output.resize (0);
 
+    if (limiter_mode)
+    {
+        limiter_process (data.begin (), data.len () / current_channels);
+        return output;
+    }
+
     int offset = 0;
     int remain = data.len ();
 
@@ -194,6 +426,12 @@ Index<float> & Compressor::process (Index<float> & data)
 
 bool Compressor::flush (bool force)
 {
+    if (limiter_mode)
+    {
+        limiter_flush ();
+        return true;
+    }
+
     buffer.discard ();
     peaks.discard ();
 
@@ -205,6 +443,19 @@ Index<float> & Compressor::finish (Index<float> & data, bool end_of_playlist)
 {
     output.resize (0);
 
+    if (limiter_mode)
+    {
+        limiter_process (data.begin (), data.len () / current_channels);
+
+        /* push the delayed audio out with silence */
+        Index<float> silence;
+        silence.insert (0, current_channels * delay_frames);
+        limiter_process (silence.begin (), delay_frames);
+
+        limiter_flush ();
+        return output;
+    }
+
     peaks.discard ();
 
     while (buffer.len ())
@@ -227,5 +478,8 @@ Index<float> & Compressor::finish (Index<float> & data, bool end_of_playlist)
 
 int Compressor::adjust_delay (int delay)
 {
+    if (limiter_mode)
+        return delay + aud::rescale<int64_t> (limiter_delay (), current_rate, 1000);
+
     return delay + aud::rescale<int64_t> (buffer.len () / current_channels, current_rate, 1000);
 }
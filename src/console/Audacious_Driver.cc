@@ -6,8 +6,16 @@
  * http://www.slack.net/~ant/libs/
  */
 
+#include <chrono>
 #include <cstring>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
 #include <math.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
 
 #include <libaudcore/audstrings.h>
 #include <libaudcore/runtime.h>
@@ -15,11 +23,15 @@
 #include "configure.h"
 #include "plugin.h"
 #include "Music_Emu.h"
+#include "Emu_State.h"
 #include "Gzip_Reader.h"
 
 static const int fade_threshold = 10 * 1000;
 static const int fade_length    = 8 * 1000;
 
+static const int snapshot_interval = 10 * 1000;
+static const unsigned max_snapshots = 60;
+
 static bool log_err(blargg_err_t err)
 {
     if (err)
@@ -36,7 +48,9 @@ static void log_warning(Music_Emu * emu)
 
 /* Handles URL parsing, file opening and identification, and file
  * loading. Keeps file header around when loading rest of file to
- * avoid seeking and re-reading.
+ * avoid seeking and re-reading. Local uncompressed files are mapped
+ * and loaded in place instead, so emulators that keep the file data
+ * don't need a copy of it.
  */
 class ConsoleFileHandler {
 public:
@@ -59,6 +73,9 @@ private:
     char m_header[4];
     Vfs_File_Reader vfs_in;
     Gzip_Reader gzip_in;
+    GMappedFile *m_map = nullptr; // must outlive m_emu
+
+    bool map_file();
 };
 
 ConsoleFileHandler::ConsoleFileHandler(const char *path, VFSFile &fd)
@@ -96,6 +113,31 @@ ConsoleFileHandler::ConsoleFileHandler(const char *path, VFSFile &fd)
 ConsoleFileHandler::~ConsoleFileHandler()
 {
     gme_delete(m_emu);
+
+    if (m_map)
+        g_mapped_file_unref(m_map);
+}
+
+bool ConsoleFileHandler::map_file()
+{
+    StringBuf filename = uri_to_filename(m_path);
+    int fd = filename ? g_open(filename, O_RDONLY, 0) : -1;
+    if (fd < 0)
+        return false;
+
+    m_map = g_mapped_file_new_from_fd(fd, false, nullptr);
+    close(fd);
+
+    // a gzipped file won't match the (inflated) header
+    if (m_map && g_mapped_file_get_length(m_map) >= sizeof(m_header) &&
+        !memcmp(g_mapped_file_get_contents(m_map), m_header, sizeof(m_header)))
+        return true;
+
+    if (m_map)
+        g_mapped_file_unref(m_map);
+
+    m_map = nullptr;
+    return false;
 }
 
 int ConsoleFileHandler::load(int sample_rate)
@@ -110,10 +152,19 @@ int ConsoleFileHandler::load(int sample_rate)
         return 1;
     }
 
-    // combine header with remaining file data
-    Remaining_Reader reader(m_header, sizeof(m_header), &gzip_in);
-    if (log_err(m_emu->load(reader)))
-        return 1;
+    if (map_file())
+    {
+        if (log_err(m_emu->load_mem(g_mapped_file_get_contents(m_map),
+                                    g_mapped_file_get_length(m_map))))
+            return 1;
+    }
+    else
+    {
+        // combine header with remaining file data
+        Remaining_Reader reader(m_header, sizeof(m_header), &gzip_in);
+        if (log_err(m_emu->load(reader)))
+            return 1;
+    }
 
     // files can be closed now
     gzip_in.close();
@@ -141,6 +192,92 @@ int ConsoleFileHandler::load(int sample_rate)
     return 0;
 }
 
+/* Keeps a snapshot of the emulator state every few seconds of playback, so
+ * that a seek only has to emulate from the nearest earlier snapshot rather
+ * than from the start of the track. When the table fills up, every other
+ * snapshot is dropped and the interval doubled, so snapshots keep covering
+ * the whole track. Emulators that can't save their state fall back to
+ * Music_Emu::seek().
+ */
+class SeekSnapshots {
+public:
+    explicit SeekSnapshots(Music_Emu *emu) : m_emu(emu) {}
+
+    // Saves a snapshot if playback has moved past the last one
+    void update();
+
+    // Restores the nearest usable snapshot, then skips to msec
+    void seek(int msec);
+
+private:
+    struct Snapshot {
+        long time;
+        std::unique_ptr<Emu_State> state;
+    };
+
+    Music_Emu *m_emu;
+    std::vector<Snapshot> m_snapshots;
+    long m_interval = snapshot_interval;
+    bool m_enabled = true;
+};
+
+void SeekSnapshots::update()
+{
+    if (!m_enabled)
+        return;
+
+    long time = m_emu->tell();
+    if (!m_snapshots.empty() && time < m_snapshots.back().time + m_interval)
+        return;
+
+    if (m_snapshots.size() >= max_snapshots)
+    {
+        unsigned kept = 0;
+        for (unsigned i = 0; i < m_snapshots.size(); i += 2)
+            m_snapshots[kept++] = std::move(m_snapshots[i]);
+
+        m_snapshots.resize(kept);
+        m_interval *= 2;
+
+        if (time < m_snapshots.back().time + m_interval)
+            return;
+    }
+
+    std::unique_ptr<Emu_State> state(new Emu_State);
+    if (m_emu->save_state(*state))
+    {
+        m_enabled = false; // not supported by this emulator
+        return;
+    }
+
+    m_snapshots.push_back({time, std::move(state)});
+}
+
+void SeekSnapshots::seek(int msec)
+{
+    long time = m_emu->tell();
+
+    const Snapshot *nearest = nullptr;
+    for (const Snapshot &snapshot : m_snapshots)
+    {
+        if (snapshot.time <= msec)
+            nearest = &snapshot;
+    }
+
+    // when seeking forward, only worth it if the snapshot is ahead of us
+    if (nearest && (msec < time || nearest->time > time))
+    {
+        if (log_err(m_emu->load_state(*nearest->state)))
+        {
+            m_snapshots.clear();
+            m_enabled = false;
+            log_err(m_emu->start_track(m_emu->current_track()));
+        }
+    }
+
+    log_err(m_emu->seek(msec));
+}
+
 static int get_track_length(const track_info_t &info)
 {
     int length = info.length;
@@ -265,18 +402,29 @@ bool ConsolePlugin::play(const char *filename, VFSFile &file)
         length -= fade_length / 2;
     fh.m_emu->set_fade(length, fade_length);
 
+    // emulation speed, logged at debug level when playback stops
+    std::chrono::steady_clock::duration emu_time {};
+    int64_t emu_samples = 0;
+
+    SeekSnapshots snapshots(fh.m_emu);
+
     while (!check_stop())
     {
         /* Perform seek, if requested */
         int seek_value = check_seek();
         if (seek_value >= 0)
-            fh.m_emu->seek(seek_value);
+            snapshots.seek(seek_value);
+        else
+            snapshots.update();
 
         /* Fill and play buffer of audio */
         int const buf_size = 1024;
         Music_Emu::sample_t buf[buf_size];
 
+        auto start = std::chrono::steady_clock::now();
         fh.m_emu->play(buf_size, buf);
+        emu_time += std::chrono::steady_clock::now() - start;
+        emu_samples += buf_size;
 
         write_audio(buf, sizeof(buf));
 
@@ -284,5 +432,10 @@ bool ConsolePlugin::play(const char *filename, VFSFile &file)
             break;
     }
 
+    double emu_seconds = std::chrono::duration<double>(emu_time).count();
+    if (emu_seconds > 0)
+        AUDDBG("%s: %.1fx realtime\n", fh.m_type->system,
+               (double) emu_samples / (2 * sample_rate) / emu_seconds);
+
     return true;
 }
@@ -35,6 +35,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 #define CPU_IN( cpu, addr, TIME )\
 	ay_cpu_in( cpu, addr )
 
+#include "Emu_State.h"
 #include "blargg_source.h"
 
 // flags, named with hex value for clarity
@@ -141,6 +142,14 @@ typedef int         fint16;
 typedef unsigned    fuint16;
 typedef unsigned    fuint8;
 
+void Ay_Cpu::copy_state( Emu_State& s )
+{
+	assert( state == &state_ );
+	s.copy( r );
+	s.copy( state_ );
+	s.copy( end_time_ );
+}
+
 bool Ay_Cpu::run( cpu_time_t end_time )
 {
 	set_end_time( end_time );
@@ -12,6 +12,8 @@ typedef blargg_long cpu_time_t;
 void ay_cpu_out( class Ay_Cpu*, cpu_time_t, unsigned addr, int data );
 int ay_cpu_in( class Ay_Cpu*, unsigned addr );
 
+class Emu_State;
+
 class Ay_Cpu {
 public:
 	// Clear all registers and keep pointer to 64K memory passed in
@@ -21,6 +23,9 @@ public:
 	// instruction was encountered at any point during run.
 	bool run( cpu_time_t end_time );
 
+	// Save or load registers and timing (see Music_Emu::save_state())
+	void copy_state( Emu_State& );
+
 	// Time of beginning of next instruction
 	cpu_time_t time() const             { return state->time + state->base; }
 
@@ -2,6 +2,7 @@
 
 #include "Ay_Emu.h"
 
+#include "Emu_State.h"
 #include "blargg_endian.h"
 #include <string.h>
 
@@ -360,6 +361,20 @@ int ay_cpu_in( Ay_Cpu*, unsigned addr )
 	return 0xFF;
 }
 
+blargg_err_t Ay_Emu::copy_state_( Emu_State& s )
+{
+	RETURN_ERR( copy_buffer_state( s ) );
+	Ay_Cpu::copy_state( s );
+	s.copy( next_play );
+	s.copy( beeper_delta );
+	s.copy( last_beeper );
+	s.copy( apu_addr );
+	s.copy( cpc_latch );
+	s.copy( mem );
+	s.copy( apu );
+	return 0;
+}
+
 blargg_err_t Ay_Emu::run_clocks( blip_time_t& duration, int )
 {
 	set_time( 0 );
@@ -203,8 +203,9 @@ void Blip_Synth_Fast_::volume_unit( double new_unit )
 
 #if !BLIP_BUFFER_FAST
 
-Blip_Synth_::Blip_Synth_( short* p, int w ) :
+Blip_Synth_::Blip_Synth_( short* p, int w, short* k ) :
 	impulses( p ),
+	kernels( k ),
 	width( w )
 {
 	volume_unit_ = 0.0;
@@ -302,6 +303,26 @@ void Blip_Synth_::adjust_impulse()
 	//for ( int i = blip_res; i--; printf( "\n" ) )
 	//  for ( int j = 0; j < width / 2; j++ )
 	//      printf( "%5ld,", impulses [j * blip_res + i + 1] );
+
+	build_kernels();
+}
+
+void Blip_Synth_::build_kernels()
+{
+	if ( !kernels )
+		return;
+
+	// first half of each phase's taps runs backwards through impulses from
+	// blip_res - phase, second half forwards from phase (see offset_resampled())
+	for ( int phase = 0; phase < blip_res; phase++ )
+	{
+		short* out = &kernels [phase * width];
+		for ( int i = 0; i < width / 2; i++ )
+		{
+			out [i            ] = impulses [blip_res * (i + 1) - phase];
+			out [width - 1 - i] = impulses [blip_res * i + phase];
+		}
+	}
 }
 
 void Blip_Synth_::treble_eq( blip_eq_t const& eq )
@@ -137,6 +137,20 @@ private:
 	#endif
 #endif
 
+// Keep a copy of each Blip_Synth's impulse laid out by phase, so that a transition
+// can be added to the buffer with SSE2. Costs blip_res * quality shorts per synth.
+#ifndef BLIP_SYNTH_KERNELS
+	#ifdef __SSE2__
+		#define BLIP_SYNTH_KERNELS 1
+	#else
+		#define BLIP_SYNTH_KERNELS 0
+	#endif
+#endif
+
+#if BLIP_SYNTH_KERNELS
+	#include <emmintrin.h>
+#endif
+
 	// Internal
 	typedef blip_ulong blip_resampled_time_t;
 	int const blip_widest_impulse_ = 16;
@@ -162,15 +176,17 @@ private:
 		int delta_factor;
 
 		void volume_unit( double );
-		Blip_Synth_( short* impulses, int width );
+		Blip_Synth_( short* impulses, int width, short* kernels = 0 );
 		void treble_eq( blip_eq_t const& );
 	private:
 		double volume_unit_;
 		short* const impulses;
+		short* const kernels;
 		int const width;
 		blip_long kernel_unit;
 		int impulses_size() const { return blip_res / 2 * width + 1; }
 		void adjust_impulse();
+		void build_kernels();
 	};
 
 // Quality level. Start with blip_good_quality.
@@ -224,9 +240,16 @@ private:
 	Blip_Synth_ impl;
 	typedef short imp_t;
 	imp_t impulses [blip_res * (quality / 2) + 1];
+#if BLIP_SYNTH_KERNELS
+	// impulses rearranged so each phase's taps are contiguous, in output order
+	imp_t kernels [blip_res] [quality];
+public:
+	Blip_Synth() : impl( impulses, quality, kernels [0] ) { }
+#else
 public:
 	Blip_Synth() : impl( impulses, quality ) { }
 #endif
+#endif
 };
 
 // Low-pass equalization parameters
@@ -358,6 +381,39 @@ inline void Blip_Synth<quality,range>::offset_resampled( blip_resampled_time_t t
 	int const rev = fwd + quality - 2;
 	int const mid = quality / 2 - 1;
 
+#if BLIP_SYNTH_KERNELS
+	// Same products as ADD_IMP below, eight taps at a time. Each product is built
+	// from 16-bit halves of delta; only its low 32 bits are kept, as in ADD_IMP.
+	imp_t const* k = kernels [phase];
+	buf += fwd;
+	short const delta_lo = (short) delta;
+	__m128i const lo = _mm_set1_epi16( delta_lo );
+	__m128i const hi = _mm_set1_epi16( (short) ((blip_ulong) (delta - delta_lo) >> 16) );
+	__m128i const zero = _mm_setzero_si128();
+	for ( int n = 0; n + 8 <= quality; n += 8 )
+	{
+		__m128i c  = _mm_loadu_si128( (__m128i const*) &k [n] );
+		__m128i pl = _mm_mullo_epi16( c, lo );
+		__m128i ph = _mm_mulhi_epi16( c, lo );
+		__m128i x  = _mm_mullo_epi16( c, hi );
+		__m128i p0 = _mm_add_epi32( _mm_unpacklo_epi16( pl, ph ), _mm_unpacklo_epi16( zero, x ) );
+		__m128i p1 = _mm_add_epi32( _mm_unpackhi_epi16( pl, ph ), _mm_unpackhi_epi16( zero, x ) );
+		__m128i* out = (__m128i*) &buf [n];
+		_mm_storeu_si128( out,     _mm_add_epi32( _mm_loadu_si128( out     ), p0 ) );
+		_mm_storeu_si128( out + 1, _mm_add_epi32( _mm_loadu_si128( out + 1 ), p1 ) );
+	}
+	if ( quality & 4 )
+	{
+		__m128i c  = _mm_loadl_epi64( (__m128i const*) &k [quality - 4] );
+		__m128i p0 = _mm_add_epi32(
+				_mm_unpacklo_epi16( _mm_mullo_epi16( c, lo ), _mm_mulhi_epi16( c, lo ) ),
+				_mm_unpacklo_epi16( zero, _mm_mullo_epi16( c, hi ) ) );
+		__m128i* out = (__m128i*) &buf [quality - 4];
+		_mm_storeu_si128( out, _mm_add_epi32( _mm_loadu_si128( out ), p0 ) );
+	}
+	(void) rev;
+	(void) mid;
+#else
 	imp_t const* BLIP_RESTRICT imp = impulses + blip_res - phase;
 
 	#if defined (_M_IX86) || defined (_M_IA64) || defined (__i486__) || \
@@ -432,6 +488,7 @@ inline void Blip_Synth<quality,range>::offset_resampled( blip_resampled_time_t t
 		buf [rev    ] = t0;
 		buf [rev + 1] = t1;
 	#endif
+#endif
 
 #endif
 }
@@ -95,6 +95,11 @@ blargg_err_t Classic_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Classic_Emu::copy_buffer_state( Emu_State& s )
+{
+	return buf->copy_state( s );
+}
+
 blargg_err_t Classic_Emu::play_( long count, sample_t* out )
 {
 	long remain = count;
@@ -172,7 +177,11 @@ void Rom_Data_::set_addr_( long addr, int unit )
 	if ( addr < 0 )
 		addr = 0;
 	size_ = rounded;
-	if ( rom.resize( rounded - rom_addr + pad_extra ) ) { } // OK if shrink fails
+
+	// don't move data when size doesn't change, so that pointers to it held in
+	// saved state stay valid after track is restarted
+	long new_size = rounded - rom_addr + pad_extra;
+	if ( (unsigned long) new_size != rom.size() && rom.resize( new_size ) ) { } // OK if shrink fails
 
 	if ( 0 )
 	{
@@ -21,6 +21,9 @@ protected:
 	long clock_rate() const { return clock_rate_; }
 	void change_clock_rate( long ); // experimental
 
+	// Pass sound buffer state to Emu_State, as part of copy_state_()
+	blargg_err_t copy_buffer_state( Emu_State& );
+
 	// Overridable
 	virtual void set_voice( int index, Blip_Buffer* center,
 			Blip_Buffer* left, Blip_Buffer* right ) = 0;
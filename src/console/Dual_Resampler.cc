@@ -2,6 +2,7 @@
 
 #include "Dual_Resampler.h"
 
+#include "Emu_State.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -100,6 +101,18 @@ void Dual_Resampler::dual_play( long count, dsample_t* out, Blip_Buffer& blip_bu
 	}
 }
 
+void Dual_Resampler::copy_state( Emu_State& s )
+{
+	s.copy( buf_pos );
+	if ( (unsigned) buf_pos > (unsigned) sample_buf_size )
+	{
+		s.corrupt();
+		return;
+	}
+	s.copy( &sample_buf [buf_pos], (sample_buf_size - buf_pos) * sizeof sample_buf [0] );
+	resampler.copy_state( s );
+}
+
 void Dual_Resampler::mix_samples( Blip_Buffer& blip_buf, dsample_t* out )
 {
 	Blip_Reader sn;
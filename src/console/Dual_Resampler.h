@@ -21,6 +21,9 @@ public:
 
 	void dual_play( long count, dsample_t* out, Blip_Buffer& );
 
+	// Save or load resampler state and unread samples of current frame
+	void copy_state( Emu_State& );
+
 protected:
 	virtual int play_frame( blip_time_t, int pcm_count, dsample_t* pcm_out ) = 0;
 private:
@@ -2,6 +2,8 @@
 
 #include "Effects_Buffer.h"
 
+#include "Emu_State.h"
+
 #include <string.h>
 
 /* Copyright (C) 2003-2006 Shay Green. This module is free software; you
@@ -121,6 +123,25 @@ void Effects_Buffer::clear()
 		bufs [i].clear();
 }
 
+blargg_err_t Effects_Buffer::copy_state( Emu_State& s )
+{
+	for ( int i = 0; i < buf_count; i++ )
+		s.copy_buffer( bufs [i] );
+	s.copy( stereo_remain );
+	s.copy( effect_remain );
+	s.copy( effects_enabled );
+
+	// echo and reverb are unused otherwise, and cleared when effects are enabled
+	if ( config_.effects_enabled || effect_remain )
+	{
+		s.copy( echo_buf.begin(), echo_size * sizeof echo_buf [0] );
+		s.copy( reverb_buf.begin(), reverb_size * sizeof reverb_buf [0] );
+		s.copy( echo_pos );
+		s.copy( reverb_pos );
+	}
+	return 0;
+}
+
 inline int pin_range( int n, int max, int min = 0 )
 {
 	if ( n < min )
@@ -351,38 +372,9 @@ void Effects_Buffer::mix_mono( blip_sample_t* out_, blargg_long count )
 	BLIP_READER_END( c, bufs [0] );
 }
 
-void Effects_Buffer::mix_stereo( blip_sample_t* out_, blargg_long count )
+void Effects_Buffer::mix_stereo( blip_sample_t* out, blargg_long count )
 {
-	blip_sample_t* BLIP_RESTRICT out = out_;
-	int const bass = BLIP_READER_BASS( bufs [0] );
-	BLIP_READER_BEGIN( c, bufs [0] );
-	BLIP_READER_BEGIN( l, bufs [1] );
-	BLIP_READER_BEGIN( r, bufs [2] );
-
-	while ( count-- )
-	{
-		int cs = BLIP_READER_READ( c );
-		BLIP_READER_NEXT( c, bass );
-		int left = cs + BLIP_READER_READ( l );
-		int right = cs + BLIP_READER_READ( r );
-		BLIP_READER_NEXT( l, bass );
-		BLIP_READER_NEXT( r, bass );
-
-		if ( (int16_t) left != left )
-			left = 0x7FFF - (left >> 24);
-
-		out [0] = left;
-		out [1] = right;
-
-		out += 2;
-
-		if ( (int16_t) right != right )
-			out [-1] = 0x7FFF - (right >> 24);
-	}
-
-	BLIP_READER_END( r, bufs [2] );
-	BLIP_READER_END( l, bufs [1] );
-	BLIP_READER_END( c, bufs [0] );
+	Multi_Buffer::mix_stereo( out, count, bufs [0], bufs [1], bufs [2] );
 }
 
 void Effects_Buffer::mix_mono_enhanced( blip_sample_t* out_, blargg_long count )
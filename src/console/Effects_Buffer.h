@@ -48,6 +48,7 @@ public:
 	void end_frame( blip_time_t );
 	long read_samples( blip_sample_t*, long );
 	long samples_avail() const;
+	blargg_err_t copy_state( Emu_State& );
 private:
 	typedef long fixed_t;
 
@@ -0,0 +1,97 @@
+// Game_Music_Emu 0.5.5. http://www.slack.net/~ant/
+
+#include "Emu_State.h"
+
+#include "Blip_Buffer.h"
+#include <string.h>
+
+/* This module is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. This module is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser
+General Public License for more details. You should have received a copy of
+the GNU Lesser General Public License along with this module; if not, write
+to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+Boston, MA 02110-1301 USA */
+
+#include "blargg_source.h"
+
+Emu_State::Emu_State()
+{
+	size_ = 0;
+	pos   = 0;
+	mode  = size_mode;
+	error = 0;
+}
+
+Emu_State::~Emu_State() { }
+
+void Emu_State::clear()
+{
+	data.clear();
+	size_ = 0;
+}
+
+blargg_err_t Emu_State::begin( mode_t m )
+{
+	mode  = m;
+	pos   = 0;
+	error = 0;
+	if ( m == save_mode )
+		RETURN_ERR( data.resize( size_ ) );
+	else if ( m == load_mode && !size_ )
+		return "No saved state";
+	return 0;
+}
+
+blargg_err_t Emu_State::end()
+{
+	if ( mode == size_mode )
+		size_ = pos;
+	else if ( pos != size_ )
+		corrupt();
+	return error;
+}
+
+void Emu_State::copy( void* p, long n )
+{
+	if ( mode != size_mode && n )
+	{
+		if ( pos + n > size_ )
+		{
+			corrupt();
+			return;
+		}
+		if ( mode == save_mode )
+			memcpy( &data [pos], p, n );
+		else
+			memcpy( p, &data [pos], n );
+	}
+	pos += n;
+}
+
+void Emu_State::copy_buffer( Blip_Buffer& b )
+{
+	int modified = b.clear_modified();
+	copy( modified );
+	if ( modified )
+		b.set_modified();
+
+	copy( b.reader_accum_ );
+	copy( b.offset_ );
+	long avail = b.samples_avail();
+	if ( avail > b.buffer_size_ )
+	{
+		corrupt();
+		b.clear();
+		return;
+	}
+
+	// rest of buffer is always clear
+	long n = avail + blip_buffer_extra_;
+	copy( b.buffer_, n * sizeof *b.buffer_ );
+	if ( loading() )
+		memset( b.buffer_ + n, 0, (b.buffer_size_ - avail) * sizeof *b.buffer_ );
+}
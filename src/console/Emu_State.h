@@ -0,0 +1,57 @@
+// Snapshot of emulator state, for Music_Emu::save_state() and load_state()
+
+// Game_Music_Emu 0.5.5
+#ifndef EMU_STATE_H
+#define EMU_STATE_H
+
+#include "blargg_common.h"
+class Blip_Buffer;
+
+class Emu_State {
+public:
+	// Size of saved state, in bytes
+	long size() const { return size_; }
+
+	// Free saved state
+	void clear();
+
+// Used by emulators to describe their state
+
+	// Copy 'size' bytes at 'p' into state when saving, or from state into 'p'
+	// when loading. Blocks must be passed in the same order both ways.
+	void copy( void* p, long size );
+
+	// Copy variable or array
+	template<class T>
+	void copy( T& t ) { copy( &t, sizeof t ); }
+
+	// Copy unread samples and reader state of buffer
+	void copy_buffer( Blip_Buffer& );
+
+	// True if state is being loaded
+	bool loading() const { return mode == load_mode; }
+
+	// Report that loaded state doesn't fit the emulator
+	void corrupt() { error = "Corrupt saved state"; }
+
+public:
+	Emu_State();
+	~Emu_State();
+
+	// Used by Music_Emu
+	enum mode_t { size_mode, save_mode, load_mode };
+	blargg_err_t begin( mode_t );
+	blargg_err_t end();
+private:
+	blargg_vector<unsigned char> data;
+	long size_;
+	long pos;
+	mode_t mode;
+	blargg_err_t error;
+
+	// noncopyable
+	Emu_State( const Emu_State& );
+	Emu_State& operator = ( const Emu_State& );
+};
+
+#endif
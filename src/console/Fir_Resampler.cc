@@ -2,6 +2,7 @@
 
 #include "Fir_Resampler.h"
 
+#include "Emu_State.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -184,6 +185,22 @@ int Fir_Resampler_::avail_( blargg_long input_count ) const
 	return output_count;
 }
 
+void Fir_Resampler_::copy_state( Emu_State& s )
+{
+	long count = write_pos - buf.begin();
+	int phase = imp_phase;
+	s.copy( count );
+	s.copy( phase );
+	if ( (unsigned long) count > buf.size() || (unsigned) phase >= (unsigned) res )
+	{
+		s.corrupt();
+		return;
+	}
+	imp_phase = phase;
+	write_pos = buf.begin() + count;
+	s.copy( buf.begin(), count * sizeof buf [0] );
+}
+
 int Fir_Resampler_::skip_input( long count )
 {
 	int remain = write_pos - buf.begin();
@@ -6,6 +6,11 @@
 
 #include "blargg_common.h"
 #include <string.h>
+class Emu_State;
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
 
 class Fir_Resampler_ {
 public:
@@ -45,6 +50,9 @@ public:
 	// Skip 'count' input samples. Returns number of samples actually skipped.
 	int skip_input( long count );
 
+	// Save or load buffered input and phase (see Music_Emu::save_state())
+	void copy_state( Emu_State& );
+
 // Output
 
 	// Number of extra input samples needed until 'count' output samples are available
@@ -124,7 +132,41 @@ int Fir_Resampler<width>::read( sample_t* out_begin, blargg_long count )
 			if ( count < 0 )
 				break;
 
+		#ifdef __SSE2__
+			// Regroup input from L R L R to L L R R so that each madd pair
+			// holds two taps of the same channel, then accumulate in lanes
+			// l r l r. Sums wrap the same way as the scalar loop below.
+			int n = width / 4;
+			__m128i sum = _mm_setzero_si128();
+			for ( ; n >= 2; n -= 2 )
+			{
+				__m128i c  = _mm_loadu_si128( (__m128i const*) imp );
+				__m128i i0 = _mm_loadu_si128( (__m128i const*) i );
+				__m128i i1 = _mm_loadu_si128( (__m128i const*) (i + 8) );
+				i0 = _mm_shufflehi_epi16( _mm_shufflelo_epi16( i0, 0xD8 ), 0xD8 );
+				i1 = _mm_shufflehi_epi16( _mm_shufflelo_epi16( i1, 0xD8 ), 0xD8 );
+				sum = _mm_add_epi32( sum, _mm_madd_epi16( i0, _mm_unpacklo_epi32( c, c ) ) );
+				sum = _mm_add_epi32( sum, _mm_madd_epi16( i1, _mm_unpackhi_epi32( c, c ) ) );
+				imp += 8;
+				i += 16;
+			}
+			if ( n )
+			{
+				__m128i c  = _mm_loadl_epi64( (__m128i const*) imp );
+				__m128i i0 = _mm_loadu_si128( (__m128i const*) i );
+				i0 = _mm_shufflehi_epi16( _mm_shufflelo_epi16( i0, 0xD8 ), 0xD8 );
+				sum = _mm_add_epi32( sum, _mm_madd_epi16( i0, _mm_unpacklo_epi32( c, c ) ) );
+				imp += 4;
+				i += 8;
+			}
+			sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, 0x4E ) );
+			l = _mm_cvtsi128_si32( sum );
+			r = _mm_cvtsi128_si32( _mm_shuffle_epi32( sum, 0x01 ) );
+
+			if ( width & 2 )
+		#else
 			for ( int n = width / 2; n; --n )
+		#endif
 			{
 				int pt0 = imp [0];
 				l += pt0 * i [0];
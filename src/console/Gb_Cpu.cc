@@ -19,6 +19,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 
 #include "gb_cpu_io.h"
 
+#include "Emu_State.h"
 #include "blargg_source.h"
 
 // Common instructions:
@@ -87,6 +88,14 @@ unsigned const n_flag = 0x40;
 unsigned const h_flag = 0x20;
 unsigned const c_flag = 0x10;
 
+void Gb_Cpu::copy_state( Emu_State& s )
+{
+	assert( state == &state_ );
+	s.copy( r );
+	s.copy( rst_base );
+	s.copy( state_ );
+}
+
 bool Gb_Cpu::run( blargg_long cycle_count )
 {
 	state_.remain = blargg_ulong (cycle_count + clocks_per_instr) / clocks_per_instr;
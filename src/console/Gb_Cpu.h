@@ -10,6 +10,8 @@
 
 typedef unsigned gb_addr_t; // 16-bit CPU address
 
+class Emu_State;
+
 class Gb_Cpu {
 	enum { clocks_per_instr = 4 };
 public:
@@ -54,6 +56,9 @@ public:
 	// illegal instruction is encountered.
 	bool run( blargg_long count );
 
+	// Save or load registers and memory mapping (see Music_Emu::save_state())
+	void copy_state( Emu_State& );
+
 	// Number of clock cycles remaining for most recent run() call
 	blargg_long remain() const { return state->remain * clocks_per_instr; }
 
@@ -2,6 +2,7 @@
 
 #include "Gbs_Emu.h"
 
+#include "Emu_State.h"
 #include "blargg_endian.h"
 #include <string.h>
 
@@ -236,6 +237,19 @@ blargg_err_t Gbs_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Gbs_Emu::copy_state_( Emu_State& s )
+{
+	RETURN_ERR( copy_buffer_state( s ) );
+	Gb_Cpu::copy_state( s );
+	s.copy( cpu_time );
+	s.copy( next_play );
+	s.copy( ram );
+	s.copy( apu );
+	if ( s.loading() )
+		update_timer(); // timer registers are in ram
+	return 0;
+}
+
 blargg_err_t Gbs_Emu::run_clocks( blip_time_t& duration, int )
 {
 	cpu_time = 0;
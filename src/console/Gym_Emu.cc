@@ -2,6 +2,7 @@
 
 #include "Gym_Emu.h"
 
+#include "Emu_State.h"
 #include "blargg_endian.h"
 #include <string.h>
 
@@ -373,6 +374,30 @@ int Gym_Emu::play_frame( blip_time_t blip_time, int sample_count, sample_t* buf
 	return sample_count;
 }
 
+blargg_err_t Gym_Emu::copy_state_( Emu_State& s )
+{
+	// positions are saved as offsets so that state never points outside file data
+	long offsets [2] = { pos - data, loop_begin ? loop_begin - data : -1 };
+	s.copy( offsets );
+	if ( offsets [0] < 0 || offsets [0] > data_end - data || offsets [1] > data_end - data )
+	{
+		s.corrupt();
+		return 0;
+	}
+	pos        = data + offsets [0];
+	loop_begin = (offsets [1] < 0 ? 0 : data + offsets [1]);
+
+	s.copy( loop_remain );
+	s.copy( dac_amp );
+	s.copy( prev_dac_count );
+	s.copy( dac_enabled );
+	s.copy( apu );
+	fm.copy_state( s );
+	Dual_Resampler::copy_state( s );
+	s.copy_buffer( blip_buf );
+	return 0;
+}
+
 blargg_err_t Gym_Emu::play_( long count, sample_t* out )
 {
 	Dual_Resampler::dual_play( count, out, blip_buf );
@@ -52,6 +52,7 @@ protected:
 	void mute_voices_( int );
 	void set_tempo_( double );
 	int play_frame( blip_time_t blip_time, int sample_count, sample_t* buf );
+	blargg_err_t copy_state_( Emu_State& );
 private:
 	// sequence data begin, loop begin, current position, end
 	const byte* data;
@@ -28,6 +28,7 @@ int const ram_addr = 0x2000;
 
 #include "hes_cpu_io.h"
 
+#include "Emu_State.h"
 #include "blargg_source.h"
 
 #if BLARGG_NONPORTABLE
@@ -91,6 +92,17 @@ typedef unsigned    fuint16;
 typedef unsigned    fuint8;
 typedef blargg_long fint32;
 
+void Hes_Cpu::copy_state( Emu_State& s )
+{
+	assert( state == &state_ );
+	s.copy( ram );
+	s.copy( r );
+	s.copy( mmr );
+	s.copy( state_ );
+	s.copy( irq_time_ );
+	s.copy( end_time_ );
+}
+
 bool Hes_Cpu::run( hes_time_t end_time )
 {
 	bool illegal_encountered = false;
@@ -10,6 +10,8 @@ typedef blargg_long hes_time_t; // clock cycle count
 typedef unsigned hes_addr_t; // 16-bit address
 enum { future_hes_time = INT_MAX / 2 + 1 };
 
+class Emu_State;
+
 class Hes_Cpu {
 public:
 	void reset();
@@ -41,6 +43,9 @@ public:
 	// instructions were encountered.
 	bool run( hes_time_t end_time );
 
+	// Save or load registers, RAM, memory mapping and timing (see Music_Emu::save_state())
+	void copy_state( Emu_State& );
+
 	// Time of beginning of next instruction to be executed
 	hes_time_t time() const             { return state->time + state->base; }
 	void set_time( hes_time_t t )       { state->time = t - state->base; }
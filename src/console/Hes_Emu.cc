@@ -2,6 +2,7 @@
 
 #include "Hes_Emu.h"
 
+#include "Emu_State.h"
 #include "blargg_endian.h"
 #include <string.h>
 
@@ -504,6 +505,20 @@ static void adjust_time( blargg_long& time, hes_time_t delta )
 	}
 }
 
+blargg_err_t Hes_Emu::copy_state_( Emu_State& s )
+{
+	RETURN_ERR( copy_buffer_state( s ) );
+	Hes_Cpu::copy_state( s );
+	s.copy( write_pages );
+	s.copy( last_frame_hook );
+	s.copy( timer );
+	s.copy( vdp );
+	s.copy( irq );
+	s.copy( apu );
+	s.copy( sgx );
+	return 0;
+}
+
 blargg_err_t Hes_Emu::run_clocks( blip_time_t& duration_, int )
 {
 	blip_time_t const duration = duration_; // cache
@@ -38,6 +38,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 #define CPU_WRITE( cpu, addr, data, time )\
 	(SYNC_TIME(), kss_cpu_write( this, addr, data ))
 
+#include "Emu_State.h"
 #include "blargg_source.h"
 
 // flags, named with hex value for clarity
@@ -167,6 +168,14 @@ typedef int         fint16;
 typedef unsigned    fuint16;
 typedef unsigned    fuint8;
 
+void Kss_Cpu::copy_state( Emu_State& s )
+{
+	assert( state == &state_ );
+	s.copy( r );
+	s.copy( state_ );
+	s.copy( end_time_ );
+}
+
 bool Kss_Cpu::run( cpu_time_t end_time )
 {
 	set_end_time( end_time );
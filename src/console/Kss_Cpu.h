@@ -13,6 +13,8 @@ void kss_cpu_out( class Kss_Cpu*, cpu_time_t, unsigned addr, int data );
 int  kss_cpu_in( class Kss_Cpu*, cpu_time_t, unsigned addr );
 void kss_cpu_write( class Kss_Cpu*, unsigned addr, int data );
 
+class Emu_State;
+
 class Kss_Cpu {
 public:
 	// Clear registers and map all pages to unmapped
@@ -30,6 +32,9 @@ public:
 	// instruction was encountered at any point during run.
 	bool run( cpu_time_t end_time );
 
+	// Save or load registers, memory mapping and timing (see Music_Emu::save_state())
+	void copy_state( Emu_State& );
+
 	// Time of beginning of next instruction
 	cpu_time_t time() const             { return state->time + state->base; }
 
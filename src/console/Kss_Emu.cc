@@ -2,6 +2,7 @@
 
 #include "Kss_Emu.h"
 
+#include "Emu_State.h"
 #include "blargg_endian.h"
 #include <string.h>
 
@@ -374,6 +375,23 @@ int kss_cpu_in( Kss_Cpu*, cpu_time_t, unsigned addr )
 
 // Emulation
 
+blargg_err_t Kss_Emu::copy_state_( Emu_State& s )
+{
+	RETURN_ERR( copy_buffer_state( s ) );
+	Kss_Cpu::copy_state( s );
+	s.copy( scc_accessed );
+	s.copy( gain_updated );
+	s.copy( scc_enabled );
+	s.copy( next_play );
+	s.copy( ay_latch );
+	s.copy( ram );
+	s.copy( ay );
+	s.copy( scc );
+	if ( sn )
+		s.copy( *sn );
+	return 0;
+}
+
 blargg_err_t Kss_Emu::run_clocks( blip_time_t& duration, int )
 {
 	while ( time() < duration )
@@ -2,6 +2,12 @@
 
 #include "Multi_Buffer.h"
 
+#include "Emu_State.h"
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
 /* Copyright (C) 2003-2006 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -28,6 +34,11 @@ Multi_Buffer::Multi_Buffer( int spf ) : samples_per_frame_( spf )
 
 blargg_err_t Multi_Buffer::set_channel_count( int ) { return 0; }
 
+blargg_err_t Multi_Buffer::copy_state( Emu_State& )
+{
+	return "Sound buffer doesn't support saving state";
+}
+
 // Silent_Buffer
 
 Silent_Buffer::Silent_Buffer() : Multi_Buffer( 1 ) // 0 channels would probably confuse
@@ -55,6 +66,12 @@ blargg_err_t Mono_Buffer::set_sample_rate( long rate, int msec )
 	return Multi_Buffer::set_sample_rate( buf.sample_rate(), buf.length() );
 }
 
+blargg_err_t Mono_Buffer::copy_state( Emu_State& s )
+{
+	s.copy_buffer( buf );
+	return 0;
+}
+
 // Stereo_Buffer
 
 Stereo_Buffer::Stereo_Buffer() : Multi_Buffer( 2 )
@@ -93,6 +110,15 @@ void Stereo_Buffer::clear()
 		bufs [i].clear();
 }
 
+blargg_err_t Stereo_Buffer::copy_state( Emu_State& s )
+{
+	for ( int i = 0; i < buf_count; i++ )
+		s.copy_buffer( bufs [i] );
+	s.copy( stereo_added );
+	s.copy( was_stereo );
+	return 0;
+}
+
 void Stereo_Buffer::end_frame( blip_time_t clock_count )
 {
 	stereo_added = 0;
@@ -148,13 +174,67 @@ long Stereo_Buffer::read_samples( blip_sample_t* out, long count )
 	return count * 2;
 }
 
-void Stereo_Buffer::mix_stereo( blip_sample_t* out_, blargg_long count )
+void Multi_Buffer::mix_stereo( blip_sample_t* out_, blargg_long count,
+		Blip_Buffer& center_buf, Blip_Buffer& left_buf, Blip_Buffer& right_buf )
 {
 	blip_sample_t* BLIP_RESTRICT out = out_;
-	int const bass = BLIP_READER_BASS( bufs [1] );
-	BLIP_READER_BEGIN( left, bufs [1] );
-	BLIP_READER_BEGIN( right, bufs [2] );
-	BLIP_READER_BEGIN( center, bufs [0] );
+	int const bass = BLIP_READER_BASS( left_buf );
+	BLIP_READER_BEGIN( left, left_buf );
+	BLIP_READER_BEGIN( right, right_buf );
+	BLIP_READER_BEGIN( center, center_buf );
+
+#ifdef __SSE2__
+	// Run the three readers side by side in lanes c l r -, four samples at a
+	// time. packs saturates the same way as the clamp below.
+	if ( count >= 4 )
+	{
+		__m128i const zero  = _mm_setzero_si128();
+		__m128i const shift = _mm_cvtsi32_si128( bass );
+		__m128i acc = _mm_setr_epi32( center_reader_accum, left_reader_accum,
+				right_reader_accum, 0 );
+		do
+		{
+			__m128i c = _mm_loadu_si128( (__m128i const*) center_reader_buf );
+			__m128i l = _mm_loadu_si128( (__m128i const*) left_reader_buf );
+			__m128i r = _mm_loadu_si128( (__m128i const*) right_reader_buf );
+			center_reader_buf += 4;
+			left_reader_buf   += 4;
+			right_reader_buf  += 4;
+
+			__m128i cl0 = _mm_unpacklo_epi32( c, l );
+			__m128i cl1 = _mm_unpackhi_epi32( c, l );
+			__m128i r0  = _mm_unpacklo_epi32( r, zero );
+			__m128i r1  = _mm_unpackhi_epi32( r, zero );
+
+			#define NEXT( s, in ) \
+				__m128i s = _mm_srai_epi32( acc, blip_sample_bits - 16 );\
+				acc = _mm_add_epi32( _mm_sub_epi32( acc, _mm_sra_epi32( acc, shift ) ), in )
+
+			NEXT( s0, _mm_unpacklo_epi64( cl0, r0 ) );
+			NEXT( s1, _mm_unpackhi_epi64( cl0, r0 ) );
+			NEXT( s2, _mm_unpacklo_epi64( cl1, r1 ) );
+			NEXT( s3, _mm_unpackhi_epi64( cl1, r1 ) );
+			#undef NEXT
+
+			__m128i t0 = _mm_unpacklo_epi32( s0, s1 );
+			__m128i t1 = _mm_unpacklo_epi32( s2, s3 );
+			__m128i t2 = _mm_unpackhi_epi32( s0, s1 );
+			__m128i t3 = _mm_unpackhi_epi32( s2, s3 );
+			__m128i cs = _mm_unpacklo_epi64( t0, t1 );
+			__m128i lr = _mm_packs_epi32(
+					_mm_add_epi32( cs, _mm_unpackhi_epi64( t0, t1 ) ),
+					_mm_add_epi32( cs, _mm_unpacklo_epi64( t2, t3 ) ) );
+			_mm_storeu_si128( (__m128i*) out, _mm_unpacklo_epi16( lr, _mm_srli_si128( lr, 8 ) ) );
+			out += 8;
+			count -= 4;
+		}
+		while ( count >= 4 );
+
+		center_reader_accum = _mm_cvtsi128_si32( acc );
+		left_reader_accum   = _mm_cvtsi128_si32( _mm_shuffle_epi32( acc, 0x01 ) );
+		right_reader_accum  = _mm_cvtsi128_si32( _mm_shuffle_epi32( acc, 0x02 ) );
+	}
+#endif
 
 	for ( ; count; --count )
 	{
@@ -176,9 +256,14 @@ void Stereo_Buffer::mix_stereo( blip_sample_t* out_, blargg_long count )
 		out += 2;
 	}
 
-	BLIP_READER_END( center, bufs [0] );
-	BLIP_READER_END( right, bufs [2] );
-	BLIP_READER_END( left, bufs [1] );
+	BLIP_READER_END( center, center_buf );
+	BLIP_READER_END( right, right_buf );
+	BLIP_READER_END( left, left_buf );
+}
+
+void Stereo_Buffer::mix_stereo( blip_sample_t* out, blargg_long count )
+{
+	Multi_Buffer::mix_stereo( out, count, bufs [0], bufs [1], bufs [2] );
 }
 
 void Stereo_Buffer::mix_stereo_no_center( blip_sample_t* out_, blargg_long count )
@@ -6,6 +6,7 @@
 
 #include "blargg_common.h"
 #include "Blip_Buffer.h"
+class Emu_State;
 
 // Interface to one or more Blip_Buffers mapped to one or more channels
 // consisting of left, center, and right buffers.
@@ -47,12 +48,21 @@ public:
 	// a change is made to any of the Blip_Buffers for any channel.
 	unsigned channels_changed_count() { return channels_changed_count_; }
 
+	// Save or load unread samples (see Music_Emu::save_state()). Default returns
+	// error, for buffers that don't support it.
+	virtual blargg_err_t copy_state( Emu_State& );
+
 	// See Blip_Buffer.h
 	virtual long read_samples( blip_sample_t*, long ) = 0;
 	virtual long samples_avail() const = 0;
 
 protected:
 	void channels_changed() { channels_changed_count_++; }
+
+	// Reads count samples from each buffer and writes count stereo pairs of
+	// center + left and center + right to out
+	static void mix_stereo( blip_sample_t* out, blargg_long count,
+			Blip_Buffer& center, Blip_Buffer& left, Blip_Buffer& right );
 private:
 	// noncopyable
 	Multi_Buffer( const Multi_Buffer& );
@@ -83,6 +93,7 @@ public:
 	long read_samples( blip_sample_t* p, long s ) { return buf.read_samples( p, s ); }
 	channel_t channel( int, int ) { return chan; }
 	void end_frame( blip_time_t t ) { buf.end_frame( t ); }
+	blargg_err_t copy_state( Emu_State& );
 };
 
 // Uses three buffers (one for center) and outputs stereo sample pairs.
@@ -106,6 +117,7 @@ public:
 
 	long samples_avail() const { return bufs [0].samples_avail() * 2; }
 	long read_samples( blip_sample_t*, long );
+	blargg_err_t copy_state( Emu_State& );
 
 private:
 	enum { buf_count = 3 };
@@ -132,6 +144,7 @@ public:
 	void end_frame( blip_time_t ) { }
 	long samples_avail() const { return 0; }
 	long read_samples( blip_sample_t*, long ) { return 0; }
+	blargg_err_t copy_state( Emu_State& ) { return 0; }
 };
 
 
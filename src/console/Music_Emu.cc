@@ -3,6 +3,7 @@
 #include "Music_Emu.h"
 
 #include "Multi_Buffer.h"
+#include "Emu_State.h"
 #include <string.h>
 
 /* Copyright (C) 2003-2006 Shay Green. This module is free software; you
@@ -249,6 +250,63 @@ blargg_err_t Music_Emu::skip_( long count )
 	return 0;
 }
 
+// Save/load state
+
+blargg_err_t Music_Emu::copy_state_( Emu_State& )
+{
+	return "Emulator doesn't support saving state";
+}
+
+blargg_err_t Music_Emu::copy_state( Emu_State& s, int mode )
+{
+	require( current_track() >= 0 ); // start_track() must have been called already
+	RETURN_ERR( s.begin( (Emu_State::mode_t) mode ) );
+
+	// identify emulator and track, and don't touch anything if they don't match
+	Music_Emu* emu = this;
+	int track = current_track_;
+	long rate = sample_rate_;
+	s.copy( emu );
+	s.copy( track );
+	s.copy( rate );
+	if ( emu != this || track != current_track_ || rate != sample_rate_ )
+		return "Saved state is for a different track";
+
+	s.copy( out_time );
+	s.copy( emu_time );
+	s.copy( emu_track_ended_ );
+	bool ended = track_ended_;
+	s.copy( ended );
+	track_ended_ = ended;
+	s.copy( silence_time );
+	s.copy( silence_count );
+	s.copy( buf_remain );
+	s.copy( buf.begin(), buf.size() * sizeof (sample_t) );
+
+	blargg_err_t err = copy_state_( s );
+	if ( !err )
+		err = s.end();
+	if ( s.loading() )
+	{
+		if ( err )
+			emu_track_ended_ = track_ended_ = true; // state is now unusable
+		else
+			remute_voices(); // loaded sound chips might have saved other outputs
+	}
+	return err;
+}
+
+blargg_err_t Music_Emu::save_state( Emu_State& out )
+{
+	RETURN_ERR( copy_state( out, Emu_State::size_mode ) );
+	return copy_state( out, Emu_State::save_mode );
+}
+
+blargg_err_t Music_Emu::load_state( Emu_State& in )
+{
+	return copy_state( in, Emu_State::load_mode );
+}
+
 // Fading
 
 void Music_Emu::set_fade( long start_msec, long length_msec )
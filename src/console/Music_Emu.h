@@ -6,6 +6,7 @@
 
 #include "Gme_File.h"
 class Multi_Buffer;
+class Emu_State;
 
 struct Music_Emu : public Gme_File {
 public:
@@ -47,6 +48,13 @@ public:
 	// Skip n samples
 	blargg_err_t skip( long n );
 
+	// Save state of current track, so that play can later continue from this point
+	// by passing it to load_state(). State can only be loaded back into the same
+	// emulator, with the same track started and the file not reloaded since, and
+	// with the same sample rate, tempo and equalization. Not all emulators support this.
+	blargg_err_t save_state( Emu_State& out );
+	blargg_err_t load_state( Emu_State& in );
+
 	// True if a track has reached its end
 	bool track_ended() const;
 
@@ -122,6 +130,10 @@ protected:
 	virtual blargg_err_t start_track_( int ) = 0; // tempo is set before this
 	virtual blargg_err_t play_( long count, sample_t* out ) = 0;
 	virtual blargg_err_t skip_( long count );
+
+	// Pass all memory that changes while a track plays to Emu_State. Default returns
+	// error, for emulators that don't support saving state.
+	virtual blargg_err_t copy_state_( Emu_State& );
 protected:
 	virtual void unload();
 	virtual void pre_load();
@@ -147,6 +159,7 @@ private:
 	volatile bool track_ended_;
 	void clear_track_vars();
 	void end_track_if_error( blargg_err_t );
+	blargg_err_t copy_state( Emu_State&, int mode );
 
 	// fading
 	blargg_long fade_start;
@@ -27,6 +27,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 
 #include "nes_cpu_io.h"
 
+#include "Emu_State.h"
 #include "blargg_source.h"
 
 #ifndef CPU_DONE
@@ -117,6 +118,17 @@ typedef int         fint16;
 typedef unsigned    fuint16;
 typedef unsigned    fuint8;
 
+void Nes_Cpu::copy_state( Emu_State& s )
+{
+	assert( state == &state_ );
+	s.copy( low_mem );
+	s.copy( r );
+	s.copy( state_ );
+	s.copy( irq_time_ );
+	s.copy( end_time_ );
+	s.copy( error_count_ );
+}
+
 bool Nes_Cpu::run( nes_time_t end_time )
 {
 	set_end_time( end_time );
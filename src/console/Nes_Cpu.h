@@ -10,6 +10,8 @@ typedef blargg_long nes_time_t; // clock cycle count
 typedef unsigned nes_addr_t; // 16-bit address
 enum { future_nes_time = INT_MAX / 2 + 1 };
 
+class Emu_State;
+
 class Nes_Cpu {
 public:
 	// Clear registers, map low memory and its three mirrors to address 0,
@@ -43,6 +45,9 @@ public:
 	// stopped due to encountering bad_opcode.
 	bool run( nes_time_t end_time );
 
+	// Save or load registers, low memory and timing (see Music_Emu::save_state())
+	void copy_state( Emu_State& );
+
 	// Time of beginning of next instruction to be executed
 	nes_time_t time() const             { return state->time + state->base; }
 	void set_time( nes_time_t t )       { state->time = t - state->base; }
@@ -2,6 +2,7 @@
 
 #include "Nsf_Emu.h"
 
+#include "Emu_State.h"
 #include "blargg_endian.h"
 #include <string.h>
 #include <stdio.h>
@@ -485,6 +486,22 @@ blargg_err_t Nsf_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Nsf_Emu::copy_state_( Emu_State& s )
+{
+	RETURN_ERR( copy_buffer_state( s ) );
+	Nes_Cpu::copy_state( s );
+	s.copy( saved_state );
+	s.copy( next_play );
+	s.copy( play_extra );
+	s.copy( play_ready );
+	s.copy( sram );
+	s.copy( apu );
+	if ( namco ) s.copy( *namco );
+	if ( vrc6  ) s.copy( *vrc6  );
+	if ( fme7  ) s.copy( *fme7  );
+	return 0;
+}
+
 blargg_err_t Nsf_Emu::run_clocks( blip_time_t& duration, int )
 {
 	set_time( 0 );
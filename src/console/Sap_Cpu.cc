@@ -27,6 +27,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 	#define CPU_DONE( cpu, time, result_out )   { result_out = -1; }
 #endif
 
+#include "Emu_State.h"
 #include "blargg_source.h"
 
 int const st_n = 0x80;
@@ -72,6 +73,15 @@ typedef unsigned    fuint16;
 typedef unsigned    fuint8;
 typedef blargg_long fint32;
 
+void Sap_Cpu::copy_state( Emu_State& s )
+{
+	assert( state == &state_ );
+	s.copy( r );
+	s.copy( state_ );
+	s.copy( irq_time_ );
+	s.copy( end_time_ );
+}
+
 bool Sap_Cpu::run( sap_time_t end_time )
 {
 	bool illegal_encountered = false;
@@ -10,6 +10,8 @@ typedef blargg_long sap_time_t; // clock cycle count
 typedef unsigned sap_addr_t; // 16-bit address
 enum { future_sap_time = INT_MAX / 2 + 1 };
 
+class Emu_State;
+
 class Sap_Cpu {
 public:
 	// Clear all registers and keep pointer to 64K memory passed in
@@ -19,6 +21,9 @@ public:
 	// instruction was encountered at any point during run.
 	bool run( sap_time_t end_time );
 
+	// Save or load registers and timing (see Music_Emu::save_state())
+	void copy_state( Emu_State& );
+
 	// Registers are not updated until run() returns (except I flag in status)
 	struct registers_t {
 		uint16_t pc;
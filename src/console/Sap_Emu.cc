@@ -2,6 +2,7 @@
 
 #include "Sap_Emu.h"
 
+#include "Emu_State.h"
 #include "blargg_endian.h"
 #include <string.h>
 
@@ -488,6 +489,17 @@ inline void Sap_Emu::call_play()
 	}
 }
 
+blargg_err_t Sap_Emu::copy_state_( Emu_State& s )
+{
+	RETURN_ERR( copy_buffer_state( s ) );
+	Sap_Cpu::copy_state( s );
+	s.copy( next_play );
+	s.copy( mem );
+	s.copy( apu );
+	s.copy( apu2 );
+	return 0;
+}
+
 blargg_err_t Sap_Emu::run_clocks( blip_time_t& duration, int )
 {
 	set_time( 0 );
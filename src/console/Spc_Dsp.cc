@@ -5,6 +5,13 @@
 #include "blargg_endian.h"
 #include <string.h>
 
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+#ifdef __SSE4_1__
+	#include <smmintrin.h>
+#endif
+
 /* Copyright (C) 2007 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -161,12 +168,12 @@ inline void Spc_Dsp::init_counter()
 	int n = 2;
 	for ( int i = 1; i < 32; i++ )
 	{
-		m.counter_select [i] = &m.counters [n];
+		m.counter_select [i] = n;
 		if ( !--n )
 			n = 3;
 	}
-	m.counter_select [ 0] = &m.counters [0];
-	m.counter_select [30] = &m.counters [2];
+	m.counter_select [ 0] = 0;
+	m.counter_select [30] = 2;
 }
 
 inline void Spc_Dsp::run_counter( int i )
@@ -177,367 +184,455 @@ inline void Spc_Dsp::run_counter( int i )
 	m.counters [i] = n;
 }
 
-#define READ_COUNTER( rate )\
-	(*m.counter_select [rate] & counter_mask [rate])
+#define READ_COUNTER( counters, rate )\
+	((counters) [m.counter_select [rate]] & counter_mask [rate])
 
 
 //// Emulation
 
-void Spc_Dsp::run( int clock_count )
+// Advances the state shared by all voices by one sample
+inline void Spc_Dsp::run_clock( voice_clock_t& c, int noise_rate )
 {
-	int new_phase = m.phase + clock_count;
-	int count = new_phase >> 5;
-	m.phase = new_phase & 31;
-	if ( !count )
-		return;
+	// KON/KOFF reading
+	c.kon  = 0;
+	c.koff = 0;
+	if ( (m.every_other_sample ^= 1) != 0 )
+	{
+		m.new_kon &= ~m.kon;
+		m.kon    = m.new_kon;
+		m.t_koff = REG(koff);
+		c.kon    = m.kon;
+		c.koff   = m.t_koff;
+	}
+
+	run_counter( 1 );
+	run_counter( 2 );
+	run_counter( 3 );
+
+	// Noise
+	if ( !READ_COUNTER( m.counters, noise_rate ) )
+	{
+		int feedback = (m.noise << 13) ^ (m.noise << 14);
+		m.noise = (feedback & 0x4000) ^ (m.noise >> 1);
+	}
+
+	c.noise = m.noise;
+	memcpy( c.counters, m.counters, sizeof c.counters );
+}
+
+// Runs voice for one sample and returns its output (before volume)
+BLARGG_FORCE_INLINE int Spc_Dsp::run_voice( voice_t* v, uint8_t* v_regs, int vbit, int pmon_input,
+		voice_clock_t const& c, uint8_t const* dir, int slow_gaussian )
+{
+	#define SAMPLE_PTR(i) GET_LE16A( &dir [VREG(v_regs,srcn) * 4 + i * 2] )
 
 	uint8_t* const ram = m.ram;
-	uint8_t const* const dir = &ram [REG(dir) * 0x100];
-	int const slow_gaussian = (REG(pmon) >> 1) | REG(non);
-	int const noise_rate = REG(flg) & 0x1F;
+	int brr_header = ram [v->brr_addr];
+	int kon_delay = v->kon_delay;
 
-	// Global volume
-	int mvoll = (int8_t) REG(mvoll);
-	int mvolr = (int8_t) REG(mvolr);
-	if ( mvoll * mvolr < m.surround_threshold )
-		mvoll = -mvoll; // eliminate surround
+	// Pitch
+	int pitch = GET_LE16A( &VREG(v_regs,pitchl) ) & 0x3FFF;
+	if ( REG(pmon) & vbit )
+		pitch += ((pmon_input >> 5) * pitch) >> 10;
 
-	do
+	// KON phases
+	if ( --kon_delay >= 0 )
 	{
-		// KON/KOFF reading
-		if ( (m.every_other_sample ^= 1) != 0 )
+		v->kon_delay = kon_delay;
+
+		// Get ready to start BRR decoding on next sample
+		if ( kon_delay == 4 )
 		{
-			m.new_kon &= ~m.kon;
-			m.kon    = m.new_kon;
-			m.t_koff = REG(koff);
+			v->brr_addr   = SAMPLE_PTR( 0 );
+			v->brr_offset = 1;
+			v->buf_pos    = v->buf;
+			brr_header    = 0; // header is ignored on this sample
 		}
 
-		run_counter( 1 );
-		run_counter( 2 );
-		run_counter( 3 );
+		// Envelope is never run during KON
+		v->env        = 0;
+		v->hidden_env = 0;
 
-		// Noise
-		if ( !READ_COUNTER( noise_rate ) )
-		{
-			int feedback = (m.noise << 13) ^ (m.noise << 14);
-			m.noise = (feedback & 0x4000) ^ (m.noise >> 1);
-		}
+		// Disable BRR decoding until last three samples
+		v->interp_pos = (kon_delay & 3 ? 0x4000 : 0);
 
-		// Voices
-		int pmon_input = 0;
-		int main_out_l = 0;
-		int main_out_r = 0;
-		int echo_out_l = 0;
-		int echo_out_r = 0;
-		voice_t* v = m.voices;
-		uint8_t* v_regs = m.regs;
-		int vbit = 1;
-		do
-		{
-			#define SAMPLE_PTR(i) GET_LE16A( &dir [VREG(v_regs,srcn) * 4 + i * 2] )
+		// Pitch is never added during KON
+		pitch = 0;
+	}
 
-			int brr_header = ram [v->brr_addr];
-			int kon_delay = v->kon_delay;
+	int env = v->env;
+
+	// Gaussian interpolation
+	int output = 0;
+	VREG(v_regs,envx) = (uint8_t) (env >> 4);
+	if ( env )
+	{
+		// Make pointers into gaussian based on fractional position between samples
+		int offset = (unsigned) v->interp_pos >> 3 & 0x1FE;
+		short const* fwd = interleved_gauss       + offset;
+		short const* rev = interleved_gauss + 510 - offset; // mirror left half of gaussian
 
-			// Pitch
-			int pitch = GET_LE16A( &VREG(v_regs,pitchl) ) & 0x3FFF;
-			if ( REG(pmon) & vbit )
-				pitch += ((pmon_input >> 5) * pitch) >> 10;
+		int const* in = &v->buf_pos [(unsigned) v->interp_pos >> 12];
 
-			// KON phases
-			if ( --kon_delay >= 0 )
+		if ( !(slow_gaussian & vbit) ) // 99%
+		{
+			// Faster approximation when exact sample value isn't necessary for pitch mod
+			output = (fwd [0] * in [0] +
+			          fwd [1] * in [1] +
+			          rev [1] * in [2] +
+			          rev [0] * in [3]) >> 11;
+			output = (output * env) >> 11;
+		}
+		else
+		{
+			output = (int16_t) (c.noise * 2);
+			if ( !(REG(non) & vbit) )
 			{
-				v->kon_delay = kon_delay;
+				output  = (fwd [0] * in [0]) >> 11;
+				output += (fwd [1] * in [1]) >> 11;
+				output += (rev [1] * in [2]) >> 11;
+				output = (int16_t) output;
+				output += (rev [0] * in [3]) >> 11;
+
+				CLAMP16( output );
+				output &= ~1;
+			}
+			output = (output * env) >> 11 & ~1;
+		}
+	}
+	VREG(v_regs,outx) = (uint8_t) (output >> 8);
 
-				// Get ready to start BRR decoding on next sample
-				if ( kon_delay == 4 )
-				{
-					v->brr_addr   = SAMPLE_PTR( 0 );
-					v->brr_offset = 1;
-					v->buf_pos    = v->buf;
-					brr_header    = 0; // header is ignored on this sample
-				}
+	// Soft reset or end of sample
+	if ( REG(flg) & 0x80 || (brr_header & 3) == 1 )
+	{
+		v->env_mode = env_release;
+		env         = 0;
+	}
 
-				// Envelope is never run during KON
-				v->env        = 0;
-				v->hidden_env = 0;
+	// KOFF
+	if ( c.koff & vbit )
+		v->env_mode = env_release;
 
-				// Disable BRR decoding until last three samples
-				v->interp_pos = (kon_delay & 3 ? 0x4000 : 0);
+	// KON
+	if ( c.kon & vbit )
+	{
+		v->kon_delay = 5;
+		v->env_mode  = env_attack;
+		REG(endx) &= ~vbit;
+	}
 
-				// Pitch is never added during KON
-				pitch = 0;
+	// Envelope
+	if ( !v->kon_delay )
+	{
+		if ( v->env_mode == env_release ) // 97%
+		{
+			env -= 0x8;
+			v->env = env;
+			if ( env <= 0 )
+			{
+				v->env = 0;
+				return output; // no BRR decoding for you!
 			}
-
-			int env = v->env;
-
-			// Gaussian interpolation
+		}
+		else // 3%
+		{
+			int rate;
+			int const adsr0 = VREG(v_regs,adsr0);
+			int env_data = VREG(v_regs,adsr1);
+			if ( adsr0 >= 0x80 ) // 97% ADSR
 			{
-				int output = 0;
-				VREG(v_regs,envx) = (uint8_t) (env >> 4);
-				if ( env )
+				if ( v->env_mode > env_decay ) // 89%
 				{
-					// Make pointers into gaussian based on fractional position between samples
-					int offset = (unsigned) v->interp_pos >> 3 & 0x1FE;
-					short const* fwd = interleved_gauss       + offset;
-					short const* rev = interleved_gauss + 510 - offset; // mirror left half of gaussian
+					env--;
+					env -= env >> 8;
+					rate = env_data & 0x1F;
 
-					int const* in = &v->buf_pos [(unsigned) v->interp_pos >> 12];
-
-					if ( !(slow_gaussian & vbit) ) // 99%
+					// optimized handling
+					v->hidden_env = env;
+					if ( READ_COUNTER( c.counters, rate ) )
+						goto exit_env;
+					v->env = env;
+					goto exit_env;
+				}
+				else if ( v->env_mode == env_decay )
+				{
+					env--;
+					env -= env >> 8;
+					rate = (adsr0 >> 3 & 0x0E) + 0x10;
+				}
+				else // env_attack
+				{
+					rate = (adsr0 & 0x0F) * 2 + 1;
+					env += rate < 31 ? 0x20 : 0x400;
+				}
+			}
+			else // GAIN
+			{
+				int mode;
+				env_data = VREG(v_regs,gain);
+				mode = env_data >> 5;
+				if ( mode < 4 ) // direct
+				{
+					env = env_data * 0x10;
+					rate = 31;
+				}
+				else
+				{
+					rate = env_data & 0x1F;
+					if ( mode == 4 ) // 4: linear decrease
 					{
-						// Faster approximation when exact sample value isn't necessary for pitch mod
-						output = (fwd [0] * in [0] +
-						          fwd [1] * in [1] +
-						          rev [1] * in [2] +
-						          rev [0] * in [3]) >> 11;
-						output = (output * env) >> 11;
+						env -= 0x20;
 					}
-					else
+					else if ( mode < 6 ) // 5: exponential decrease
 					{
-						output = (int16_t) (m.noise * 2);
-						if ( !(REG(non) & vbit) )
-						{
-							output  = (fwd [0] * in [0]) >> 11;
-							output += (fwd [1] * in [1]) >> 11;
-							output += (rev [1] * in [2]) >> 11;
-							output = (int16_t) output;
-							output += (rev [0] * in [3]) >> 11;
-
-							CLAMP16( output );
-							output &= ~1;
-						}
-						output = (output * env) >> 11 & ~1;
+						env--;
+						env -= env >> 8;
 					}
-
-					// Output
-					int l = output * v->volume [0];
-					int r = output * v->volume [1];
-
-					main_out_l += l;
-					main_out_r += r;
-
-					if ( REG(eon) & vbit )
+					else // 6,7: linear increase
 					{
-						echo_out_l += l;
-						echo_out_r += r;
+						env += 0x20;
+						if ( mode > 6 && (unsigned) v->hidden_env >= 0x600 )
+							env += 0x8 - 0x20; // 7: two-slope linear increase
 					}
 				}
-
-				pmon_input = output;
-				VREG(v_regs,outx) = (uint8_t) (output >> 8);
 			}
 
-			// Soft reset or end of sample
-			if ( REG(flg) & 0x80 || (brr_header & 3) == 1 )
+			// Sustain level
+			if ( (env >> 8) == (env_data >> 5) && v->env_mode == env_decay )
+				v->env_mode = env_sustain;
+
+			v->hidden_env = env;
+
+			// unsigned cast because linear decrease going negative also triggers this
+			if ( (unsigned) env > 0x7FF )
 			{
-				v->env_mode = env_release;
-				env         = 0;
+				env = (env < 0 ? 0 : 0x7FF);
+				if ( v->env_mode == env_attack )
+					v->env_mode = env_decay;
 			}
 
-			if ( m.every_other_sample )
-			{
-				// KOFF
-				if ( m.t_koff & vbit )
-					v->env_mode = env_release;
+			if ( !READ_COUNTER( c.counters, rate ) )
+				v->env = env; // nothing else is controlled by the counter
+		}
+	}
+exit_env:
 
-				// KON
-				if ( m.kon & vbit )
+	{
+		// Apply pitch
+		int old_pos = v->interp_pos;
+		int interp_pos = (old_pos & 0x3FFF) + pitch;
+		if ( interp_pos > 0x7FFF )
+			interp_pos = 0x7FFF;
+		v->interp_pos = interp_pos;
+
+		// BRR decode if necessary
+		if ( old_pos >= 0x4000 )
+		{
+			// Arrange the four input nybbles in 0xABCD order for easy decoding
+			int nybbles = ram [(v->brr_addr + v->brr_offset) & 0xFFFF] * 0x100 +
+					ram [(v->brr_addr + v->brr_offset + 1) & 0xFFFF];
+
+			// Advance read position
+			int const brr_block_size = 9;
+			int brr_offset = v->brr_offset;
+			if ( (brr_offset += 2) >= brr_block_size )
+			{
+				// Next BRR block
+				int brr_addr = (v->brr_addr + brr_block_size) & 0xFFFF;
+				assert( brr_offset == brr_block_size );
+				if ( brr_header & 1 )
 				{
-					v->kon_delay = 5;
-					v->env_mode  = env_attack;
-					REG(endx) &= ~vbit;
+					brr_addr = SAMPLE_PTR( 1 );
+					if ( !v->kon_delay )
+						REG(endx) |= vbit;
 				}
+				v->brr_addr = brr_addr;
+				brr_offset  = 1;
 			}
+			v->brr_offset = brr_offset;
+
+			// Decode
 
-			// Envelope
-			if ( !v->kon_delay )
+			// 0: >>1  1: <<0  2: <<1 ... 12: <<11  13-15: >>4 <<11
+			static unsigned char const shifts [16 * 2] = {
+				13,12,12,12,12,12,12,12,12,12,12, 12, 12, 16, 16, 16,
+				 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 11, 11, 11
+			};
+			int const scale = brr_header >> 4;
+			int const right_shift = shifts [scale];
+			int const left_shift  = shifts [scale + 16];
+
+			// Write to next four samples in circular buffer
+			int* pos = v->buf_pos;
+			int* end;
+
+			// Decode four samples
+			for ( end = pos + 4; pos < end; pos++, nybbles <<= 4 )
 			{
-				if ( v->env_mode == env_release ) // 97%
-				{
-					env -= 0x8;
-					v->env = env;
-					if ( env <= 0 )
-					{
-						v->env = 0;
-						goto skip_brr; // no BRR decoding for you!
-					}
-				}
-				else // 3%
+				// Extract upper nybble and scale appropriately
+				int s = ((int16_t) nybbles >> right_shift) << left_shift;
+
+				// Apply IIR filter (8 is the most commonly used)
+				int const filter = brr_header & 0x0C;
+				int const p1 = pos [brr_buf_size - 1];
+				int const p2 = pos [brr_buf_size - 2] >> 1;
+				if ( filter >= 8 )
 				{
-					int rate;
-					int const adsr0 = VREG(v_regs,adsr0);
-					int env_data = VREG(v_regs,adsr1);
-					if ( adsr0 >= 0x80 ) // 97% ADSR
+					s += p1;
+					s -= p2;
+					if ( filter == 8 ) // s += p1 * 0.953125 - p2 * 0.46875
 					{
-						if ( v->env_mode > env_decay ) // 89%
-						{
-							env--;
-							env -= env >> 8;
-							rate = env_data & 0x1F;
-
-							// optimized handling
-							v->hidden_env = env;
-							if ( READ_COUNTER( rate ) )
-								goto exit_env;
-							v->env = env;
-							goto exit_env;
-						}
-						else if ( v->env_mode == env_decay )
-						{
-							env--;
-							env -= env >> 8;
-							rate = (adsr0 >> 3 & 0x0E) + 0x10;
-						}
-						else // env_attack
-						{
-							rate = (adsr0 & 0x0F) * 2 + 1;
-							env += rate < 31 ? 0x20 : 0x400;
-						}
+						s += p2 >> 4;
+						s += (p1 * -3) >> 6;
 					}
-					else // GAIN
+					else // s += p1 * 0.8984375 - p2 * 0.40625
 					{
-						int mode;
-						env_data = VREG(v_regs,gain);
-						mode = env_data >> 5;
-						if ( mode < 4 ) // direct
-						{
-							env = env_data * 0x10;
-							rate = 31;
-						}
-						else
-						{
-							rate = env_data & 0x1F;
-							if ( mode == 4 ) // 4: linear decrease
-							{
-								env -= 0x20;
-							}
-							else if ( mode < 6 ) // 5: exponential decrease
-							{
-								env--;
-								env -= env >> 8;
-							}
-							else // 6,7: linear increase
-							{
-								env += 0x20;
-								if ( mode > 6 && (unsigned) v->hidden_env >= 0x600 )
-									env += 0x8 - 0x20; // 7: two-slope linear increase
-							}
-						}
+						s += (p1 * -13) >> 7;
+						s += (p2 * 3) >> 4;
 					}
+				}
+				else if ( filter ) // s += p1 * 0.46875
+				{
+					s += p1 >> 1;
+					s += (-p1) >> 5;
+				}
 
-					// Sustain level
-					if ( (env >> 8) == (env_data >> 5) && v->env_mode == env_decay )
-						v->env_mode = env_sustain;
+				// Adjust and write sample
+				CLAMP16( s );
+				s = (int16_t) (s * 2);
+				pos [brr_buf_size] = pos [0] = s; // second copy simplifies wrap-around
+			}
 
-					v->hidden_env = env;
+			if ( pos >= &v->buf [brr_buf_size] )
+				pos = v->buf;
+			v->buf_pos = pos;
+		}
+	}
 
-					// unsigned cast because linear decrease going negative also triggers this
-					if ( (unsigned) env > 0x7FF )
-					{
-						env = (env < 0 ? 0 : 0x7FF);
-						if ( v->env_mode == env_attack )
-							v->env_mode = env_decay;
-					}
+	return output;
+}
 
-					if ( !READ_COUNTER( rate ) )
-						v->env = env; // nothing else is controlled by the counter
-				}
-			}
-		exit_env:
+// Runs echo and writes one output sample from the summed voice outputs
+BLARGG_FORCE_INLINE void Spc_Dsp::run_echo( int main_out_l, int main_out_r, int echo_out_l, int echo_out_r,
+		int mvoll, int mvolr )
+{
+	uint8_t* const ram = m.ram;
 
-			{
-				// Apply pitch
-				int old_pos = v->interp_pos;
-				int interp_pos = (old_pos & 0x3FFF) + pitch;
-				if ( interp_pos > 0x7FFF )
-					interp_pos = 0x7FFF;
-				v->interp_pos = interp_pos;
-
-				// BRR decode if necessary
-				if ( old_pos >= 0x4000 )
-				{
-					// Arrange the four input nybbles in 0xABCD order for easy decoding
-					int nybbles = ram [(v->brr_addr + v->brr_offset) & 0xFFFF] * 0x100 +
-							ram [(v->brr_addr + v->brr_offset + 1) & 0xFFFF];
-
-					// Advance read position
-					int const brr_block_size = 9;
-					int brr_offset = v->brr_offset;
-					if ( (brr_offset += 2) >= brr_block_size )
-					{
-						// Next BRR block
-						int brr_addr = (v->brr_addr + brr_block_size) & 0xFFFF;
-						assert( brr_offset == brr_block_size );
-						if ( brr_header & 1 )
-						{
-							brr_addr = SAMPLE_PTR( 1 );
-							if ( !v->kon_delay )
-								REG(endx) |= vbit;
-						}
-						v->brr_addr = brr_addr;
-						brr_offset  = 1;
-					}
-					v->brr_offset = brr_offset;
+	// Echo position
+	int echo_offset = m.echo_offset;
+	uint8_t* const echo_ptr = &ram [(REG(esa) * 0x100 + echo_offset) & 0xFFFF];
+	if ( !echo_offset )
+		m.echo_length = (REG(edl) & 0x0F) * 0x800;
+	echo_offset += 4;
+	if ( echo_offset >= m.echo_length )
+		echo_offset = 0;
+	m.echo_offset = echo_offset;
+
+	// FIR
+	int echo_in_l = GET_LE16SA( echo_ptr + 0 );
+	int echo_in_r = GET_LE16SA( echo_ptr + 2 );
+
+	int (*echo_hist_pos) [2] = m.echo_hist_pos;
+	if ( ++echo_hist_pos >= &m.echo_hist [echo_hist_size] )
+		echo_hist_pos = m.echo_hist;
+	m.echo_hist_pos = echo_hist_pos;
+
+	echo_hist_pos [0] [0] = echo_hist_pos [8] [0] = echo_in_l;
+	echo_hist_pos [0] [1] = echo_hist_pos [8] [1] = echo_in_r;
+
+	#define CALC_FIR_( i, in )  ((in) * (int8_t) REG(fir + i * 0x10))
+	echo_in_l = CALC_FIR_( 7, echo_in_l );
+	echo_in_r = CALC_FIR_( 7, echo_in_r );
+
+	#define CALC_FIR( i, ch )   CALC_FIR_( i, echo_hist_pos [i + 1] [ch] )
+	#define DO_FIR( i )\
+		echo_in_l += CALC_FIR( i, 0 );\
+		echo_in_r += CALC_FIR( i, 1 );
+	DO_FIR( 0 );
+	DO_FIR( 1 );
+	DO_FIR( 2 );
+	#if defined (__MWERKS__) && __MWERKS__ < 0x3200
+		__eieio(); // keeps compiler from stupidly "caching" things in memory
+	#endif
+	DO_FIR( 3 );
+	DO_FIR( 4 );
+	DO_FIR( 5 );
+	DO_FIR( 6 );
 
-					// Decode
+	// Echo out
+	if ( !(REG(flg) & 0x20) )
+	{
+		int l = (echo_out_l >> 7) + ((echo_in_l * (int8_t) REG(efb)) >> 14);
+		int r = (echo_out_r >> 7) + ((echo_in_r * (int8_t) REG(efb)) >> 14);
 
-					// 0: >>1  1: <<0  2: <<1 ... 12: <<11  13-15: >>4 <<11
-					static unsigned char const shifts [16 * 2] = {
-						13,12,12,12,12,12,12,12,12,12,12, 12, 12, 16, 16, 16,
-						 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 11, 11, 11
-					};
-					int const scale = brr_header >> 4;
-					int const right_shift = shifts [scale];
-					int const left_shift  = shifts [scale + 16];
+		// just to help pass more validation tests
+		#if SPC_MORE_ACCURACY
+			l &= ~1;
+			r &= ~1;
+		#endif
 
-					// Write to next four samples in circular buffer
-					int* pos = v->buf_pos;
-					int* end;
+		CLAMP16( l );
+		CLAMP16( r );
 
-					// Decode four samples
-					for ( end = pos + 4; pos < end; pos++, nybbles <<= 4 )
-					{
-						// Extract upper nybble and scale appropriately
-						int s = ((int16_t) nybbles >> right_shift) << left_shift;
-
-						// Apply IIR filter (8 is the most commonly used)
-						int const filter = brr_header & 0x0C;
-						int const p1 = pos [brr_buf_size - 1];
-						int const p2 = pos [brr_buf_size - 2] >> 1;
-						if ( filter >= 8 )
-						{
-							s += p1;
-							s -= p2;
-							if ( filter == 8 ) // s += p1 * 0.953125 - p2 * 0.46875
-							{
-								s += p2 >> 4;
-								s += (p1 * -3) >> 6;
-							}
-							else // s += p1 * 0.8984375 - p2 * 0.40625
-							{
-								s += (p1 * -13) >> 7;
-								s += (p2 * 3) >> 4;
-							}
-						}
-						else if ( filter ) // s += p1 * 0.46875
-						{
-							s += p1 >> 1;
-							s += (-p1) >> 5;
-						}
-
-						// Adjust and write sample
-						CLAMP16( s );
-						s = (int16_t) (s * 2);
-						pos [brr_buf_size] = pos [0] = s; // second copy simplifies wrap-around
-					}
+		SET_LE16A( echo_ptr + 0, l );
+		SET_LE16A( echo_ptr + 2, r );
+	}
 
-					if ( pos >= &v->buf [brr_buf_size] )
-						pos = v->buf;
-					v->buf_pos = pos;
-				}
+	// Sound out
+	int l = (main_out_l * mvoll + echo_in_l * (int8_t) REG(evoll)) >> 14;
+	int r = (main_out_r * mvolr + echo_in_r * (int8_t) REG(evolr)) >> 14;
+
+	CLAMP16( l );
+	CLAMP16( r );
+
+	if ( (REG(flg) & 0x40) )
+	{
+		l = 0;
+		r = 0;
+	}
+
+	sample_t* out = m.out;
+	WRITE_SAMPLES( l, r, out );
+	m.out = out;
+}
+
+// Runs all voices one sample at a time. Used when run_block() can't be.
+void Spc_Dsp::run_samples( int count, uint8_t const* dir, int slow_gaussian, int noise_rate,
+		int mvoll, int mvolr )
+{
+	do
+	{
+		voice_clock_t c;
+		run_clock( c, noise_rate );
+
+		// Voices
+		int pmon_input = 0;
+		int main_out_l = 0;
+		int main_out_r = 0;
+		int echo_out_l = 0;
+		int echo_out_r = 0;
+		voice_t* v = m.voices;
+		uint8_t* v_regs = m.regs;
+		int vbit = 1;
+		do
+		{
+			int output = run_voice( v, v_regs, vbit, pmon_input, c, dir, slow_gaussian );
+
+			// Output
+			int l = output * v->volume [0];
+			int r = output * v->volume [1];
+
+			main_out_l += l;
+			main_out_r += r;
+
+			if ( REG(eon) & vbit )
+			{
+				echo_out_l += l;
+				echo_out_r += r;
 			}
-skip_brr:
+
+			pmon_input = output;
+
 			// Next voice
 			vbit <<= 1;
 			v_regs += 0x10;
@@ -545,84 +640,188 @@ skip_brr:
 		}
 		while ( vbit < 0x100 );
 
-		// Echo position
-		int echo_offset = m.echo_offset;
-		uint8_t* const echo_ptr = &ram [(REG(esa) * 0x100 + echo_offset) & 0xFFFF];
-		if ( !echo_offset )
-			m.echo_length = (REG(edl) & 0x0F) * 0x800;
-		echo_offset += 4;
-		if ( echo_offset >= m.echo_length )
-			echo_offset = 0;
-		m.echo_offset = echo_offset;
-
-		// FIR
-		int echo_in_l = GET_LE16SA( echo_ptr + 0 );
-		int echo_in_r = GET_LE16SA( echo_ptr + 2 );
-
-		int (*echo_hist_pos) [2] = m.echo_hist_pos;
-		if ( ++echo_hist_pos >= &m.echo_hist [echo_hist_size] )
-			echo_hist_pos = m.echo_hist;
-		m.echo_hist_pos = echo_hist_pos;
-
-		echo_hist_pos [0] [0] = echo_hist_pos [8] [0] = echo_in_l;
-		echo_hist_pos [0] [1] = echo_hist_pos [8] [1] = echo_in_r;
-
-		#define CALC_FIR_( i, in )  ((in) * (int8_t) REG(fir + i * 0x10))
-		echo_in_l = CALC_FIR_( 7, echo_in_l );
-		echo_in_r = CALC_FIR_( 7, echo_in_r );
-
-		#define CALC_FIR( i, ch )   CALC_FIR_( i, echo_hist_pos [i + 1] [ch] )
-		#define DO_FIR( i )\
-			echo_in_l += CALC_FIR( i, 0 );\
-			echo_in_r += CALC_FIR( i, 1 );
-		DO_FIR( 0 );
-		DO_FIR( 1 );
-		DO_FIR( 2 );
-		#if defined (__MWERKS__) && __MWERKS__ < 0x3200
-			__eieio(); // keeps compiler from stupidly "caching" things in memory
-		#endif
-		DO_FIR( 3 );
-		DO_FIR( 4 );
-		DO_FIR( 5 );
-		DO_FIR( 6 );
+		run_echo( main_out_l, main_out_r, echo_out_l, echo_out_r, mvoll, mvolr );
+	}
+	while ( --count );
+}
 
-		// Echo out
-		if ( !(REG(flg) & 0x20) )
-		{
-			int l = (echo_out_l >> 7) + ((echo_in_l * (int8_t) REG(efb)) >> 14);
-			int r = (echo_out_r >> 7) + ((echo_in_r * (int8_t) REG(efb)) >> 14);
+// True if the ranges [a, a + a_size) and [b, b + b_size) of RAM overlap
+static inline bool ram_overlaps( int a, int a_size, int b, int b_size )
+{
+	return ((b - a) & 0xFFFF) < a_size || ((a - b) & 0xFFFF) < b_size;
+}
 
-			// just to help pass more validation tests
-			#if SPC_MORE_ACCURACY
-				l &= ~1;
-				r &= ~1;
-			#endif
+// True if echo writes during the next count samples could change sample
+// directory entries or BRR data that voices read in that time, which would
+// make the result depend on the order voices and echo are run in.
+bool Spc_Dsp::echo_overlaps_voices( int count ) const
+{
+	if ( REG(flg) & 0x20 )
+		return false;
 
-			CLAMP16( l );
-			CLAMP16( r );
+	int const echo_addr = REG(esa) * 0x100;
+	int echo_size = (REG(edl) & 0x0F) * 0x800;
+	if ( echo_size < m.echo_length )
+		echo_size = m.echo_length;
+	echo_size += 4;
 
-			SET_LE16A( echo_ptr + 0, l );
-			SET_LE16A( echo_ptr + 2, r );
-		}
+	uint8_t const* const dir = &m.ram [REG(dir) * 0x100];
+	for ( int i = 0; i < voice_count; i++ )
+	{
+		voice_t const& v = m.voices [i];
+		uint8_t const* const v_regs = &m.regs [i * 0x10];
+
+		int const dir_addr = (REG(dir) * 0x100 + VREG(v_regs,srcn) * 4) & 0xFFFF;
+		if ( ram_overlaps( echo_addr, echo_size, dir_addr, 4 ) )
+			return true;
+
+		// A voice decodes two bytes of BRR data at most once per sample (plus a
+		// few times during KON), and pitch modulation can at most double pitch.
+		int pitch = GET_LE16A( &VREG(v_regs,pitchl) ) & 0x3FFF;
+		if ( REG(pmon) & (1 << i) )
+			pitch *= 2;
+		int decodes = ((count * pitch) >> 14) + 6;
+		if ( decodes > count + 4 )
+			decodes = count + 4;
+		int const brr_size = (decodes / 4 + 2) * 9;
+
+		if ( ram_overlaps( echo_addr, echo_size, v.brr_addr, brr_size ) ||
+				ram_overlaps( echo_addr, echo_size, SAMPLE_PTR( 0 ), brr_size ) ||
+				ram_overlaps( echo_addr, echo_size, SAMPLE_PTR( 1 ), brr_size ) )
+			return true;
+	}
 
-		// Sound out
-		int l = (main_out_l * mvoll + echo_in_l * (int8_t) REG(evoll)) >> 14;
-		int r = (main_out_r * mvolr + echo_in_r * (int8_t) REG(evolr)) >> 14;
+	return false;
+}
 
-		CLAMP16( l );
-		CLAMP16( r );
+#ifdef __SSE2__
+// Low 32 bits of each lane of a * b
+static inline __m128i mul_lanes( __m128i a, __m128i b )
+{
+#ifdef __SSE4_1__
+	return _mm_mullo_epi32( a, b );
+#else
+	__m128i even = _mm_shuffle_epi32( _mm_mul_epu32( a, b ), _MM_SHUFFLE( 0, 0, 2, 0 ) );
+	__m128i odd  = _mm_shuffle_epi32( _mm_mul_epu32( _mm_srli_epi64( a, 32 ), b ),
+			_MM_SHUFFLE( 0, 0, 2, 0 ) );
+	return _mm_unpacklo_epi32( even, odd );
+#endif
+}
+#endif
+
+// Adds output [i] * vol to sum [i]
+static inline void mix_voice( int* sum, int const* output, int vol, int count )
+{
+	int i = 0;
+#ifdef __SSE2__
+	__m128i const v = _mm_set1_epi32( vol );
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		__m128i s = _mm_loadu_si128( (__m128i const*) &sum [i] );
+		__m128i o = _mm_loadu_si128( (__m128i const*) &output [i] );
+		_mm_storeu_si128( (__m128i*) &sum [i], _mm_add_epi32( s, mul_lanes( o, v ) ) );
+	}
+#endif
+	for ( ; i < count; i++ )
+		sum [i] += output [i] * vol;
+}
 
-		if ( (REG(flg) & 0x40) )
+// Runs count samples (at most block_size) one voice at a time: the state
+// shared by voices is stepped first, then each voice runs through all
+// samples, then echo and output. Gives the same result as run_samples()
+// as long as echo writes don't touch what voices read.
+void Spc_Dsp::run_block( int count, uint8_t const* dir, int slow_gaussian, int noise_rate,
+		int mvoll, int mvolr )
+{
+	voice_clock_t clocks [block_size];
+	int kon = 0;
+	for ( int i = 0; i < count; i++ )
+	{
+		run_clock( clocks [i], noise_rate );
+		kon |= clocks [i].kon;
+	}
+
+	int main_out_l [block_size];
+	int main_out_r [block_size];
+	int echo_out_l [block_size];
+	int echo_out_r [block_size];
+	int output [2] [block_size];
+	int* pmon_input = output [0];
+	int* voice_out  = output [1];
+	memset( main_out_l, 0, count * sizeof *main_out_l );
+	memset( main_out_r, 0, count * sizeof *main_out_r );
+	memset( echo_out_l, 0, count * sizeof *echo_out_l );
+	memset( echo_out_r, 0, count * sizeof *echo_out_r );
+	memset( pmon_input, 0, count * sizeof *pmon_input );
+
+	voice_t* v = m.voices;
+	uint8_t* v_regs = m.regs;
+	for ( int vbit = 1; vbit < 0x100; vbit <<= 1, v_regs += 0x10, v++ )
+	{
+		if ( !v->kon_delay && v->env_mode == env_release && !v->env && !(kon & vbit) )
 		{
-			l = 0;
-			r = 0;
+			// Silent and stays silent, so each sample would do nothing but
+			// clear ENVX and OUTX
+			VREG(v_regs,envx) = 0;
+			VREG(v_regs,outx) = 0;
+			memset( voice_out, 0, count * sizeof *voice_out );
+		}
+		else
+		{
+			for ( int i = 0; i < count; i++ )
+				voice_out [i] = run_voice( v, v_regs, vbit, pmon_input [i],
+						clocks [i], dir, slow_gaussian );
+
+			mix_voice( main_out_l, voice_out, v->volume [0], count );
+			mix_voice( main_out_r, voice_out, v->volume [1], count );
+			if ( REG(eon) & vbit )
+			{
+				mix_voice( echo_out_l, voice_out, v->volume [0], count );
+				mix_voice( echo_out_r, voice_out, v->volume [1], count );
+			}
 		}
 
-		sample_t* out = m.out;
-		WRITE_SAMPLES( l, r, out );
-		m.out = out;
+		// this voice's output modulates the next one's pitch
+		int* t = pmon_input;
+		pmon_input = voice_out;
+		voice_out = t;
 	}
-	while ( --count );
+
+	for ( int i = 0; i < count; i++ )
+		run_echo( main_out_l [i], main_out_r [i], echo_out_l [i], echo_out_r [i], mvoll, mvolr );
+}
+
+void Spc_Dsp::run( int clock_count )
+{
+	int new_phase = m.phase + clock_count;
+	int count = new_phase >> 5;
+	m.phase = new_phase & 31;
+	if ( !count )
+		return;
+
+	uint8_t const* const dir = &m.ram [REG(dir) * 0x100];
+	int const slow_gaussian = (REG(pmon) >> 1) | REG(non);
+	int const noise_rate = REG(flg) & 0x1F;
+
+	// Global volume
+	int mvoll = (int8_t) REG(mvoll);
+	int mvolr = (int8_t) REG(mvolr);
+	if ( mvoll * mvolr < m.surround_threshold )
+		mvoll = -mvoll; // eliminate surround
+
+	// Registers can't change until this returns, so the whole run can be
+	// done in blocks, one voice at a time
+	while ( count )
+	{
+		int n = (count < block_size ? count : block_size);
+		if ( echo_overlaps_voices( n ) )
+			break;
+		run_block( n, dir, slow_gaussian, noise_rate, mvoll, mvolr );
+		count -= n;
+	}
+
+	if ( count )
+		run_samples( count, dir, slow_gaussian, noise_rate, mvoll, mvolr );
 }
 
 
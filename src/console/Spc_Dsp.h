@@ -125,7 +125,7 @@ private:
 
 		voice_t voices [voice_count];
 
-		unsigned* counter_select [32];
+		unsigned char counter_select [32]; // index into counters
 
 		// non-emulation state
 		uint8_t* ram; // 64K shared RAM between DSP and SMP
@@ -138,11 +138,34 @@ private:
 	};
 	state_t m;
 
+	// Global state the voices see during one sample
+	struct voice_clock_t
+	{
+		int noise;
+		int kon;                // KON bits to act on (0 on samples where KON isn't read)
+		int koff;
+		unsigned counters [4];
+	};
+
+	// Samples are run in blocks of up to block_size, one voice at a time
+	enum { block_size = 64 };
+
 	void init_counter();
 	void run_counter( int );
 	void soft_reset_common();
 	void write_outline( int addr, int data );
 	void update_voice_vol( int addr );
+
+	void run_clock( voice_clock_t&, int noise_rate );
+	int  run_voice( voice_t*, uint8_t* v_regs, int vbit, int pmon_input,
+			voice_clock_t const&, uint8_t const* dir, int slow_gaussian );
+	void run_echo( int main_out_l, int main_out_r, int echo_out_l, int echo_out_r,
+			int mvoll, int mvolr );
+	void run_samples( int count, uint8_t const* dir, int slow_gaussian, int noise_rate,
+			int mvoll, int mvolr );
+	bool echo_overlaps_voices( int count ) const;
+	void run_block( int count, uint8_t const* dir, int slow_gaussian, int noise_rate,
+			int mvoll, int mvolr );
 };
 
 #include <assert.h>
@@ -2,6 +2,7 @@
 
 #include "Spc_Emu.h"
 
+#include "Emu_State.h"
 #include "blargg_endian.h"
 #include <stdlib.h>
 #include <string.h>
@@ -331,6 +332,14 @@ blargg_err_t Spc_Emu::skip_( long count )
 	return play_( resampler_latency, buf );
 }
 
+blargg_err_t Spc_Emu::copy_state_( Emu_State& s )
+{
+	resampler.copy_state( s );
+	s.copy( filter );
+	s.copy( apu );
+	return 0;
+}
+
 blargg_err_t Spc_Emu::play_( long count, sample_t* out )
 {
 	if ( sample_rate() == native_sample_rate )
@@ -2,6 +2,7 @@
 
 #include "Vgm_Emu.h"
 
+#include "Emu_State.h"
 #include "blargg_endian.h"
 #include <string.h>
 #include <math.h>
@@ -406,6 +407,40 @@ blargg_err_t Vgm_Emu::run_clocks( blip_time_t& time_io, int msec )
 	return 0;
 }
 
+blargg_err_t Vgm_Emu::copy_state_( Emu_State& s )
+{
+	// positions are saved as offsets so that state never points outside file data
+	long offsets [3] = { pos - data, pcm_pos - data, pcm_data - data };
+	s.copy( offsets );
+	for ( int i = 0; i < 3; i++ )
+	{
+		if ( offsets [i] < 0 || offsets [i] > data_end - data )
+		{
+			s.corrupt();
+			return 0;
+		}
+	}
+	pos      = data + offsets [0];
+	pcm_pos  = data + offsets [1];
+	pcm_data = data + offsets [2];
+
+	s.copy( vgm_time );
+	s.copy( dac_amp );
+	s.copy( dac_disabled );
+	s.copy( psg );
+	if ( !uses_fm )
+		return copy_buffer_state( s );
+
+	s.copy( fm_time_offset );
+	Dual_Resampler::copy_state( s );
+	s.copy_buffer( blip_buf );
+	if ( ym2612.enabled() )
+		ym2612.copy_state( s );
+	if ( ym2413.enabled() )
+		ym2413.copy_state( s );
+	return 0;
+}
+
 blargg_err_t Vgm_Emu::play_( long count, sample_t* out )
 {
 	if ( !uses_fm )
@@ -2145,6 +2145,7 @@ OPLL_calc_stereo (OPLL * opll, e_int32 out[2])
 
 // Ym2413_Emu
 #include "Ym2413_Emu.h"
+#include "Emu_State.h"
 
 #include <assert.h>
 
@@ -2203,6 +2204,11 @@ void Ym2413_Emu::mute_voices( int mask )
 	OPLL_setMask( opll, mask );
 }
 
+void Ym2413_Emu::copy_state( Emu_State& s )
+{
+	s.copy( *opll );
+}
+
 void Ym2413_Emu::run( int pair_count, sample_t* out )
 {
 	while ( pair_count-- )
@@ -4,6 +4,8 @@
 #ifndef YM2413_EMU_H
 #define YM2413_EMU_H
 
+class Emu_State;
+
 class Ym2413_Emu  {
 	struct OPLL* opll;
 public:
@@ -21,6 +23,9 @@ public:
 	enum { channel_count = 14 };
 	void mute_voices( int mask );
 
+	// Save or load chip state (see Music_Emu::save_state())
+	void copy_state( Emu_State& );
+
 	// Write 'data' to 'addr'
 	void write( int addr, int data );
 
@@ -4,6 +4,7 @@
 
 #include "Ym2612_Emu.h"
 
+#include "Emu_State.h"
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
@@ -11,6 +12,13 @@
 #include <stdio.h>
 #include <math.h>
 
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+#ifdef __SSE4_1__
+	#include <smmintrin.h>
+#endif
+
 /* Copyright (C) 2002 Stphane Dallongeville (gens AT consolemul.com) */
 /* Copyright (C) 2004-2006 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
@@ -961,6 +969,13 @@ void Ym2612_Emu::write1( int addr, int data )
 
 void Ym2612_Emu::mute_voices( int mask ) { impl->mute_mask = mask; }
 
+void Ym2612_Emu::copy_state( Emu_State& s )
+{
+	s.copy( impl->YM2612 );
+	s.copy( impl->g.LFOcnt );
+	s.copy( impl->g.LFOinc );
+}
+
 static void update_envelope_( slot_t* sl )
 {
 	switch ( sl->Ecurp )
@@ -1031,6 +1046,52 @@ inline void update_envelope( slot_t& sl )
 		update_envelope_( &sl );
 }
 
+#ifdef __SSE2__
+
+// The four operators of a channel are kept in the lanes of SSE registers
+// (lane n = SLOT [n]) so that their envelope levels, envelope counters and
+// phase counters are all stepped at once. Only the table lookups and the
+// algorithm's operator graph remain scalar. Results are bit-identical to the
+// scalar code below.
+
+inline __m128i slot_lanes( channel_t const& ch, int slot_t::* f )
+{
+	return _mm_set_epi32( ch.SLOT [3].*f, ch.SLOT [2].*f, ch.SLOT [1].*f, ch.SLOT [0].*f );
+}
+
+inline void store_slot_lanes( channel_t& ch, int slot_t::* f, __m128i v )
+{
+	int n [4];
+	_mm_storeu_si128( (__m128i*) n, v );
+	ch.SLOT [0].*f = n [0];
+	ch.SLOT [1].*f = n [1];
+	ch.SLOT [2].*f = n [2];
+	ch.SLOT [3].*f = n [3];
+}
+
+// env_LFO >> AMS, done as (env_LFO * (1 << (14 - AMS))) >> 14 so that every
+// lane can use its own shift. AMS is always 0, 1, 4 (LFO_AMS_TAB) or 31 (off),
+// and env_LFO is well below 1 << 15.
+inline int ams_mul( int ams )
+{
+	return (ams > 14) ? 0 : 1 << (14 - ams);
+}
+
+// Low 32 bits of each lane of a * b
+inline __m128i mul_lanes( __m128i a, __m128i a_odd, __m128i b )
+{
+#ifdef __SSE4_1__
+	(void) a_odd;
+	return _mm_mullo_epi32( a, b );
+#else
+	__m128i even = _mm_shuffle_epi32( _mm_mul_epu32( a,     b ), _MM_SHUFFLE( 0, 0, 2, 0 ) );
+	__m128i odd  = _mm_shuffle_epi32( _mm_mul_epu32( a_odd, b ), _MM_SHUFFLE( 0, 0, 2, 0 ) );
+	return _mm_unpacklo_epi32( even, odd );
+#endif
+}
+
+#endif
+
 template<int algo>
 struct ym2612_update_chan {
 	static void func( tables_t&, channel_t&, Ym2612_Emu::sample_t*, int );
@@ -1059,10 +1120,26 @@ void ym2612_update_chan<algo>::func( tables_t& g, channel_t& ch,
 
 	int CH_S0_OUT_1 = ch.S0_OUT [1];
 
+#ifdef __SSE2__
+	__m128i Fcnt = slot_lanes( ch, &slot_t::Fcnt );
+	__m128i const Finc = slot_lanes( ch, &slot_t::Finc );
+	__m128i const Finc_odd = _mm_srli_epi64( Finc, 32 );
+	__m128i const TLL = slot_lanes( ch, &slot_t::TLL );
+	__m128i const AMS_mul = _mm_set_epi32( ams_mul( ch.SLOT [3].AMS ), ams_mul( ch.SLOT [2].AMS ),
+			ams_mul( ch.SLOT [1].AMS ), ams_mul( ch.SLOT [0].AMS ) );
+
+	// changed only by update_envelope_()
+	__m128i Ecnt    = slot_lanes( ch, &slot_t::Ecnt );
+	__m128i Einc    = slot_lanes( ch, &slot_t::Einc );
+	__m128i Ecmp    = slot_lanes( ch, &slot_t::Ecmp );
+	__m128i env_xor = slot_lanes( ch, &slot_t::env_xor );
+	__m128i env_max = slot_lanes( ch, &slot_t::env_max );
+#else
 	int in0 = ch.SLOT [S0].Fcnt;
 	int in1 = ch.SLOT [S1].Fcnt;
 	int in2 = ch.SLOT [S2].Fcnt;
 	int in3 = ch.SLOT [S3].Fcnt;
+#endif
 
 	int YM2612_LFOinc = g.LFOinc;
 	int YM2612_LFOcnt = g.LFOcnt + YM2612_LFOinc;
@@ -1077,6 +1154,34 @@ void ym2612_update_chan<algo>::func( tables_t& g, channel_t& ch,
 
 		short const* const ENV_TAB = g.ENV_TAB;
 
+	#ifdef __SSE2__
+		int in [4];
+		_mm_storeu_si128( (__m128i*) in, Fcnt );
+		int const in0 = in [S0];
+		int const in1 = in [S1];
+		int const in2 = in [S2];
+		int const in3 = in [S3];
+
+		// ENV_TAB entries are non-negative and Ecnt >> ENV_LBITS fits in 16 bits
+		__m128i const index = _mm_srli_epi32( Ecnt, ENV_LBITS );
+		__m128i temp = _mm_setzero_si128();
+		temp = _mm_insert_epi16( temp, ENV_TAB [_mm_extract_epi16( index, 0 )], 0 );
+		temp = _mm_insert_epi16( temp, ENV_TAB [_mm_extract_epi16( index, 2 )], 2 );
+		temp = _mm_insert_epi16( temp, ENV_TAB [_mm_extract_epi16( index, 4 )], 4 );
+		temp = _mm_insert_epi16( temp, ENV_TAB [_mm_extract_epi16( index, 6 )], 6 );
+		temp = _mm_add_epi32( temp, TLL );
+
+		__m128i const lfo = _mm_srli_epi32( _mm_madd_epi16( _mm_set1_epi32( env_LFO ), AMS_mul ), 14 );
+		__m128i const en = _mm_and_si128( _mm_add_epi32( _mm_xor_si128( temp, env_xor ), lfo ),
+				_mm_srai_epi32( _mm_sub_epi32( temp, env_max ), 31 ) );
+
+		int en_ [4];
+		_mm_storeu_si128( (__m128i*) en_, en );
+		int const en0 = en_ [S0];
+		int const en1 = en_ [S1];
+		int const en2 = en_ [S2];
+		int const en3 = en_ [S3];
+	#else
 	#define CALC_EN( x ) \
 		int temp##x = ENV_TAB [ch.SLOT [S##x].Ecnt >> ENV_LBITS] + ch.SLOT [S##x].TLL;  \
 		int en##x = ((temp##x ^ ch.SLOT [S##x].env_xor) + (env_LFO >> ch.SLOT [S##x].AMS)) &    \
@@ -1086,6 +1191,7 @@ void ym2612_update_chan<algo>::func( tables_t& g, channel_t& ch,
 		CALC_EN( 1 )
 		CALC_EN( 2 )
 		CALC_EN( 3 )
+	#endif
 
 		int const* const TL_TAB = g.TL_TAB;
 
@@ -1162,18 +1268,43 @@ void ym2612_update_chan<algo>::func( tables_t& g, channel_t& ch,
 		unsigned freq_LFO = ((g.LFO_FREQ_TAB [YM2612_LFOcnt >> LFO_LBITS & LFO_MASK] *
 				ch.FMS) >> (LFO_HBITS - 1 + 1)) + (1L << (LFO_FMS_LBITS - 1));
 		YM2612_LFOcnt += YM2612_LFOinc;
+	#ifdef __SSE2__
+		Fcnt = _mm_add_epi32( Fcnt, _mm_srli_epi32( mul_lanes( Finc, Finc_odd,
+				_mm_set1_epi32( freq_LFO ) ), LFO_FMS_LBITS - 1 ) );
+	#else
 		in0 += (ch.SLOT [S0].Finc * freq_LFO) >> (LFO_FMS_LBITS - 1);
 		in1 += (ch.SLOT [S1].Finc * freq_LFO) >> (LFO_FMS_LBITS - 1);
 		in2 += (ch.SLOT [S2].Finc * freq_LFO) >> (LFO_FMS_LBITS - 1);
 		in3 += (ch.SLOT [S3].Finc * freq_LFO) >> (LFO_FMS_LBITS - 1);
+	#endif
 
 		int t0 = buf [0] + (CH_OUTd & ch.LEFT);
 		int t1 = buf [1] + (CH_OUTd & ch.RIGHT);
 
+	#ifdef __SSE2__
+		Ecnt = _mm_add_epi32( Ecnt, Einc );
+		int const next = _mm_movemask_ps( _mm_castsi128_ps( _mm_cmplt_epi32( Ecnt, Ecmp ) ) ) ^ 0x0F;
+		if ( next )
+		{
+			// at least one operator moves to its next envelope phase
+			store_slot_lanes( ch, &slot_t::Ecnt, Ecnt );
+			for ( int i = 0; i < 4; i++ )
+			{
+				if ( next & (1 << i) )
+					update_envelope_( &ch.SLOT [i] );
+			}
+			Ecnt    = slot_lanes( ch, &slot_t::Ecnt );
+			Einc    = slot_lanes( ch, &slot_t::Einc );
+			Ecmp    = slot_lanes( ch, &slot_t::Ecmp );
+			env_xor = slot_lanes( ch, &slot_t::env_xor );
+			env_max = slot_lanes( ch, &slot_t::env_max );
+		}
+	#else
 		update_envelope( ch.SLOT [0] );
 		update_envelope( ch.SLOT [1] );
 		update_envelope( ch.SLOT [2] );
 		update_envelope( ch.SLOT [3] );
+	#endif
 
 		ch.S0_OUT [0] = CH_S0_OUT_0;
 		buf [0] = t0;
@@ -1184,10 +1315,15 @@ void ym2612_update_chan<algo>::func( tables_t& g, channel_t& ch,
 
 	ch.S0_OUT [1] = CH_S0_OUT_1;
 
+#ifdef __SSE2__
+	store_slot_lanes( ch, &slot_t::Ecnt, Ecnt );
+	store_slot_lanes( ch, &slot_t::Fcnt, Fcnt );
+#else
 	ch.SLOT [S0].Fcnt = in0;
 	ch.SLOT [S1].Fcnt = in1;
 	ch.SLOT [S2].Fcnt = in2;
 	ch.SLOT [S3].Fcnt = in3;
+#endif
 }
 
 static const ym2612_update_chan_t UPDATE_CHAN [8] = {
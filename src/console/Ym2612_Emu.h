@@ -5,6 +5,7 @@
 #define YM2612_EMU_H
 
 struct Ym2612_Impl;
+class Emu_State;
 
 class Ym2612_Emu  {
 	Ym2612_Impl* impl;
@@ -23,6 +24,9 @@ public:
 	enum { channel_count = 6 };
 	void mute_voices( int mask );
 
+	// Save or load chip state (see Music_Emu::save_state())
+	void copy_state( Emu_State& );
+
 	// Write addr to register 0 then data to register 1
 	void write0( int addr, int data );
 
@@ -73,4 +73,13 @@ public:
 	#endif
 #endif
 
+// BLARGG_FORCE_INLINE: inline even when the compiler thinks it too large
+#ifndef BLARGG_FORCE_INLINE
+	#ifdef __GNUC__
+		#define BLARGG_FORCE_INLINE inline __attribute__((always_inline))
+	#else
+		#define BLARGG_FORCE_INLINE inline
+	#endif
+#endif
+
 #endif
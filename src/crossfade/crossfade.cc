@@ -18,6 +18,7 @@
  */
 
 #include <math.h>
+#include <string.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
@@ -101,11 +102,125 @@ public:
 
 EXPORT Crossfade aud_plugin_instance;
 
+/* The crossfade buffer is a ring, so that audio can be added at the end and
+ * output from the beginning without shifting the rest of it.  The storage only
+ * grows (in whole frames), so once playback has settled, nothing is allocated
+ * or moved around on the audio thread. */
+class FadeBuffer
+{
+public:
+    int len () const
+        { return m_len; }
+    float & operator[] (int i)
+        { return m_data[(m_head + i) % m_data.len ()]; }
+
+    void reset (int channels)
+    {
+        m_data.clear ();
+        m_channels = channels;
+        m_head = m_len = 0;
+    }
+
+    void clear ()
+        { m_head = m_len = 0; }
+    void truncate (int len)
+        { m_len = aud::min (m_len, len); }
+
+    void append (const float * data, int len);
+    void append_silence (int len);
+    void move_out (Index<float> & out, int len);
+
+    /* calls func (data, len, offset) for each contiguous part of [pos, pos + len) */
+    template<class F>
+    void for_each_span (int pos, int len, F func)
+    {
+        if (! len)
+            return;
+
+        int size = m_data.len ();
+        int start = (m_head + pos) % size;
+        int first = aud::min (len, size - start);
+
+        func (& m_data[start], first, 0);
+        if (first < len)
+            func (& m_data[0], len - first, first);
+    }
+
+private:
+    void reserve (int len);
+
+    Index<float> m_data;
+    int m_channels = 1;
+    int m_head = 0, m_len = 0;
+};
+
+void FadeBuffer::reserve (int len)
+{
+    if (m_data.len () >= len)
+        return;
+
+    int size = aud::max (len, m_data.len () * 2);
+    size = (size + m_channels - 1) / m_channels * m_channels;
+
+    Index<float> grown;
+    grown.insert (0, size);
+
+    for_each_span (0, m_len, [& grown] (float * data, int len, int offset)
+        { memcpy (& grown[offset], data, sizeof (float) * len); });
+
+    m_data = std::move (grown);
+    m_head = 0;
+}
+
+void FadeBuffer::append (const float * data, int len)
+{
+    reserve (m_len + len);
+
+    for_each_span (m_len, len, [data] (float * to, int len, int offset)
+        { memcpy (to, data + offset, sizeof (float) * len); });
+
+    m_len += len;
+}
+
+void FadeBuffer::append_silence (int len)
+{
+    reserve (m_len + len);
+
+    for_each_span (m_len, len, [] (float * to, int len, int offset)
+        { memset (to, 0, sizeof (float) * len); });
+
+    m_len += len;
+}
+
+void FadeBuffer::move_out (Index<float> & out, int len)
+{
+    if (! len)
+        return;
+
+    int out_pos = out.len ();
+    out.insert (-1, len);
+
+    for_each_span (0, len, [& out, out_pos] (float * data, int len, int offset)
+        { memcpy (& out[out_pos + offset], data, sizeof (float) * len); });
+
+    m_head = (m_head + len) % m_data.len ();
+    m_len -= len;
+}
+
 static char state = STATE_OFF;
 static int current_channels, current_rate;
-static Index<float> buffer, output;
+static FadeBuffer buffer;
+static Index<float> output;
 static int fadein_point;
 
+/* The S-curve is precomputed whenever the steepness changes and then linearly
+ * interpolated, rather than calling tanhf() for every sample. */
+#define SIGMOID_STEPS 1024
+
+static float sigmoid_table[SIGMOID_STEPS + 1];
+static float sigmoid_steepness;
+static bool use_sigmoid;
+
 bool Crossfade::init ()
 {
     aud_config_set_defaults ("crossfade", crossfade_defaults);
@@ -115,38 +230,59 @@ bool Crossfade::init ()
 void Crossfade::cleanup ()
 {
     state = STATE_OFF;
-    buffer.clear ();
+    buffer.reset (1);
     output.clear ();
 }
 
-static void do_linear_ramp (float * data, int length, float a, float b)
+static void update_ramp_settings ()
 {
-    for (int i = 0; i < length; i ++)
-        (* data ++) *= (a * (length - i) + b * i) / length;
-}
+    use_sigmoid = aud_get_bool ("crossfade", "use_sigmoid");
+    if (! use_sigmoid)
+        return;
 
-static void do_sigmoid_ramp (float * data, int length, float a, float b)
-{
     float steepness = aud_get_double ("crossfade", "sigmoid_steepness");
-    for (int i = 0; i < length; i ++)
+    if (steepness == sigmoid_steepness)
+        return;
+
+    for (int i = 0; i <= SIGMOID_STEPS; i ++)
     {
-        float linear = (a * (length - i) + b * i) / length;
-        (* data ++) *= 0.5f + 0.5f * tanhf (steepness * (linear - 0.5f));
+        float linear = (float) i / SIGMOID_STEPS;
+        sigmoid_table[i] = 0.5f + 0.5f * tanhf (steepness * (linear - 0.5f));
     }
+
+    sigmoid_steepness = steepness;
 }
 
-static void do_ramp (float * data, int length, float a, float b)
+static inline float ramp_gain (float a, float b, int pos, int length)
 {
-    if (aud_get_bool ("crossfade", "use_sigmoid"))
-        do_sigmoid_ramp (data, length, a, b);
-    else
-        do_linear_ramp (data, length, a, b);
+    float linear = (a * (length - pos) + b * pos) / length;
+    if (! use_sigmoid)
+        return linear;
+
+    float x = linear * SIGMOID_STEPS;
+    int i = aud::clamp ((int) x, 0, SIGMOID_STEPS - 1);
+
+    return sigmoid_table[i] + (sigmoid_table[i + 1] - sigmoid_table[i]) * (x - i);
 }
 
-static void mix (float * data, float * add, int length)
+/* ramps the whole buffer from gain a to gain b, one gain value per frame */
+static void do_ramp (float a, float b)
 {
-    while (length --)
-        (* data ++) += (* add ++);
+    int frames = buffer.len () / current_channels;
+    int channels = current_channels;
+
+    update_ramp_settings ();
+
+    buffer.for_each_span (0, buffer.len (), [=] (float * data, int len, int offset)
+    {
+        int first = offset / channels;
+        for (int f = 0; f < len / channels; f ++)
+        {
+            float gain = ramp_gain (a, b, first + f, frames);
+            for (int c = 0; c < channels; c ++)
+                (* data ++) *= gain;
+        }
+    });
 }
 
 /* stupid simple resampling/rechanneling algorithm */
@@ -162,8 +298,9 @@ static void reformat (int channels, int rate)
     for (int c = 0; c < channels; c ++)
         map[c] = c * current_channels / channels;
 
-    Index<float> new_buffer;
-    new_buffer.resize (new_frames * channels);
+    FadeBuffer new_buffer;
+    new_buffer.reset (channels);
+    new_buffer.append_silence (new_frames * channels);
 
     for (int f = 0; f < new_frames; f ++)
     {
@@ -197,7 +334,7 @@ static void output_data_as_ready (int buffer_needed, bool exact)
 
     /* if allowed, wait until we have at least 1/2 second ready to output */
     if (exact ? (copy > 0) : (copy >= current_channels * (current_rate / 2)))
-        output.move_from (buffer, 0, -1, copy, true, true);
+        buffer.move_out (output, copy);
 }
 
 void Crossfade::start (int & channels, int & rate)
@@ -210,10 +347,12 @@ void Crossfade::start (int & channels, int & rate)
 
     if (state == STATE_OFF)
     {
+        buffer.reset (channels);
+
         if (aud_get_bool ("crossfade", "manual"))
         {
             state = STATE_FLUSHED;
-            buffer.insert (0, buffer_needed_for_state ());
+            buffer.append_silence (buffer_needed_for_state ());
         }
         else
             state = STATE_RUNNING;
@@ -222,33 +361,50 @@ void Crossfade::start (int & channels, int & rate)
 
 static void run_fadeout ()
 {
-    do_ramp (buffer.begin (), buffer.len (), 1.0, 0.0);
+    do_ramp (1.0, 0.0);
 
     state = STATE_FADEIN;
     fadein_point = 0;
 }
 
-static void run_fadein (Index<float> & data)
+/* mixes the start of the new song into the buffer, fading it in; returns the
+ * number of samples used */
+static int run_fadein (const Index<float> & data)
 {
     int length = buffer.len ();
+    int copy = 0;
 
     if (fadein_point < length)
     {
-        int copy = aud::min (data.len (), length - fadein_point);
-        float a = (float) fadein_point / length;
-        float b = (float) (fadein_point + copy) / length;
+        copy = aud::min (data.len (), length - fadein_point);
+
+        int frames = length / current_channels;
+        int channels = current_channels;
+        bool fade = ! aud_get_bool ("crossfade", "no_fade_in");
+        const float * add = data.begin ();
 
-        if (! aud_get_bool ("crossfade", "no_fade_in"))
-            do_ramp (data.begin (), copy, a, b);
+        update_ramp_settings ();
+
+        buffer.for_each_span (fadein_point, copy, [=] (float * mix, int len, int offset)
+        {
+            const float * in = add + offset;
+            int first = (fadein_point + offset) / channels;
 
-        mix (& buffer[fadein_point], data.begin (), copy);
-        data.remove (0, copy);
+            for (int f = 0; f < len / channels; f ++)
+            {
+                float gain = fade ? ramp_gain (0.0, 1.0, first + f, frames) : 1.0f;
+                for (int c = 0; c < channels; c ++)
+                    (* mix ++) += (* in ++) * gain;
+            }
+        });
 
         fadein_point += copy;
     }
 
     if (fadein_point == length)
         state = STATE_RUNNING;
+
+    return copy;
 }
 
 Index<float> & Crossfade::process (Index<float> & data)
@@ -261,12 +417,14 @@ Index<float> & Crossfade::process (Index<float> & data)
     if (state == STATE_FINISHED || state == STATE_FLUSHED)
         run_fadeout ();
 
+    int used = 0;
+
     if (state == STATE_FADEIN)
-        run_fadein (data);
+        used = run_fadein (data);
 
     if (state == STATE_RUNNING)
     {
-        buffer.insert (data.begin (), -1, data.len ());
+        buffer.append (data.begin () + used, data.len () - used);
         output_data_as_ready (buffer_needed_for_state (), false);
     }
 
@@ -281,15 +439,13 @@ bool Crossfade::flush (bool force)
     if (! force && aud_get_bool ("crossfade", "manual"))
     {
         state = STATE_FLUSHED;
-        int buffer_needed = buffer_needed_for_state ();
-        if (buffer.len () > buffer_needed)
-            buffer.remove (buffer_needed, -1);
+        buffer.truncate (buffer_needed_for_state ());
 
         return false;
     }
 
     state = STATE_RUNNING;
-    buffer.resize (0);
+    buffer.clear ();
 
     return true;
 }
@@ -301,12 +457,14 @@ Index<float> & Crossfade::finish (Index<float> & data, bool end_of_playlist)
 
     output.resize (0);
 
+    int used = 0;
+
     if (state == STATE_FADEIN)
-        run_fadein (data);
+        used = run_fadein (data);
 
     if (state == STATE_RUNNING || state == STATE_FINISHED || state == STATE_FLUSHED)
     {
-        buffer.insert (data.begin (), -1, data.len ());
+        buffer.append (data.begin () + used, data.len () - used);
         output_data_as_ready (buffer_needed_for_state (), state != STATE_RUNNING);
     }
 
@@ -326,7 +484,7 @@ Index<float> & Crossfade::finish (Index<float> & data, bool end_of_playlist)
 
     if (end_of_playlist && (state == STATE_FINISHED || state == STATE_FLUSHED))
     {
-        do_ramp (buffer.begin (), buffer.len (), 1.0, 0.0);
+        do_ramp (1.0, 0.0);
 
         state = STATE_OFF;
         output_data_as_ready (0, true);
@@ -21,12 +21,14 @@
  */
 
 #include <glib.h>
+#include <pthread.h>
 #include <string.h>
 
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
+#include <libaudcore/ringbuf.h>
 #include <libaudcore/runtime.h>
 
 #ifdef FILEWRITER_MP3
@@ -62,11 +64,11 @@ public:
     bool open_audio (int fmt, int rate, int nch, String & error) override;
     void close_audio () override;
 
-    void period_wait () override {}
+    void period_wait () override;
     int write_audio (const void * ptr, int length) override;
-    void drain () override {}
+    void drain () override;
 
-    int get_delay () override { return 0; }
+    int get_delay () override;
 
     void pause (bool pause) override {}
     void flush () override {}
@@ -130,6 +132,24 @@ static const char *fileext_str[FILEEXT_MAX] =
 static FileWriterImpl *plugin;
 static VFSFile output_file;
 
+/* Audio is queued by write_audio() and converted and encoded by a separate
+ * thread, so that a slow encoder does not hold up the output thread.  The
+ * queue holds input-format bytes; the encoder takes whole frames from it. */
+#define QUEUE_MS 1000  /* amount of audio the queue can hold */
+#define BLOCK_MS 50    /* amount of audio passed to the encoder at once */
+
+static pthread_t encoder_thread;
+static pthread_mutex_t encoder_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t encoder_cond = PTHREAD_COND_INITIALIZER;
+
+static RingBuf<char> encoder_queue;
+static bool encoder_busy, encoder_quit;
+static int in_rate, in_frame_size;
+
+/* statistics, logged when the file is closed */
+static int64_t stat_bytes, stat_encode_us;
+static int stat_max_queued;
+
 FileWriterImpl *plugins[FILEEXT_MAX] = {
     &wav_plugin,
 #ifdef FILEWRITER_MP3
@@ -290,6 +310,92 @@ static StringBuf format_filename (const char * suffix)
     return filename.settle ();
 }
 
+static void * encoder_worker (void *)
+{
+    int block = in_frame_size * aud::max (aud::rescale (BLOCK_MS, 1000, in_rate), 1);
+    Index<char> chunk;
+    chunk.resize (block);
+
+    pthread_mutex_lock (& encoder_mutex);
+
+    while (1)
+    {
+        int len = encoder_queue.len ();
+        len = aud::min (len - len % in_frame_size, block);
+
+        if (! len)
+        {
+            if (encoder_quit)
+                break;
+
+            pthread_cond_wait (& encoder_cond, & encoder_mutex);
+            continue;
+        }
+
+        encoder_queue.move_out (chunk.begin (), len);
+        encoder_busy = true;
+
+        /* wake the output thread, which may be waiting for space */
+        pthread_cond_broadcast (& encoder_cond);
+        pthread_mutex_unlock (& encoder_mutex);
+
+        int64_t start = g_get_monotonic_time ();
+
+        auto & buf = convert_process (chunk.begin (), len);
+        plugin->write (output_file, buf.begin (), buf.len ());
+
+        int64_t elapsed = g_get_monotonic_time () - start;
+
+        pthread_mutex_lock (& encoder_mutex);
+
+        stat_bytes += len;
+        stat_encode_us += elapsed;
+        encoder_busy = false;
+
+        /* wake drain(), which waits for the encoder to go idle */
+        pthread_cond_broadcast (& encoder_cond);
+    }
+
+    pthread_mutex_unlock (& encoder_mutex);
+    return nullptr;
+}
+
+static void start_encoder (int fmt, int rate, int nch)
+{
+    in_rate = rate;
+    in_frame_size = FMT_SIZEOF (fmt) * nch;
+
+    encoder_queue.alloc (in_frame_size * aud::rescale (QUEUE_MS, 1000, rate));
+    encoder_busy = false;
+    encoder_quit = false;
+
+    stat_bytes = 0;
+    stat_encode_us = 0;
+    stat_max_queued = 0;
+
+    pthread_create (& encoder_thread, nullptr, encoder_worker, nullptr);
+}
+
+static void stop_encoder ()
+{
+    pthread_mutex_lock (& encoder_mutex);
+    encoder_quit = true;
+    pthread_cond_broadcast (& encoder_cond);
+    pthread_mutex_unlock (& encoder_mutex);
+
+    pthread_join (encoder_thread, nullptr);
+
+    double audio_secs = (double) stat_bytes / ((int64_t) in_frame_size * in_rate);
+    double encode_secs = stat_encode_us / 1000000.0;
+
+    AUDDBG ("Encoded %.1f s of audio in %.1f s (%.1fx realtime), "
+     "peak queue depth %d%%.\n", audio_secs, encode_secs,
+     (encode_secs > 0) ? audio_secs / encode_secs : 0.0,
+     aud::rescale (stat_max_queued, encoder_queue.size (), 100));
+
+    encoder_queue.destroy ();
+}
+
 bool FileWriter::open_audio (int fmt, int rate, int nch, String & error)
 {
     int ext = aud_get_int ("filewriter", "fileext");
@@ -308,7 +414,10 @@ bool FileWriter::open_audio (int fmt, int rate, int nch, String & error)
     if (output_file)
     {
         if (plugin->open (output_file, {out_fmt, rate, nch}, in_tuple))
+        {
+            start_encoder (fmt, rate, nch);
             return true;
+        }
     }
     else
     {
@@ -323,16 +432,55 @@ bool FileWriter::open_audio (int fmt, int rate, int nch, String & error)
     return false;
 }
 
+void FileWriter::period_wait ()
+{
+    pthread_mutex_lock (& encoder_mutex);
+
+    while (! encoder_queue.space ())
+        pthread_cond_wait (& encoder_cond, & encoder_mutex);
+
+    pthread_mutex_unlock (& encoder_mutex);
+}
+
 int FileWriter::write_audio (const void * ptr, int length)
 {
-    auto & buf = convert_process (ptr, length);
-    plugin->write (output_file, buf.begin (), buf.len ());
+    pthread_mutex_lock (& encoder_mutex);
+
+    length = aud::min (length, encoder_queue.space ());
+    encoder_queue.copy_in ((const char *) ptr, length);
+
+    stat_max_queued = aud::max (stat_max_queued, encoder_queue.len ());
+
+    pthread_cond_broadcast (& encoder_cond);
+    pthread_mutex_unlock (& encoder_mutex);
 
     return length;
 }
 
+void FileWriter::drain ()
+{
+    pthread_mutex_lock (& encoder_mutex);
+
+    while (encoder_queue.len () >= in_frame_size || encoder_busy)
+        pthread_cond_wait (& encoder_cond, & encoder_mutex);
+
+    pthread_mutex_unlock (& encoder_mutex);
+}
+
+int FileWriter::get_delay ()
+{
+    pthread_mutex_lock (& encoder_mutex);
+    int delay = aud::rescale (encoder_queue.len (), in_frame_size * in_rate, 1000);
+    pthread_mutex_unlock (& encoder_mutex);
+
+    return delay;
+}
+
 void FileWriter::close_audio ()
 {
+    /* encodes whatever is still queued before returning */
+    stop_encoder ();
+
     plugin->close (output_file);
     convert_free ();
 
@@ -568,6 +716,15 @@ static const PreferencesWidget vorbis_widgets[] = {
 };
 #endif
 
+#ifdef FILEWRITER_FLAC
+static const PreferencesWidget flac_widgets[] = {
+    WidgetSpin(N_("Encoder threads:"),
+        WidgetInt("filewriter_flac", "threads"),
+        {1, 64, 1}),
+    WidgetLabel(N_("<small>Requires libFLAC 1.5 or newer</small>"))
+};
+#endif
+
 static const NotebookTab tabs[] = {
     {N_("General"), {main_widgets}}
 #ifdef FILEWRITER_MP3
@@ -576,6 +733,9 @@ static const NotebookTab tabs[] = {
 #ifdef FILEWRITER_VORBIS
     ,{"Vorbis", {vorbis_widgets}}
 #endif
+#ifdef FILEWRITER_FLAC
+    ,{"FLAC", {flac_widgets}}
+#endif
 };
 
 const PreferencesWidget FileWriter::widgets[] = {
@@ -26,11 +26,35 @@
 #include <FLAC/all.h>
 
 #include <libaudcore/audstrings.h>
+#include <libaudcore/index.h>
+#include <libaudcore/runtime.h>
+
+/* FLAC__stream_encoder_set_num_threads() first appeared in libFLAC 1.5 */
+#if defined(FLAC_API_VERSION_CURRENT) && FLAC_API_VERSION_CURRENT >= 14
+#define FLAC_HAVE_THREADS
+#endif
+
+#define FLAC_MAX_CHANNELS 8
+#define FLAC_MAX_THREADS 64
+
+static const char * const flac_defaults[] = {
+ "threads", "1",
+ nullptr};
 
 static int channels;
+static int sample_format;
 static FLAC__StreamEncoder *flac_encoder;
 static FLAC__StreamMetadata *flac_metadata;
 
+/* widened samples for 16-bit input; kept between writes so that encoding
+ * does not allocate once the buffer has grown to the output block size */
+static Index<FLAC__int32> encbuffer;
+
+static void flac_init ()
+{
+    aud_config_set_defaults ("filewriter_flac", flac_defaults);
+}
+
 static FLAC__StreamEncoderWriteStatus flac_write_cb(const FLAC__StreamEncoder *encoder,
     const FLAC__byte buffer[], size_t bytes, unsigned samples, unsigned current_frame, void * data)
 {
@@ -94,13 +118,30 @@ static void insert_vorbis_comment (FLAC__StreamMetadata * meta,
      meta->data.vorbis_comment.num_comments, comment, true);
 }
 
+static void flac_close (VFSFile & file);
+
 static bool flac_open (VFSFile & file, const format_info & info, const Tuple & tuple)
 {
+    if (info.channels < 1 || info.channels > FLAC_MAX_CHANNELS)
+    {
+        AUDERR ("FLAC supports at most %d channels.\n", FLAC_MAX_CHANNELS);
+        return false;
+    }
+
     flac_encoder = FLAC__stream_encoder_new();
 
     FLAC__stream_encoder_set_channels(flac_encoder, info.channels);
+    FLAC__stream_encoder_set_bits_per_sample(flac_encoder,
+     (info.format == FMT_S16_NE) ? 16 : 24);
     FLAC__stream_encoder_set_sample_rate(flac_encoder, info.frequency);
 
+#ifdef FLAC_HAVE_THREADS
+    int threads = aud::clamp (aud_get_int ("filewriter_flac", "threads"), 1, FLAC_MAX_THREADS);
+    if (threads > 1 && FLAC__stream_encoder_set_num_threads(flac_encoder, threads) !=
+     FLAC__STREAM_ENCODER_SET_NUM_THREADS_OK)
+        AUDWARN ("libFLAC refused to use %d threads.\n", threads);
+#endif
+
     flac_metadata = FLAC__metadata_object_new(FLAC__METADATA_TYPE_VORBIS_COMMENT);
 
     insert_vorbis_comment (flac_metadata, "TITLE", tuple, Tuple::Title);
@@ -115,59 +156,47 @@ static bool flac_open (VFSFile & file, const format_info & info, const Tuple & t
 
     FLAC__stream_encoder_set_metadata(flac_encoder, &flac_metadata, 1);
 
-    FLAC__stream_encoder_init_stream(flac_encoder, flac_write_cb, flac_seek_cb,
-     flac_tell_cb, nullptr, &file);
+    if (FLAC__stream_encoder_init_stream(flac_encoder, flac_write_cb, flac_seek_cb,
+     flac_tell_cb, nullptr, &file) != FLAC__STREAM_ENCODER_INIT_STATUS_OK)
+    {
+        AUDERR ("Error initializing FLAC encoder: %s\n",
+         FLAC__stream_encoder_get_resolved_state_string (flac_encoder));
+        flac_close (file);
+        return false;
+    }
 
     channels = info.channels;
+    sample_format = info.format;
     return true;
 }
 
 static void flac_write (VFSFile & file, const void * data, int length)
 {
-#if 1
-    FLAC__int32 *encbuffer[2];
-    int16_t *tmpdata = (int16_t *) data;
-    int i;
-
-    encbuffer[0] = new FLAC__int32[length / channels];
-    encbuffer[1] = new FLAC__int32[length / channels];
+    const FLAC__int32 * samples;
+    int n_samples;
 
-    if (channels == 1)
-    {
-        for (i = 0; i < (length / 2); i++)
-        {
-            encbuffer[0][i] = tmpdata[i];
-            encbuffer[1][i] = tmpdata[i];
-        }
-    }
-    else
+    if (sample_format == FMT_S16_NE)
     {
-        for (i = 0; i < (length / 4); i++)
-        {
-            encbuffer[0][i] = tmpdata[2 * i];
-            encbuffer[1][i] = tmpdata[2 * i + 1];
-        }
-    }
+        auto in = (const int16_t *) data;
+        n_samples = length / sizeof (int16_t);
 
-    FLAC__stream_encoder_process(flac_encoder, (const FLAC__int32 **)encbuffer, length / (channels * 2));
+        if (encbuffer.len () < n_samples)
+            encbuffer.resize (n_samples);
 
-    delete[] encbuffer[0];
-    delete[] encbuffer[1];
-#else
-    FLAC__int32 *encbuffer;
-    int16_t *tmpdata = (int16_t *) data;
-    int i;
+        FLAC__int32 * out = encbuffer.begin ();
+        for (int i = 0; i < n_samples; i ++)
+            out[i] = in[i];
 
-    encbuffer = new FLAC__int32[length];
-
-    for (i=0; i < length; i++) {
-        encbuffer[i] = tmpdata[i];
+        samples = out;
+    }
+    else
+    {
+        /* FMT_S24_NE is already one sign-extended sample per 32-bit word */
+        samples = (const FLAC__int32 *) data;
+        n_samples = length / sizeof (int32_t);
     }
 
-    FLAC__stream_encoder_process_interleaved(flac_encoder, encbuffer, length);
-
-    delete[] encbuffer;
-#endif
+    FLAC__stream_encoder_process_interleaved(flac_encoder, samples, n_samples / channels);
 }
 
 static void flac_close (VFSFile & file)
@@ -184,15 +213,28 @@ static void flac_close (VFSFile & file)
         FLAC__metadata_object_delete(flac_metadata);
         flac_metadata = nullptr;
     }
+
+    encbuffer.clear ();
 }
 
 static int flac_format_required (int fmt)
 {
-    return FMT_S16_NE;
+    switch (fmt)
+    {
+        case FMT_S8:
+        case FMT_U8:
+        case FMT_S16_LE:
+        case FMT_S16_BE:
+        case FMT_U16_LE:
+        case FMT_U16_BE:
+            return FMT_S16_NE;
+        default:
+            return FMT_S24_NE;
+    }
 }
 
 FileWriterImpl flac_plugin = {
-    nullptr,  // init
+    flac_init,
     flac_open,
     flac_write,
     flac_close,
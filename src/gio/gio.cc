@@ -17,6 +17,7 @@
  * the use of this software.
  */
 
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,6 +29,7 @@
 #include <libaudcore/i18n.h>
 #include <libaudcore/interface.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/preferences.h>
 #include <libaudcore/runtime.h>
 
 static const char gio_about[] =
@@ -39,10 +41,21 @@ static const char * const gio_schemes[] = {"ftp", "sftp", "smb", "mtp"};
 class GIOTransport : public TransportPlugin
 {
 public:
-    static constexpr PluginInfo info = {N_("GIO Plugin"), PACKAGE, gio_about};
+    static const char * const defaults[];
+    static const PreferencesWidget widgets[];
+    static const PluginPreferences prefs;
+
+    static constexpr PluginInfo info = {
+        N_("GIO Plugin"),
+        PACKAGE,
+        gio_about,
+        & prefs
+    };
 
     constexpr GIOTransport () : TransportPlugin (info, gio_schemes) {}
 
+    bool init () override;
+
     VFSImpl * fopen (const char * path, const char * mode, String & error) override;
     VFSFileTest test_file (const char * filename, VFSFileTest test, String & error) override;
     Index<String> read_folder (const char * filename, String & error) override;
@@ -50,6 +63,82 @@ public:
 
 EXPORT GIOTransport aud_plugin_instance;
 
+const char * const GIOTransport::defaults[] = {
+    "read_ahead", "TRUE",
+    "read_ahead_size", "2",  // MiB
+    nullptr
+};
+
+const PreferencesWidget GIOTransport::widgets[] = {
+    WidgetCheck (N_("Read ahead in the background"),
+        WidgetBool ("gio", "read_ahead")),
+    WidgetSpin (N_("Buffer size:"),
+        WidgetInt ("gio", "read_ahead_size"),
+        {1, 16, 1, N_("MiB")},
+        WIDGET_CHILD)
+};
+
+const PluginPreferences GIOTransport::prefs = {{widgets}};
+
+bool GIOTransport::init ()
+{
+    aud_config_set_defaults ("gio", defaults);
+    return true;
+}
+
+/* Window of the file held in memory for buffered reading.  The data is kept
+ * in a ring: bytes [start, end) of the file, of which the reader has consumed
+ * up to pos.  Some consumed data is kept so that short backward seeks (as
+ * done by many demuxers when probing) can be served from memory as well. */
+struct ReadWindow
+{
+    Index<char> ring;
+    int head = 0;       // ring offset of start
+    int len = 0;        // end - start
+    int64_t start = 0;  // file offset of the first byte held
+    int64_t pos = 0;    // file offset of the reader, in [start, start + len]
+
+    int size () const { return ring.len (); }
+    int64_t end () const { return start + len; }
+    int ahead () const { return end () - pos; }
+    int behind () const { return pos - start; }
+
+    void reset (int64_t offset)
+    {
+        head = len = 0;
+        start = pos = offset;
+    }
+
+    /* contiguous free space after the data */
+    char * tail (int & avail)
+    {
+        int at = (head + len) % size ();
+        avail = aud::min (size () - len, size () - at);
+        return & ring[at];
+    }
+
+    void commit (int bytes)
+        { len += bytes; }
+
+    void discard (int bytes)
+    {
+        head = (head + bytes) % size ();
+        len -= bytes;
+        start += bytes;
+    }
+
+    /* copies out data at the reader position and advances it */
+    void read (char * to, int bytes)
+    {
+        int at = (head + behind ()) % size ();
+        int part = aud::min (bytes, size () - at);
+
+        memcpy (to, & ring[at], part);
+        memcpy (to + part, & ring[0], bytes - part);
+        pos += bytes;
+    }
+};
+
 class GIOFile : public VFSImpl
 {
 public:
@@ -75,6 +164,19 @@ protected:
     int fflush () override;
 
 private:
+    void start_reader ();
+    void stop_reader ();
+    void run_reader ();
+
+    static void * reader_worker (void * data)
+    {
+        ((GIOFile *) data)->run_reader ();
+        return nullptr;
+    }
+
+    int64_t buffered_fread (char * buf, int64_t len);
+    int buffered_fseek (int64_t offset);
+
     String m_filename;
     GFile * m_file = nullptr;
     GIOStream * m_iostream = nullptr;
@@ -82,6 +184,30 @@ private:
     GOutputStream * m_ostream = nullptr;
     GSeekable * m_seekable = nullptr;
     bool m_eof = false;
+
+    /* buffered (read-only) mode; once the reader thread is running, it is
+     * the only one to touch the stream, and the fields below are protected
+     * by m_mutex */
+    bool m_buffered = false;
+    pthread_t m_reader;
+    pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_cond = PTHREAD_COND_INITIALIZER;
+    GCancellable * m_cancel = nullptr;
+
+    ReadWindow m_window;
+    int m_block_size = 0;
+    int m_ahead_limit = 0;   // how far the reader may get ahead of the consumer
+    int64_t m_sequential = 0;  // bytes read since the last seek outside the window
+    int64_t m_size = -1;
+    bool m_size_known = false;
+    int m_generation = 0;    // incremented on each seek outside the window
+    bool m_seek_pending = false, m_seek_failed = false;
+    bool m_reader_eof = false, m_reader_error = false;
+    bool m_reader_quit = false;
+
+    /* statistics, logged when the file is closed */
+    int m_backend_reads = 0, m_backend_seeks = 0;
+    int m_reads = 0, m_window_seeks = 0;
 };
 
 #define CHECK_ERROR(op, name) do { \
@@ -125,6 +251,9 @@ GIOFile::GIOFile (const char * filename, const char * mode) :
             m_istream = (GInputStream *) g_file_read (m_file, 0, & error);
             CHECK_AND_SAVE_ERROR ("open", filename);
             m_seekable = (GSeekable *) m_istream;
+
+            if (aud_get_bool ("gio", "read_ahead"))
+                start_reader ();
         }
         break;
     case 'w':
@@ -177,6 +306,9 @@ GIOFile::~GIOFile ()
 {
     GError * error = nullptr;
 
+    if (m_buffered)
+        stop_reader ();
+
     if (m_iostream)
     {
         g_io_stream_close (m_iostream, 0, & error);
@@ -210,6 +342,225 @@ VFSImpl * GIOTransport::fopen (const char * filename, const char * mode, String
     }
 }
 
+/* the reader starts out fetching this much, and goes further ahead only as
+ * the file is read sequentially, so that probing a file for its tags or type
+ * does not pull in the whole window */
+#define MIN_READ_AHEAD 65536
+
+void GIOFile::start_reader ()
+{
+    int window = aud::clamp (aud_get_int ("gio", "read_ahead_size"), 1, 16) << 20;
+
+    m_window.ring.resize (window);
+    m_window.reset (g_seekable_tell (m_seekable));
+    m_block_size = aud::clamp (window / 4, 65536, 1048576);
+    m_ahead_limit = MIN_READ_AHEAD;
+    m_sequential = 0;
+
+    /* the size is looked up when first needed (see fsize), since the stream
+     * belongs to the reader thread from now on */
+    m_eof = false;
+
+    m_cancel = g_cancellable_new ();
+    m_buffered = true;
+
+    pthread_create (& m_reader, nullptr, reader_worker, this);
+}
+
+void GIOFile::stop_reader ()
+{
+    pthread_mutex_lock (& m_mutex);
+    m_reader_quit = true;
+    g_cancellable_cancel (m_cancel);
+    pthread_cond_broadcast (& m_cond);
+    pthread_mutex_unlock (& m_mutex);
+
+    pthread_join (m_reader, nullptr);
+
+    g_object_unref (m_cancel);
+    m_buffered = false;
+
+    AUDDBG ("%s: %d reads and %d seeks served by %d backend reads and %d backend seeks.\n",
+     (const char *) m_filename, m_reads, m_window_seeks, m_backend_reads,
+     m_backend_seeks);
+}
+
+void GIOFile::run_reader ()
+{
+    pthread_mutex_lock (& m_mutex);
+
+    while (! m_reader_quit)
+    {
+        int generation = m_generation;
+
+        if (m_seek_pending)
+        {
+            int64_t offset = m_window.start;
+
+            pthread_mutex_unlock (& m_mutex);
+
+            GError * error = nullptr;
+            g_seekable_seek (m_seekable, offset, G_SEEK_SET, nullptr, & error);
+
+            pthread_mutex_lock (& m_mutex);
+
+            m_backend_seeks ++;
+
+            if (generation == m_generation)
+            {
+                m_seek_pending = false;
+                m_seek_failed = (error != nullptr);
+                pthread_cond_broadcast (& m_cond);
+            }
+
+            if (error)
+            {
+                AUDERR ("Cannot seek within %s: %s.\n", (const char *) m_filename, error->message);
+                g_error_free (error);
+            }
+
+            continue;
+        }
+
+        /* drop consumed data, keeping a quarter of the window behind the
+         * reader for short backward seeks */
+        int keep = m_window.size () / 4;
+        int space = m_window.size () - m_window.len;
+
+        if (space < m_block_size && m_window.behind () > keep)
+        {
+            m_window.discard (aud::min (m_window.behind () - keep, m_block_size - space));
+            space = m_window.size () - m_window.len;
+        }
+
+        int wanted = m_ahead_limit - m_window.ahead ();
+
+        if (m_reader_eof || m_reader_error || wanted <= 0 ||
+         space < aud::min (wanted, m_block_size / 2))
+        {
+            pthread_cond_wait (& m_cond, & m_mutex);
+            continue;
+        }
+
+        int avail;
+        char * tail = m_window.tail (avail);
+        avail = aud::min (avail, aud::min (wanted, m_block_size));
+
+        /* the consumer never touches free space in the window, so this is
+         * safe to fill without the lock; a seek in the meantime discards it */
+        pthread_mutex_unlock (& m_mutex);
+
+        GError * error = nullptr;
+        int64_t part = g_input_stream_read (m_istream, tail, avail, m_cancel, & error);
+
+        pthread_mutex_lock (& m_mutex);
+
+        m_backend_reads ++;
+
+        if (error)
+        {
+            if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+                g_cancellable_reset (m_cancel);
+            else if (generation == m_generation)
+            {
+                AUDERR ("Cannot read from %s: %s.\n", (const char *) m_filename, error->message);
+                m_reader_error = true;
+            }
+
+            g_error_free (error);
+        }
+        else if (generation == m_generation)
+        {
+            if (part > 0)
+                m_window.commit (part);
+            else
+                m_reader_eof = true;
+        }
+
+        pthread_cond_broadcast (& m_cond);
+    }
+
+    pthread_mutex_unlock (& m_mutex);
+}
+
+int64_t GIOFile::buffered_fread (char * buf, int64_t len)
+{
+    int64_t total = 0;
+
+    pthread_mutex_lock (& m_mutex);
+
+    m_reads ++;
+
+    while (total < len)
+    {
+        if (m_window.ahead ())
+        {
+            int part = aud::min ((int64_t) m_window.ahead (), len - total);
+            m_window.read (buf + total, part);
+            total += part;
+
+            /* reading straight through; fetch further ahead */
+            m_sequential += part;
+            if (m_sequential >= m_ahead_limit)
+                m_ahead_limit = aud::min (m_ahead_limit * 2, m_window.size () * 3 / 4);
+
+            /* the reader may be waiting for the consumer to free space */
+            pthread_cond_broadcast (& m_cond);
+        }
+        else if (m_seek_pending || ! (m_reader_eof || m_reader_error))
+            pthread_cond_wait (& m_cond, & m_mutex);
+        else
+            break;
+    }
+
+    m_eof = (total < len && m_reader_eof);
+
+    pthread_mutex_unlock (& m_mutex);
+    return total;
+}
+
+int GIOFile::buffered_fseek (int64_t offset)
+{
+    pthread_mutex_lock (& m_mutex);
+
+    m_window_seeks ++;
+
+    /* within the window (or just past it, while data is still arriving):
+     * no need to touch the stream at all */
+    if (offset >= m_window.start && offset <= m_window.end () &&
+     ! m_seek_pending && ! m_reader_error)
+    {
+        m_window.pos = offset;
+        m_eof = (offset == m_window.end () && m_reader_eof);
+        pthread_mutex_unlock (& m_mutex);
+        return 0;
+    }
+
+    m_generation ++;
+    m_window.reset (offset);
+    m_ahead_limit = MIN_READ_AHEAD;
+    m_sequential = 0;
+    m_seek_pending = true;
+    m_seek_failed = false;
+    m_reader_eof = false;
+    m_reader_error = false;
+
+    g_cancellable_cancel (m_cancel);
+    pthread_cond_broadcast (& m_cond);
+
+    while (m_seek_pending)
+        pthread_cond_wait (& m_cond, & m_mutex);
+
+    bool failed = m_seek_failed;
+    if (failed)
+        m_reader_error = true;
+
+    m_eof = (! failed && m_size_known && offset == m_size);
+
+    pthread_mutex_unlock (& m_mutex);
+    return failed ? -1 : 0;
+}
+
 int64_t GIOFile::fread (void * buf, int64_t size, int64_t nitems)
 {
     GError * error = nullptr;
@@ -220,6 +571,12 @@ int64_t GIOFile::fread (void * buf, int64_t size, int64_t nitems)
         return 0;
     }
 
+    if (m_buffered)
+    {
+        int64_t total = buffered_fread ((char *) buf, size * nitems);
+        return (size > 0) ? total / size : 0;
+    }
+
     int64_t total = 0;
     int64_t remain = size * nitems;
 
@@ -293,6 +650,24 @@ int GIOFile::fseek (int64_t offset, VFSSeekType whence)
         return -1;
     }
 
+    if (m_buffered)
+    {
+        if (whence == VFS_SEEK_CUR)
+            offset += ftell ();
+        else if (whence == VFS_SEEK_END)
+        {
+            if (fsize () < 0)
+            {
+                AUDERR ("Cannot seek within %s: size unknown.\n", (const char *) m_filename);
+                return -1;
+            }
+
+            offset += m_size;
+        }
+
+        return buffered_fseek (offset);
+    }
+
     g_seekable_seek (m_seekable, offset, gwhence, nullptr, & error);
     CHECK_ERROR ("seek within", m_filename);
 
@@ -306,6 +681,14 @@ FAILED:
 
 int64_t GIOFile::ftell ()
 {
+    if (m_buffered)
+    {
+        pthread_mutex_lock (& m_mutex);
+        int64_t pos = m_window.pos;
+        pthread_mutex_unlock (& m_mutex);
+        return pos;
+    }
+
     return g_seekable_tell (m_seekable);
 }
 
@@ -331,6 +714,26 @@ FAILED:
 
 int64_t GIOFile::fsize ()
 {
+    if (m_buffered)
+    {
+        /* ask the file rather than the stream, which the reader owns */
+        if (! m_size_known)
+        {
+            GFileInfo * info = g_file_query_info (m_file,
+             G_FILE_ATTRIBUTE_STANDARD_SIZE, G_FILE_QUERY_INFO_NONE, nullptr, nullptr);
+
+            if (info && g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE))
+                m_size = g_file_info_get_size (info);
+
+            if (info)
+                g_object_unref (info);
+
+            m_size_known = true;
+        }
+
+        return m_size;
+    }
+
     if (! g_seekable_can_seek (m_seekable))
         return -1;
 
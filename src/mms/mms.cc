@@ -17,13 +17,29 @@
  * the use of this software.
  */
 
+#include <pthread.h>
+#include <sys/time.h>
+
 #include <libmms/mms.h>
 #include <libmms/mmsh.h>
 
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/ringbuf.h>
 #include <libaudcore/runtime.h>
 
+#define MMS_BANDWIDTH (128 * 1024)
+
+/* Data is fetched by a reader thread into a ring buffer (as in the neon
+ * transport), so that a stalled connection does not stall the decoder until
+ * the buffer runs dry.  At 128 kbit/s, the buffer holds about 30 seconds. */
+#define MMS_BUFSIZE (512 * 1024)
+#define MMS_BLOCKSIZE (16 * 1024)
+#define MMS_PREBUFFER (64 * 1024)  /* collected at start and after an underrun */
+
+#define MMS_RECONNECT_TRIES 5
+#define MMS_RECONNECT_DELAY 1  /* seconds */
+
 static const char * const mms_schemes[] = {"mms"};
 
 class MMSTransport : public TransportPlugin
@@ -38,12 +54,29 @@ public:
 
 EXPORT MMSTransport aud_plugin_instance;
 
+static bool connect_handle (const char * path, mms_t * & mms, mmsh_t * & mmsh)
+{
+    mms = nullptr;
+
+    if ((mmsh = mmsh_connect (nullptr, nullptr, path, MMS_BANDWIDTH)))
+        return true;
+
+    AUDDBG ("Failed to connect with MMSH protocol; trying MMS.\n");
+
+    return (mms = mms_connect (nullptr, nullptr, path, MMS_BANDWIDTH));
+}
+
 class MMSFile : public VFSImpl
 {
 public:
     MMSFile (const char * path, mms_t * mms, mmsh_t * mmsh) :
+        m_path (path),
         m_mms (mms),
-        m_mmsh (mmsh) {}
+        m_mmsh (mmsh),
+        m_length (get_length ())
+    {
+        m_rb.alloc (MMS_BUFSIZE);
+    }
 
     ~MMSFile () override;
 
@@ -60,36 +93,249 @@ public:
     int fflush () override;
 
 private:
+    enum ReaderStatus {
+        READER_STOPPED,
+        READER_RUNNING,
+        READER_EOF,
+        READER_ERROR
+    };
+
+    static void * reader_worker (void * data)
+    {
+        ((MMSFile *) data)->reader ();
+        return nullptr;
+    }
+
+    void reader ();
+    bool reconnect ();
+    void start_reader ();
+    void stop_reader ();
+
+    int64_t read_handle (char * buf, int64_t len);
+    int64_t seek_handle (int64_t offset);
+    int64_t get_length ();
+    void close_handle ();
+
+    String m_path;
     mms_t * m_mms;
     mmsh_t * m_mmsh;
+
+    /* while the reader thread runs, it alone uses the connection; the
+     * fields below are protected by m_mutex */
+    pthread_t m_reader;
+    pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_cond = PTHREAD_COND_INITIALIZER;
+    ReaderStatus m_status = READER_STOPPED;
+    bool m_reader_quit = false;
+    bool m_prebuffering = true;
+
+    RingBuf<char> m_rb;
+    int64_t m_length;
+    int64_t m_pos = 0;      // position of the consumer
+    int64_t m_fetched = 0;  // position of the connection (m_pos + m_rb.len ())
 };
 
 VFSImpl * MMSTransport::fopen (const char * path, const char * mode, String & error)
 {
-    mms_t * mms = nullptr;
-    mmsh_t * mmsh = nullptr;
+    mms_t * mms;
+    mmsh_t * mmsh;
 
-    if (! (mmsh = mmsh_connect (nullptr, nullptr, path, 128 * 1024)))
+    if (! connect_handle (path, mms, mmsh))
     {
-        AUDDBG ("Failed to connect with MMSH protocol; trying MMS.\n");
-
-        if (! (mms = mms_connect (nullptr, nullptr, path, 128 * 1024)))
-        {
-            AUDERR ("Failed to open %s.\n", path);
-            error = String (_("Error connecting to MMS server"));
-            return nullptr;
-        }
+        AUDERR ("Failed to open %s.\n", path);
+        error = String (_("Error connecting to MMS server"));
+        return nullptr;
     }
 
     return new MMSFile (path, mms, mmsh);
 }
 
 MMSFile::~MMSFile ()
+{
+    stop_reader ();
+    close_handle ();
+}
+
+int64_t MMSFile::read_handle (char * buf, int64_t len)
 {
     if (m_mms)
-        mms_close (m_mms);
+        return mms_read (nullptr, m_mms, buf, len);
+    else if (m_mmsh)
+        return mmsh_read (nullptr, m_mmsh, buf, len);
     else
+        return -1;  // reconnecting failed
+}
+
+int64_t MMSFile::seek_handle (int64_t offset)
+{
+    if (m_mms)
+        return mms_seek (nullptr, m_mms, offset, SEEK_SET);
+    else if (m_mmsh)
+        return mmsh_seek (nullptr, m_mmsh, offset, SEEK_SET);
+    else
+        return -1;  // reconnecting failed
+}
+
+int64_t MMSFile::get_length ()
+{
+    if (m_mms)
+        return mms_get_length (m_mms);
+    else if (m_mmsh)
+        return mmsh_get_length (m_mmsh);
+    else
+        return 0;  // reconnecting failed
+}
+
+void MMSFile::close_handle ()
+{
+    if (m_mms)
+        mms_close (m_mms);
+    else if (m_mmsh)
         mmsh_close (m_mmsh);
+
+    m_mms = nullptr;
+    m_mmsh = nullptr;
+}
+
+/* called from the reader thread without the lock held */
+bool MMSFile::reconnect ()
+{
+    for (int attempt = 1; attempt <= MMS_RECONNECT_TRIES; attempt ++)
+    {
+        AUDWARN ("Connection to %s lost; reconnecting (attempt %d of %d).\n",
+         (const char *) m_path, attempt, MMS_RECONNECT_TRIES);
+
+        pthread_mutex_lock (& m_mutex);
+
+        timeval now;
+        gettimeofday (& now, nullptr);
+        timespec until = {now.tv_sec + MMS_RECONNECT_DELAY, now.tv_usec * 1000};
+
+        while (! m_reader_quit && pthread_cond_timedwait (& m_cond, & m_mutex, & until) == 0)
+            ;
+
+        bool quit = m_reader_quit;
+        pthread_mutex_unlock (& m_mutex);
+
+        if (quit)
+            return false;
+
+        close_handle ();
+
+        if (! connect_handle (m_path, m_mms, m_mmsh))
+            continue;
+
+        /* resume where the old connection stopped; streams that cannot seek
+         * (live broadcasts) are picked up at the first packet instead, since
+         * the header has already been passed on */
+        if (m_fetched && seek_handle (m_fetched) != m_fetched)
+        {
+            int64_t header = m_mms ? mms_get_asf_header_len (m_mms) :
+             mmsh_get_asf_header_len (m_mmsh);
+
+            char skip[MMS_BLOCKSIZE];
+            while (header > 0)
+            {
+                int64_t part = read_handle (skip, aud::min (header, (int64_t) MMS_BLOCKSIZE));
+                if (part <= 0)
+                    break;
+
+                header -= part;
+            }
+
+            if (header > 0)
+                continue;
+        }
+
+        pthread_mutex_lock (& m_mutex);
+        m_length = get_length ();
+        pthread_mutex_unlock (& m_mutex);
+
+        AUDINFO ("Reconnected to %s.\n", (const char *) m_path);
+        return true;
+    }
+
+    return false;
+}
+
+void MMSFile::reader ()
+{
+    char block[MMS_BLOCKSIZE];
+
+    pthread_mutex_lock (& m_mutex);
+
+    while (! m_reader_quit)
+    {
+        if (m_rb.space () < MMS_BLOCKSIZE)
+        {
+            pthread_cond_wait (& m_cond, & m_mutex);
+            continue;
+        }
+
+        bool at_end = (m_length > 0 && m_fetched >= m_length);
+        pthread_mutex_unlock (& m_mutex);
+
+        int64_t readsize = read_handle (block, MMS_BLOCKSIZE);
+        bool lost = (readsize < 0 || (readsize == 0 && ! at_end));
+
+        if (lost && reconnect ())
+        {
+            pthread_mutex_lock (& m_mutex);
+            continue;
+        }
+
+        pthread_mutex_lock (& m_mutex);
+
+        if (readsize <= 0)
+        {
+            if (lost && ! m_reader_quit)
+                AUDERR ("Read failed.\n");
+
+            m_status = lost ? READER_ERROR : READER_EOF;
+            pthread_cond_broadcast (& m_cond);
+            break;
+        }
+
+        m_rb.copy_in (block, readsize);
+        m_fetched += readsize;
+
+        if (m_rb.len () >= MMS_PREBUFFER)
+            m_prebuffering = false;
+
+        pthread_cond_broadcast (& m_cond);
+    }
+
+    pthread_mutex_unlock (& m_mutex);
+}
+
+/* called with the lock held */
+void MMSFile::start_reader ()
+{
+    m_status = READER_RUNNING;
+    m_reader_quit = false;
+    m_prebuffering = true;
+
+    pthread_create (& m_reader, nullptr, reader_worker, this);
+}
+
+void MMSFile::stop_reader ()
+{
+    pthread_mutex_lock (& m_mutex);
+
+    if (m_status == READER_STOPPED)
+    {
+        pthread_mutex_unlock (& m_mutex);
+        return;
+    }
+
+    m_reader_quit = true;
+    pthread_cond_broadcast (& m_cond);
+    pthread_mutex_unlock (& m_mutex);
+
+    pthread_join (m_reader, nullptr);
+
+    /* the buffered data stays; m_fetched is still where the connection is */
+    m_status = READER_STOPPED;
 }
 
 int64_t MMSFile::fread (void * buf, int64_t size, int64_t count)
@@ -97,24 +343,36 @@ int64_t MMSFile::fread (void * buf, int64_t size, int64_t count)
     int64_t bytes_total = size * count;
     int64_t bytes_read = 0;
 
+    pthread_mutex_lock (& m_mutex);
+
+    if (m_status == READER_STOPPED)
+        start_reader ();
+
     while (bytes_read < bytes_total)
     {
-        int64_t readsize;
+        /* after an underrun, wait for the prebuffer to fill again, so that
+         * one late packet does not turn into a series of dropouts */
+        if (m_status == READER_RUNNING && (m_prebuffering || ! m_rb.len ()))
+        {
+            m_prebuffering = true;
+            pthread_cond_wait (& m_cond, & m_mutex);
+            continue;
+        }
 
-        if (m_mms)
-            readsize = mms_read (nullptr, m_mms, (char *) buf + bytes_read, bytes_total - bytes_read);
-        else
-            readsize = mmsh_read (nullptr, m_mmsh, (char *) buf + bytes_read, bytes_total - bytes_read);
+        if (! m_rb.len ())
+            break;
 
-        if (readsize < 0)
-            AUDERR ("Read failed.\n");
+        int64_t part = aud::min (bytes_total - bytes_read, (int64_t) m_rb.len ());
+        m_rb.move_out ((char *) buf + bytes_read, part);
 
-        if (readsize <= 0)
-            break;
+        bytes_read += part;
+        m_pos += part;
 
-        bytes_read += readsize;
+        pthread_cond_broadcast (& m_cond);
     }
 
+    pthread_mutex_unlock (& m_mutex);
+
     return size ? bytes_read / size : 0;
 }
 
@@ -126,51 +384,71 @@ int64_t MMSFile::fwrite (const void * data, int64_t size, int64_t count)
 
 int MMSFile::fseek (int64_t offset, VFSSeekType whence)
 {
+    pthread_mutex_lock (& m_mutex);
+
     if (whence == VFS_SEEK_CUR)
-    {
-        if (m_mms)
-            offset += mms_get_current_pos (m_mms);
-        else
-            offset += mmsh_get_current_pos (m_mmsh);
-    }
+        offset += m_pos;
     else if (whence == VFS_SEEK_END)
+        offset += m_length;
+
+    /* short forward seeks are served from the buffer */
+    if (offset >= m_pos && offset <= m_pos + m_rb.len ())
     {
-        if (m_mms)
-            offset += mms_get_length (m_mms);
-        else
-            offset += mmsh_get_length (m_mmsh);
+        m_rb.discard (offset - m_pos);
+        m_pos = offset;
+
+        pthread_cond_broadcast (& m_cond);
+        pthread_mutex_unlock (& m_mutex);
+        return 0;
     }
 
-    int64_t ret;
+    pthread_mutex_unlock (& m_mutex);
 
-    if (m_mms)
-        ret = mms_seek (nullptr, m_mms, offset, SEEK_SET);
-    else
-        ret = mmsh_seek (nullptr, m_mmsh, offset, SEEK_SET);
+    stop_reader ();
+
+    int64_t ret = seek_handle (offset);
 
     if (ret < 0 || ret != offset)
     {
         AUDERR ("Seek failed.\n");
+
+        /* keep reading where the buffer ends; if the connection moved anyway,
+         * move it back, or failing that, continue from wherever it is now */
+        if (ret >= 0 && ret != m_fetched)
+        {
+            int64_t back = seek_handle (m_fetched);
+
+            if (back != m_fetched)
+            {
+                m_rb.discard ();
+                m_pos = m_fetched = (back >= 0) ? back : ret;
+            }
+        }
+
         return -1;
     }
 
+    m_rb.discard ();
+    m_pos = m_fetched = offset;
     return 0;
 }
 
 int64_t MMSFile::ftell ()
 {
-    if (m_mms)
-        return mms_get_current_pos (m_mms);
-    else
-        return mmsh_get_current_pos (m_mmsh);
+    pthread_mutex_lock (& m_mutex);
+    int64_t pos = m_pos;
+    pthread_mutex_unlock (& m_mutex);
+
+    return pos;
 }
 
 bool MMSFile::feof ()
 {
-    if (m_mms)
-        return (mms_get_current_pos (m_mms) < (int64_t) mms_get_length (m_mms));
-    else
-        return (mmsh_get_current_pos (m_mmsh) < (int64_t) mmsh_get_length (m_mmsh));
+    pthread_mutex_lock (& m_mutex);
+    bool eof = (m_status == READER_EOF && ! m_rb.len ());
+    pthread_mutex_unlock (& m_mutex);
+
+    return eof;
 }
 
 int MMSFile::ftruncate (int64_t size)
@@ -181,10 +459,11 @@ int MMSFile::ftruncate (int64_t size)
 
 int64_t MMSFile::fsize ()
 {
-    if (m_mms)
-        return mms_get_length (m_mms);
-    else
-        return mmsh_get_length (m_mmsh);
+    pthread_mutex_lock (& m_mutex);
+    int64_t length = m_length;
+    pthread_mutex_unlock (& m_mutex);
+
+    return length;
 }
 
 int MMSFile::fflush ()
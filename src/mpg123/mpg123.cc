@@ -19,8 +19,13 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <atomic>
+#include <mutex>
 #include <string.h>
 
+#include <glib.h>
+#include <glib/gstdio.h>
+
 #undef EXPORT
 #include <mpg123.h>
 
@@ -74,13 +79,18 @@ EXPORT MPG123Plugin aud_plugin_instance;
 const char * const MPG123Plugin::mimes[] = {
     "audio/mp3", "audio/mpeg", "audio/x-mp3", "audio/x-mpeg", nullptr};
 
-const char * const MPG123Plugin::defaults[] = {"full_scan", "FALSE", //
-                                               nullptr};
+const char * const MPG123Plugin::defaults[] = {
+    "full_scan", "FALSE",     //
+    "index_cache_size", "32", // MiB
+    nullptr};
 
 const PreferencesWidget MPG123Plugin::widgets[] = {
     WidgetLabel(N_("<b>Advanced</b>")),
     WidgetCheck(N_("Use accurate length calculation (slow)"),
-                WidgetBool("mpg123", "full_scan"))};
+                WidgetBool("mpg123", "full_scan")),
+    WidgetSpin(N_("Remember scan results for up to"),
+               WidgetInt("mpg123", "index_cache_size"), {0, 1024, 8, N_("MiB")},
+               WIDGET_CHILD)};
 
 const PluginPreferences MPG123Plugin::prefs = {{widgets}};
 
@@ -119,8 +129,227 @@ bool MPG123Plugin::init()
     return true;
 }
 
+/* Frame index cache for full_scan.  mpg123_scan() reads the whole file to
+ * count its samples and build a seek index; the results are saved under the
+ * user config directory, keyed by URI, size and modification time, and are
+ * restored with mpg123_set_index() whenever the same file is opened again. */
+
+#define INDEX_MAGIC "AUDMPIX1"
+
+struct IndexHeader
+{
+    char magic[8];
+    int64_t size, mtime;
+    int64_t samples;
+    int64_t step, fill;
+    int64_t uri_len;
+};
+
+struct IndexCacheEntry
+{
+    String path;
+    int64_t mtime, size;
+};
+
+static std::atomic<int> index_hits, index_misses;
+static std::mutex index_cache_mutex;
+static int64_t index_cache_bytes = -1; // -1 until the directory has been scanned
+
+static StringBuf index_cache_dir()
+{
+    return filename_build({aud_get_path(AudPath::UserDir), "mpg123-index"});
+}
+
+static StringBuf index_cache_path(const char * filename)
+{
+    CharPtr hash(g_compute_checksum_for_string(G_CHECKSUM_SHA1, filename, -1));
+    return filename_build({index_cache_dir(), hash});
+}
+
+static bool stat_local_file(const char * filename, GStatBuf & st)
+{
+    StringBuf path = uri_to_filename(filename);
+    return path && g_stat(path, &st) == 0;
+}
+
+static int compare_mtime(const IndexCacheEntry & a, const IndexCacheEntry & b)
+{
+    return (a.mtime > b.mtime) - (a.mtime < b.mtime);
+}
+
+/* count the size of the cache and, if it is over its limit, delete the oldest
+ * entries until it is under 3/4 of it; called with index_cache_mutex held */
+static void prune_index_cache(int64_t limit)
+{
+    StringBuf dir = index_cache_dir();
+    GDir * handle = g_dir_open(dir, 0, nullptr);
+    if (!handle)
+        return;
+
+    Index<IndexCacheEntry> entries;
+    int64_t total = 0;
+    const char * name;
+
+    while ((name = g_dir_read_name(handle)))
+    {
+        StringBuf path = filename_build({dir, name});
+        GStatBuf st;
+
+        if (g_stat(path, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            IndexCacheEntry entry = {String(path), (int64_t)st.st_mtime,
+                                     (int64_t)st.st_size};
+            entries.append(std::move(entry));
+            total += st.st_size;
+        }
+    }
+
+    g_dir_close(handle);
+
+    index_cache_bytes = total;
+
+    if (total <= limit)
+        return;
+
+    entries.sort(compare_mtime);
+
+    for (auto & entry : entries)
+    {
+        if (total <= limit * 3 / 4)
+            break;
+
+        if (g_unlink(entry.path) == 0)
+            total -= entry.size;
+    }
+
+    index_cache_bytes = total;
+}
+
+static bool load_frame_index(const char * filename, mpg123_handle * dec,
+                             int64_t & samples)
+{
+    GStatBuf st;
+    if (!stat_local_file(filename, st))
+        return false;
+
+    char * data = nullptr;
+    gsize len = 0;
+    bool found = false;
+
+    if (g_file_get_contents(index_cache_path(filename), &data, &len, nullptr))
+    {
+        IndexHeader header;
+        int uri_len = strlen(filename);
+
+        if (len >= sizeof header)
+        {
+            memcpy(&header, data, sizeof header);
+
+            found = !memcmp(header.magic, INDEX_MAGIC, 8) &&
+                    header.size == (int64_t)st.st_size &&
+                    header.mtime == (int64_t)st.st_mtime &&
+                    header.uri_len == uri_len && header.fill >= 0 &&
+                    len == sizeof header + uri_len +
+                               header.fill * sizeof(int64_t) &&
+                    !memcmp(data + sizeof header, filename, uri_len);
+        }
+
+        if (found)
+        {
+            const char * src = data + sizeof header + uri_len;
+            Index<off_t> offsets;
+            offsets.resize(header.fill);
+
+            for (int64_t i = 0; i < header.fill; i++)
+            {
+                int64_t offset;
+                memcpy(&offset, src + i * sizeof offset, sizeof offset);
+                offsets[i] = offset;
+            }
+
+            found = (mpg123_set_index(dec, offsets.begin(), header.step,
+                                      header.fill) == MPG123_OK);
+            samples = header.samples;
+        }
+
+        g_free(data);
+    }
+
+    if (found)
+        index_hits++;
+    else
+        index_misses++;
+
+    AUDDBG("Frame index cache %s for %s.\n", found ? "hit" : "miss", filename);
+    return found;
+}
+
+static void save_frame_index(const char * filename, mpg123_handle * dec)
+{
+    int64_t limit = (int64_t)aud_get_int("mpg123", "index_cache_size") << 20;
+    GStatBuf st;
+    off_t * offsets;
+    off_t step;
+    size_t fill;
+
+    if (limit <= 0 || !stat_local_file(filename, st) ||
+        mpg123_index(dec, &offsets, &step, &fill) != MPG123_OK)
+        return;
+
+    IndexHeader header;
+    memcpy(header.magic, INDEX_MAGIC, 8);
+    header.size = st.st_size;
+    header.mtime = st.st_mtime;
+    header.samples = mpg123_length(dec);
+    header.step = step;
+    header.fill = fill;
+    header.uri_len = strlen(filename);
+
+    Index<char> buf;
+    buf.insert((const char *)&header, 0, sizeof header);
+    buf.insert(filename, -1, header.uri_len);
+
+    for (size_t i = 0; i < fill; i++)
+    {
+        int64_t offset = offsets[i];
+        buf.insert((const char *)&offset, -1, sizeof offset);
+    }
+
+    StringBuf dir = index_cache_dir();
+    if (g_mkdir_with_parents(dir, 0755) < 0)
+        return;
+
+    /* an older index of the same file is replaced */
+    StringBuf path = index_cache_path(filename);
+    GStatBuf old;
+    int64_t old_size = (g_stat(path, &old) == 0) ? old.st_size : 0;
+
+    GError * error = nullptr;
+    if (!g_file_set_contents(path, buf.begin(), buf.len(), &error))
+    {
+        AUDWARN("Failed to save frame index: %s\n", error->message);
+        g_error_free(error);
+        return;
+    }
+
+    /* the directory is only scanned the first time and when the tracked size
+     * goes over the limit */
+    std::lock_guard<std::mutex> lock(index_cache_mutex);
+
+    if (index_cache_bytes >= 0)
+        index_cache_bytes += buf.len() - old_size;
+
+    if (index_cache_bytes < 0 || index_cache_bytes > limit)
+        prune_index_cache(limit);
+}
+
 void MPG123Plugin::cleanup()
 {
+    int lookups = index_hits + index_misses;
+    if (lookups)
+        AUDINFO("Frame index cache: %d hits, %d misses (%d%% hit rate)\n",
+                (int)index_hits, (int)index_misses, index_hits * 100 / lookups);
+
     AUDDBG("deinitializing mpg123 library\n");
     mpg123_exit();
 }
@@ -138,6 +367,7 @@ struct DecodeState
     long rate;
     int channels, encoding;
     mpg123_frameinfo info;
+    int64_t scanned_length = -1; // from the frame index cache
     size_t bytes_read;
     float buf[4096];
 };
@@ -165,8 +395,14 @@ DecodeState::DecodeState(const char * filename, VFSFile & file, bool probing,
     if (mpg123_open_handle(dec, &file) < 0)
         goto err;
 
-    if (!stream && aud_get_bool("mpg123", "full_scan") && mpg123_scan(dec) < 0)
-        goto err;
+    if (!stream && aud_get_bool("mpg123", "full_scan") &&
+        !load_frame_index(filename, dec, scanned_length))
+    {
+        if (mpg123_scan(dec) < 0)
+            goto err;
+
+        save_frame_index(filename, dec);
+    }
 
     while (1)
     {
@@ -216,10 +452,232 @@ static bool detect_id3(VFSFile & file)
     return is_id3;
 }
 
-static StringBuf make_format_string(const mpg123_frameinfo * info)
+static StringBuf make_format_string(int version, int layer)
 {
     static const char * vers[] = {"1", "2", "2.5"};
-    return str_printf("MPEG-%s layer %d", vers[info->version], info->layer);
+    return str_printf("MPEG-%s layer %d", vers[version], layer);
+}
+
+static void set_format_info(Tuple & tuple, int version, int layer,
+                            int bitrate, int channels, int rate)
+{
+    tuple.set_int(Tuple::Bitrate, bitrate);
+    tuple.set_str(Tuple::Codec, make_format_string(version, layer));
+    tuple.set_int(Tuple::Channels, channels);
+
+    const char * chan_str = (channels == 2)
+                                ? _("Stereo")
+                                : (channels > 2) ? _("Surround") : _("Mono");
+    tuple.set_str(Tuple::Quality, str_printf("%s, %d Hz", chan_str, rate));
+}
+
+/* Header-only probe used by read_tag().  The first frame header, and the
+ * Xing/Info (with LAME extension) or VBRI header that follows it, are parsed
+ * from a single buffered read without setting up a decoder.  Tags are left to
+ * libaudtag as before.  If the length cannot be determined this way, the
+ * caller falls back to a full DecodeState. */
+
+#define PROBE_BUFSIZE 16384
+#define PROBE_MARGIN 4096 // enough for the largest frame plus a header
+
+struct FrameHeader
+{
+    int version; // 0 = MPEG-1, 1 = MPEG-2, 2 = MPEG-2.5
+    int layer;
+    int bitrate; // kbps
+    int rate;
+    int channels;
+    int size;    // bytes, including padding
+    int samples; // per frame
+};
+
+static uint32_t read_be32(const unsigned char * p)
+{
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static uint32_t read_le32(const unsigned char * p)
+{
+    return ((uint32_t)p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+}
+
+static bool parse_frame_header(const unsigned char * p, FrameHeader & h)
+{
+    static const short bitrates[2][3][15] = {
+        {{0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},
+         {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},
+         {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320}},
+        {{0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},
+         {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+         {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160}}};
+    static const int rates[3] = {44100, 48000, 32000};
+
+    if (p[0] != 0xff || (p[1] & 0xe0) != 0xe0)
+        return false;
+
+    int version_bits = (p[1] >> 3) & 3;
+    int layer_bits = (p[1] >> 1) & 3;
+    int bitrate_index = p[2] >> 4;
+    int rate_index = (p[2] >> 2) & 3;
+    int padding = (p[2] >> 1) & 1;
+
+    /* reserved values, and free format (left to the decoder) */
+    if (version_bits == 1 || layer_bits == 0 || bitrate_index == 0 ||
+        bitrate_index == 15 || rate_index == 3)
+        return false;
+
+    h.version = (version_bits == 3) ? 0 : (version_bits == 2) ? 1 : 2;
+    h.layer = 4 - layer_bits;
+    h.bitrate = bitrates[h.version ? 1 : 0][h.layer - 1][bitrate_index];
+    h.rate = rates[rate_index] >> h.version;
+    h.channels = ((p[3] >> 6) == 3) ? 1 : 2;
+
+    if (h.layer == 1)
+    {
+        h.samples = 384;
+        h.size = (12000 * h.bitrate / h.rate + padding) * 4;
+    }
+    else
+    {
+        h.samples = (h.layer == 3 && h.version) ? 576 : 1152;
+        h.size = h.samples / 8 * 1000 * h.bitrate / h.rate + padding;
+    }
+
+    return true;
+}
+
+/* size of ID3v1 and APEv2 tags at the end of the file */
+static int64_t trailing_tag_size(VFSFile & file, int64_t size)
+{
+    unsigned char buf[32];
+    int64_t end = size;
+
+    if (end >= 128 && file.fseek(end - 128, VFS_SEEK_SET) == 0 &&
+        file.fread(buf, 1, 3) == 3 && !memcmp(buf, "TAG", 3))
+        end -= 128;
+
+    if (end >= 32 && file.fseek(end - 32, VFS_SEEK_SET) == 0 &&
+        file.fread(buf, 1, 32) == 32 && !memcmp(buf, "APETAGEX", 8))
+    {
+        int64_t ape_size = read_le32(buf + 12);
+        if (read_le32(buf + 20) & 0x80000000) // has header
+            ape_size += 32;
+
+        if (ape_size <= end)
+            end -= ape_size;
+    }
+
+    return size - end;
+}
+
+static bool read_header_info(const char * filename, VFSFile & file,
+                             int64_t size, Tuple & tuple)
+{
+    unsigned char buf[PROBE_BUFSIZE];
+    int64_t offset = 0; // file offset of buf[0]
+
+    if (file.fseek(0, VFS_SEEK_SET) < 0)
+        return false;
+
+    int64_t len = file.fread(buf, 1, sizeof buf);
+    int64_t pos = 0;
+
+    /* skip ID3v2 tags, re-reading only if the audio starts past the buffer */
+    while (len - pos >= 10 && !memcmp(buf + pos, "ID3", 3))
+    {
+        const unsigned char * t = buf + pos;
+        if ((t[6] | t[7] | t[8] | t[9]) & 0x80)
+            return false;
+
+        int64_t skip = 10 + ((t[6] << 21) | (t[7] << 14) | (t[8] << 7) | t[9]);
+        if (t[5] & 0x10) // footer present
+            skip += 10;
+
+        if (pos + skip + PROBE_MARGIN <= len)
+            pos += skip;
+        else
+        {
+            offset += pos + skip;
+            if (file.fseek(offset, VFS_SEEK_SET) < 0)
+                return false;
+
+            len = file.fread(buf, 1, sizeof buf);
+            pos = 0;
+        }
+    }
+
+    /* find a frame header confirmed by the one following it */
+    FrameHeader h, next;
+    for (; pos + 4 <= len; pos++)
+    {
+        if (!parse_frame_header(buf + pos, h))
+            continue;
+
+        if (pos + h.size + 4 <= len &&
+            parse_frame_header(buf + pos + h.size, next) &&
+            next.version == h.version && next.layer == h.layer &&
+            next.rate == h.rate)
+            break;
+    }
+
+    if (pos + 4 > len)
+        return false;
+
+    const unsigned char * frame = buf + pos;
+    const unsigned char * end = buf + len;
+    int64_t frames = 0, delay = 0, padding = 0;
+
+    /* Xing/Info header, located after the side info of a layer III frame */
+    int side_info = h.version ? (h.channels == 1 ? 9 : 17)
+                              : (h.channels == 1 ? 17 : 32);
+    const unsigned char * x = frame + 4 + side_info;
+
+    if (h.layer == 3 && x + 8 <= end &&
+        (!memcmp(x, "Xing", 4) || !memcmp(x, "Info", 4)))
+    {
+        uint32_t flags = read_be32(x + 4);
+        const unsigned char * q = x + 8;
+
+        if ((flags & 1) && q + 4 <= end)
+            frames = read_be32(q);
+
+        q += ((flags & 1) ? 4 : 0) + ((flags & 2) ? 4 : 0) +
+             ((flags & 4) ? 100 : 0) + ((flags & 8) ? 4 : 0);
+
+        /* LAME extension, also written by libavcodec */
+        if (q + 24 <= end && (!memcmp(q, "LAME", 4) ||
+                              !memcmp(q, "Lavf", 4) || !memcmp(q, "Lavc", 4)))
+        {
+            delay = (q[21] << 4) | (q[22] >> 4);
+            padding = ((q[22] & 0xf) << 8) | q[23];
+        }
+    }
+    else if (frame + 4 + 32 + 18 <= end && !memcmp(frame + 4 + 32, "VBRI", 4))
+        frames = read_be32(frame + 4 + 32 + 14);
+
+    int length;
+
+    if (frames > 0)
+    {
+        int64_t samples = frames * h.samples - delay - padding;
+        length = aud::rescale<int64_t>(samples, h.rate, 1000);
+    }
+    else
+    {
+        /* no frame count; assume constant bitrate, as mpg123 does */
+        int64_t audio = size - (offset + pos) - trailing_tag_size(file, size);
+        length = aud::rdiv<int64_t>(8 * audio, h.bitrate);
+    }
+
+    if (length <= 0)
+        return false;
+
+    set_format_info(tuple, h.version, h.layer, h.bitrate, h.channels, h.rate);
+    tuple.set_int(Tuple::Length, length);
+    tuple.set_int(Tuple::Bitrate, aud::rdiv<int64_t>(8 * size, length));
+
+    MPG123_IODBG("Header probe of %s: %d ms\n", filename, length);
+    return true;
 }
 
 bool MPG123Plugin::is_our_file(const char * filename, VFSFile & file)
@@ -236,7 +694,7 @@ bool MPG123Plugin::is_our_file(const char * filename, VFSFile & file)
     if (!s.valid())
         return false;
 
-    auto fmt = make_format_string(&s.info);
+    auto fmt = make_format_string(s.info.version, s.info.layer);
     AUDDBG("Accepted as %s: %s.\n", &fmt[0], filename);
     return true;
 }
@@ -247,23 +705,26 @@ static bool read_mpg123_info(const char * filename, VFSFile & file,
     int64_t size = file.fsize();
     bool stream = (size < 0);
 
+    if (!stream && !aud_get_bool("mpg123", "full_scan"))
+    {
+        if (read_header_info(filename, file, size, tuple))
+            return true;
+
+        if (file.fseek(0, VFS_SEEK_SET) < 0)
+            return false;
+    }
+
     DecodeState s(filename, file, false, stream);
     if (!s.valid())
         return false;
 
-    tuple.set_int(Tuple::Bitrate, s.info.bitrate);
-    tuple.set_str(Tuple::Codec, make_format_string(&s.info));
-    tuple.set_int(Tuple::Channels, s.channels);
-
-    const char * chan_str = (s.channels == 2)
-                                ? _("Stereo")
-                                : (s.channels > 2) ? _("Surround") : _("Mono");
-    tuple.set_str(Tuple::Quality,
-                  str_printf("%s, %d Hz", chan_str, (int)s.rate));
+    set_format_info(tuple, s.info.version, s.info.layer, s.info.bitrate,
+                    s.channels, s.rate);
 
     if (!stream && s.rate > 0)
     {
-        int64_t samples = mpg123_length(s.dec);
+        int64_t samples = (s.scanned_length >= 0) ? s.scanned_length
+                                                  : mpg123_length(s.dec);
         int length = aud::rescale<int64_t>(samples, s.rate, 1000);
 
         if (length > 0)
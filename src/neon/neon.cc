@@ -28,7 +28,6 @@
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
-#include <libaudcore/ringbuf.h>
 #include <libaudcore/runtime.h>
 
 #include <ne_auth.h>
@@ -47,9 +46,16 @@
 #include "cert_verification.h"
 
 #define NEON_NETBLKSIZE     (4096)
+#define NEON_NETBLKSIZE_MAX (65536)
+#define NEON_WAKE_WATERMARK (65536)
 #define NEON_ICY_BUFSIZE    (4096)
 #define NEON_RETRY_COUNT 6
 
+/* Limits for the session pool */
+#define NEON_POOL_IDLE_TIMEOUT  (30 * G_TIME_SPAN_SECOND)
+#define NEON_POOL_MAX_PER_HOST  4
+#define NEON_POOL_MAX_TOTAL     16
+
 enum FillBufferResult {
     FILL_BUFFER_SUCCESS,
     FILL_BUFFER_ERROR,
@@ -69,6 +75,14 @@ struct reader_status
     bool reading = false;
     neon_reader_t status = NEON_READER_INIT;
 
+    /* Who is sleeping on the condition variable, and how much data the
+     * consumer is waiting for.  Each side only signals when the other one is
+     * waiting; the reader is woken once enough space has been freed to be
+     * worth it, the consumer as soon as it can read anything at all. */
+    bool reader_waiting = false;
+    bool consumer_waiting = false;
+    int64_t wanted = 0;
+
     pthread_mutex_t mutex;
     pthread_cond_t cond;
 
@@ -85,6 +99,72 @@ struct reader_status
     }
 };
 
+/* Buffer between the reader thread and the consumer.  Unlike RingBuf, it
+ * exposes its free space, so that the reader thread can receive data from the
+ * network directly into it.  The reader only writes to the free space and the
+ * consumer only reads from the filled part, so only the positions need to be
+ * protected by the mutex, not the data transfers. */
+class NetBuffer
+{
+public:
+    void alloc (int size)
+    {
+        m_data.resize (size);
+        m_head = m_len = 0;
+    }
+
+    int size () const
+        { return m_data.len (); }
+    int len () const
+        { return m_len; }
+    int space () const
+        { return size () - m_len; }
+    void discard ()
+        { m_head = m_len = 0; }
+
+    /* returns the contiguous free space following the data */
+    char * tail (int & avail)
+    {
+        int pos = (m_head + m_len) % size ();
+        avail = aud::min (space (), size () - pos);
+        return & m_data[pos];
+    }
+
+    /* marks bytes written to the free space as data */
+    void commit (int len)
+        { m_len += len; }
+
+    char & head ()
+        { return m_data[m_head]; }
+    void pop ()
+        { consume (1); }
+
+    void move_out (char * to, int len)
+    {
+        int first = aud::min (len, size () - m_head);
+        memcpy (to, & m_data[m_head], first);
+        memcpy (to + first, & m_data[0], len - first);
+        consume (len);
+    }
+
+    void move_out (Index<char> & to, int len)
+    {
+        int pos = to.len ();
+        to.insert (-1, len);
+        move_out (& to[pos], len);
+    }
+
+private:
+    void consume (int len)
+    {
+        m_head = (m_head + len) % size ();
+        m_len -= len;
+    }
+
+    Index<char> m_data;
+    int m_head = 0, m_len = 0;
+};
+
 struct icy_metadata
 {
     String stream_name;
@@ -111,6 +191,338 @@ public:
 
 EXPORT NeonTransport aud_plugin_instance;
 
+/* Sessions are not destroyed after use, but kept in a pool and shared between
+ * NeonFile instances.  Consecutive requests to the same server (tag probes,
+ * seeks, redirects, playlist entries) can then reuse a keep-alive connection
+ * or, if the connection had to be closed, at least resume the TLS session
+ * instead of doing a full handshake.  Sessions are keyed by everything that
+ * goes into their setup: scheme, host, port, credentials and proxy settings.
+ * A session is only ever used by one file at a time.
+ *
+ * Only NEON_POOL_MAX_PER_HOST sessions to one host are pooled.  Files opened
+ * while that many are in use get a session of their own, which is destroyed
+ * after use instead of going back into the pool. */
+
+struct SessionSettings
+{
+    bool use_proxy = false;
+    bool use_proxy_auth = false;
+    bool socks_proxy = false;
+    ne_sock_sversion socks_type = NE_SOCK_SOCKSV4A;
+    String proxy_host;
+    int proxy_port = 0;
+    String proxy_user {""}; // ne_session_socks_proxy requires non NULL user and password
+    String proxy_pass {""};
+};
+
+struct PooledSession
+{
+    String key;
+    String host;
+    String userinfo;
+    ne_session * session = nullptr;
+    int64_t idle_since = 0;
+    bool counted = false;  // included in active_hosts
+};
+
+struct ActiveHost
+{
+    String host;
+    int sessions;
+};
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Index<PooledSession *> idle_sessions;
+static Index<ActiveHost> active_hosts;
+static int sessions_created, sessions_reused, sessions_unpooled;
+
+static void destroy_pooled (PooledSession * pooled)
+{
+    ne_session_destroy (pooled->session);
+    delete pooled;
+}
+
+/* must be called with pool_mutex held */
+static ActiveHost * lookup_active_host (const char * host)
+{
+    for (ActiveHost & active : active_hosts)
+    {
+        if (! strcmp (active.host, host))
+            return & active;
+    }
+
+    return nullptr;
+}
+
+/* must be called with pool_mutex held */
+static void expire_idle_sessions (int64_t now)
+{
+    for (int i = 0; i < idle_sessions.len ();)
+    {
+        if (now - idle_sessions[i]->idle_since > NEON_POOL_IDLE_TIMEOUT)
+        {
+            destroy_pooled (idle_sessions[i]);
+            idle_sessions.remove (i, 1);
+        }
+        else
+            i ++;
+    }
+}
+
+static void destroy_idle_sessions ()
+{
+    pthread_mutex_lock (& pool_mutex);
+
+    for (PooledSession * pooled : idle_sessions)
+        destroy_pooled (pooled);
+
+    idle_sessions.clear ();
+
+    AUDDBG ("Session pool: %d created, %d reused, %d unpooled\n",
+     sessions_created, sessions_reused, sessions_unpooled);
+    pthread_mutex_unlock (& pool_mutex);
+}
+
+static int server_auth_cb (void * data, const char * realm, int attempt,
+ char * username, char * password)
+{
+    auto pooled = (PooledSession *) data;
+
+    if (! pooled->userinfo || ! pooled->userinfo[0])
+    {
+        AUDERR ("Authentication required, but no credentials set\n");
+        return 1;
+    }
+
+    char * * authtok = g_strsplit (pooled->userinfo, ":", 2);
+
+    if (! authtok[1] || strlen (authtok[1]) > NE_ABUFSIZ - 1 ||
+     strlen (authtok[0]) > NE_ABUFSIZ - 1)
+    {
+        AUDERR ("Username/Password too long\n");
+        g_strfreev (authtok);
+        return 1;
+    }
+
+    g_strlcpy (username, authtok[0], NE_ABUFSIZ);
+    g_strlcpy (password, authtok[1], NE_ABUFSIZ);
+
+    AUDDBG ("Authenticating: Username: %s, Password: %s\n", username, password);
+
+    g_strfreev (authtok);
+
+    return attempt;
+}
+
+static int neon_proxy_auth_cb (void * userdata, const char * realm, int attempt,
+ char * username, char * password)
+{
+    String value = aud_get_str ("proxy_user");
+    g_strlcpy (username, value, NE_ABUFSIZ);
+
+    value = aud_get_str ("proxy_pass");
+    g_strlcpy (password, value, NE_ABUFSIZ);
+
+    return attempt;
+}
+
+#ifdef _WIN32
+static void trust_win32_root_certs (ne_session * m_session)
+{
+    auto store = CertOpenSystemStore (0, "ROOT");
+    if (! store)
+        return;
+
+    const CERT_CONTEXT * ctx = NULL;
+    while ((ctx = CertEnumCertificatesInStore (store, ctx)))
+    {
+        char * enc = g_base64_encode (ctx->pbCertEncoded, ctx->cbCertEncoded);
+        ne_ssl_certificate * cert = ne_ssl_cert_import (enc);
+        if (cert)
+        {
+            ne_ssl_trust_cert (m_session, cert);
+            ne_ssl_cert_free (cert);
+        }
+        g_free (enc);
+    }
+
+    CertCloseStore (store, 0);
+}
+#endif
+
+static void setup_session (PooledSession * pooled, const ne_uri & uri,
+ const SessionSettings & settings)
+{
+    ne_session * session = ne_session_create (uri.scheme, uri.host, uri.port);
+    pooled->session = session;
+
+    ne_redirect_register (session);
+    ne_add_server_auth (session, NE_AUTH_BASIC, server_auth_cb, pooled);
+    ne_set_session_flag (session, NE_SESSFLAG_ICYPROTO, 1);
+    ne_set_session_flag (session, NE_SESSFLAG_PERSIST, 1);
+    ne_set_connect_timeout (session, 10);
+    ne_set_read_timeout (session, 10);
+    ne_set_useragent (session, "Audacious/" PACKAGE_VERSION);
+
+    if (settings.use_proxy)
+    {
+        AUDDBG ("Using proxy: %s:%d\n", (const char *) settings.proxy_host, settings.proxy_port);
+        if (settings.socks_proxy)
+        {
+            ne_session_socks_proxy (session, settings.socks_type, settings.proxy_host,
+             settings.proxy_port, settings.proxy_user, settings.proxy_pass);
+        }
+        else
+        {
+            ne_session_proxy (session, settings.proxy_host, settings.proxy_port);
+        }
+
+        if (settings.use_proxy_auth)
+        {
+            AUDDBG ("Using proxy authentication\n");
+            ne_add_proxy_auth (session, NE_AUTH_BASIC, neon_proxy_auth_cb, nullptr);
+        }
+    }
+
+    if (! strcmp ("https", uri.scheme))
+    {
+        ne_ssl_trust_default_ca (session);
+#ifdef _WIN32
+        trust_win32_root_certs (session);
+#endif
+        ne_ssl_set_verify (session, neon_vfs_verify_environment_ssl_certs, session);
+    }
+}
+
+static PooledSession * acquire_session (const ne_uri & uri, const SessionSettings & settings)
+{
+    StringBuf key = str_printf ("%s://%s@%s:%d %d %d %d %d %s:%d %s:%s", uri.scheme,
+     uri.userinfo ? uri.userinfo : "", uri.host, uri.port, settings.use_proxy,
+     settings.use_proxy_auth, settings.socks_proxy, (int) settings.socks_type,
+     (const char *) settings.proxy_host, settings.proxy_port,
+     (const char *) settings.proxy_user, (const char *) settings.proxy_pass);
+
+    StringBuf host = str_printf ("%s://%s:%d", uri.scheme, uri.host, uri.port);
+
+    pthread_mutex_lock (& pool_mutex);
+
+    expire_idle_sessions (g_get_monotonic_time ());
+
+    /* prefer the most recently used session, whose connection is most likely
+     * to still be open */
+    PooledSession * pooled = nullptr;
+
+    for (int i = idle_sessions.len () - 1; i >= 0; i --)
+    {
+        if (! strcmp (idle_sessions[i]->key, key))
+        {
+            pooled = idle_sessions[i];
+            idle_sessions.remove (i, 1);
+            break;
+        }
+    }
+
+    ActiveHost * active = lookup_active_host (host);
+    bool counted = pooled || ! active || active->sessions < NEON_POOL_MAX_PER_HOST;
+
+    if (counted)
+    {
+        if (active)
+            active->sessions ++;
+        else
+            active_hosts.append (ActiveHost {String (host), 1});
+    }
+
+    if (pooled)
+    {
+        pooled->counted = true;
+        sessions_reused ++;
+        pthread_mutex_unlock (& pool_mutex);
+
+        AUDDBG ("Reusing session to %s://%s:%d\n", uri.scheme, uri.host, uri.port);
+        return pooled;
+    }
+
+    if (counted)
+        sessions_created ++;
+    else
+        sessions_unpooled ++;
+
+    pthread_mutex_unlock (& pool_mutex);
+
+    if (counted)
+        AUDDBG ("Creating session to %s://%s:%d\n", uri.scheme, uri.host, uri.port);
+    else
+        AUDDBG ("Too many sessions to %s://%s:%d, creating one outside the pool\n",
+         uri.scheme, uri.host, uri.port);
+
+    pooled = new PooledSession;
+    pooled->key = String (key);
+    pooled->host = String (host);
+    pooled->userinfo = String (uri.userinfo);
+    pooled->counted = counted;
+    setup_session (pooled, uri, settings);
+
+    return pooled;
+}
+
+/* Returns a session to the pool.  If the last request was not read to the
+ * end, the connection is in an unknown state and must be closed first. */
+static void release_session (PooledSession * pooled, bool request_finished)
+{
+    if (! pooled->counted)
+    {
+        destroy_pooled (pooled);
+        return;
+    }
+
+    if (! request_finished)
+        ne_close_connection (pooled->session);
+
+    int64_t now = g_get_monotonic_time ();
+
+    pthread_mutex_lock (& pool_mutex);
+
+    for (int i = 0; i < active_hosts.len (); i ++)
+    {
+        if (! strcmp (active_hosts[i].host, pooled->host))
+        {
+            if (! -- active_hosts[i].sessions)
+                active_hosts.remove (i, 1);
+            break;
+        }
+    }
+
+    pooled->counted = false;
+
+    expire_idle_sessions (now);
+
+    int same_host = 0;
+    for (PooledSession * idle : idle_sessions)
+    {
+        if (! strcmp (idle->key, pooled->key))
+            same_host ++;
+    }
+
+    if (same_host >= NEON_POOL_MAX_PER_HOST)
+    {
+        pthread_mutex_unlock (& pool_mutex);
+        destroy_pooled (pooled);
+        return;
+    }
+
+    if (idle_sessions.len () >= NEON_POOL_MAX_TOTAL)
+    {
+        destroy_pooled (idle_sessions[0]);
+        idle_sessions.remove (0, 1);
+    }
+
+    pooled->idle_since = now;
+    idle_sessions.append (pooled);
+
+    pthread_mutex_unlock (& pool_mutex);
+}
+
 bool NeonTransport::init ()
 {
     int ret = ne_sock_init ();
@@ -126,6 +538,7 @@ bool NeonTransport::init ()
 
 void NeonTransport::cleanup ()
 {
+    destroy_idle_sessions ();
     ne_sock_exit ();
 }
 
@@ -169,28 +582,29 @@ private:
 
     bool m_eof = false;
 
-    RingBuf<char> m_rb;           /* Ringbuffer for our data */
+    NetBuffer m_rb;               /* Ringbuffer for our data */
+    int m_block_size = NEON_NETBLKSIZE;  /* Current size of network reads */
     Index<char> m_icy_buf;        /* Buffer for ICY metadata */
     icy_metadata m_icy_metadata;  /* Current ICY metadata */
 
+    PooledSession * m_pooled = nullptr;
     ne_session * m_session = nullptr;
     ne_request * m_request = nullptr;
+    bool m_request_finished = false;    /* true if the response was read to the end */
 
     pthread_t m_reader;
     reader_status m_reader_status;
 
     void kill_reader ();
-    int server_auth (const char * realm, int attempt, char * username, char * password);
+    void close_session ();
+    void wake_consumer ();
+    void wake_reader ();
     void handle_headers ();
     int open_request (int64_t startbyte, String * error);
     FillBufferResult fill_buffer ();
     void reader ();
     int64_t try_fread (void * ptr, int64_t size, int64_t nmemb, bool & data_read);
 
-    static int server_auth_callback (void * data, const char * realm, int attempt,
-     char * username, char * password)
-        { return ((NeonFile *) data)->server_auth (realm, attempt, username, password); }
-
     static void * reader_thread (void * data)
         { ((NeonFile *) data)->reader (); return nullptr; }
 };
@@ -207,11 +621,7 @@ NeonFile::~NeonFile ()
     if (m_reader_status.reading)
         kill_reader ();
 
-    if (m_request)
-        ne_request_destroy (m_request);
-    if (m_session)
-        ne_session_destroy (m_session);
-
+    close_session ();
     ne_uri_free (& m_purl);
 }
 
@@ -331,31 +741,22 @@ void NeonFile::kill_reader ()
     AUDDBG ("Reader thread has died\n");
 }
 
-int NeonFile::server_auth (const char * realm, int attempt, char * username, char * password)
+void NeonFile::close_session ()
 {
-    if (! m_purl.userinfo || ! m_purl.userinfo[0])
+    if (m_request)
     {
-        AUDERR ("Authentication required, but no credentials set\n");
-        return 1;
+        ne_request_destroy (m_request);
+        m_request = nullptr;
     }
 
-    char * * authtok = g_strsplit (m_purl.userinfo, ":", 2);
-
-    if (strlen (authtok[1]) > NE_ABUFSIZ - 1 || strlen (authtok[0]) > NE_ABUFSIZ - 1)
+    if (m_pooled)
     {
-        AUDERR ("Username/Password too long\n");
-        g_strfreev (authtok);
-        return 1;
+        release_session (m_pooled, m_request_finished);
+        m_pooled = nullptr;
+        m_session = nullptr;
     }
 
-    g_strlcpy (username, authtok[0], NE_ABUFSIZ);
-    g_strlcpy (password, authtok[1], NE_ABUFSIZ);
-
-    AUDDBG ("Authenticating: Username: %s, Password: %s\n", username, password);
-
-    g_strfreev (authtok);
-
-    return attempt;
+    m_request_finished = false;
 }
 
 void NeonFile::handle_headers ()
@@ -431,24 +832,14 @@ void NeonFile::handle_headers ()
     }
 }
 
-static int neon_proxy_auth_cb (void * userdata, const char * realm, int attempt,
- char * username, char * password)
-{
-    String value = aud_get_str ("proxy_user");
-    g_strlcpy (username, value, NE_ABUFSIZ);
-
-    value = aud_get_str ("proxy_pass");
-    g_strlcpy (password, value, NE_ABUFSIZ);
-
-    return attempt;
-}
-
 int NeonFile::open_request (int64_t startbyte, String * error)
 {
     int ret;
     const ne_status * status;
     ne_uri * rediruri;
 
+    m_request_finished = false;
+
     if (m_purl.query && * (m_purl.query))
     {
         StringBuf tmp = str_concat ({m_purl.path, "?", m_purl.query});
@@ -484,7 +875,7 @@ int NeonFile::open_request (int64_t startbyte, String * error)
         case 303:
         case 307:
             /* Redirect encountered. Reconnect. */
-            ne_end_request (m_request);
+            m_request_finished = (ne_end_request (m_request) == NE_OK);
             ret = NE_REDIRECT;
             break;
 
@@ -549,58 +940,29 @@ int NeonFile::open_request (int64_t startbyte, String * error)
     return -1;
 }
 
-#ifdef _WIN32
-static void trust_win32_root_certs (ne_session * m_session)
-{
-    auto store = CertOpenSystemStore (0, "ROOT");
-    if (! store)
-        return;
-
-    const CERT_CONTEXT * ctx = NULL;
-    while ((ctx = CertEnumCertificatesInStore (store, ctx)))
-    {
-        char * enc = g_base64_encode (ctx->pbCertEncoded, ctx->cbCertEncoded);
-        ne_ssl_certificate * cert = ne_ssl_cert_import (enc);
-        if (cert)
-        {
-            ne_ssl_trust_cert (m_session, cert);
-            ne_ssl_cert_free (cert);
-        }
-        g_free (enc);
-    }
-
-    CertCloseStore (store, 0);
-}
-#endif
-
 int NeonFile::open_handle (int64_t startbyte, String * error)
 {
     int ret;
-    String proxy_host;
-    int proxy_port = 0;
-    String proxy_user (""); // ne_session_socks_proxy requires non NULL user and password
-    String proxy_pass ("");
-    bool socks_proxy = false;
-    ne_sock_sversion socks_type = NE_SOCK_SOCKSV4A;
+    SessionSettings settings;
 
-    bool use_proxy = aud_get_bool ("use_proxy");
-    bool use_proxy_auth = aud_get_bool ("use_proxy_auth");
+    settings.use_proxy = aud_get_bool ("use_proxy");
+    settings.use_proxy_auth = aud_get_bool ("use_proxy_auth");
 
-    if (use_proxy)
+    if (settings.use_proxy)
     {
-        proxy_host = aud_get_str ("proxy_host");
-        proxy_port = aud_get_int ("proxy_port");
-        socks_proxy = aud_get_bool ("socks_proxy");
+        settings.proxy_host = aud_get_str ("proxy_host");
+        settings.proxy_port = aud_get_int ("proxy_port");
+        settings.socks_proxy = aud_get_bool ("socks_proxy");
 
-        if (use_proxy_auth)
+        if (settings.use_proxy_auth)
         {
-            proxy_user = aud_get_str ("proxy_user");
-            proxy_pass = aud_get_str ("proxy_pass");
+            settings.proxy_user = aud_get_str ("proxy_user");
+            settings.proxy_pass = aud_get_str ("proxy_pass");
         }
 
-        if (socks_proxy)
+        if (settings.socks_proxy)
         {
-            socks_type = aud_get_int ("socks_type") == 0 ? NE_SOCK_SOCKSV4A : NE_SOCK_SOCKSV5;
+            settings.socks_type = aud_get_int ("socks_type") == 0 ? NE_SOCK_SOCKSV4A : NE_SOCK_SOCKSV5;
         }
     }
 
@@ -608,6 +970,8 @@ int NeonFile::open_handle (int64_t startbyte, String * error)
 
     AUDDBG ("<%p> Parsing URL\n", this);
 
+    ne_uri_free (& m_purl);
+
     if (ne_uri_parse (m_url, & m_purl) != 0)
     {
         if (error)
@@ -622,47 +986,8 @@ int NeonFile::open_handle (int64_t startbyte, String * error)
         if (! m_purl.port)
             m_purl.port = ne_uri_defaultport (m_purl.scheme);
 
-        AUDDBG ("<%p> Creating session to %s://%s:%d\n", this,
-         m_purl.scheme, m_purl.host, m_purl.port);
-        m_session = ne_session_create (m_purl.scheme,
-         m_purl.host, m_purl.port);
-        ne_redirect_register (m_session);
-        ne_add_server_auth (m_session, NE_AUTH_BASIC, server_auth_callback, this);
-        ne_set_session_flag (m_session, NE_SESSFLAG_ICYPROTO, 1);
-        ne_set_session_flag (m_session, NE_SESSFLAG_PERSIST, 0);
-        ne_set_connect_timeout (m_session, 10);
-        ne_set_read_timeout (m_session, 10);
-        ne_set_useragent (m_session, "Audacious/" PACKAGE_VERSION);
-
-        if (use_proxy)
-        {
-            AUDDBG ("<%p> Using proxy: %s:%d\n", this, (const char *) proxy_host, proxy_port);
-            if (socks_proxy)
-            {
-                ne_session_socks_proxy (m_session, socks_type, proxy_host, proxy_port, proxy_user, proxy_pass);
-            }
-            else
-            {
-                ne_session_proxy (m_session, proxy_host, proxy_port);
-            }
-
-            if (use_proxy_auth)
-            {
-                AUDDBG ("<%p> Using proxy authentication\n", this);
-                ne_add_proxy_auth (m_session, NE_AUTH_BASIC,
-                 neon_proxy_auth_cb, (void *) this);
-            }
-        }
-
-        if (! strcmp ("https", m_purl.scheme))
-        {
-            ne_ssl_trust_default_ca (m_session);
-#ifdef _WIN32
-            trust_win32_root_certs (m_session);
-#endif
-            ne_ssl_set_verify (m_session,
-             neon_vfs_verify_environment_ssl_certs, m_session);
-        }
+        m_pooled = acquire_session (m_purl, settings);
+        m_session = m_pooled->session;
 
         AUDDBG ("<%p> Creating request\n", this);
         ret = open_request (startbyte, error);
@@ -670,16 +995,12 @@ int NeonFile::open_handle (int64_t startbyte, String * error)
         if (! ret)
             return 0;
 
+        close_session ();
+
         if (ret == -1)
-        {
-            ne_session_destroy (m_session);
-            m_session = nullptr;
             return -1;
-        }
 
         AUDDBG ("<%p> Following redirect...\n", this);
-        ne_session_destroy (m_session);
-        m_session = nullptr;
     }
 
     /* If we get here, our redirect count exceeded */
@@ -690,20 +1011,46 @@ int NeonFile::open_handle (int64_t startbyte, String * error)
     return 1;
 }
 
+/* must be called with the reader mutex held */
+void NeonFile::wake_consumer ()
+{
+    if (m_reader_status.consumer_waiting && m_rb.len () >= m_reader_status.wanted)
+        pthread_cond_broadcast (& m_reader_status.cond);
+}
+
+/* must be called with the reader mutex held */
+void NeonFile::wake_reader ()
+{
+    int watermark = aud::min (NEON_WAKE_WATERMARK, m_rb.size () / 2);
+
+    if (m_reader_status.reader_waiting && m_rb.space () >= watermark)
+        pthread_cond_broadcast (& m_reader_status.cond);
+}
+
 FillBufferResult NeonFile::fill_buffer ()
 {
-    char buffer[NEON_NETBLKSIZE];
+    char * dest;
     int to_read;
 
+    if (m_request_finished)
+        return FILL_BUFFER_EOF;
+
     pthread_mutex_lock (& m_reader_status.mutex);
-    to_read = aud::min (m_rb.space (), NEON_NETBLKSIZE);
+    dest = m_rb.tail (to_read);
     pthread_mutex_unlock (& m_reader_status.mutex);
 
-    int bsize = ne_read_response_block (m_request, buffer, to_read);
+    to_read = aud::min (to_read, m_block_size);
+
+    /* The consumer never touches the free space of the buffer, so we can
+     * receive into it without holding the lock. */
+    int bsize = ne_read_response_block (m_request, dest, to_read);
 
     if (! bsize)
     {
         AUDDBG ("<%p> End of file encountered\n", this);
+
+        /* finish the response, so the connection can be kept open */
+        m_request_finished = (ne_end_request (m_request) == NE_OK);
         return FILL_BUFFER_EOF;
     }
 
@@ -717,8 +1064,17 @@ FillBufferResult NeonFile::fill_buffer ()
 
     AUDDBG ("<%p> Read %d bytes of %d\n", this, bsize, to_read);
 
+    /* Grow the block size while the network keeps up with it (fewer wakeups
+     * and system calls for fast streams), and shrink it again when reads come
+     * back mostly empty. */
+    if (bsize == to_read)
+        m_block_size = aud::min (m_block_size * 2, NEON_NETBLKSIZE_MAX);
+    else if (bsize < m_block_size / 4)
+        m_block_size = aud::max (m_block_size / 2, NEON_NETBLKSIZE);
+
     pthread_mutex_lock (& m_reader_status.mutex);
-    m_rb.copy_in (buffer, bsize);
+    m_rb.commit (bsize);
+    wake_consumer ();
     pthread_mutex_unlock (& m_reader_status.mutex);
 
     return FILL_BUFFER_SUCCESS;
@@ -739,14 +1095,12 @@ void NeonFile::reader ()
 
             pthread_mutex_lock (& m_reader_status.mutex);
 
-            /* Wake up main thread if it is waiting. */
-            pthread_cond_broadcast (& m_reader_status.cond);
-
             if (ret == FILL_BUFFER_ERROR)
             {
                 AUDERR ("<%p> Error while reading from the network. "
                         "Terminating reader thread\n", this);
                 m_reader_status.status = NEON_READER_ERROR;
+                pthread_cond_broadcast (& m_reader_status.cond);
                 pthread_mutex_unlock (& m_reader_status.mutex);
                 return;
             }
@@ -755,15 +1109,22 @@ void NeonFile::reader ()
                 AUDDBG ("<%p> EOF encountered while reading from the network. "
                         "Terminating reader thread\n", this);
                 m_reader_status.status = NEON_READER_EOF;
+                pthread_cond_broadcast (& m_reader_status.cond);
                 pthread_mutex_unlock (& m_reader_status.mutex);
                 return;
             }
         }
         else
         {
-            /* Not enough free space in the buffer.
-             * Sleep until the main thread wakes us up. */
+            /* Not enough free space in the buffer.  Make sure the consumer
+             * is not left waiting for more than we can buffer, then sleep
+             * until it wakes us up. */
+            if (m_reader_status.consumer_waiting)
+                pthread_cond_broadcast (& m_reader_status.cond);
+
+            m_reader_status.reader_waiting = true;
             pthread_cond_wait (& m_reader_status.cond, & m_reader_status.mutex);
+            m_reader_status.reader_waiting = false;
         }
     }
 
@@ -808,8 +1169,16 @@ int64_t NeonFile::try_fread (void * ptr, int64_t size, int64_t nmemb, bool & dat
          m_reader_status.status != NEON_READER_RUN)
             break;
 
-        pthread_cond_broadcast (& m_reader_status.cond);
+        /* a slow stream may take seconds to fill the whole request, so
+         * return as soon as one element is available */
+        m_reader_status.wanted = size;
+
+        if (m_reader_status.reader_waiting)
+            pthread_cond_broadcast (& m_reader_status.cond);
+
+        m_reader_status.consumer_waiting = true;
         pthread_cond_wait (& m_reader_status.cond, & m_reader_status.mutex);
+        m_reader_status.consumer_waiting = false;
     }
 
     pthread_mutex_unlock (& m_reader_status.mutex);
@@ -934,7 +1303,7 @@ int64_t NeonFile::try_fread (void * ptr, int64_t size, int64_t nmemb, bool & dat
             }
 
             if (m_icy_buf.len () < m_icy_len)
-                m_rb.move_out (m_icy_buf, -1, aud::min (m_icy_len - m_icy_buf.len (), m_rb.len ()));
+                m_rb.move_out (m_icy_buf, aud::min (m_icy_len - m_icy_buf.len (), m_rb.len ()));
 
             if (m_icy_buf.len () >= m_icy_len)
             {
@@ -966,7 +1335,7 @@ int64_t NeonFile::try_fread (void * ptr, int64_t size, int64_t nmemb, bool & dat
         }
     }
     else
-        pthread_cond_broadcast (& m_reader_status.cond);
+        wake_reader ();
 
     pthread_mutex_unlock (& m_reader_status.mutex);
 
@@ -1096,23 +1465,15 @@ int NeonFile::fseek (int64_t offset, VFSSeekType whence)
 
     /* To seek to the new position we have to
      * - stop the current reader thread, if there is one
-     * - destroy the current request
+     * - destroy the current request and return the session to the pool
      * - dump all data currently in the ringbuffer
      * - create a new request starting at newpos */
     if (m_reader_status.reading)
         kill_reader ();
 
-    if (m_request)
-    {
-        ne_request_destroy (m_request);
-        m_request = nullptr;
-    }
-
-    if (m_session)
-    {
-        ne_session_destroy (m_session);
-        m_session = nullptr;
-    }
+    /* unless the response was read to the end, this closes the connection,
+     * but the session (and its TLS state) is reused by open_handle() */
+    close_session ();
 
     m_rb.discard ();
     m_icy_buf.clear ();
@@ -8,10 +8,19 @@
 #define __AO_H
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <memory>
 
 #define WANT_AUD_BSWAP
 #include <libaudcore/audio.h>
 #include <libaudcore/index.h>
+#include <libaudcore/objects.h>
+
+#include "corlett.h"
+
+typedef struct _GMappedFile GMappedFile;
+class VFSFile;
+struct psx_state;
 
 #define AO_SUCCESS					1
 #define AO_FAIL						0
@@ -33,6 +42,54 @@ enum
 	COMMAND_JUMP
 };
 
-Index<char> ao_get_lib(char *filename);
+/* Per-track state passed through the engine functors.  The PSX machine is
+ * owned here (see psx.h); the SPU cores still keep theirs in thread-local
+ * storage, so several tracks can be rendered at once as long as each one is
+ * driven from its own thread. */
+struct ao_instance
+{
+	String dirpath;		// where library files are looked up
+	bool stop_flag = false;	// ends the engine's execute loop
+	void (*update)(ao_instance *inst, const void *data, int bytes) = nullptr;
+	std::unique_ptr<psx_state> psx;	// for the PSF and PSF2 engines
+};
+
+/* The raw image of a rip or library file.  Local files are mapped rather than
+ * copied; the mapping is private and writable since the SPX engine patches its
+ * buffer in place.  Anything else is read into memory through VFS. */
+class ao_file
+{
+public:
+	ao_file() = default;
+	ao_file(const ao_file &) = delete;
+	void operator=(const ao_file &) = delete;
+	~ao_file();
+
+	// <file> is an already opened handle for <filename>, used when it can't be mapped
+	bool load(const char *filename, VFSFile *file = nullptr);
+
+	uint8_t *begin() const { return m_data; }
+	uint32_t len() const { return m_len; }
+
+private:
+	GMappedFile *m_map = nullptr;
+	Index<char> m_buf;
+	uint8_t *m_data = nullptr;
+	uint32_t m_len = 0;
+};
+
+/* A decoded library file.  These are shared between tracks (and threads) that
+ * reference the same library, so they must not be modified. */
+struct ao_lib
+{
+	ao_file file;			// res_section points into this
+	uint8_t *decoded = nullptr;	// program section
+	uint64_t decoded_len = 0;
+	corlett_t *c = nullptr;
+
+	~ao_lib() { free(decoded); free(c); }
+};
+
+std::shared_ptr<const ao_lib> ao_get_lib(ao_instance *inst, char *filename);
 
 #endif // AO_H
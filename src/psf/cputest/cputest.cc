@@ -0,0 +1,137 @@
+/*
+	cputest.cc - R3000 core comparison harness
+
+	Runs a flat MIPS binary loaded at 0x80010000 and prints a hash of the
+	registers after every slice and of RAM at the end.  The slices are
+	pseudo-random and include empty and negative ones, so any difference in
+	cycle counting, delay slots, exceptions or code invalidation between two
+	builds of psx.cc shows up as a different hash.
+
+	The programs next to this file are assembled with
+
+	  llvm-mc -triple=mipsel -mcpu=mips1 -filetype=obj smc.s -o smc.o
+	  ld.lld -Ttext=0x80010000 smc.o -o smc.elf
+	  llvm-objcopy -O binary -j .text smc.elf smc.bin
+
+	and the expected hash for "exact 3000000" is noted at the top of each,
+	as produced by the plain interpreter.  "speed N" runs N cycles in 96
+	cycle slices, like psx_hw_slice() does, and reports the rate.
+
+	  ninja src/psf/psf-cputest && src/psf/psf-cputest smc.bin exact 3000000
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../ao.h"
+#include "../cpuintrf.h"
+#include "../psx.h"
+
+// no library files here
+std::shared_ptr<const ao_lib> ao_get_lib(ao_instance *inst, char *filename)
+{
+	return nullptr;
+}
+
+static uint64_t hash = 1469598103934665603ull;	// FNV-1a
+
+static void hash_word(uint32_t v)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		hash ^= (v >> (i*8)) & 0xff;
+		hash *= 1099511628211ull;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t buf[65536];
+	union cpuinfo mipsinfo;
+	FILE *f;
+	size_t len;
+	long total, done;
+
+	if (argc != 4 || (strcmp(argv[2], "exact") && strcmp(argv[2], "speed")))
+	{
+		fprintf(stderr, "usage: %s <program.bin> exact|speed <cycles>\n", argv[0]);
+		return 1;
+	}
+
+	f = fopen(argv[1], "rb");
+	if (!f)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+	len = fread(buf, 1, sizeof(buf), f);
+	fclose(f);
+
+	std::unique_ptr<psx_state> psx(new psx_state());
+	psx_ctx = psx.get();
+
+	memset(psx_ram, 0, 2*1024*1024);
+	memcpy((uint8_t *)psx_ram + 0x10000, buf, len);
+
+	mips_init();
+	mips_reset(nullptr);
+	psx_hw_init();
+
+	mipsinfo.i = 0x80010000;
+	mips_set_info(CPUINFO_INT_PC, &mipsinfo);
+	mipsinfo.i = 0x801ffff0;
+	mips_set_info(CPUINFO_INT_REGISTER + MIPS_R29, &mipsinfo);
+
+	total = atol(argv[3]);
+
+	if (!strcmp(argv[2], "exact"))
+	{
+		uint32_t seed = 12345;
+
+		for (done = 0; done < total; )
+		{
+			int slice, ran;
+
+			seed = seed * 1103515245 + 12345;
+			slice = (seed >> 16) % 300 + ((seed & 7) == 0 ? -5 : 1);
+
+			ran = mips_execute(slice);
+			done += ran > 0 ? ran : 1;
+			hash_word(ran);
+
+			for (int i = MIPS_PC; i <= MIPS_R31; i++)
+			{
+				mips_get_info(CPUINFO_INT_REGISTER + i, &mipsinfo);
+				hash_word(mipsinfo.i);
+			}
+		}
+
+		for (int i = 0; i < 512*1024; i++)
+		{
+			hash_word(psx_ram[i]);
+		}
+
+		mips_get_info(CPUINFO_INT_REGISTER + MIPS_R3, &mipsinfo);
+		printf("%016llx v1=%u\n", (unsigned long long)hash, (unsigned)mipsinfo.i);
+	}
+	else
+	{
+		struct timespec start, end;
+		double secs;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (done = 0; done < total; done += 96)
+		{
+			mips_execute(96);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+		printf("%.3fs %.1f Minstr/s\n", secs, total / secs / 1e6);
+	}
+
+	return 0;
+}
@@ -0,0 +1,38 @@
+# Overflow exceptions and unaligned loads handled by a routine copied to
+# the exception vector with ordinary stores.
+# exact 3000000: d5f9062f69dca8a8 v1=315799
+.set noreorder
+.set noat
+.text
+start:
+  mtc0 $zero, $12
+  lui $s0, 0x7fff
+  ori $s0, $s0, 0xfff0
+  lui $t0, 0x8000
+  la $t1, handler
+  lw $t2, 0($t1)
+  lw $t3, 4($t1)
+  lw $t4, 8($t1)
+  lw $t5, 12($t1)
+  lw $t6, 16($t1)
+  sw $t2, 0x80($t0)
+  sw $t3, 0x84($t0)
+  sw $t4, 0x88($t0)
+  sw $t5, 0x8c($t0)
+  sw $t6, 0x90($t0)
+loop:
+  addiu $s1, $s1, 3
+  add $s2, $s0, $s1
+  addi $s3, $s1, 0x7fff
+  sub $s4, $s1, $s0
+  addu $s5, $s5, $s2
+  lh $s6, 0x101($t0)
+  addiu $s7, $s7, 1
+  beq $zero, $zero, loop
+  addu $s5, $s5, $s7
+handler:
+  mfc0 $k0, $14
+  addiu $v1, $v1, 1
+  addiu $k0, $k0, 4
+  jr $k0
+  .word 0x42000010
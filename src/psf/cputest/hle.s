@@ -0,0 +1,40 @@
+# Calls a routine, then has the HLE BIOS memcpy a different body over it.
+# exact 3000000: 6f0035d017ea77b0 v1=6587127
+.set noreorder
+.set noat
+.text
+start:
+  addiu $s7, $zero, 0
+  addiu $s5, $zero, 0
+loop:
+  jal target
+  nop
+  addu $s7, $s7, $v0
+  la $a0, target
+  andi $t2, $s5, 1
+  la $a1, bodya
+  beq $t2, $zero, 1f
+  nop
+  la $a1, bodyb
+1:
+  addiu $a2, $zero, 8
+  addiu $t1, $zero, 0x2a
+  addiu $t0, $zero, 0xa0
+  jalr $t0
+  nop
+  addiu $s5, $s5, 1
+  addu $v1, $s7, $zero
+  b loop
+  nop
+
+bodya:
+  jr $ra
+  addiu $v0, $zero, 1
+bodyb:
+  jr $ra
+  addiu $v0, $zero, 100
+
+.align 9
+target:
+  jr $ra
+  addiu $v0, $zero, 7
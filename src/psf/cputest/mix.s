@@ -0,0 +1,45 @@
+# A voice mixing loop shaped like a sound driver's inner loop.
+# exact 3000000: 179d245e99548c0c v1=0
+.set noreorder
+.set noat
+.text
+start:
+  lui $s0, 0x8002         # voice table
+  lui $s1, 0x8003         # output buffer
+  addiu $s2, $zero, 24    # voices
+frame:
+  addu $t9, $s0, $zero
+  addiu $t8, $zero, 0
+voice:
+  lw $t0, 0($t9)          # position
+  lw $t1, 4($t9)          # step
+  lhu $t2, 8($t9)         # volume
+  addu $t0, $t0, $t1
+  sw $t0, 0($t9)
+  srl $t3, $t0, 12
+  andi $t3, $t3, 0x3fe
+  addu $t3, $t3, $s1
+  lh $t4, 0($t3)
+  nop
+  mult $t4, $t2
+  mflo $t5
+  sra $t5, $t5, 15
+  slti $at, $t5, 0x7fff
+  bne $at, $zero, 1f
+  nop
+  addiu $t5, $zero, 0x7fff
+1:
+  jal mix
+  addu $a0, $t5, $zero
+  addiu $t8, $t8, 1
+  bne $t8, $s2, voice
+  addiu $t9, $t9, 16
+  j frame
+  nop
+mix:
+  lui $at, 0x8004
+  lw $v0, 0($at)
+  nop
+  addu $v0, $v0, $a0
+  jr $ra
+  sw $v0, 0($at)
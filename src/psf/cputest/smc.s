@@ -0,0 +1,112 @@
+# Every ALU, load/store, branch and jump form, with a store that patches
+# an instruction later in the same loop each time round.
+# exact 3000000: ee29ff67aecee68d v1=42
+.set noreorder
+.set noat
+.text
+start:
+  lui $s0, 0x8002
+  addiu $s1, $zero, 0
+  lui $s2, 0x1234
+  ori $s2, $s2, 0x5678
+  lui $s3, 0x2694        # addiu $s4,$s4,1 = 0x26940001
+  ori $s3, $s3, 0x0001
+  lui $s5, 0x2694
+  ori $s5, $s5, 0x0002
+  la $s6, patch
+outer:
+  sw $s3, 0($s6)
+  xor $s3, $s3, $s5      # swap s3/s5
+  xor $s5, $s5, $s3
+  xor $s3, $s3, $s5
+  addiu $t1, $zero, 200
+  addu $t0, $s0, $zero
+inner:
+  lw $t2, 0($t0)
+  addu $t3, $t3, $t2
+  sll $t4, $t3, 3
+  srl $t5, $t4, 2
+  sra $t6, $s2, 4
+  xor $t3, $t3, $s2
+  sw $t3, 4($t0)
+  lh $t7, 6($t0)
+  lbu $t8, 5($t0)
+  lb $t9, 7($t0)
+  lhu $v0, 4($t0)
+  addu $t3, $t3, $t7
+  subu $t3, $t3, $t8
+  sh $t9, 10($t0)
+  sb $t3, 13($t0)
+  sb $t4, 14($t0)
+  sb $t5, 15($t0)
+  sh $t6, 16($t0)
+  slt $a0, $t3, $t4
+  sltu $a1, $t3, $t4
+  slti $a2, $t3, -5
+  sltiu $a3, $t3, 100
+  andi $v0, $t3, 0xff0
+  xori $v1, $t3, 0x5a5a
+  nor $v0, $v0, $v1
+  sllv $v1, $t3, $t9
+  srlv $a0, $t3, $t8
+  srav $a1, $t3, $t7
+  and $a2, $a1, $a0
+  or $a3, $a2, $v1
+  mult $t3, $s2
+  mflo $a2
+  mfhi $a3
+  multu $t3, $s2
+  mflo $v0
+  divu $zero, $t3, $t1
+  mfhi $v1
+  div $zero, $t4, $t1
+  mflo $a0
+  mthi $t3
+  mtlo $t4
+  slt $a0, $t3, $t4
+  sltu $a1, $t3, $t4
+  add $t5, $a0, $a1
+  addi $t6, $a0, 7
+  sub $t7, $a0, $a1
+  lwl $t8, 9($t0)
+  lwr $t8, 6($t0)
+  swl $t3, 17($t0)
+  swr $t3, 22($t0)
+  nop
+  jal func
+  addiu $t0, $t0, 32
+  la $at, func2
+  jalr $at
+  nop
+  bgez $t3, 1f
+  sll $zero, $zero, 0
+  addiu $s1, $s1, 1
+1:
+  bltzal $t3, 2f
+  addiu $s1, $s1, 3
+  bgezal $t4, 4f
+  nop
+4:
+  blez $t1, 2f
+  nop
+  bgtz $t1, 3f
+  lw $t2, 0($s0)
+2:
+  addiu $s1, $s1, 5
+3:
+  addiu $t1, $t1, -1
+  bne $t1, $zero, inner
+  addu $t2, $t2, $t1
+patch:
+  nop
+  beq $zero, $zero, outer
+  nop
+func:
+  lui $at, 0x8002
+  addu $at, $at, $s1
+  jr $ra
+  lbu $v0, 100($at)
+func2:
+  lw $k1, 0($sp)
+  jr $ra
+  addu $k1, $k1, $ra
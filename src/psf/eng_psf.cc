@@ -45,21 +45,21 @@
 
 #define LE32(x) FROM_LE32(x)
 
-static corlett_t	*c = nullptr;
-static char 		psfby[256];
-int			psf_refresh  = -1;
+static thread_local corlett_t	*c = nullptr;
+static thread_local char 		psfby[256];
 
-static uint32_t initialPC, initialGP, initialSP;
+static thread_local uint32_t initialPC, initialGP, initialSP;
 
-int32_t psf_start(uint8_t *buffer, uint32_t length)
+int32_t psf_start(ao_instance *inst, uint8_t *buffer, uint32_t length)
 {
 	uint8_t *file, *lib_decoded, *alib_decoded;
 	uint32_t offset, plength, PC, SP, GP, lengthMS, fadeMS;
 	uint64_t file_len, lib_len, alib_len;
-	corlett_t *lib;
 	int i;
 	union cpuinfo mipsinfo;
 
+	psx_ctx = inst->psx.get();
+
 	// clear PSX work RAM before we start scribbling in it
 	memset(psx_ram, 0, 2*1024*1024);
 
@@ -112,18 +112,17 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 		printf("Loading library: %s\n", c->lib);
 		#endif
 
-		Index<char> buf = ao_get_lib(c->lib);
+		auto lib = ao_get_lib(inst, c->lib);
 
-		if (!buf.len())
+		if (!lib)
 			return AO_FAIL;
 
-		if (corlett_decode((uint8_t *)buf.begin(), buf.len(), &lib_decoded, &lib_len, &lib) != AO_SUCCESS)
-			return AO_FAIL;
+		lib_decoded = lib->decoded;
+		lib_len = lib->decoded_len;
 
-		if (strncmp((char *)lib_decoded, "PS-X EXE", 8))
+		if (lib_len < 8 || strncmp((char *)lib_decoded, "PS-X EXE", 8))
 		{
 			printf("Major error!  PSF was OK, but referenced library is not!\n");
-			free(lib);
 			return AO_FAIL;
 		}
 
@@ -133,17 +132,17 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 		offset = lib_decoded[0x1c] | lib_decoded[0x1d]<<8 | lib_decoded[0x1e]<<16 | lib_decoded[0x1f]<<24;
 		printf("Text section size: %x\n", offset);
 		printf("Region: [%s]\n", &lib_decoded[0x4c]);
-		printf("refresh: [%s]\n", lib->inf_refresh);
+		printf("refresh: [%s]\n", lib->c->inf_refresh);
 		#endif
 
 		// if the original file had no refresh tag, give the lib a shot
 		if (psf_refresh == -1)
 		{
-			if (lib->inf_refresh[0] == '5')
+			if (lib->c->inf_refresh[0] == '5')
 			{
 				psf_refresh = 50;
 			}
-			if (lib->inf_refresh[0] == '6')
+			if (lib->c->inf_refresh[0] == '6')
 			{
 				psf_refresh = 60;
 			}
@@ -172,9 +171,6 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 		printf("library offset: %x plength: %d\n", offset, plength);
 		#endif
 		memcpy(&psx_ram[offset/4], lib_decoded + 2048, plength);
-
-		// Dispose the corlett structure for the lib - we don't use it
-		free(lib);
 	}
 
 	// now patch the main file into RAM OVER the libraries (but not the aux lib)
@@ -197,18 +193,17 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 			printf("Loading aux library: %s\n", c->libaux[i]);
 			#endif
 
-			Index<char> buf = ao_get_lib(c->libaux[i]);
+			auto alib = ao_get_lib(inst, c->libaux[i]);
 
-			if (!buf.len())
+			if (!alib)
 				return AO_FAIL;
 
-			if (corlett_decode((uint8_t *)buf.begin(), buf.len(), &alib_decoded, &alib_len, &lib) != AO_SUCCESS)
-				return AO_FAIL;
+			alib_decoded = alib->decoded;
+			alib_len = alib->decoded_len;
 
-			if (strncmp((char *)alib_decoded, "PS-X EXE", 8))
+			if (alib_len < 8 || strncmp((char *)alib_decoded, "PS-X EXE", 8))
 			{
 				printf("Major error!  PSF was OK, but referenced library is not!\n");
-				free(lib);
 				return AO_FAIL;
 			}
 
@@ -230,9 +225,6 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 				plength = alib_len - 2048;
 
 			memcpy(&psx_ram[offset/4], alib_decoded + 2048, plength);
-
-			// Dispose the corlett structure for the lib - we don't use it
-			free(lib);
 		}
 	}
 
@@ -330,14 +322,16 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 	return AO_SUCCESS;
 }
 
-int32_t psf_execute(void (*update)(const void *, int))
+int32_t psf_execute(ao_instance *inst)
 {
 	int i;
 
-	while (!stop_flag) {
+	psx_ctx = inst->psx.get();
+
+	while (!inst->stop_flag) {
 		for (i = 0; i < 44100 / 60; i++) {
 			psx_hw_slice();
-			SPUasync(384, update);
+			SPUasync(384, inst);
 		}
 
 		psx_hw_frame();
@@ -70,16 +70,16 @@
 
 #define LE32(x) FROM_LE32(x)
 
-static corlett_t	*c = nullptr;
+static thread_local corlett_t	*c = nullptr;
 
 // main RAM
-static uint32_t initialPC, initialSP;
-static uint32_t loadAddr, lengthMS, fadeMS;
+static thread_local uint32_t initialPC, initialSP;
+static thread_local uint32_t loadAddr, lengthMS, fadeMS;
 
-static uint8_t *filesys[MAX_FS];
-static Index<char> lib_raw_file;
-static uint32_t fssize[MAX_FS];
-static int num_fs;
+static thread_local uint8_t *filesys[MAX_FS];
+static thread_local std::shared_ptr<const ao_lib> lib_file;
+static thread_local uint32_t fssize[MAX_FS];
+static thread_local int num_fs;
 
 static void do_iopmod(uint8_t *start, uint32_t offset)
 {
@@ -161,6 +161,7 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 
 			case 1:			// PROGBITS: copy data to destination
 				memcpy(&psx_ram[(loadAddr + addr)/4], &start[offset], size);
+				mips_mark_dirty(loadAddr + addr, size);
 				totallen += size;
 				break;
 
@@ -172,6 +173,7 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 
 			case 8:			// NOBITS: BSS region, zero out destination
 				memset(&psx_ram[(loadAddr + addr)/4], 0, size);
+				mips_mark_dirty(loadAddr + addr, size);
 				totallen += size;
 				break;
 
@@ -179,7 +181,7 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 		  		for (rec = 0; rec < (size/8); rec++)
 				{
 					uint32_t offs, info, target, temp, val, vallo;
-					static uint32_t hi16offs = 0, hi16target = 0;
+					static thread_local uint32_t hi16offs = 0, hi16target = 0;
 
 					offs = start[offset+(rec*8)] | start[offset+1+(rec*8)]<<8 | start[offset+2+(rec*8)]<<16 | start[offset+3+(rec*8)]<<24;
 					info = start[offset+4+(rec*8)] | start[offset+5+(rec*8)]<<8 | start[offset+6+(rec*8)]<<16 | start[offset+7+(rec*8)]<<24;
@@ -223,6 +225,7 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 							target = (target & ~0xffff) | (val & 0xffff);
 
 							psx_ram[(loadAddr+hi16offs)/4] = LE32(hi16target);
+							mips_mark_dirty(loadAddr+hi16offs, 4);
 							break;
 
 						default:
@@ -232,6 +235,7 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 					}
 
 					psx_ram[(loadAddr+offs)/4] = LE32(target);
+					mips_mark_dirty(loadAddr+offs, 4);
 				}
 				break;
 
@@ -434,14 +438,15 @@ uint32_t psf2_load_file(const char *file, uint8_t *buf, uint32_t buflen)
 	return 0xffffffff;
 }
 
-int32_t psf2_start(uint8_t *buffer, uint32_t length)
+int32_t psf2_start(ao_instance *inst, uint8_t *buffer, uint32_t length)
 {
-	uint8_t *file, *lib_decoded;
+	uint8_t *file;
 	uint32_t irx_len;
-	uint64_t file_len, lib_len;
+	uint64_t file_len;
 	uint8_t *buf;
 	union cpuinfo mipsinfo;
-	corlett_t *lib;
+
+	psx_ctx = inst->psx.get();
 
 	loadAddr = 0x23f00;	// this value makes allocations work out similarly to how they would
 				// in Highly Experimental (as per Shadow Hearts' hard-coded assumptions)
@@ -473,22 +478,19 @@ int32_t psf2_start(uint8_t *buffer, uint32_t length)
 		printf("Loading library: %s\n", c->lib);
 		#endif
 
-		lib_raw_file = ao_get_lib(c->lib);
-
-		if (!lib_raw_file.len())
-			return AO_FAIL;
+		// the filesystem stays in the (shared) raw library image
+		lib_file = ao_get_lib(inst, c->lib);
 
-		if (corlett_decode((uint8_t *)lib_raw_file.begin(), lib_raw_file.len(),
-		 &lib_decoded, &lib_len, &lib) != AO_SUCCESS)
+		if (!lib_file)
 			return AO_FAIL;
 
 		#if DEBUG_LOADER
-		printf("Lib FS section: size %x bytes\n", lib->res_size);
+		printf("Lib FS section: size %x bytes\n", lib_file->c->res_size);
 		#endif
 
 		num_fs++;
-		filesys[1] = (uint8_t *)lib->res_section;
- 		fssize[1] = lib->res_size;
+		filesys[1] = (uint8_t *)lib_file->c->res_section;
+ 		fssize[1] = lib_file->c->res_size;
 	}
 
 	// dump all files
@@ -561,15 +563,17 @@ int32_t psf2_start(uint8_t *buffer, uint32_t length)
 	return AO_SUCCESS;
 }
 
-int32_t psf2_execute(void (*update)(const void *, int))
+int32_t psf2_execute(ao_instance *inst)
 {
 	int i;
 
-	while (!stop_flag)
+	psx_ctx = inst->psx.get();
+
+	while (!inst->stop_flag)
 	{
 		for (i = 0; i < 44100 / 60; i++)
 		{
-			SPU2async(update);
+			SPU2async(inst);
 			ps2_hw_slice();
 		}
 
@@ -582,7 +586,7 @@ int32_t psf2_execute(void (*update)(const void *, int))
 int32_t psf2_stop(void)
 {
 	SPU2close();
-	lib_raw_file.clear();
+	lib_file.reset();
 	free(c);
 
 	return AO_SUCCESS;
@@ -44,12 +44,12 @@
 #include "peops/registers.h"
 #include "peops/spu.h"
 
-static uint8_t *start_of_file, *song_ptr;
-static uint32_t cur_tick, cur_event, num_events, next_tick, end_tick;
-static int old_fmt;
-static char name[128], song[128], company[128];
+static thread_local uint8_t *start_of_file, *song_ptr;
+static thread_local uint32_t cur_tick, cur_event, num_events, next_tick, end_tick;
+static thread_local int old_fmt;
+static thread_local char name[128], song[128], company[128];
 
-int32_t spx_start(uint8_t *buffer, uint32_t length)
+int32_t spx_start(ao_instance *inst, uint8_t *buffer, uint32_t length)
 {
 	int i;
 	uint16_t reg;
@@ -202,11 +202,11 @@ static void spx_tick(void)
 	cur_tick++;
 }
 
-int32_t spx_execute(void (*update)(const void *, int))
+int32_t spx_execute(ao_instance *inst)
 {
 	int i, run = 1;
 
-	while (!stop_flag)
+	while (!inst->stop_flag)
 	{
 		if (old_fmt && (cur_event >= num_events))
 			run = 0;
@@ -218,7 +218,7 @@ int32_t spx_execute(void (*update)(const void *, int))
 			for (i = 0; i < 44100 / 60; i++)
 			{
 			  	spx_tick();
-				SPUasync(384, update);
+				SPUasync(384, inst);
 			}
 		}
 	}
@@ -36,7 +36,7 @@
 // ADSR func
 ////////////////////////////////////////////////////////////////////////
 
-static u32 RateTable[160];
+static thread_local u32 RateTable[160];
 
 static void InitADSR(void)                                    // INIT ADSR
 {
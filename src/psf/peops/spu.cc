@@ -98,27 +98,27 @@
 
 // psx buffer / addresses
 
-static u16  regArea[0x200];
-static u16  spuMem[256*1024];
-static u8 * spuMemC;
-static u8 * pSpuIrq=0;
-static u8 * pSpuBuffer;
+static thread_local u16  regArea[0x200];
+static thread_local u16  spuMem[256*1024];
+static thread_local u8 * spuMemC;
+static thread_local u8 * pSpuIrq=0;
+static thread_local u8 * pSpuBuffer;
 
 // user settings
-static int             iVolume;
+static thread_local int             iVolume;
 
 // MAIN infos struct for each channel
 
-static SPUCHAN         s_chan[MAXCHAN+1];                     // channel + 1 infos (1 is security for fmod handling)
-static REVERBInfo      rvb;
+static thread_local SPUCHAN         s_chan[MAXCHAN+1];                     // channel + 1 infos (1 is security for fmod handling)
+static thread_local REVERBInfo      rvb;
 
-static u32   dwNoiseVal=1;                          // global noise generator
+static thread_local u32   dwNoiseVal=1;                          // global noise generator
 
-static u16  spuCtrl=0;                             // some vars to store psx reg infos
-static u16  spuStat=0;
-static u16  spuIrq=0;
-static u32  spuAddr=0xffffffff;                    // address into spu mem
-static int  bSPUIsOpen=0;
+static thread_local u16  spuCtrl=0;                             // some vars to store psx reg infos
+static thread_local u16  spuStat=0;
+static thread_local u16  spuIrq=0;
+static thread_local u32  spuAddr=0xffffffff;                    // address into spu mem
+static thread_local int  bSPUIsOpen=0;
 
 static const int f[5][2] = {
 			{    0,  0  },
@@ -126,8 +126,8 @@ static const int f[5][2] = {
                         {  115, -52 },
                         {   98, -55 },
                         {  122, -60 } };
-static s16 * pS;
-static s32 ttemp;
+static thread_local s16 * pS;
+static thread_local s32 ttemp;
 
 ////////////////////////////////////////////////////////////////////////
 // CODE AREA
@@ -182,11 +182,11 @@ static inline void StartSound(int ch)
 // basically the whole sound processing is done in this fat func!
 ////////////////////////////////////////////////////////////////////////
 
-static u32 sampcount;
-static u32 decaybegin;
-static u32 decayend;
+static thread_local u32 sampcount;
+static thread_local u32 decaybegin;
+static thread_local u32 decayend;
 
-static u32 seektime;
+static thread_local u32 seektime;
 int psf_seek(u32 t)
 {
  seektime=t*441/10;
@@ -194,7 +194,7 @@ int psf_seek(u32 t)
  return(0);
 }
 
-static int endless;
+static thread_local int endless;
 void setendless(int e)
 {
  endless=e;
@@ -218,10 +218,10 @@ void setlength(s32 stop, s32 fade)
 }
 
 #define CLIP(_x) {if(_x>32767) _x=32767; if(_x<-32767) _x=-32767;}
-int SPUasync(u32 cycles, void (*update)(const void *, int))
+int SPUasync(u32 cycles, ao_instance *inst)
 {
  int volmul=iVolume;
- static s32 dosampies;
+ static thread_local s32 dosampies;
  s32 temp;
 
  ttemp+=cycles;
@@ -469,7 +469,7 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
    {
     if(sampcount>=decayend)
     {
-      update(nullptr, 0);
+      inst->update(inst, nullptr, 0);
       return(0);
     }
     dmul=256-(256*(sampcount-decaybegin)/(decayend-decaybegin));
@@ -526,7 +526,7 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
 
    if (iSilenceCount < 20)
 #endif
-     update((u8*)pSpuBuffer,(u8*)pS-(u8*)pSpuBuffer);
+     inst->update(inst, (u8*)pSpuBuffer,(u8*)pS-(u8*)pSpuBuffer);
 
    pS=(short *)pSpuBuffer;
  }
@@ -535,7 +535,7 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
 }
 
 #ifdef TIMEO
-static u64 begintime;
+static thread_local u64 begintime;
 static u64 gettime64(void)
 {
  struct timeval tv;
@@ -30,7 +30,7 @@ int psf_seek(uint32_t t);
 void setendless(int e);
 void setlength(int32_t stop, int32_t fade);
 
-int SPUasync(uint32_t cycles, void (*update)(const void *, int));
+int SPUasync(uint32_t cycles, ao_instance *inst);
 void SPU_flushboot(void);
 int SPUinit(void);
 int SPUopen(void);
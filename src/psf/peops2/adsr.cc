@@ -41,7 +41,7 @@
 // ADSR func
 ////////////////////////////////////////////////////////////////////////
 
-unsigned long RateTable[160];
+thread_local unsigned long RateTable[160];
 
 static void InitADSR(void)                                    // INIT ADSR
 {
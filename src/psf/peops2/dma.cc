@@ -36,7 +36,7 @@
 #include "../peops2/registers.h"
 //#include "debug.h"
 
-extern uint32_t psx_ram[(2*1024*1024)/4+4];
+#include "../psx.h"
 
 ////////////////////////////////////////////////////////////////////////
 // READ DMA (many values)
@@ -254,56 +254,56 @@ typedef struct
 
 // psx buffers / addresses
 
-extern unsigned short  regArea[];
-extern unsigned short  spuMem[];
-extern unsigned char * spuMemC;
-extern unsigned char * pSpuIrq[];
-extern unsigned char * pSpuBuffer;
+extern thread_local unsigned short  regArea[];
+extern thread_local unsigned short  spuMem[];
+extern thread_local unsigned char * spuMemC;
+extern thread_local unsigned char * pSpuIrq[];
+extern thread_local unsigned char * pSpuBuffer;
 
 // user settings
 
-extern int        iUseXA;
+extern thread_local int        iUseXA;
 extern int        iVolume;
-extern int        iXAPitch;
-extern int        iUseTimer;
-extern int        iSPUIRQWait;
-extern int        iDebugMode;
-extern int        iRecordMode;
-extern int        iUseReverb;
-extern int        iUseInterpolation;
+extern thread_local int        iXAPitch;
+extern thread_local int        iUseTimer;
+extern thread_local int        iSPUIRQWait;
+extern thread_local int        iDebugMode;
+extern thread_local int        iRecordMode;
+extern thread_local int        iUseReverb;
+extern thread_local int        iUseInterpolation;
 extern int        iDisStereo;
 // MISC
 
-extern SPUCHAN2 s_chan[];
-extern REVERBInfo2 rvb[];
+extern thread_local SPUCHAN2 s_chan[];
+extern thread_local REVERBInfo2 rvb[];
 
-extern unsigned long dwNoiseVal;
-extern unsigned short spuCtrl2[];
-extern unsigned short spuStat2[];
-extern unsigned long  spuIrq2[];
-extern unsigned long  spuAddr2[];
-extern unsigned long   spuRvbAddr2[];
-extern unsigned long   spuRvbAEnd2[];
+extern thread_local unsigned long dwNoiseVal;
+extern thread_local unsigned short spuCtrl2[];
+extern thread_local unsigned short spuStat2[];
+extern thread_local unsigned long  spuIrq2[];
+extern thread_local unsigned long  spuAddr2[];
+extern thread_local unsigned long   spuRvbAddr2[];
+extern thread_local unsigned long   spuRvbAEnd2[];
 
-extern int      bEndThread;
-extern int      bThreadEnded;
-extern int      bSpuInit;
+extern thread_local int      bEndThread;
+extern thread_local int      bThreadEnded;
+extern thread_local int      bSpuInit;
 
-extern int      SSumR[];
-extern int      SSumL[];
-extern int      iCycle;
-extern short *  pS;
-extern unsigned long dwNewChannel2[];
-extern unsigned long dwEndChannel2[];
+extern thread_local int      SSumR[];
+extern thread_local int      SSumL[];
+extern thread_local int      iCycle;
+extern thread_local short *  pS;
+extern thread_local unsigned long dwNewChannel2[];
+extern thread_local unsigned long dwEndChannel2[];
 
-extern int iSpuAsyncWait;
+extern thread_local int iSpuAsyncWait;
 
 #ifdef _WINDOWS
 //extern HWND    hWMain;                               // window handle
 //extern HWND    hWDebug;
 #endif
 
-extern void (CALLBACK *cddavCallback)(unsigned short,unsigned short);
+extern thread_local void (CALLBACK *cddavCallback)(unsigned short,unsigned short);
 
 #endif
 
@@ -371,9 +371,9 @@ extern int           iRightXAVol;
 
 #ifndef _IN_REVERB
 
-extern int *          sRVBPlay[];
-extern int *          sRVBEnd[];
-extern int *          sRVBStart[];
+extern thread_local int *          sRVBPlay[];
+extern thread_local int *          sRVBEnd[];
+extern thread_local int *          sRVBStart[];
 
 #endif
 
@@ -49,9 +49,9 @@
 
 // REVERB info and timing vars...
 
-int *          sRVBPlay[2];
-int *          sRVBEnd[2];
-int *          sRVBStart[2];
+thread_local int *          sRVBPlay[2];
+thread_local int *          sRVBEnd[2];
+thread_local int *          sRVBStart[2];
 
 ////////////////////////////////////////////////////////////////////////
 // START REVERB
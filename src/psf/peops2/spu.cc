@@ -110,47 +110,47 @@
 
 // psx buffer / addresses
 
-unsigned short  regArea[32*1024];
-unsigned short  spuMem[1*1024*1024];
-unsigned char * spuMemC;
-unsigned char * pSpuIrq[2];
-unsigned char * pSpuBuffer;
+thread_local unsigned short  regArea[32*1024];
+thread_local unsigned short  spuMem[1*1024*1024];
+thread_local unsigned char * spuMemC;
+thread_local unsigned char * pSpuIrq[2];
+thread_local unsigned char * pSpuBuffer;
 
 // user settings
 
-int             iUseXA=0;
-int             iXAPitch=1;
-int             iUseTimer=2;
-int             iSPUIRQWait=1;
-int             iDebugMode=0;
-int             iRecordMode=0;
-int             iUseReverb=1;
-int             iUseInterpolation=2;
+thread_local int             iUseXA=0;
+thread_local int             iXAPitch=1;
+thread_local int             iUseTimer=2;
+thread_local int             iSPUIRQWait=1;
+thread_local int             iDebugMode=0;
+thread_local int             iRecordMode=0;
+thread_local int             iUseReverb=1;
+thread_local int             iUseInterpolation=2;
 
 // MAIN infos struct for each channel
 
-SPUCHAN2         s_chan[MAXCHAN+1];                     // channel + 1 infos (1 is security for fmod handling)
-REVERBInfo2      rvb[2];
+thread_local SPUCHAN2         s_chan[MAXCHAN+1];                     // channel + 1 infos (1 is security for fmod handling)
+thread_local REVERBInfo2      rvb[2];
 
-unsigned long   dwNoiseVal=1;                          // global noise generator
+thread_local unsigned long   dwNoiseVal=1;                          // global noise generator
 
-unsigned short  spuCtrl2[2];                           // some vars to store psx reg infos
-unsigned short  spuStat2[2];
-unsigned long   spuIrq2[2];
-unsigned long   spuAddr2[2];                           // address into spu mem
-unsigned long   spuRvbAddr2[2];
-unsigned long   spuRvbAEnd2[2];
-int             bEndThread=0;                          // thread handlers
-int             bThreadEnded=0;
-int             bSpuInit=0;
-int             bSPUIsOpen=0;
+thread_local unsigned short  spuCtrl2[2];                           // some vars to store psx reg infos
+thread_local unsigned short  spuStat2[2];
+thread_local unsigned long   spuIrq2[2];
+thread_local unsigned long   spuAddr2[2];                           // address into spu mem
+thread_local unsigned long   spuRvbAddr2[2];
+thread_local unsigned long   spuRvbAEnd2[2];
+thread_local int             bEndThread=0;                          // thread handlers
+thread_local int             bThreadEnded=0;
+thread_local int             bSpuInit=0;
+thread_local int             bSPUIsOpen=0;
 
-unsigned long dwNewChannel2[2];                        // flags for faster testing, if new channel starts
-unsigned long dwEndChannel2[2];
+thread_local unsigned long dwNewChannel2[2];                        // flags for faster testing, if new channel starts
+thread_local unsigned long dwEndChannel2[2];
 
 // UNUSED IN PS2 YET
-void (CALLBACK *irqCallback)(void)=0;                  // func of main emu, called on spu irq
-void (CALLBACK *cddavCallback)(unsigned short,unsigned short)=0;
+thread_local void (CALLBACK *irqCallback)(void)=0;                  // func of main emu, called on spu irq
+thread_local void (CALLBACK *cddavCallback)(unsigned short,unsigned short)=0;
 
 // certain globals (were local before, but with the new timeproc I need em global)
 
@@ -159,13 +159,13 @@ const int f[5][2] = {   {    0,  0  },
                         {  115, -52 },
                         {   98, -55 },
                         {  122, -60 } };
-int SSumR[NSSIZE];
-int SSumL[NSSIZE];
-int iCycle=0;
-short * pS;
+thread_local int SSumR[NSSIZE];
+thread_local int SSumL[NSSIZE];
+thread_local int iCycle=0;
+thread_local short * pS;
 
-static int lastch=-1;      // last channel processed on spu irq in timer mode
-static int iSecureStart=0; // secure start counter
+static thread_local int lastch=-1;      // last channel processed on spu irq in timer mode
+static thread_local int iSecureStart=0; // secure start counter
 
 ////////////////////////////////////////////////////////////////////////
 // CODE AREA
@@ -325,11 +325,11 @@ static inline void StartSound(int ch)
 // basically the whole sound processing is done in this fat func!
 ////////////////////////////////////////////////////////////////////////
 
-static u32 sampcount;
-static u32 decaybegin;
-static u32 decayend;
+static thread_local u32 sampcount;
+static thread_local u32 decaybegin;
+static thread_local u32 decayend;
 
-static u32 seektime;
+static thread_local u32 seektime;
 int psf2_seek(u32 t)
 {
  seektime=t*441/10;
@@ -337,7 +337,7 @@ int psf2_seek(u32 t)
  return(0);
 }
 
-static int endless;
+static thread_local int endless;
 void setendless2(int e)
 {
  endless=e;
@@ -368,9 +368,9 @@ void setlength2(s32 stop, s32 fade)
 
 ////////////////////////////////////////////////////////////////////////
 
-int iSpuAsyncWait=0;
+thread_local int iSpuAsyncWait=0;
 
-static void *MAINThread(void (*update)(const void *, int))
+static void *MAINThread(ao_instance *inst)
 {
  int s_1,s_2,fa;
  unsigned char * start;unsigned int nSample;
@@ -754,7 +754,7 @@ ENDX:   ;
        {
         if(sampcount>=decayend)
          {
-          update(nullptr, 0);
+          inst->update(inst, nullptr, 0);
           return(0);
          }
 
@@ -792,7 +792,7 @@ ENDX:   ;
      }
 
     if(iSilenceCount < 20)
-     update((u8*)pSpuBuffer,(u8*)pS-(u8*)pSpuBuffer);
+     inst->update(inst, (u8*)pSpuBuffer,(u8*)pS-(u8*)pSpuBuffer);
 
     pS=(short *)pSpuBuffer;
    }
@@ -814,7 +814,7 @@ ENDX:   ;
 //  1 time every 'cycle' cycles... harhar
 ////////////////////////////////////////////////////////////////////////
 
-EXPORT_GCC void CALLBACK SPU2async(void (*update)(const void *, int))
+EXPORT_GCC void CALLBACK SPU2async(ao_instance *inst)
 {
  if(iSpuAsyncWait)
   {
@@ -822,7 +822,7 @@ EXPORT_GCC void CALLBACK SPU2async(void (*update)(const void *, int))
    if(iSpuAsyncWait<=64) return;
    iSpuAsyncWait=0;
   }
- MAINThread(update);                                      // -> linux high-compat mode
+ MAINThread(inst);                                      // -> linux high-compat mode
 }
 
 ////////////////////////////////////////////////////////////////////////
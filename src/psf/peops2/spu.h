@@ -32,7 +32,7 @@ void setlength2(int32_t stop, int32_t fade);
 
 long SPU2init(void);
 long SPU2open(void *pDsp);
-void SPU2async(void (*update)(const void *, int));
+void SPU2async(ao_instance *inst);
 void SPU2close(void);
 
 int psf2_seek(uint32_t t);
@@ -26,12 +26,19 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <mutex>
+
+#include <glib.h>
+#include <glib/gstdio.h>
 
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
 #include <libaudcore/audstrings.h>
 #include <libaudcore/runtime.h>
+#include <libaudcore/vfs.h>
 
 #include "ao.h"
 #include "corlett.h"
@@ -65,7 +72,7 @@ public:
     bool play(const char *filename, VFSFile &file) override;
 
 protected:
-    static void update(const void *data, int bytes);
+    static void update(ao_instance *inst, const void *data, int bytes);
 };
 
 EXPORT PSFPlugin aud_plugin_instance;
@@ -79,10 +86,10 @@ typedef enum {
 } PSFEngine;
 
 typedef struct {
-    int32_t (*start)(uint8_t *buffer, uint32_t length);
+    int32_t (*start)(ao_instance *inst, uint8_t *buffer, uint32_t length);
     int32_t (*stop)(void);
     int32_t (*seek)(uint32_t);
-    int32_t (*execute)(void (*update)(const void *, int));
+    int32_t (*execute)(ao_instance *inst);
 } PSFEngineFunctors;
 
 static PSFEngineFunctors psf_functor_map[ENG_COUNT] = {
@@ -104,15 +111,15 @@ bool PSFPlugin::init()
     return true;
 }
 
-static PSFEngineFunctors *f;
-static String dirpath;
-
-bool stop_flag = false;
+struct PSFInstance : public ao_instance
+{
+    PSFEngineFunctors *f = nullptr;
 
-/* The emulation engine can only seek forward, not back.  This variable is set
- * a non-negative time (milliseconds) when the song is to be restarted in order
- * to seek backward. */
-static int reverse_seek;
+    /* The emulation engine can only seek forward, not back.  This variable is
+     * set a non-negative time (milliseconds) when the song is to be restarted
+     * in order to seek backward. */
+    int reverse_seek = -1;
+};
 
 static PSFEngine psf_probe(const char *buf, int len)
 {
@@ -134,21 +141,126 @@ static PSFEngine psf_probe(const char *buf, int len)
     return ENG_NONE;
 }
 
+ao_file::~ao_file()
+{
+    if (m_map)
+        g_mapped_file_unref(m_map);
+}
+
+bool ao_file::load(const char *filename, VFSFile *file)
+{
+    StringBuf path = uri_to_filename(filename);
+    int fd = path ? g_open(path, O_RDONLY, 0) : -1;
+
+    if (fd >= 0)
+    {
+        /* a writable mapping of a read-only descriptor is copy-on-write */
+        m_map = g_mapped_file_new_from_fd(fd, true, nullptr);
+        close(fd);
+    }
+
+    if (m_map)
+    {
+        m_data = (uint8_t *)g_mapped_file_get_contents(m_map);
+        m_len = g_mapped_file_get_length(m_map);
+    }
+    else if (file)
+        m_buf = file->read_all();
+    else
+    {
+        VFSFile vfs(filename, "r");
+        if (vfs)
+            m_buf = vfs.read_all();
+    }
+
+    if (!m_map)
+    {
+        m_data = (uint8_t *)m_buf.begin();
+        m_len = m_buf.len();
+    }
+
+    return m_len > 0;
+}
+
+/* Minipsfs of one rip usually share a library, so decoded libraries are kept
+ * around for the next track.  Entries are checked against the size and
+ * modification time of the file; that can only be done for local files, so
+ * others are loaded again every time. */
+struct LibCacheEntry
+{
+    String path;
+    int64_t size, mtime;
+    std::shared_ptr<const ao_lib> lib;
+};
+
+static constexpr int lib_cache_max = 8;
+
+static std::mutex lib_cache_mutex;
+static Index<LibCacheEntry> lib_cache;
+
 /* ao_get_lib: called to load secondary files */
-Index<char> ao_get_lib(char *filename)
+std::shared_ptr<const ao_lib> ao_get_lib(ao_instance *inst, char *filename)
 {
-    VFSFile file(filename_build({dirpath, filename}), "r");
-    return file ? file.read_all() : Index<char>();
+    StringBuf uri = filename_build({inst->dirpath, filename});
+    StringBuf path = uri_to_filename(uri);
+
+    GStatBuf st;
+    bool cacheable = path && g_stat(path, &st) == 0;
+
+    if (cacheable)
+    {
+        std::lock_guard<std::mutex> lock(lib_cache_mutex);
+
+        for (int i = 0; i < lib_cache.len(); i++)
+        {
+            LibCacheEntry &entry = lib_cache[i];
+            if (strcmp(entry.path, path))
+                continue;
+
+            if (entry.size == st.st_size && entry.mtime == st.st_mtime)
+            {
+                /* move it to the back, so the oldest entry is dropped first */
+                LibCacheEntry hit = std::move(entry);
+                lib_cache.remove(i, 1);
+                lib_cache.append(std::move(hit));
+                return lib_cache[lib_cache.len() - 1].lib;
+            }
+
+            lib_cache.remove(i, 1);
+            break;
+        }
+    }
+
+    auto lib = std::make_shared<ao_lib>();
+
+    if (!lib->file.load(uri))
+        return nullptr;
+
+    if (corlett_decode(lib->file.begin(), lib->file.len(), &lib->decoded,
+     &lib->decoded_len, &lib->c) != AO_SUCCESS)
+        return nullptr;
+
+    if (cacheable)
+    {
+        std::lock_guard<std::mutex> lock(lib_cache_mutex);
+
+        if (lib_cache.len() >= lib_cache_max)
+            lib_cache.remove(0, 1);
+
+        lib_cache.append(LibCacheEntry{String(path), (int64_t)st.st_size, (int64_t)st.st_mtime, lib});
+    }
+
+    return lib;
 }
 
 bool PSFPlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image)
 {
-    Index<char> buf = file.read_all ();
-    if (!buf.len())
+    ao_file buf;
+    if (!buf.load(filename, &file))
         return false;
 
     corlett_t *c;
-    if (corlett_decode((uint8_t *)buf.begin(), buf.len(), nullptr, nullptr, &c) != AO_SUCCESS)
+    if (corlett_decode(buf.begin(), buf.len(), nullptr, nullptr, &c) != AO_SUCCESS)
         return false;
 
     tuple.set_int(Tuple::Length, psfTimeToMS(c->inf_length) + psfTimeToMS(c->inf_fade));
@@ -173,13 +285,16 @@ bool PSFPlugin::play(const char *filename, VFSFile &file)
     if (! slash)
         return false;
 
-    dirpath = String (str_copy (filename, slash + 1 - filename));
+    PSFInstance inst;
+    inst.dirpath = String (str_copy (filename, slash + 1 - filename));
+    inst.update = update;
 
-    Index<char> buf = file.read_all ();
+    ao_file buf;
+    buf.load(filename, &file);
 
     bool ignore_len = aud_get_bool("psf", "ignore_length");
 
-    PSFEngine eng = psf_probe(buf.begin(), buf.len());
+    PSFEngine eng = psf_probe((const char *)buf.begin(), buf.len());
     if (eng == ENG_NONE || eng == ENG_COUNT)
     {
         error = true;
@@ -192,48 +307,47 @@ bool PSFPlugin::play(const char *filename, VFSFile &file)
     if(eng == ENG_PSF2)
         setendless2(ignore_len);
 
-    f = &psf_functor_map[eng];
+    inst.f = &psf_functor_map[eng];
+
+    inst.psx.reset(new psx_state());
 
     set_stream_bitrate(44100*2*2*8);
     open_audio(FMT_S16_NE, 44100, 2);
 
-    reverse_seek = -1;
-
     /* This loop will restart playback from the beginning when necessary to seek
      * backwards in the file (reverse_seek >= 0). */
     do
     {
-        if (f->start((uint8_t *)buf.begin(), buf.len()) != AO_SUCCESS)
+        if (inst.f->start(&inst, buf.begin(), buf.len()) != AO_SUCCESS)
         {
             error = true;
             goto cleanup;
         }
 
-        if (reverse_seek >= 0)
+        if (inst.reverse_seek >= 0)
         {
-            f->seek(reverse_seek); /* should never fail here */
-            reverse_seek = -1;
+            inst.f->seek(inst.reverse_seek); /* should never fail here */
+            inst.reverse_seek = -1;
         }
 
-        stop_flag = false;
+        inst.stop_flag = false;
 
-        f->execute(update);
-        f->stop();
+        inst.f->execute(&inst);
+        inst.f->stop();
     }
-    while (reverse_seek >= 0);
+    while (inst.reverse_seek >= 0);
 
 cleanup:
-    f = nullptr;
-    dirpath = String ();
-
     return ! error;
 }
 
-void PSFPlugin::update(const void *data, int bytes)
+void PSFPlugin::update(ao_instance *inst, const void *data, int bytes)
 {
+    auto psf = static_cast<PSFInstance *>(inst);
+
     if (!data || check_stop())
     {
-        stop_flag = true;
+        psf->stop_flag = true;
         return;
     }
 
@@ -241,10 +355,10 @@ void PSFPlugin::update(const void *data, int bytes)
 
     if (seek >= 0)
     {
-        if (!f->seek(seek))
+        if (!psf->f->seek(seek))
         {
-            reverse_seek = seek;
-            stop_flag = true;
+            psf->reverse_seek = seek;
+            psf->stop_flag = true;
         }
 
         return;
@@ -15,10 +15,13 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include "ao.h"
 #include "cpuintrf.h"
 #include "psx.h"
 
+#define LE32(x) FROM_LE32(x)
+
 #define EXC_INT ( 0 )
 #define EXC_ADEL ( 4 )
 #define EXC_ADES ( 5 )
@@ -147,25 +150,8 @@ static uint8_t mips_win_layout[] = {
 
 #define REGPC ( 32 )
 
-typedef struct
-{
-	uint32_t op;
-	uint32_t pc;
-	uint32_t prevpc;
-	uint32_t delayv;
-	uint32_t delayr;
-	uint32_t hi;
-	uint32_t lo;
-	uint32_t r[ 32 ];
-	uint32_t cp0r[ 32 ];
-	PAIR cp2cr[ 32 ];
-	PAIR cp2dr[ 32 ];
-	int (*irq_callback)(int irqline);
-} mips_cpu_context;
-
-static mips_cpu_context mipscpu;
-
-static int mips_ICount = 0;
+#define mipscpu (psx_ctx->mips)
+#define mips_ICount (psx_ctx->mips_icount)
 
 static uint32_t mips_mtc0_writemask[]=
 {
@@ -223,6 +209,7 @@ static uint32_t getcp2cr( int n_reg );
 static void setcp2cr( int n_reg, uint32_t n_value );
 static void docop2( int gteop );
 static void mips_exception( int exception );
+static void mips_flush_blocks( void );
 
 static void mips_stop( void )
 {
@@ -250,81 +237,114 @@ static inline void mips_set_cp0r( int reg, uint32_t value )
 	}
 }
 
-static inline void mips_commit_delayed_load( void )
+/* the helpers below take the context explicitly so that the block loop in
+ * mips_execute() can look up the thread-local state once per call */
+
+static inline void mips_commit_delayed_load( mips_cpu_context *cpu )
 {
-	if( mipscpu.delayr != 0 )
+	if( cpu->delayr != 0 )
 	{
-		mipscpu.r[ mipscpu.delayr ] = mipscpu.delayv;
-		mipscpu.delayr = 0;
-		mipscpu.delayv = 0;
+		cpu->r[ cpu->delayr ] = cpu->delayv;
+		cpu->delayr = 0;
+		cpu->delayv = 0;
 	}
 }
 
-static inline void mips_delayed_branch( uint32_t n_adr )
+static inline void mips_commit_delayed_load( void )
 {
-	if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
+	mips_commit_delayed_load( &mipscpu );
+}
+
+static inline void mips_delayed_branch( mips_cpu_context *cpu, uint32_t n_adr )
+{
+	if( ( n_adr & ( ( ( cpu->cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
 	{
 		mips_exception( EXC_ADEL );
 		mips_set_cp0r( CP0_BADVADDR, n_adr );
 	}
 	else
 	{
-		mips_commit_delayed_load();
-		mipscpu.delayr = REGPC;
-		mipscpu.delayv = n_adr;
-		mipscpu.pc += 4;
+		mips_commit_delayed_load( cpu );
+		cpu->delayr = REGPC;
+		cpu->delayv = n_adr;
+		cpu->pc += 4;
 	}
 }
 
-static inline void mips_set_pc( unsigned val )
+static inline void mips_delayed_branch( uint32_t n_adr )
 {
-	mipscpu.pc = val;
+	mips_delayed_branch( &mipscpu, n_adr );
+}
+
+static inline void mips_set_pc( mips_cpu_context *cpu, unsigned val )
+{
+	cpu->pc = val;
 	change_pc( val );
-	mipscpu.delayr = 0;
-	mipscpu.delayv = 0;
+	cpu->delayr = 0;
+	cpu->delayv = 0;
 }
 
-static inline void mips_advance_pc( void )
+static inline void mips_set_pc( unsigned val )
 {
-	if( mipscpu.delayr == REGPC )
+	mips_set_pc( &mipscpu, val );
+}
+
+static inline void mips_advance_pc( mips_cpu_context *cpu )
+{
+	if( cpu->delayr == REGPC )
 	{
-		mips_set_pc( mipscpu.delayv );
+		mips_set_pc( cpu, cpu->delayv );
 	}
 	else
 	{
-		mips_commit_delayed_load();
-		mipscpu.pc += 4;
+		mips_commit_delayed_load( cpu );
+		cpu->pc += 4;
 	}
 }
 
-static inline void mips_load( uint32_t n_r, uint32_t n_v )
+static inline void mips_advance_pc( void )
+{
+	mips_advance_pc( &mipscpu );
+}
+
+static inline void mips_load( mips_cpu_context *cpu, uint32_t n_r, uint32_t n_v )
 {
-	mips_advance_pc();
+	mips_advance_pc( cpu );
 	if( n_r != 0 )
 	{
-		mipscpu.r[ n_r ] = n_v;
+		cpu->r[ n_r ] = n_v;
 	}
 }
 
-static inline void mips_delayed_load( uint32_t n_r, uint32_t n_v )
+static inline void mips_load( uint32_t n_r, uint32_t n_v )
 {
-	if( mipscpu.delayr == REGPC )
+	mips_load( &mipscpu, n_r, n_v );
+}
+
+static inline void mips_delayed_load( mips_cpu_context *cpu, uint32_t n_r, uint32_t n_v )
+{
+	if( cpu->delayr == REGPC )
 	{
-		mips_set_pc( mipscpu.delayv );
-		mipscpu.delayr = n_r;
-		mipscpu.delayv = n_v;
+		mips_set_pc( cpu, cpu->delayv );
+		cpu->delayr = n_r;
+		cpu->delayv = n_v;
 	}
 	else
 	{
-		mips_commit_delayed_load();
-		mipscpu.pc += 4;
+		mips_commit_delayed_load( cpu );
+		cpu->pc += 4;
 		if( n_r != 0 )
 		{
-			mipscpu.r[ n_r ] = n_v;
+			cpu->r[ n_r ] = n_v;
 		}
 	}
 }
 
+static inline void mips_delayed_load( uint32_t n_r, uint32_t n_v )
+{
+	mips_delayed_load( &mipscpu, n_r, n_v );
+}
+
 static void mips_exception( int exception )
 {
 	mips_set_cp0r( CP0_SR, ( mipscpu.cp0r[ CP0_SR ] & ~0x3f ) | ( ( mipscpu.cp0r[ CP0_SR ] << 2 ) & 0x3f ) );
@@ -374,6 +394,7 @@ void mips_reset( void *param )
 	mips_set_cp0r( CP0_PRID, 0x00000200 ); /* todo: */
 	mips_set_pc( 0xbfc00000 );
 	mipscpu.prevpc = 0xffffffff;
+	mips_flush_blocks();
 }
 
 static void mips_exit( void )
@@ -389,42 +410,11 @@ void psx_hw_runcounters(void);
 
 int psxcpu_verbose = 0;
 
-int mips_execute( int cycles )
+static void mips_interpret( void )
 {
 	uint32_t n_res;
 
-	mips_ICount = cycles;
-	do
 	{
-//		CALL_MAME_DEBUG;
-
-//		psx_hw_runcounters();
-
-		mipscpu.op = cpu_readop32( mipscpu.pc );
-
-#if 0
-		while (mipscpu.prevpc == mipscpu.pc)
-		{
-			psx_hw_runcounters();
-			mips_ICount--;
-
-			if (mips_ICount == 0) return cycles;
-		}
-#endif
-
-		// if we're not in a delay slot, update
-		// if we're in a delay slot and the delay instruction is not NOP, update
-		if (( mipscpu.delayr == 0 ) || ((mipscpu.delayr != 0) && (mipscpu.op != 0)))
-		{
-			mipscpu.prevpc = mipscpu.pc;
-		}
-#if 0
-		if (1) //psxcpu_verbose)
-		{
-			printf("[%08x: %08x] [SP %08x RA %08x V0 %08x V1 %08x A0 %08x S0 %08x S1 %08x]\n", mipscpu.pc, mipscpu.op, mipscpu.r[29], mipscpu.r[31], mipscpu.r[2], mipscpu.r[3], mipscpu.r[4], mipscpu.r[ 16 ], mipscpu.r[ 17 ]);
-//			psxcpu_verbose--;
-		}
-#endif
 		switch( INS_OP( mipscpu.op ) )
 		{
 		case OP_SPECIAL:
@@ -1638,10 +1628,665 @@ int mips_execute( int cycles )
 			mips_exception( EXC_RI );
   			break;
 		}
-		mips_ICount--;
-	} while( mips_ICount > 0 );
+	}
+}
+
+/*
+ * Predecoded block cache.
+ *
+ * Sound drivers spend nearly all their time in a few tight loops, so
+ * instructions fetched from RAM are decoded once into short straight-line
+ * blocks holding the register fields, the sign-extended immediate or the
+ * resolved branch target, and a handler number.  Anything unusual
+ * (coprocessors, unaligned accesses, non-RAM addresses, HLE calls) goes
+ * through mips_interpret().
+ *
+ * Pages that blocks were decoded from are flagged in mips_code_pages.
+ * Every RAM write outside the block loop (psx_hw_write, DMA, the HLE BIOS
+ * and the IRX loader) goes through mips_mark_dirty(), and the loop's own
+ * stores check the flag inline, so a write to a code page marks it dirty
+ * and the blocks on it are dropped before the next one is looked up.
+ */
+
+/* The CPU context and RAM are reached through the thread's psx_state, which
+ * the compiler reloads after every store through another pointer; hiding
+ * where a pointer came from makes it keep the pointer in a register. */
+#ifdef __GNUC__
+#define MIPS_OPAQUE( p ) __asm__( "" : "+r"( p ) )
+#else
+#define MIPS_OPAQUE( p )
+#endif
+
+enum
+{
+	DEC_SLOW, DEC_NOP,
+	DEC_SLL, DEC_SRL, DEC_SRA, DEC_SLLV, DEC_SRLV, DEC_SRAV,
+	DEC_JR, DEC_JALR, DEC_MFHI, DEC_MTHI, DEC_MFLO, DEC_MTLO,
+	DEC_MULT, DEC_MULTU, DEC_DIV, DEC_DIVU,
+	DEC_ADD, DEC_ADDU, DEC_SUB, DEC_SUBU, DEC_AND, DEC_OR, DEC_XOR, DEC_NOR, DEC_SLT, DEC_SLTU,
+	DEC_BLTZ, DEC_BGEZ, DEC_BLTZAL, DEC_BGEZAL, DEC_J, DEC_JAL, DEC_BEQ, DEC_BNE, DEC_BLEZ, DEC_BGTZ,
+	DEC_ADDI, DEC_ADDIU, DEC_SLTI, DEC_SLTIU, DEC_ANDI, DEC_ORI, DEC_XORI, DEC_LUI,
+	DEC_LB, DEC_LH, DEC_LW, DEC_LBU, DEC_LHU, DEC_SB, DEC_SH, DEC_SW
+};
+
+#define mips_blocks (psx_ctx->blocks)
+#define mips_code_pages (psx_ctx->code_pages)
+#define mips_dirty_pages (psx_ctx->dirty_pages)
+#define mips_dirty (psx_ctx->dirty)
+
+static void mips_flush_blocks( void )
+{
+	for( int i = 0; i < MIPS_BLOCK_COUNT; i++ )
+	{
+		mips_blocks[ i ].pc = MIPS_BLOCK_NONE;
+	}
+
+	memset( mips_code_pages, 0, sizeof( mips_code_pages ) );
+	memset( mips_dirty_pages, 0, sizeof( mips_dirty_pages ) );
+	mips_dirty = 0;
+}
+
+/* drops the blocks decoded from pages written since they were built */
+static void mips_flush_dirty( void )
+{
+	for( int i = 0; i < MIPS_BLOCK_COUNT; i++ )
+	{
+		uint32_t n_page = ( mips_blocks[ i ].pc & 0x1fffff ) >> MIPS_PAGE_BITS;
+
+		if( mips_blocks[ i ].pc != MIPS_BLOCK_NONE && ( mips_dirty_pages[ n_page >> 5 ] & ( 1u << ( n_page & 31 ) ) ) )
+		{
+			mips_blocks[ i ].pc = MIPS_BLOCK_NONE;
+		}
+	}
+
+	memset( mips_dirty_pages, 0, sizeof( mips_dirty_pages ) );
+	mips_dirty = 0;
+}
+
+static inline void mips_mark_page( psx_state *ctx, uint32_t n_page )
+{
+	ctx->code_pages[ n_page >> 5 ] &= ~( 1u << ( n_page & 31 ) );
+	ctx->dirty_pages[ n_page >> 5 ] |= 1u << ( n_page & 31 );
+	ctx->dirty = 1;
+}
+
+/* to be called after anything other than the CPU writes to RAM */
+void mips_mark_dirty( uint32_t n_adr, uint32_t n_size )
+{
+	uint32_t n_page;
+	uint32_t n_last;
+
+	if( n_size == 0 )
+	{
+		return;
+	}
+
+	n_page = ( n_adr & 0x1fffff ) >> MIPS_PAGE_BITS;
+	n_last = ( ( n_adr & 0x1fffff ) + n_size - 1 ) >> MIPS_PAGE_BITS;
+	if( n_last - n_page >= MIPS_PAGE_COUNT )
+	{
+		n_last = n_page + MIPS_PAGE_COUNT - 1;
+	}
+
+	for( ; n_page <= n_last; n_page++ )
+	{
+		uint32_t n_wrapped = n_page & ( MIPS_PAGE_COUNT - 1 );
+
+		if( mips_code_pages[ n_wrapped >> 5 ] & ( 1u << ( n_wrapped & 31 ) ) )
+		{
+			mips_mark_page( psx_ctx, n_wrapped );
+		}
+	}
+}
+
+/* returns the RAM word backing an address, or NULL for anything that has to go through psx_hw */
+static inline uint32_t *mips_ram_ptr( uint32_t *ram, uint32_t n_adr )
+{
+	if( n_adr <= 0x007fffff || ( n_adr >= 0x80000000 && n_adr <= 0x807fffff ) )
+	{
+		return &ram[ ( n_adr & 0x1fffff ) >> 2 ];
+	}
+
+	return NULL;
+}
+
+/* returns true if the op ends a block after its delay slot */
+static int mips_decode( mips_decoded_op *d, uint32_t pc, uint32_t op )
+{
+	uint32_t n_branch = pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( op ) ) << 2 );
+
+	d->op = op;
+	d->imm = MIPS_WORD_EXTEND( INS_IMMEDIATE( op ) );
+	d->handler = DEC_SLOW;
+	d->rs = INS_RS( op );
+	d->rt = INS_RT( op );
+	d->rd = INS_RD( op );
+
+	switch( INS_OP( op ) )
+	{
+	case OP_SPECIAL:
+		switch( INS_FUNCT( op ) )
+		{
+		case FUNCT_SLL:  d->handler = ( op == 0 ) ? DEC_NOP : DEC_SLL; d->imm = INS_SHAMT( op ); break;
+		case FUNCT_SRL:  d->handler = DEC_SRL; d->imm = INS_SHAMT( op ); break;
+		case FUNCT_SRA:  d->handler = DEC_SRA; d->imm = INS_SHAMT( op ); break;
+		case FUNCT_SLLV: d->handler = DEC_SLLV; break;
+		case FUNCT_SRLV: d->handler = DEC_SRLV; break;
+		case FUNCT_SRAV: d->handler = DEC_SRAV; break;
+		case FUNCT_JR:   if( d->rd == 0 ) d->handler = DEC_JR; return 1;
+		case FUNCT_JALR: d->handler = DEC_JALR; return 1;
+		case FUNCT_MFHI: d->handler = DEC_MFHI; break;
+		case FUNCT_MTHI: if( d->rd == 0 ) d->handler = DEC_MTHI; break;
+		case FUNCT_MFLO: d->handler = DEC_MFLO; break;
+		case FUNCT_MTLO: if( d->rd == 0 ) d->handler = DEC_MTLO; break;
+		case FUNCT_MULT: if( d->rd == 0 ) d->handler = DEC_MULT; break;
+		case FUNCT_MULTU: if( d->rd == 0 ) d->handler = DEC_MULTU; break;
+		case FUNCT_DIV:  if( d->rd == 0 ) d->handler = DEC_DIV; break;
+		case FUNCT_DIVU: if( d->rd == 0 ) d->handler = DEC_DIVU; break;
+		case FUNCT_ADD:  d->handler = DEC_ADD; break;
+		case FUNCT_ADDU: d->handler = DEC_ADDU; break;
+		case FUNCT_SUB:  d->handler = DEC_SUB; break;
+		case FUNCT_SUBU: d->handler = DEC_SUBU; break;
+		case FUNCT_AND:  d->handler = DEC_AND; break;
+		case FUNCT_OR:   d->handler = DEC_OR; break;
+		case FUNCT_XOR:  d->handler = DEC_XOR; break;
+		case FUNCT_NOR:  d->handler = DEC_NOR; break;
+		case FUNCT_SLT:  d->handler = DEC_SLT; break;
+		case FUNCT_SLTU: d->handler = DEC_SLTU; break;
+		}
+		break;
+	case OP_REGIMM:
+		d->imm = n_branch;
+		switch( INS_RT( op ) )
+		{
+		case RT_BLTZ:   d->handler = DEC_BLTZ; return 1;
+		case RT_BGEZ:   d->handler = DEC_BGEZ; return 1;
+		case RT_BLTZAL: d->handler = DEC_BLTZAL; return 1;
+		case RT_BGEZAL: d->handler = DEC_BGEZAL; return 1;
+		}
+		break;
+	case OP_J:
+		d->handler = DEC_J;
+		d->imm = ( ( pc + 4 ) & 0xf0000000 ) + ( INS_TARGET( op ) << 2 );
+		return 1;
+	case OP_JAL:
+		d->handler = DEC_JAL;
+		d->imm = ( ( pc + 4 ) & 0xf0000000 ) + ( INS_TARGET( op ) << 2 );
+		return 1;
+	case OP_BEQ:
+		d->handler = DEC_BEQ;
+		d->imm = n_branch;
+		return 1;
+	case OP_BNE:
+		d->handler = DEC_BNE;
+		d->imm = n_branch;
+		return 1;
+	case OP_BLEZ:
+		if( d->rt == 0 ) d->handler = DEC_BLEZ;
+		d->imm = n_branch;
+		return 1;
+	case OP_BGTZ:
+		if( d->rt == 0 ) d->handler = DEC_BGTZ;
+		d->imm = n_branch;
+		return 1;
+	case OP_ADDI:  d->handler = DEC_ADDI; break;
+	case OP_ADDIU: if( d->rt != 0 ) d->handler = DEC_ADDIU; break;
+	case OP_SLTI:  d->handler = DEC_SLTI; break;
+	case OP_SLTIU: d->handler = DEC_SLTIU; break;
+	case OP_ANDI:  d->handler = DEC_ANDI; d->imm = INS_IMMEDIATE( op ); break;
+	case OP_ORI:   d->handler = DEC_ORI; d->imm = INS_IMMEDIATE( op ); break;
+	case OP_XORI:  d->handler = DEC_XORI; d->imm = INS_IMMEDIATE( op ); break;
+	case OP_LUI:   d->handler = DEC_LUI; d->imm = INS_IMMEDIATE( op ) << 16; break;
+	case OP_LB:    d->handler = DEC_LB; break;
+	case OP_LH:    d->handler = DEC_LH; break;
+	case OP_LW:    d->handler = DEC_LW; break;
+	case OP_LBU:   d->handler = DEC_LBU; break;
+	case OP_LHU:   d->handler = DEC_LHU; break;
+	case OP_SB:    d->handler = DEC_SB; break;
+	case OP_SH:    d->handler = DEC_SH; break;
+	case OP_SW:    d->handler = DEC_SW; break;
+	}
+
+	return 0;
+}
+
+static void mips_build_block( mips_block *block, uint32_t pc, const uint32_t *p_code )
+{
+	/* stop at the end of the page, which also keeps p_code inside RAM */
+	uint32_t n_page = ( pc & 0x1fffff ) >> MIPS_PAGE_BITS;
+	uint32_t n_max = ( ( 1 << MIPS_PAGE_BITS ) - ( pc & ( ( 1 << MIPS_PAGE_BITS ) - 1 ) ) ) >> 2;
+	uint32_t n_count = 0;
+	int b_branch = 0;
+
+	if( n_max > MIPS_BLOCK_OPS )
+	{
+		n_max = MIPS_BLOCK_OPS;
+	}
+
+	while( n_count < n_max )
+	{
+		int b_ends = mips_decode( &block->ops[ n_count ], pc + n_count * 4, LE32( p_code[ n_count ] ) );
+		n_count++;
+
+		/* include the delay slot */
+		if( b_branch )
+		{
+			break;
+		}
+		b_branch = b_ends;
+	}
+
+	block->pc = pc;
+	block->count = n_count;
+	mips_code_pages[ n_page >> 5 ] |= 1u << ( n_page & 31 );
+}
+
+int mips_execute( int cycles )
+{
+	psx_state *ctx = psx_ctx;
+	int n_icount = cycles;
+
+	MIPS_OPAQUE( ctx );
+
+	mips_cpu_context *cpu = &ctx->mips;
+	uint32_t *ram = ctx->mem.ram;
+
+	do
+	{
+		uint32_t n_pc = cpu->pc;
+		uint32_t *p_code = ( n_pc & 3 ) ? NULL : mips_ram_ptr( ram, n_pc );
+
+		if( p_code == NULL )
+		{
+			cpu->op = cpu_readop32( n_pc );
+			// if we're not in a delay slot, update
+			// if we're in a delay slot and the delay instruction is not NOP, update
+			if( cpu->delayr == 0 || cpu->op != 0 )
+			{
+				cpu->prevpc = n_pc;
+			}
+			mips_ICount = n_icount;
+			mips_interpret();
+			n_icount = mips_ICount - 1;
+			continue;
+		}
+
+		if( ctx->dirty )
+		{
+			mips_flush_dirty();
+		}
+
+		mips_block *block = &ctx->blocks[ ( n_pc >> 2 ) & ( MIPS_BLOCK_COUNT - 1 ) ];
+		if( block->pc != n_pc )
+		{
+			mips_build_block( block, n_pc, p_code );
+		}
+
+		const mips_decoded_op *d = block->ops;
+		const mips_decoded_op *d_end = d + block->count;
+
+		do
+		{
+			cpu->op = d->op;
+			if( cpu->delayr == 0 || cpu->op != 0 )
+			{
+				cpu->prevpc = n_pc;
+			}
+
+			n_pc += 4;
+
+			switch( d->handler )
+			{
+			case DEC_SLOW:
+				/* may re-enter mips_execute and rebuild this block */
+				mips_ICount = n_icount;
+				mips_interpret();
+				n_icount = mips_ICount;
+				d_end = d;
+				break;
+			case DEC_NOP:
+				mips_advance_pc( cpu );
+				break;
+			case DEC_SLL:
+				mips_load( cpu, d->rd, cpu->r[ d->rt ] << d->imm );
+				break;
+			case DEC_SRL:
+				mips_load( cpu, d->rd, cpu->r[ d->rt ] >> d->imm );
+				break;
+			case DEC_SRA:
+				mips_load( cpu, d->rd, (int32_t)cpu->r[ d->rt ] >> d->imm );
+				break;
+			case DEC_SLLV:
+				mips_load( cpu, d->rd, cpu->r[ d->rt ] << ( cpu->r[ d->rs ] & 31 ) );
+				break;
+			case DEC_SRLV:
+				mips_load( cpu, d->rd, cpu->r[ d->rt ] >> ( cpu->r[ d->rs ] & 31 ) );
+				break;
+			case DEC_SRAV:
+				mips_load( cpu, d->rd, (int32_t)cpu->r[ d->rt ] >> ( cpu->r[ d->rs ] & 31 ) );
+				break;
+			case DEC_JR:
+				mips_delayed_branch( cpu, cpu->r[ d->rs ] );
+				break;
+			case DEC_JALR:
+				{
+					uint32_t n_res = cpu->pc + 8;
+					mips_delayed_branch( cpu, cpu->r[ d->rs ] );
+					if( d->rd != 0 )
+					{
+						cpu->r[ d->rd ] = n_res;
+					}
+				}
+				break;
+			case DEC_MFHI:
+				mips_load( cpu, d->rd, cpu->hi );
+				break;
+			case DEC_MTHI:
+				mips_advance_pc( cpu );
+				cpu->hi = cpu->r[ d->rs ];
+				break;
+			case DEC_MFLO:
+				mips_load( cpu, d->rd, cpu->lo );
+				break;
+			case DEC_MTLO:
+				mips_advance_pc( cpu );
+				cpu->lo = cpu->r[ d->rs ];
+				break;
+			case DEC_MULT:
+				{
+					int64_t n_res64 = MUL_64_32_32( (int32_t)cpu->r[ d->rs ], (int32_t)cpu->r[ d->rt ] );
+					mips_advance_pc( cpu );
+					cpu->lo = LO32_32_64( n_res64 );
+					cpu->hi = HI32_32_64( n_res64 );
+				}
+				break;
+			case DEC_MULTU:
+				{
+					uint64_t n_res64 = MUL_U64_U32_U32( cpu->r[ d->rs ], cpu->r[ d->rt ] );
+					mips_advance_pc( cpu );
+					cpu->lo = LO32_U32_U64( n_res64 );
+					cpu->hi = HI32_U32_U64( n_res64 );
+				}
+				break;
+			case DEC_DIV:
+				if( cpu->r[ d->rt ] != 0 )
+				{
+					uint32_t n_div = (int32_t)cpu->r[ d->rs ] / (int32_t)cpu->r[ d->rt ];
+					uint32_t n_mod = (int32_t)cpu->r[ d->rs ] % (int32_t)cpu->r[ d->rt ];
+					mips_advance_pc( cpu );
+					cpu->lo = n_div;
+					cpu->hi = n_mod;
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
+				break;
+			case DEC_DIVU:
+				if( cpu->r[ d->rt ] != 0 )
+				{
+					uint32_t n_div = cpu->r[ d->rs ] / cpu->r[ d->rt ];
+					uint32_t n_mod = cpu->r[ d->rs ] % cpu->r[ d->rt ];
+					mips_advance_pc( cpu );
+					cpu->lo = n_div;
+					cpu->hi = n_mod;
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
+				break;
+			case DEC_ADD:
+				{
+					uint32_t n_res = cpu->r[ d->rs ] + cpu->r[ d->rt ];
+					if( (int32_t)( ~( cpu->r[ d->rs ] ^ cpu->r[ d->rt ] ) & ( cpu->r[ d->rs ] ^ n_res ) ) < 0 )
+					{
+						mips_exception( EXC_OVF );
+					}
+					else
+					{
+						mips_load( cpu, d->rd, n_res );
+					}
+				}
+				break;
+			case DEC_ADDU:
+				mips_load( cpu, d->rd, cpu->r[ d->rs ] + cpu->r[ d->rt ] );
+				break;
+			case DEC_SUB:
+				{
+					uint32_t n_res = cpu->r[ d->rs ] - cpu->r[ d->rt ];
+					if( (int32_t)( ( cpu->r[ d->rs ] ^ cpu->r[ d->rt ] ) & ( cpu->r[ d->rs ] ^ n_res ) ) < 0 )
+					{
+						mips_exception( EXC_OVF );
+					}
+					else
+					{
+						mips_load( cpu, d->rd, n_res );
+					}
+				}
+				break;
+			case DEC_SUBU:
+				mips_load( cpu, d->rd, cpu->r[ d->rs ] - cpu->r[ d->rt ] );
+				break;
+			case DEC_AND:
+				mips_load( cpu, d->rd, cpu->r[ d->rs ] & cpu->r[ d->rt ] );
+				break;
+			case DEC_OR:
+				mips_load( cpu, d->rd, cpu->r[ d->rs ] | cpu->r[ d->rt ] );
+				break;
+			case DEC_XOR:
+				mips_load( cpu, d->rd, cpu->r[ d->rs ] ^ cpu->r[ d->rt ] );
+				break;
+			case DEC_NOR:
+				mips_load( cpu, d->rd, ~( cpu->r[ d->rs ] | cpu->r[ d->rt ] ) );
+				break;
+			case DEC_SLT:
+				mips_load( cpu, d->rd, (int32_t)cpu->r[ d->rs ] < (int32_t)cpu->r[ d->rt ] );
+				break;
+			case DEC_SLTU:
+				mips_load( cpu, d->rd, cpu->r[ d->rs ] < cpu->r[ d->rt ] );
+				break;
+			case DEC_BLTZ:
+				if( (int32_t)cpu->r[ d->rs ] < 0 )
+				{
+					mips_delayed_branch( cpu, d->imm );
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
+				break;
+			case DEC_BGEZ:
+				if( (int32_t)cpu->r[ d->rs ] >= 0 )
+				{
+					mips_delayed_branch( cpu, d->imm );
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
+				break;
+			case DEC_BLTZAL:
+				{
+					uint32_t n_res = cpu->pc + 8;
+					if( (int32_t)cpu->r[ d->rs ] < 0 )
+					{
+						mips_delayed_branch( cpu, d->imm );
+					}
+					else
+					{
+						mips_advance_pc( cpu );
+					}
+					cpu->r[ 31 ] = n_res;
+				}
+				break;
+			case DEC_BGEZAL:
+				{
+					uint32_t n_res = cpu->pc + 8;
+					if( (int32_t)cpu->r[ d->rs ] >= 0 )
+					{
+						mips_delayed_branch( cpu, d->imm );
+					}
+					else
+					{
+						mips_advance_pc( cpu );
+					}
+					cpu->r[ 31 ] = n_res;
+				}
+				break;
+			case DEC_J:
+				mips_delayed_branch( cpu, d->imm );
+				break;
+			case DEC_JAL:
+				{
+					uint32_t n_res = cpu->pc + 8;
+					mips_delayed_branch( cpu, d->imm );
+					cpu->r[ 31 ] = n_res;
+				}
+				break;
+			case DEC_BEQ:
+				if( cpu->r[ d->rs ] == cpu->r[ d->rt ] )
+				{
+					mips_delayed_branch( cpu, d->imm );
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
+				break;
+			case DEC_BNE:
+				if( cpu->r[ d->rs ] != cpu->r[ d->rt ] )
+				{
+					mips_delayed_branch( cpu, d->imm );
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
+				break;
+			case DEC_BLEZ:
+				if( (int32_t)cpu->r[ d->rs ] <= 0 )
+				{
+					mips_delayed_branch( cpu, d->imm );
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
+				break;
+			case DEC_BGTZ:
+				if( (int32_t)cpu->r[ d->rs ] > 0 )
+				{
+					mips_delayed_branch( cpu, d->imm );
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
+				break;
+			case DEC_ADDI:
+				{
+					uint32_t n_res = cpu->r[ d->rs ] + d->imm;
+					if( (int32_t)( ~( cpu->r[ d->rs ] ^ d->imm ) & ( cpu->r[ d->rs ] ^ n_res ) ) < 0 )
+					{
+						mips_exception( EXC_OVF );
+					}
+					else
+					{
+						mips_load( cpu, d->rt, n_res );
+					}
+				}
+				break;
+			case DEC_ADDIU:
+				mips_load( cpu, d->rt, cpu->r[ d->rs ] + d->imm );
+				break;
+			case DEC_SLTI:
+				mips_load( cpu, d->rt, (int32_t)cpu->r[ d->rs ] < (int32_t)d->imm );
+				break;
+			case DEC_SLTIU:
+				mips_load( cpu, d->rt, cpu->r[ d->rs ] < d->imm );
+				break;
+			case DEC_ANDI:
+				mips_load( cpu, d->rt, cpu->r[ d->rs ] & d->imm );
+				break;
+			case DEC_ORI:
+				mips_load( cpu, d->rt, cpu->r[ d->rs ] | d->imm );
+				break;
+			case DEC_XORI:
+				mips_load( cpu, d->rt, cpu->r[ d->rs ] ^ d->imm );
+				break;
+			case DEC_LUI:
+				mips_load( cpu, d->rt, d->imm );
+				break;
+			default:
+				/* loads and stores: plain RAM accesses in kernel mode skip psx_hw */
+				{
+					uint32_t n_adr = cpu->r[ d->rs ] + d->imm;
+					uint32_t *p_ram = ( cpu->cp0r[ CP0_SR ] & ( SR_ISC | SR_KUC ) ) ? NULL : mips_ram_ptr( ram, n_adr );
+					int n_shift = ( n_adr & 3 ) * 8;
+
+					if( p_ram == NULL || ( ( n_adr & 1 ) && ( d->handler == DEC_LH || d->handler == DEC_LHU || d->handler == DEC_SH ) ) )
+					{
+						mips_ICount = n_icount;
+						mips_interpret();
+						n_icount = mips_ICount;
+						d_end = d;
+						break;
+					}
+
+					switch( d->handler )
+					{
+					case DEC_LB:
+						mips_delayed_load( cpu, d->rt, MIPS_BYTE_EXTEND( (uint8_t)( LE32( *p_ram ) >> n_shift ) ) );
+						break;
+					case DEC_LH:
+						mips_delayed_load( cpu, d->rt, MIPS_WORD_EXTEND( (uint16_t)( LE32( *p_ram ) >> n_shift ) ) );
+						break;
+					case DEC_LW:
+						mips_delayed_load( cpu, d->rt, LE32( *p_ram ) );
+						break;
+					case DEC_LBU:
+						mips_delayed_load( cpu, d->rt, (uint8_t)( LE32( *p_ram ) >> n_shift ) );
+						break;
+					case DEC_LHU:
+						mips_delayed_load( cpu, d->rt, (uint16_t)( LE32( *p_ram ) >> n_shift ) );
+						break;
+					case DEC_SB:
+						*p_ram = ( *p_ram & LE32( ~( 0xffu << n_shift ) ) ) | LE32( ( cpu->r[ d->rt ] & 0xff ) << n_shift );
+						mips_advance_pc( cpu );
+						break;
+					case DEC_SH:
+						*p_ram = ( *p_ram & LE32( ~( 0xffffu << n_shift ) ) ) | LE32( ( cpu->r[ d->rt ] & 0xffff ) << n_shift );
+						mips_advance_pc( cpu );
+						break;
+					case DEC_SW:
+						*p_ram = LE32( cpu->r[ d->rt ] );
+						mips_advance_pc( cpu );
+						break;
+					}
+
+					if( d->handler >= DEC_SB )
+					{
+						uint32_t n_page = ( n_adr & 0x1fffff ) >> MIPS_PAGE_BITS;
+
+						if( ctx->code_pages[ n_page >> 5 ] & ( 1u << ( n_page & 31 ) ) )
+						{
+							/* wrote over cached code, maybe this very block */
+							mips_mark_page( ctx, n_page );
+							d_end = d;
+						}
+					}
+				}
+				break;
+			}
+
+			n_icount--;
+			d++;
+		} while( d < d_end && cpu->pc == n_pc && n_icount > 0 );
+	} while( n_icount > 0 );
 
-	return cycles - mips_ICount;
+	mips_ICount = n_icount;
+	return cycles - n_icount;
 }
 
 static void mips_get_context( void *dst )
@@ -1977,19 +2622,19 @@ static void docop2( int gteop )
 	const uint32_t **p_n_cv;
 	static const uint16_t n_zm = 0;
 	static const uint32_t n_zc = 0;
-	static const uint16_t *p_n_vx[] = { &VX0, &VX1, &VX2 };
-	static const uint16_t *p_n_vy[] = { &VY0, &VY1, &VY2 };
-	static const uint16_t *p_n_vz[] = { &VZ0, &VZ1, &VZ2 };
-	static const uint16_t *p_n_rm[] = { &R11, &R12, &R13, &R21, &R22, &R23, &R31, &R32, &R33 };
-	static const uint16_t *p_n_lm[] = { &L11, &L12, &L13, &L21, &L22, &L23, &L31, &L32, &L33 };
-	static const uint16_t *p_n_cm[] = { &LR1, &LR2, &LR3, &LG1, &LG2, &LG3, &LB1, &LB2, &LB3 };
+	const uint16_t *p_n_vx[] = { &VX0, &VX1, &VX2 };
+	const uint16_t *p_n_vy[] = { &VY0, &VY1, &VY2 };
+	const uint16_t *p_n_vz[] = { &VZ0, &VZ1, &VZ2 };
+	const uint16_t *p_n_rm[] = { &R11, &R12, &R13, &R21, &R22, &R23, &R31, &R32, &R33 };
+	const uint16_t *p_n_lm[] = { &L11, &L12, &L13, &L21, &L22, &L23, &L31, &L32, &L33 };
+	const uint16_t *p_n_cm[] = { &LR1, &LR2, &LR3, &LG1, &LG2, &LG3, &LB1, &LB2, &LB3 };
 	static const uint16_t *p_n_zm[] = { &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm };
-	static const uint16_t **p_p_n_mx[] = { p_n_rm, p_n_lm, p_n_cm, p_n_zm };
-	static const uint32_t *p_n_tr[] = { &TRX, &TRY, &TRZ };
-	static const uint32_t *p_n_bk[] = { &RBK, &GBK, &BBK };
-	static const uint32_t *p_n_fc[] = { &RFC, &GFC, &BFC };
+	const uint16_t **p_p_n_mx[] = { p_n_rm, p_n_lm, p_n_cm, p_n_zm };
+	const uint32_t *p_n_tr[] = { &TRX, &TRY, &TRZ };
+	const uint32_t *p_n_bk[] = { &RBK, &GBK, &BBK };
+	const uint32_t *p_n_fc[] = { &RFC, &GFC, &BFC };
 	static const uint32_t *p_n_zc[] = { &n_zc, &n_zc, &n_zc };
-	static const uint32_t **p_p_n_cv[] = { p_n_tr, p_n_bk, p_n_fc, p_n_zc };
+	const uint32_t **p_p_n_cv[] = { p_n_tr, p_n_bk, p_n_fc, p_n_zc };
 
 	switch( GTE_FUNCT( gteop ) )
 	{
@@ -2,6 +2,7 @@
 #define _MIPS_H
 
 #include "ao.h"
+#include "osd_cpu.h"
 //#include "driver.h"
 
 typedef void genf(void);
@@ -286,31 +287,70 @@ extern void psxcpu_get_info(uint32_t state, union cpuinfo *info);
 #endif
 
 /* eng_psf.cc */
-extern int psf_refresh;
+#define psf_refresh (psx_ctx->refresh)
 
-int32_t psf_start(uint8_t *buffer, uint32_t length);
-int32_t psf_execute(void (*update)(const void *, int));
+int32_t psf_start(ao_instance *inst, uint8_t *buffer, uint32_t length);
+int32_t psf_execute(ao_instance *inst);
 int32_t psf_stop(void);
 
 /* eng_psf2.cc */
 uint32_t psf2_load_elf(uint8_t *start, uint32_t len);
 uint32_t psf2_load_file(const char *file, uint8_t *buf, uint32_t buflen);
-int32_t psf2_start(uint8_t *, uint32_t length);
-int32_t psf2_execute(void (*update)(const void *, int));
+int32_t psf2_start(ao_instance *inst, uint8_t *, uint32_t length);
+int32_t psf2_execute(ao_instance *inst);
 int32_t psf2_stop(void);
 int32_t psf2_command(int32_t, int32_t);
 uint32_t psf2_get_loadaddr(void);
 void psf2_set_loadaddr(uint32_t addr);
 
 /* eng_spx.cc */
-int32_t spx_start(uint8_t *buffer, uint32_t length);
-int32_t spx_execute(void (*update)(const void *, int));
+int32_t spx_start(ao_instance *inst, uint8_t *buffer, uint32_t length);
+int32_t spx_execute(ao_instance *inst);
 int32_t spx_stop(void);
 
-/* plugin.cc */
-extern bool stop_flag;
-
 /* psx.cc */
+typedef struct
+{
+	uint32_t op;
+	uint32_t pc;
+	uint32_t prevpc;
+	uint32_t delayv;
+	uint32_t delayr;
+	uint32_t hi;
+	uint32_t lo;
+	uint32_t r[ 32 ];
+	uint32_t cp0r[ 32 ];
+	PAIR cp2cr[ 32 ];
+	PAIR cp2dr[ 32 ];
+	int (*irq_callback)(int irqline);
+} mips_cpu_context;
+
+#define MIPS_BLOCK_BITS ( 10 )
+#define MIPS_BLOCK_COUNT ( 1 << MIPS_BLOCK_BITS )
+#define MIPS_BLOCK_OPS ( 32 )
+#define MIPS_BLOCK_NONE ( 0xffffffff )
+
+/* RAM is tracked for writes in pages this size; a block never spans two */
+#define MIPS_PAGE_BITS ( 8 )
+#define MIPS_PAGE_COUNT ( 0x200000 >> MIPS_PAGE_BITS )
+
+typedef struct
+{
+	uint32_t op;
+	uint32_t imm;
+	uint8_t handler;
+	uint8_t rs;
+	uint8_t rt;
+	uint8_t rd;
+} mips_decoded_op;
+
+typedef struct
+{
+	uint32_t pc;
+	uint32_t count;
+	mips_decoded_op ops[ MIPS_BLOCK_OPS ];
+} mips_block;
+
 void mips_init(void);
 void mips_reset(void *param);
 void mips_shorten_frame(void);
@@ -323,12 +363,51 @@ void mips_set_status(uint32_t status);
 uint32_t mips_get_ePC(void);
 int mips_get_icount(void);
 void mips_set_icount(int count);
+void mips_mark_dirty(uint32_t n_adr, uint32_t n_size);
 
 /* psx_hw.cc */
-extern uint32_t psx_ram[((2*1024*1024)/4)+4];
-extern uint32_t psx_scratch[0x400];
-extern uint32_t initial_ram[((2*1024*1024)/4)+4];
-extern uint32_t initial_scratch[0x400];
+typedef struct
+{
+	uint32_t ram[((2*1024*1024)/4)+4];
+	uint32_t scratch[0x400];
+	// backup image to restart songs
+	uint32_t initial_ram[((2*1024*1024)/4)+4];
+	uint32_t initial_scratch[0x400];
+} psx_memory;
+
+struct psx_hw_state;
+
+/* One emulated machine: the R3000 and RAM, and the IOP kernel and I/O state
+ * private to psx_hw.cc.  Each track's ao_instance owns one, and the engines
+ * point psx_ctx at it when they start or run the track, so several tracks can
+ * play at once on different threads.  The old globals (psx_ram, mipscpu, ...)
+ * are macros over psx_ctx. */
+struct psx_state
+{
+	psx_state();
+	~psx_state();
+
+	psx_memory mem;
+	mips_cpu_context mips;
+	mips_block blocks[ MIPS_BLOCK_COUNT ];
+	uint32_t code_pages[ MIPS_PAGE_COUNT / 32 ];	// pages blocks were decoded from
+	uint32_t dirty_pages[ MIPS_PAGE_COUNT / 32 ];	// code pages written since
+	int dirty;			// any bit set in dirty_pages
+	int mips_icount;
+	int refresh;			// psf_refresh
+	std::unique_ptr<psx_hw_state> hw;
+};
+
+#ifdef __GNUC__
+extern __thread psx_state *psx_ctx;
+#else
+extern thread_local psx_state *psx_ctx;
+#endif
+
+#define psx_ram (psx_ctx->mem.ram)
+#define psx_scratch (psx_ctx->mem.scratch)
+#define initial_ram (psx_ctx->mem.initial_ram)
+#define initial_scratch (psx_ctx->mem.initial_scratch)
 
 void psx_hw_slice(void);
 void ps2_hw_slice(void);
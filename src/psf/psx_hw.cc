@@ -69,15 +69,7 @@
 
 #define MAX_FILE_SLOTS	(32)
 
-static volatile int softcall_target = 0;
-static int filestat[MAX_FILE_SLOTS];
-static uint8_t *filedata[MAX_FILE_SLOTS];
-static uint32_t filesize[MAX_FILE_SLOTS], filepos[MAX_FILE_SLOTS];
 static void call_irq_routine(uint32_t routine, uint32_t parameter);
-static int intr_susp = 0;
-
-static uint64_t sys_time;
-static int timerexp = 0;
 
 typedef struct
 {
@@ -85,9 +77,6 @@ typedef struct
 	uint32_t dispatch;
 } ExternLibEntries;
 
-static int32_t iNumLibs;
-static ExternLibEntries	reglibs[32];
-
 typedef struct
 {
 	uint32_t type;
@@ -96,9 +85,6 @@ typedef struct
 	int    inUse;
 } EventFlag;
 
-static int32_t iNumFlags;
-static EventFlag evflags[32];
-
 typedef struct
 {
 	uint32_t attr;
@@ -112,9 +98,6 @@ typedef struct
 
 #define SEMA_MAX	(64)
 
-static int32_t iNumSema;
-static Semaphore semaphores[SEMA_MAX];
-
 // thread states
 enum
 {
@@ -144,9 +127,6 @@ typedef struct
 	uint32_t save_regs[37];	// CPU registers belonging to this thread
 } Thread;
 
-static int32_t iNumThreads, iCurThread;
-static Thread threads[32];
-
 #if DEBUG_THREADING
 static char *_ThreadStateNames[TS_MAXSTATE] = { "RUNNING", "READY", "WAITEVFLAG", "WAITSEMA", "WAITDELAY", "SLEEPING", "CREATED" };
 #endif
@@ -167,9 +147,6 @@ typedef struct
 	uint32_t mode;
 } IOPTimer;
 
-static IOPTimer iop_timers[8];
-static int32_t iNumTimers;
-
 typedef struct
 {
 	uint32_t count;
@@ -179,8 +156,6 @@ typedef struct
 	uint32_t interrupt;
 } Counter;
 
-static Counter root_cnts[4];	// 4 of the bastards
-
 #define CLOCK_DIV	(8)	// 33 MHz / this = what we run the R3000 at to keep the CPU usage not insane
 
 // counter modes
@@ -199,9 +174,6 @@ typedef struct
 	uint32_t fhandler;
 } EvtCtrlBlk[32];
 
-static EvtCtrlBlk *Event;
-static EvtCtrlBlk *CounterEvent;
-
 // Sony event states
 #define EvStUNUSED	0x0000
 #define EvStWAIT	0x1000
@@ -212,18 +184,113 @@ static EvtCtrlBlk *CounterEvent;
 #define EvMdINTR	0x1000
 #define EvMdNOINTR	0x2000
 
-// PSX main RAM
-uint32_t psx_ram[(2*1024*1024)/4+4];
-uint32_t psx_scratch[0x400];
-// backup image to restart songs
-uint32_t initial_ram[(2*1024*1024)/4+4];
-uint32_t initial_scratch[0x400];
+// everything below that belongs to one machine, kept in its psx_state
+struct psx_hw_state
+{
+	volatile int softcall_target;
+	int filestat[MAX_FILE_SLOTS];
+	uint8_t *filedata[MAX_FILE_SLOTS];
+	uint32_t filesize[MAX_FILE_SLOTS], filepos[MAX_FILE_SLOTS];
+	int intr_susp;
+	uint64_t sys_time;
+	int timerexp;
+
+	int32_t iNumLibs;
+	ExternLibEntries reglibs[32];
+	int32_t iNumFlags;
+	EventFlag evflags[32];
+	int32_t iNumSema;
+	Semaphore semaphores[SEMA_MAX];
+	int32_t iNumThreads, iCurThread;
+	Thread threads[32];
+	IOPTimer iop_timers[8];
+	int32_t iNumTimers;
+	Counter root_cnts[4];	// 4 of the bastards
+	EvtCtrlBlk *Event;
+	EvtCtrlBlk *CounterEvent;
+
+	uint32_t spu_delay, dma_icr, irq_data, irq_mask, dma_timer, WAI;
+	uint32_t dma4_madr, dma4_bcr, dma4_chcr, dma4_delay;
+	uint32_t dma7_madr, dma7_bcr, dma7_chcr, dma7_delay;
+	uint32_t dma4_cb, dma7_cb, dma4_fval, dma4_flag, dma7_fval, dma7_flag;
+	uint32_t irq9_cb, irq9_fval, irq9_flag;
+	uint32_t gpu_stat;
+	int fcnt;
+	uint32_t heap_addr, entry_int;
+	uint32_t irq_regs[37];
+	int irq_mutex;
+};
+
+#ifdef __GNUC__
+__thread psx_state *psx_ctx;
+#else
+thread_local psx_state *psx_ctx;
+#endif
+
+psx_state::psx_state()
+	: mem(), mips(), blocks(), code_pages(), dirty_pages(), dirty(0), mips_icount(0), refresh(-1), hw(new psx_hw_state())
+{
+}
+
+psx_state::~psx_state()
+{
+	if (psx_ctx == this)
+	{
+		psx_ctx = nullptr;
+	}
+}
 
-static uint32_t spu_delay, dma_icr, irq_data, irq_mask, dma_timer, WAI;
-static uint32_t dma4_madr, dma4_bcr, dma4_chcr, dma4_delay;
-static uint32_t dma7_madr, dma7_bcr, dma7_chcr, dma7_delay;
-static uint32_t dma4_cb, dma7_cb, dma4_fval, dma4_flag, dma7_fval, dma7_flag;
-static uint32_t irq9_cb, irq9_fval, irq9_flag;
+#define softcall_target (psx_ctx->hw->softcall_target)
+#define filestat (psx_ctx->hw->filestat)
+#define filedata (psx_ctx->hw->filedata)
+#define filesize (psx_ctx->hw->filesize)
+#define filepos (psx_ctx->hw->filepos)
+#define intr_susp (psx_ctx->hw->intr_susp)
+#define sys_time (psx_ctx->hw->sys_time)
+#define timerexp (psx_ctx->hw->timerexp)
+#define iNumLibs (psx_ctx->hw->iNumLibs)
+#define reglibs (psx_ctx->hw->reglibs)
+#define iNumFlags (psx_ctx->hw->iNumFlags)
+#define evflags (psx_ctx->hw->evflags)
+#define iNumSema (psx_ctx->hw->iNumSema)
+#define semaphores (psx_ctx->hw->semaphores)
+#define iNumThreads (psx_ctx->hw->iNumThreads)
+#define iCurThread (psx_ctx->hw->iCurThread)
+#define threads (psx_ctx->hw->threads)
+#define iop_timers (psx_ctx->hw->iop_timers)
+#define iNumTimers (psx_ctx->hw->iNumTimers)
+#define root_cnts (psx_ctx->hw->root_cnts)
+#define Event (psx_ctx->hw->Event)
+#define CounterEvent (psx_ctx->hw->CounterEvent)
+#define spu_delay (psx_ctx->hw->spu_delay)
+#define dma_icr (psx_ctx->hw->dma_icr)
+#define irq_data (psx_ctx->hw->irq_data)
+#define irq_mask (psx_ctx->hw->irq_mask)
+#define dma_timer (psx_ctx->hw->dma_timer)
+#define WAI (psx_ctx->hw->WAI)
+#define dma4_madr (psx_ctx->hw->dma4_madr)
+#define dma4_bcr (psx_ctx->hw->dma4_bcr)
+#define dma4_chcr (psx_ctx->hw->dma4_chcr)
+#define dma4_delay (psx_ctx->hw->dma4_delay)
+#define dma7_madr (psx_ctx->hw->dma7_madr)
+#define dma7_bcr (psx_ctx->hw->dma7_bcr)
+#define dma7_chcr (psx_ctx->hw->dma7_chcr)
+#define dma7_delay (psx_ctx->hw->dma7_delay)
+#define dma4_cb (psx_ctx->hw->dma4_cb)
+#define dma7_cb (psx_ctx->hw->dma7_cb)
+#define dma4_fval (psx_ctx->hw->dma4_fval)
+#define dma4_flag (psx_ctx->hw->dma4_flag)
+#define dma7_fval (psx_ctx->hw->dma7_fval)
+#define dma7_flag (psx_ctx->hw->dma7_flag)
+#define irq9_cb (psx_ctx->hw->irq9_cb)
+#define irq9_fval (psx_ctx->hw->irq9_fval)
+#define irq9_flag (psx_ctx->hw->irq9_flag)
+#define gpu_stat (psx_ctx->hw->gpu_stat)
+#define fcnt (psx_ctx->hw->fcnt)
+#define heap_addr (psx_ctx->hw->heap_addr)
+#define entry_int (psx_ctx->hw->entry_int)
+#define irq_regs (psx_ctx->hw->irq_regs)
+#define irq_mutex (psx_ctx->hw->irq_mutex)
 
 // take a snapshot of the CPU state for a thread
 static void FreezeThread(int32_t iThread, int flag)
@@ -452,8 +519,6 @@ static void psx_irq_set(uint32_t irq)
 	psx_irq_update();
 }
 
-static uint32_t gpu_stat = 0;
-
 static uint32_t psx_hw_read(offs_t offset, uint32_t mem_mask)
 {
 	if (offset <= 0x007fffff)
@@ -600,6 +665,7 @@ static void psx_dma4(uint32_t madr, uint32_t bcr, uint32_t chcr)
 		#endif
 		bcr = (bcr>>16) * (bcr & 0xffff) * 2;
 		SPUreadDMAMem(madr&0x1fffff, bcr);
+		mips_mark_dirty(madr&0x1fffff, bcr*2);
 	}
 }
 
@@ -620,6 +686,7 @@ static void ps2_dma4(uint32_t madr, uint32_t bcr, uint32_t chcr)
 		#endif
 		bcr = (bcr>>16) * (bcr & 0xffff) * 4;
 		SPU2readDMA4Mem(madr&0x1fffff, bcr);
+		mips_mark_dirty(madr&0x1fffff, bcr*2);
 	}
 
 	dma4_delay = 80;
@@ -660,6 +727,7 @@ static void psx_hw_write(offs_t offset, uint32_t data, uint32_t mem_mask)
 
 		psx_ram[offset>>2] &= LE32(mem_mask);
 		psx_ram[offset>>2] |= LE32(data);
+		mips_mark_dirty(offset, 4);
 		return;
 	}
 
@@ -670,6 +738,7 @@ static void psx_hw_write(offs_t offset, uint32_t data, uint32_t mem_mask)
 		mips_get_info(CPUINFO_INT_PC, &mipsinfo);
 		psx_ram[offset>>2] &= LE32(mem_mask);
 		psx_ram[offset>>2] |= LE32(data);
+		mips_mark_dirty(offset, 4);
 		return;
 	}
 
@@ -889,8 +958,6 @@ void ps2_hw_slice(void)
 	}
 }
 
-static int fcnt = 0;
-
 void psx_hw_frame(void)
 {
 	if (psf_refresh == 50)
@@ -928,12 +995,6 @@ enum
 	BLK_BK = 12
 };
 
-static uint32_t heap_addr, entry_int = 0;
-
-static uint32_t irq_regs[37];
-
-static int irq_mutex = 0;
-
 static void call_irq_routine(uint32_t routine, uint32_t parameter)
 {
 	int j, oldICount;
@@ -980,6 +1041,7 @@ static void call_irq_routine(uint32_t routine, uint32_t parameter)
 
 	// make sure we're set
 	psx_ram[0x1000/4] = LE32(FUNCT_HLECALL);
+	mips_mark_dirty(0x1000, 4);
 
 	softcall_target = 0;
 	oldICount = mips_get_icount();
@@ -1052,6 +1114,7 @@ static void psx_bios_exception(uint32_t pc)
 
 					// make sure we're set
 					psx_ram[0x1000/4] = LE32(FUNCT_HLECALL);
+					mips_mark_dirty(0x1000, 4);
 
 					softcall_target = 0;
 					oldICount = mips_get_icount();
@@ -1084,6 +1147,7 @@ static void psx_bios_exception(uint32_t pc)
 
 							// make sure we're set
 							psx_ram[0x1000/4] = LE32(FUNCT_HLECALL);
+							mips_mark_dirty(0x1000, 4);
 
 							softcall_target = 0;
 							oldICount = mips_get_icount();
@@ -1284,7 +1348,10 @@ void psx_hw_init(void)
 	psx_ram[0xa0/4] = LE32(FUNCT_HLECALL);
 	psx_ram[0xb0/4] = LE32(FUNCT_HLECALL);
 	psx_ram[0xc0/4] = LE32(FUNCT_HLECALL);
+	mips_mark_dirty(0xa0, 0x24);
 
+	// the event tables are only ever read back by the HLE code, so writes to
+	// them skip mips_mark_dirty()
 	Event = (EvtCtrlBlk *)&psx_ram[0x1000/4];
 	CounterEvent = (Event + (32*2));
 
@@ -1388,6 +1455,7 @@ void psx_bios_hle(uint32_t pc)
 					// GP
 					mips_get_info(CPUINFO_INT_REGISTER + MIPS_R28, &mipsinfo);
 					psx_ram[((a0&0x1fffff)+44)/4] = LE32(mipsinfo.i);
+					mips_mark_dirty(a0, 48);
 
 					// v0 = 0
 					mipsinfo.i = 0;
@@ -1432,6 +1500,7 @@ void psx_bios_hle(uint32_t pc)
 							dst++;
 							src++;
 						}
+						mips_mark_dirty(a0, dst - (uint8_t *)psx_ram - (a0 & 0x1fffff));
 
 						// v0 = a0
 						mipsinfo.i = a0;
@@ -1450,6 +1519,7 @@ void psx_bios_hle(uint32_t pc)
 						dst = (uint8_t *)psx_ram;
 						dst += (a0 & 0x1fffff);
 						memset(dst, 0, a1);
+						mips_mark_dirty(a0, a1);
 					}
 					break;
 
@@ -1465,6 +1535,7 @@ void psx_bios_hle(uint32_t pc)
 						src = (uint8_t *)psx_ram;
 						dst += (a0 & 0x1fffff);
 						src += (a1 & 0x1fffff);
+						mips_mark_dirty(a0, a2);
 
 						while (a2)
 						{
@@ -1490,6 +1561,7 @@ void psx_bios_hle(uint32_t pc)
 
 						dst = (uint8_t *)psx_ram;
 						dst += (a0 & 0x1fffff);
+						mips_mark_dirty(a0, a2);
 
 						while (a2)
 						{
@@ -1548,6 +1620,8 @@ void psx_bios_hle(uint32_t pc)
 						psx_ram[(chunk+BLK_STAT)/4] = LE32(1);
 						psx_ram[(chunk+BLK_SIZE)/4] = LE32(a0);
 						psx_ram[(chunk+BLK_FD)/4] = LE32(fd);
+						mips_mark_dirty(chunk, 16);
+						mips_mark_dirty(fd, 16);
 
 						mipsinfo.i = chunk + 16;
 						mipsinfo.i |= 0x80000000;
@@ -1579,6 +1653,7 @@ void psx_bios_hle(uint32_t pc)
 					{
 						psx_ram[(heap_addr+BLK_SIZE)/4] = LE32(a1);
 					}
+					mips_mark_dirty(heap_addr, 16);
 					break;
 
 				case 0x3f:	// printf
@@ -1817,6 +1892,7 @@ void psx_bios_hle(uint32_t pc)
 
 					// (a0*4)+0x8600 = a1;
 					psx_ram[((a0<<2) + 0x8600)/4] = LE32(a1);
+					mips_mark_dirty((a0<<2) + 0x8600, 4);
 					break;
 
 				default:
@@ -2357,6 +2433,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 				psx_ram[a0] = LE32(sys_time & 0xffffffff);  	// low
 				psx_ram[a0+1] = LE32(sys_time >> 32);	// high
+				mips_mark_dirty(a0*4, 8);
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2379,6 +2456,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 					psx_ram[((a1 & 0x1fffff)/4)] = LE32(lo);
 					psx_ram[((a1 & 0x1fffff)/4)+1] = LE32(hi);
+					mips_mark_dirty(a1, 8);
 
 					mipsinfo.i = 0;
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2413,6 +2491,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 					psx_ram[a1] = LE32(seconds);
 					psx_ram[a2] = LE32(usec);
+					mips_mark_dirty(a1*4, 4);
+					mips_mark_dirty(a2*4, 4);
 				}
 				break;
 
@@ -2784,6 +2864,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					// get exact byte alignment
 					dst += a0 % 4;
 					src += a1 % 4;
+					mips_mark_dirty(a0, a2);
 
 					while (a2)
 					{
@@ -2813,6 +2894,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					dst += a0 % 4;
 					src += a1 % 4;
 
+					mips_mark_dirty(a0, a2);
+
 					dst += a2 - 1;
 					src += a2 - 1;
 
@@ -2843,6 +2926,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					dst += (a0 & 3);
 
 					memset(dst, a1, a2);
+					mips_mark_dirty(a0, a2);
 				}
 				break;
 
@@ -2857,6 +2941,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					dst = (uint8_t *)&psx_ram[(a0&0x1fffff)/4];
 					dst += (a0 & 3);
 					memset(dst, 0, a1);
+					mips_mark_dirty(a0, a1);
 				}
 				break;
 
@@ -2873,6 +2958,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				#endif
 
 				iop_sprintf(mname, str1, CPUINFO_INT_REGISTER + MIPS_R6);	// a2 is first parameter
+				mips_mark_dirty(a0, strlen(mname) + 1);
 
 				#if DEBUG_HLE_IOP
 				printf("     = [%s]\n", mname);
@@ -2900,6 +2986,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 						src++;
 					}
 					*dst = '\0';
+					mips_mark_dirty(a0, (uint8_t *)dst - (uint8_t *)psx_ram - (a0 & 0x1fffff) + 1);
 
 					// v0 = a0
 					mipsinfo.i = a0;
@@ -2945,6 +3032,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 						a2--;
 					}
 					*dst = '\0';
+					mips_mark_dirty(a0, (uint8_t *)dst - (uint8_t *)psx_ram - (a0 & 0x1fffff) + 1);
 
 					// v0 = a0
 					mipsinfo.i = a0;
@@ -3279,6 +3367,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 							#endif
 							psx_ram[(newAlloc/4)+i] = LE32(args[i]);
 						}
+						mips_mark_dirty(newAlloc, numargs*4);
 
 						// set argv and argc
 						mipsinfo.i = numargs;
@@ -3398,6 +3487,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					rp = (uint8_t *)psx_ram;
 					rp += (a1 & 0x1fffff);
 					memcpy(rp, &filedata[a0][filepos[a0]], a2);
+					mips_mark_dirty(a1, a2);
 
 					filepos[a0] += a2;
 					mipsinfo.i = a2;
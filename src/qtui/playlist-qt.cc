@@ -458,11 +458,19 @@ void PlaylistWidget::playlistUpdate()
         else if (currentPos >= update.before)
             currentPos = -1;
 
+        proxyModel->entriesRemoved(update.before, removed);
+        proxyModel->entriesAdded(update.before, changed);
+
         model->entriesRemoved(update.before, removed);
         model->entriesAdded(update.before, changed);
     }
     else if (update.level == Playlist::Metadata || update.queue_changed)
+    {
+        if (update.level == Playlist::Metadata)
+            proxyModel->entriesChanged(update.before, changed);
+
         model->entriesChanged(update.before, changed);
+    }
 
     if (update.queue_changed)
     {
@@ -492,6 +500,13 @@ void PlaylistWidget::playlistUpdate()
 }
 
 void PlaylistWidget::setFilter(const char * text)
+{
+    // Matching runs in the background; the old results stay visible until
+    // the new ones are ready.
+    proxyModel->setFilter(text, [this]() { applyFilter(); });
+}
+
+void PlaylistWidget::applyFilter()
 {
     // Save the current focus before filtering
     int focus = m_playlist.get_focus();
@@ -502,7 +517,7 @@ void PlaylistWidget::setFilter(const char * text)
     model->entriesRemoved(0, model->rowCount());
 
     // Update the filter
-    proxyModel->setFilter(text);
+    proxyModel->commitFilter();
 
     // Repopulate the model
     model->entriesAdded(0, m_playlist.n_entries());
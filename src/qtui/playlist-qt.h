@@ -64,6 +64,7 @@ private:
     QModelIndex rowToIndex(int row);
     int indexToRow(const QModelIndex & index);
     QModelIndex visibleIndexNear(int row);
+    void applyFilter();
 
     void getSelectedRanges(int rowsBefore, int rowsAfter,
                            QItemSelection & selected,
@@ -24,6 +24,8 @@
 #include <QMimeData>
 #include <QUrl>
 
+#include <string.h>
+
 #include <libaudcore/audstrings.h>
 #include <libaudcore/drct.h>
 #include <libaudcore/i18n.h>
@@ -324,13 +326,186 @@ QString PlaylistModel::filename(const Tuple & tuple) const
 
 /* ---------------------------------- */
 
-void PlaylistProxyModel::setFilter(const char * filter)
+// number of rows matched between checks for cancellation
+static constexpr int FILTER_CHUNK = 1024;
+
+struct PlaylistProxyModel::FilterJob
+{
+    Playlist playlist;
+    Index<String> terms;
+    Index<String> keys;
+    Index<char> matches;
+    bool narrowing = false;
+
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    bool cancelled = false;
+    bool joined = false;
+};
+
+// The search key is the case-folded title, artist, album and file name,
+// separated by newlines so that no search term can match across fields.
+static String make_search_key(const Tuple & tuple)
+{
+    String strings[] = {tuple.get_str(Tuple::Title),
+                        tuple.get_str(Tuple::Artist),
+                        tuple.get_str(Tuple::Album),
+                        tuple.get_str(Tuple::Basename)};
+
+    StringBuf key = str_concat({strings[0] ? strings[0] : "", "\n",
+                                strings[1] ? strings[1] : "", "\n",
+                                strings[2] ? strings[2] : "", "\n",
+                                strings[3] ? strings[3] : ""});
+
+    return String(str_tolower_utf8(key));
+}
+
+static bool match_terms(const char * key, const Index<String> & terms)
+{
+    for (auto & term : terms)
+    {
+        if (!strstr(key, term))
+            return false;
+    }
+
+    return true;
+}
+
+PlaylistProxyModel::PlaylistProxyModel(QObject * parent, Playlist playlist)
+    : QSortFilterProxyModel(parent), m_playlist(playlist)
+{
+    entriesAdded(0, playlist.n_entries());
+}
+
+PlaylistProxyModel::~PlaylistProxyModel() { stopJob(); }
+
+void PlaylistProxyModel::setFilter(const char * filter,
+                                   std::function<void()> apply)
+{
+    stopJob();
+
+    m_pendingFilter = String(str_tolower_utf8(filter));
+    m_apply = apply;
+
+    startJob();
+}
+
+void PlaylistProxyModel::startJob()
+{
+    auto job = new FilterJob;
+    int rows = m_searchKeys.len();
+
+    job->playlist = m_playlist;
+    job->terms = str_list_to_index(m_pendingFilter, " ");
+    job->keys = std::move(m_searchKeys);
+    job->matches.insert(0, rows);
+
+    // If the query has only grown, rows that did not match before cannot
+    // match now, so only the previous matches need to be checked again.
+    if (m_searchTerms.len() &&
+        !strncmp(m_pendingFilter, m_filter, strlen(m_filter)))
+    {
+        job->narrowing = true;
+        for (int row = 0; row < rows; row++)
+            job->matches[row] = m_matches[row];
+    }
+
+    m_job = job;
+    pthread_create(&m_thread, nullptr, filterWorker, this);
+}
+
+// Cancels the running job, if any, keeping the search keys built so far.
+// Returns true if there was a job.
+bool PlaylistProxyModel::stopJob()
+{
+    if (!m_job)
+        return false;
+
+    pthread_mutex_lock(&m_job->mutex);
+    m_job->cancelled = true;
+    pthread_mutex_unlock(&m_job->mutex);
+
+    if (!m_job->joined)
+        pthread_join(m_thread, nullptr);
+
+    m_jobDone.stop();
+
+    m_searchKeys = std::move(m_job->keys);
+    delete m_job;
+    m_job = nullptr;
+
+    return true;
+}
+
+void * PlaylistProxyModel::filterWorker(void * data)
+{
+    auto proxy = (PlaylistProxyModel *)data;
+    auto job = proxy->m_job;
+    int rows = job->keys.len();
+
+    for (int start = 0; start < rows && job->terms.len(); start += FILTER_CHUNK)
+    {
+        pthread_mutex_lock(&job->mutex);
+        bool cancelled = job->cancelled;
+        pthread_mutex_unlock(&job->mutex);
+
+        if (cancelled)
+            return nullptr;
+
+        int end = aud::min(start + FILTER_CHUNK, rows);
+
+        for (int row = start; row < end; row++)
+        {
+            if (job->narrowing && job->matches[row] == NoMatch)
+                continue;
+
+            String & key = job->keys[row];
+            if (!key)
+                key = make_search_key(
+                    job->playlist.entry_tuple(row, Playlist::NoWait));
+
+            job->matches[row] = match_terms(key, job->terms) ? Match : NoMatch;
+        }
+
+        // If entries were added or removed in the meantime, the keys just
+        // built may belong to other rows.  Drop them and wait for the
+        // playlist update, which restarts the job.
+        if (job->playlist.n_entries() != rows)
+        {
+            for (int row = start; row < end; row++)
+                job->keys[row] = String();
+
+            return nullptr;
+        }
+    }
+
+    proxy->m_jobDone.queue([proxy]() { proxy->jobFinished(); });
+    return nullptr;
+}
+
+void PlaylistProxyModel::jobFinished()
+{
+    pthread_join(m_thread, nullptr);
+    m_job->joined = true;
+
+    m_apply();
+}
+
+void PlaylistProxyModel::commitFilter()
 {
+    if (!m_job || !m_job->joined)
+        return;
+
 #if QT_VERSION >= QT_VERSION_CHECK(6, 10, 0)
     beginFilterChange();
 #endif
 
-    m_searchTerms = str_list_to_index(filter, " ");
+    m_filter = m_pendingFilter;
+    m_searchTerms = std::move(m_job->terms);
+    m_searchKeys = std::move(m_job->keys);
+    m_matches = std::move(m_job->matches);
+
+    delete m_job;
+    m_job = nullptr;
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 10, 0)
     endFilterChange(QSortFilterProxyModel::Direction::Rows);
@@ -339,35 +514,70 @@ void PlaylistProxyModel::setFilter(const char * filter)
 #endif
 }
 
+void PlaylistProxyModel::entriesAdded(int row, int count)
+{
+    bool restart = stopJob();
+
+    m_searchKeys.insert(row, count);
+    m_matches.insert(row, count);
+
+    if (restart)
+        startJob();
+}
+
+void PlaylistProxyModel::entriesRemoved(int row, int count)
+{
+    bool restart = stopJob();
+
+    m_searchKeys.remove(row, count);
+    m_matches.remove(row, count);
+
+    if (restart)
+        startJob();
+}
+
+void PlaylistProxyModel::entriesChanged(int row, int count)
+{
+    bool restart = stopJob();
+
+    for (int i = row; i < row + count; i++)
+    {
+        m_searchKeys[i] = String();
+        m_matches[i] = MatchUnknown;
+    }
+
+    if (restart)
+        startJob();
+}
+
 bool PlaylistProxyModel::filterAcceptsRow(int source_row,
                                           const QModelIndex &) const
 {
     if (!m_searchTerms.len())
         return true;
 
-    Tuple tuple = m_playlist.entry_tuple(source_row);
+    if (source_row < m_matches.len() && m_matches[source_row] != MatchUnknown)
+        return m_matches[source_row] == Match;
 
-    String strings[] = {tuple.get_str(Tuple::Title),
-                        tuple.get_str(Tuple::Artist),
-                        tuple.get_str(Tuple::Album),
-                        tuple.get_str(Tuple::Basename)};
+    // The row is new or has changed since the filter was last run.  While a
+    // job is running, the cached keys are owned by the worker thread.
+    String key;
 
-    for (auto & term : m_searchTerms)
+    if (source_row < m_searchKeys.len() && m_searchKeys[source_row])
+        key = m_searchKeys[source_row];
+    else
     {
-        bool found = false;
-
-        for (auto & s : strings)
-        {
-            if (s && strstr_nocase_utf8(s, term))
-            {
-                found = true;
-                break;
-            }
-        }
+        key = make_search_key(
+            m_playlist.entry_tuple(source_row, Playlist::NoWait));
 
-        if (!found)
-            return false;
+        if (source_row < m_searchKeys.len())
+            m_searchKeys[source_row] = key;
     }
 
-    return true;
+    bool found = match_terms(key, m_searchTerms);
+
+    if (source_row < m_matches.len())
+        m_matches[source_row] = found ? Match : NoMatch;
+
+    return found;
 }
@@ -23,6 +23,10 @@
 #include <QAbstractListModel>
 #include <QSortFilterProxyModel>
 
+#include <functional>
+#include <pthread.h>
+
+#include <libaudcore/mainloop.h>
 #include <libaudcore/playlist.h>
 
 class QFont;
@@ -93,18 +97,49 @@ private:
 class PlaylistProxyModel : public QSortFilterProxyModel
 {
 public:
-    PlaylistProxyModel(QObject * parent, Playlist playlist)
-        : QSortFilterProxyModel(parent), m_playlist(playlist)
-    {
-    }
+    PlaylistProxyModel(QObject * parent, Playlist playlist);
+    ~PlaylistProxyModel();
 
-    void setFilter(const char * filter);
+    // Matching is done on a worker thread.  Once it is finished, apply() is
+    // called on the main thread, which must in turn call commitFilter().
+    void setFilter(const char * filter, std::function<void()> apply);
+    void commitFilter();
+
+    // keep the cached search keys in sync with the playlist
+    void entriesAdded(int row, int count);
+    void entriesRemoved(int row, int count);
+    void entriesChanged(int row, int count);
 
 private:
+    struct FilterJob;
+
+    enum : char
+    {
+        MatchUnknown,
+        Match,
+        NoMatch
+    };
+
     bool filterAcceptsRow(int source_row, const QModelIndex &) const override;
 
+    void startJob();
+    bool stopJob();
+    void jobFinished();
+    static void * filterWorker(void * data);
+
     Playlist m_playlist;
+    String m_filter;
     Index<String> m_searchTerms;
+
+    // per source row; the keys are built lazily and kept across filter changes
+    mutable Index<String> m_searchKeys;
+    mutable Index<char> m_matches;
+
+    String m_pendingFilter;
+    std::function<void()> m_apply;
+    FilterJob * m_job = nullptr;
+    pthread_t m_thread;
+    QueuedFunc m_jobDone;
 };
 
 #endif
@@ -14,6 +14,7 @@
 #include <curl/curl.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 //audacious includes
 #include <libaudcore/audstrings.h>
@@ -72,6 +73,34 @@ static char * scrobbler_get_signature (Index<API_Parameter> & params)
     return g_compute_checksum_for_string (G_CHECKSUM_MD5, buf, -1);
 }
 
+// builds a signed request from the given parameters, which must include
+// the method name
+static String create_message_from_params (Index<API_Parameter> & params)
+{
+    char * api_sig = scrobbler_get_signature (params);
+
+    StringBuf buf (0);
+
+    for (const API_Parameter & param : params)
+    {
+        char * esc = curl_easy_escape (curlHandle, param.argument, 0);
+        if (buf.len ())
+            buf.insert (-1, "&");
+        buf.insert (-1, param.paramName);
+        buf.insert (-1, "=");
+        buf.insert (-1, esc ? esc : "");
+        curl_free (esc);
+    }
+
+    buf.insert (-1, "&api_sig=");
+    buf.insert (-1, api_sig);
+    g_free (api_sig);
+
+    AUDDBG ("FINAL message: %s.\n", (const char *) buf);
+
+    return String (buf);
+}
+
 /*
  * n_args should count with the given authentication parameters
  * At most 2: api_key, session_key.
@@ -88,8 +117,6 @@ static String create_message_to_lastfm (const char * method_name, int n_args, ..
     Index<API_Parameter> params;
     params.append (String ("method"), String (method_name));
 
-    StringBuf buf = str_concat ({"method=", method_name});
-
     va_list vl;
     va_start (vl, n_args);
 
@@ -99,25 +126,11 @@ static String create_message_to_lastfm (const char * method_name, int n_args, ..
         const char * arg = va_arg (vl, const char *);
 
         params.append (String (name), String (arg));
-
-        char * esc = curl_easy_escape (curlHandle, arg, 0);
-        buf.insert (-1, "&");
-        buf.insert (-1, name);
-        buf.insert (-1, "=");
-        buf.insert (-1, esc ? esc : "");
-        curl_free (esc);
     }
 
     va_end (vl);
 
-    char * api_sig = scrobbler_get_signature (params);
-    buf.insert (-1, "&api_sig=");
-    buf.insert (-1, api_sig);
-    g_free (api_sig);
-
-    AUDDBG ("FINAL message: %s.\n", (const char *) buf);
-
-    return String (buf);
+    return create_message_from_params (params);
 }
 
 static gboolean send_message_to_lastfm (const char * data)
@@ -270,7 +283,11 @@ gboolean scrobbler_communication_init() {
         return false;
     }
 
-    curl_requests_result = curl_easy_setopt(curlHandle, CURLOPT_URL, SCROBBLER_URL);
+    //"api_url" is not exposed in the settings; it allows pointing the plugin
+    //at a local mock of the API for testing
+    String api_url = aud_get_str("scrobbler", "api_url");
+    curl_requests_result = curl_easy_setopt(curlHandle, CURLOPT_URL,
+     api_url[0] ? (const char *)api_url : SCROBBLER_URL);
     if (curl_requests_result != CURLE_OK) {
         AUDDBG("Could not define scrobbler destination URL: %s.\n", curl_easy_strerror(curl_requests_result));
         return false;
@@ -285,92 +302,109 @@ gboolean scrobbler_communication_init() {
     return true;
 }
 
-static void set_timestamp_to_current(char **line) {
-    //line[0] line[1] line[2] line[3] line[4] line[5] line[6]   line[7]      line[8]
-    //artist  album   title   number  length  "L"     timestamp album_artist nullptr
+/*
+ * The queue (scrobbler.log) is an append-only journal: tracks are appended by
+ * queue_track_to_scrobble(), and entries are marked as submitted by advancing
+ * an offset kept in scrobbler.log.offset rather than by rewriting the file.
+ * Once at least half of the file has been submitted, the remainder is copied
+ * into a new file (compaction), so each entry is rewritten O(1) times.
+ */
+
+#define SCROBBLE_BATCH 50   //maximum number of tracks in one track.scrobble request
 
-    char **split_line = g_strsplit(*line, "\t", 0);
-    g_free(split_line[6]);
-    split_line[6] = g_strdup_printf("%" G_GINT64_FORMAT, g_get_real_time() / G_USEC_PER_SEC);
-    AUDDBG("split line's timestamp is now: %s.\n", split_line[6]);
-    g_free(*line);
-    (*line) = g_strjoinv("\t", split_line);
-    g_strfreev(split_line);
+#define BACKOFF_MIN 7       //seconds
+#define BACKOFF_MAX 1800    //seconds
+
+typedef struct {
+    char **line;            //see is_valid_scrobble_format()
+    int64_t end;            //offset in the queue file just after this entry
+} QueueEntry;
+
+enum BatchResult {
+    BATCH_OK,               //the whole batch was handled (scrobbled, ignored or requeued)
+    BATCH_RETRY_LATER,      //network problem or temporary error; nothing was handled
+    BATCH_REJECTED          //the request was refused as a whole
+};
+
+//seconds to wait before retrying after a failure; doubles on each failure
+static int backoff_delay = 0;
+
+//set when the queue could not be submitted because of a temporary condition
+static gboolean queue_retry_later = false;
+
+static StringBuf queue_offset_path (const char *queuepath) {
+    return str_concat({queuepath, ".offset"});
 }
 
-static void delete_lines_from_scrobble_log (GSList **lines_to_remove_ptr, GSList **lines_to_retry_ptr, char *queuepath) {
-    GSList *lines_to_remove = *lines_to_remove_ptr;
-    GSList *lines_to_retry = *lines_to_retry_ptr;
+static int64_t read_queue_offset (const char *queuepath) {
     char *contents = nullptr;
-    char **lines = nullptr;
-    char **finallines = g_new (char *, 1);
-    int n_finallines;
+    int64_t offset = 0;
 
-    if (lines_to_remove != nullptr) {
-        lines_to_remove = g_slist_reverse(lines_to_remove);
-    }
-    if (lines_to_retry != nullptr) {
-        lines_to_retry = g_slist_reverse(lines_to_retry);
-    }
+    if (g_file_get_contents(queue_offset_path(queuepath), &contents, nullptr, nullptr))
+        offset = g_ascii_strtoll(contents, nullptr, 10);
+
+    g_free(contents);
+    return offset;
+}
+
+static void write_queue_offset (const char *queuepath, int64_t offset) {
+    StringBuf contents = str_printf("%" G_GINT64_FORMAT "\n", offset);
+
+    if (!g_file_set_contents(queue_offset_path(queuepath), contents, -1, nullptr))
+        AUDERR("Could not write to scrobbler.log.offset!\n");
+}
+
+//appends a copy of an entry to the end of the queue, with a new timestamp
+//if requested
+static void requeue_entry (const char *queuepath, char **line, gboolean new_timestamp) {
+    //line[0] line[1] line[2] line[3] line[4] line[5] line[6]   line[7]      line[8]
+    //artist  album   title   number  length  "L"     timestamp album_artist nullptr
+
+    StringBuf timestamp = new_timestamp ?
+     str_printf("%" G_GINT64_FORMAT, g_get_real_time() / G_USEC_PER_SEC) :
+     str_copy(line[6]);
 
     pthread_mutex_lock(&log_access_mutex);
 
-    gboolean success = g_file_get_contents(queuepath, &contents, nullptr, nullptr);
-    if (!success) {
-        AUDDBG("Could not read scrobbler.log contents.\n");
+    FILE *f = g_fopen(queuepath, "a");
+    if (f == nullptr) {
+        perror("fopen");
     } else {
-        lines = g_strsplit(contents, "\n", 0);
+        if (fprintf(f, "%s\t%s\t%s\t%s\t%s\tL\t%s\t%s\n", line[0], line[1], line[2],
+         line[3], line[4], (const char *)timestamp, line[7] != nullptr ? line[7] : "") < 0)
+            perror("fprintf");
 
-        n_finallines = 0;
-        for (int i = 0 ; lines[i] != nullptr; i++) {
-            if (!strlen(lines[i])) continue;
+        fclose(f);
+    }
 
-            if (lines_to_remove != nullptr && *((int *) (lines_to_remove->data)) == i) {
-                //this line is to remove
-                lines_to_remove = g_slist_next(lines_to_remove);
-            } else {
-                //keep this line
-                AUDDBG("Going to keep line %i\n", i);
-                if (lines_to_retry != nullptr && *((int *) (lines_to_retry->data)) == i) {
-                  lines_to_retry = g_slist_next(lines_to_retry);
-                  //this line will be retried with a zero timestamp
-                  AUDDBG("Going to zero this line.\n");
-                  AUDDBG("Line before: %s.\n", lines[i]);
-                  set_timestamp_to_current(&(lines[i]));
-                  AUDDBG("Line after: %s.\n", lines[i]);
-                } else {
-                  AUDDBG("not zeroing this line\n");
-                }
-                n_finallines++;
-                finallines = g_renew (char *, finallines, n_finallines);
-                finallines[n_finallines-1] = g_strdup(lines[i]);
-            }
-        }
+    pthread_mutex_unlock(&log_access_mutex);
+}
+
+//drops the submitted part of the queue once it makes up at least half of it
+static void compact_queue (const char *queuepath, int64_t offset) {
+    char *contents = nullptr;
+    gsize length = 0;
+
+    pthread_mutex_lock(&log_access_mutex);
 
-        finallines = g_renew (char *, finallines, n_finallines + 2);
-        finallines[n_finallines] = g_strdup("");
-        finallines[n_finallines+1] = nullptr;
-        g_free(contents);
-        contents = g_strjoinv("\n", finallines);
-        success = g_file_set_contents(queuepath, contents, -1, nullptr);
-        if (!success) {
+    if (g_file_get_contents(queuepath, &contents, &length, nullptr) &&
+     offset <= (int64_t) length && offset * 2 >= (int64_t) length) {
+        AUDDBG("Compacting the queue: %" G_GINT64_FORMAT " of %" G_GSIZE_FORMAT " bytes submitted.\n",
+         offset, length);
+
+        //reset the offset first: if we are interrupted in between, entries
+        //may be submitted twice, but none are lost
+        write_queue_offset(queuepath, 0);
+
+        if (!g_file_set_contents(queuepath, contents + offset, length - offset, nullptr))
             AUDERR("Could not write to scrobbler.log!\n");
-        }
     }
 
     pthread_mutex_unlock(&log_access_mutex);
 
-    g_strfreev(finallines);
-    g_strfreev(lines);
     g_free(contents);
 }
 
-static void save_line_to_remove(GSList **lines_to_remove, int linenumber) {
-    int *rem = g_new (int, 1);
-    *rem = linenumber;
-    (*lines_to_remove) = g_slist_prepend((*lines_to_remove), rem);
-}
-
 static gboolean is_valid_scrobble_format(char **line) {
     if (line == nullptr) return false;
 
@@ -389,117 +423,177 @@ static gboolean is_valid_scrobble_format(char **line) {
     return true;
 }
 
+static BatchResult submit_batch (const char *queuepath, const QueueEntry *entries, int n) {
+    Index<API_Parameter> params;
+    params.append(String("method"), String("track.scrobble"));
+
+    for (int i = 0; i < n; i++) {
+        char **line = entries[i].line;
+
+        auto add = [&] (const char *name, const char *value) {
+            params.append(String(str_printf("%s[%d]", name, i)), String(value));
+        };
+
+        add("artist", line[0]);
+        add("album", line[1]);
+        add("track", line[2]);
+        add("trackNumber", line[3]);
+        add("duration", line[4]);
+        add("timestamp", line[6]);
+        add("albumArtist", line[7] != nullptr ? line[7] : ""); //in case cache uses old format without album artist field
+    }
+
+    params.append(String("api_key"), String(SCROBBLER_API_KEY));
+    params.append(String("sk"), session_key);
+
+    String scrobblemsg = create_message_from_params(params);
+
+    if (send_message_to_lastfm(scrobblemsg) == false) {
+        AUDDBG("Could not scrobble the tracks on the queue. Network problem?\n");
+        scrobbling_enabled = false;
+        return BATCH_RETRY_LATER;
+    }
+
+    String error_code;
+    String error_detail;
+    Index<String> ignored_codes;
+
+    if (read_scrobble_batch_result(error_code, error_detail, ignored_codes) == true) {
+        AUDDBG("SCROBBLE OK. %d tracks submitted.\n", n);
+
+        for (int i = 0; i < n; i++) {
+            const char *ignored_code = (i < ignored_codes.len()) ? (const char *)ignored_codes[i] : nullptr;
+
+            if (g_strcmp0(ignored_code, "3") == 0) { //3: Timestamp was too old
+                AUDDBG("SCROBBLE IGNORED (timestamp too old); will retry.\n");
+                requeue_entry(queuepath, entries[i].line, true);
+            } else if (g_strcmp0(ignored_code, "5") == 0) { //5: Daily scrobble limit exceeded
+                AUDDBG("SCROBBLE IGNORED (daily limit exceeded); will retry.\n");
+                requeue_entry(queuepath, entries[i].line, false);
+                queue_retry_later = true;
+            } else if (ignored_code) {
+                AUDDBG("SCROBBLE IGNORED, code %s.\n", ignored_code);
+            }
+        }
+
+        return BATCH_OK;
+    }
+
+    AUDINFO("SCROBBLE NOT OK. Error code: %s. Error detail: %s.\n",
+     (const char *)error_code, (const char *)error_detail);
+
+    if (! error_code || //net error(?) or the answer from last.fm was not well read
+        g_strcmp0(error_code, "11") == 0 || //Service Offline - This service is temporarily offline. Try again later.
+        g_strcmp0(error_code, "16") == 0 || //The service is temporarily unavailable, please try again.
+        g_strcmp0(error_code, "29") == 0) { //Rate limit exceeded
+        queue_retry_later = true;
+        return BATCH_RETRY_LATER;
+    }
+
+    if (g_strcmp0(error_code, "9") == 0) {
+        //Bad Session. Reauth.
+        scrobbling_enabled = false;
+        session_key = String();
+        aud_set_str("scrobbler", "session_key", "");
+        return BATCH_RETRY_LATER;
+    }
+
+    return BATCH_REJECTED;
+}
+
 static void scrobble_cached_queue() {
     char *queuepath = g_build_filename(aud_get_path(AudPath::UserDir),"scrobbler.log", nullptr);
     char *contents = nullptr;
+    gsize length = 0;
     gboolean success;
-    char **lines = nullptr;
-    char **line;
-    GSList *lines_to_remove = nullptr; //lines to remove because they were scrobbled (or ignored, and will not be retried)
-    GSList *lines_to_retry = nullptr; //lines to retry later because they were too old TODO: or "daily scrobble limit reached"
+
+    queue_retry_later = false;
 
     pthread_mutex_lock(&log_access_mutex);
-    success = g_file_get_contents(queuepath, &contents, nullptr, nullptr);
+    success = g_file_get_contents(queuepath, &contents, &length, nullptr);
     pthread_mutex_unlock(&log_access_mutex);
 
     if (!success) {
         AUDDBG("Couldn't access the queue file.\n");
-    } else {
-        lines = g_strsplit(contents, "\n", 0);
-
-        for (int i = 0; lines[i] != nullptr && scrobbling_enabled; i++) {
-            if (!strlen(lines[i])) continue;
-
-            line = g_strsplit(lines[i], "\t", 0);
-
-            //line[0] line[1] line[2] line[3] line[4] line[5] line[6]   line[7]      line[8]
-            //artist  album   title   number  length  "L"     timestamp album_artist nullptr
-
-            if (is_valid_scrobble_format(line))
-            {
-                String scrobblemsg = create_message_to_lastfm ("track.scrobble",
-                 9, "artist", line[0], "album", line[1], "track", line[2],
-                 "trackNumber", line[3], "duration", line[4],
-                 "timestamp", line[6],
-                 "albumArtist", line[7] != nullptr ? line[7] : "",  //in case cache uses old format without album artist field
-                 "api_key", SCROBBLER_API_KEY, "sk", (const char *) session_key);
-
-                if (send_message_to_lastfm(scrobblemsg) == true) {
-                    String error_code;
-                    String error_detail;
-                    gboolean ignored = false;
-                    String ignored_code;
-
-                    if (read_scrobble_result(error_code, error_detail, &ignored, ignored_code) == true) {
-                        AUDDBG("SCROBBLE OK. Error code: %s. Error detail: %s\n",
-                         (const char *)error_code, (const char *)error_detail);
-                        AUDDBG("SCROBBLE OK. ignored: %i.\n", ignored);
-                        AUDDBG("SCROBBLE OK. ignored code: %s.\n",
-                         (const char *)ignored_code);
-                        if (ignored == true && g_strcmp0(ignored_code, "3") == 0) { //3: Timestamp was too old
-                            AUDDBG("SCROBBLE IGNORED!!! %i, detail: %s\n",
-                             ignored, (const char *)ignored_code);
-                            save_line_to_remove(&lines_to_retry, i);
-                        } else if (ignored == true && g_strcmp0(ignored_code, "") == 0) { //5: Daily scrobble limit reached
-                           //TODO: a track might not be scrobbled due to "daily scrobble limit exeeded".
-                           //This message comes on the ignoredMessage attribute, inside the XML of the response.
-                           //We are not dealing with this case currently and are losing that scrobble.
-                           //TODO
-                        } else {
-                            AUDDBG("Not ignored. Carrying on...\n");
-                            save_line_to_remove(&lines_to_remove, i);
-                        }
-                    } else {
-                        AUDINFO("SCROBBLE NOT OK. Error code: %s. Error detail: %s.\n",
-                         (const char *)error_code, (const char *)error_detail);
-
-                        if (! error_code) { //net error(?) or the answer from last.fm was not well read
-                            //scrobble to be retried
-                        }
-                        else if (g_strcmp0(error_code, "11") == 0 ||
-                                 g_strcmp0(error_code, "16") == 0){
-                            //error code 11: Service Offline - This service is temporarily offline. Try again later.
-                            //error code 16: The service is temporarily unavailable, please try again.
-                            //scrobble to be retried
-                        }
-                        else if (g_strcmp0(error_code,  "9") == 0) {
-                            //Bad Session. Reauth.
-                            scrobbling_enabled = false;
-                            session_key = String();
-                            aud_set_str("scrobbler", "session_key", "");
-                        }
-                        else {
-                            save_line_to_remove(&lines_to_remove, i);
-                        }
-                    }
-                } else {
-                    AUDDBG("Could not scrobble a track on the queue. Network problem?\n");
-                    //scrobble to be retried
-                    scrobbling_enabled = false;
-                }
+        g_free(queuepath);
+        return;
+    }
 
-                //TODO: Avoid spamming last.fm --- It's not as simple as just adding a wait here:
-                //If audacious is closed while we're on this loop, tracks might be re-scrobbled.
-                //This shall be doable if we only pick one track at a time from the scrobbler.log
+    int64_t offset = read_queue_offset(queuepath);
+    if (offset < 0 || offset > (int64_t) length) {
+        AUDDBG("Queue offset out of range; starting over.\n");
+        offset = 0;
+    }
+
+    //pick up the complete lines after the offset
+    Index<QueueEntry> entries;
+    int64_t pos = offset;
+
+    while (pos < (int64_t) length) {
+        char *newline = (char *) memchr(contents + pos, '\n', length - pos);
+        if (newline == nullptr)
+            break;
+
+        *newline = 0;
+
+        if (contents[pos]) {
+            char **line = g_strsplit(contents + pos, "\t", 0);
+
+            if (is_valid_scrobble_format(line)) {
+                QueueEntry entry = {line, newline + 1 - contents};
+                entries.append(entry);
             } else {
-                AUDDBG("Unscrobbable line.\n");
-                //leave entry on the cache file
+                AUDDBG("Unscrobbable line; dropping it.\n");
+                g_strfreev(line);
             }
-            g_strfreev(line);
-        }//for
+        }
 
-        delete_lines_from_scrobble_log(&lines_to_remove, &lines_to_retry, queuepath);
+        pos = newline + 1 - contents;
+    }
 
-        if (lines_to_remove != nullptr) {
-            g_slist_free_full(lines_to_remove, g_free);
-        }
-        if (lines_to_retry != nullptr) {
-            g_slist_free_full(lines_to_retry, g_free);
+    int done = 0;
+    int one_by_one_until = 0;
+
+    while (done < entries.len() && scrobbling_enabled) {
+        int n = (done < one_by_one_until) ? 1 : aud::min(SCROBBLE_BATCH, entries.len() - done);
+        BatchResult result = submit_batch(queuepath, &entries[done], n);
+
+        if (result == BATCH_RETRY_LATER)
+            break;
+
+        if (result == BATCH_REJECTED) {
+            if (n > 1) {
+                //one bad entry fails the whole request; send these one by one
+                AUDDBG("Batch rejected; retrying its tracks one by one.\n");
+                one_by_one_until = done + n;
+                continue;
+            }
+
+            AUDINFO("Dropping a track that last.fm refused to scrobble.\n");
         }
 
-        g_strfreev(lines);
+        backoff_delay = 0;
+        done += n;
+        offset = entries[done - 1].end;
+        write_queue_offset(queuepath, offset);
+
+        //the batch went through, but last.fm wants no more for now (daily limit)
+        if (queue_retry_later)
+            break;
+    }
+
+    //everything after the last entry (invalid lines) is done as well
+    if (done == entries.len() && scrobbling_enabled && offset < pos) {
+        offset = pos;
+        write_queue_offset(queuepath, offset);
     }
 
+    if (offset > 0)
+        compact_queue(queuepath, offset);
+
+    for (QueueEntry &entry : entries)
+        g_strfreev(entry.line);
+
     g_free(contents);
     g_free(queuepath);
 }
@@ -611,6 +705,22 @@ static void treat_permission_check_request() {
     } //session_key == nullptr || strlen(session_key) == 0
 }
 
+//waits with exponential backoff; wakes up early when a track is queued or
+//another request comes in
+static void wait_before_retry() {
+    backoff_delay = backoff_delay ? aud::min(backoff_delay * 2, BACKOFF_MAX) : BACKOFF_MIN;
+    AUDDBG("Retrying in %d seconds.\n", backoff_delay);
+
+    struct timeval curtime;
+    struct timespec timeout;
+    pthread_mutex_lock(&communication_mutex);
+    gettimeofday(&curtime, nullptr);
+    timeout.tv_sec = curtime.tv_sec + backoff_delay;
+    timeout.tv_nsec = curtime.tv_usec * 1000;
+    pthread_cond_timedwait(&communication_signal, &communication_mutex, &timeout);
+    pthread_mutex_unlock(&communication_mutex);
+}
+
 //Scrobbling will only be enabled after the first connection test passed
 void * scrobbling_thread (void * input_data) {
     while (scrobbler_running) {
@@ -633,24 +743,22 @@ void * scrobbling_thread (void * input_data) {
             //scrobbling may be disabled at this point if communication errors occur
 
             pthread_mutex_lock(&communication_mutex);
-            if (scrobbling_enabled) {
+            if (scrobbling_enabled && !queue_retry_later) {
                 pthread_cond_wait(&communication_signal, &communication_mutex);
                 pthread_mutex_unlock(&communication_mutex);
             }
+            else if (scrobbling_enabled) {
+                //last.fm asked us to come back later
+                pthread_mutex_unlock(&communication_mutex);
+                wait_before_retry();
+            }
             else {
                 //We don't want to wait until receiving a signal to retry
                 //if submitting the cache failed due to network problems
                 pthread_mutex_unlock(&communication_mutex);
 
                 if (scrobbler_test_connection() == false || !scrobbling_enabled) {
-                    struct timeval curtime;
-                    struct timespec timeout;
-                    pthread_mutex_lock(&communication_mutex);
-                    gettimeofday(&curtime, nullptr);
-                    timeout.tv_sec = curtime.tv_sec + 7;
-                    timeout.tv_nsec = curtime.tv_usec * 1000;
-                    pthread_cond_timedwait(&communication_signal, &communication_mutex, &timeout);
-                    pthread_mutex_unlock(&communication_mutex);
+                    wait_before_retry();
                 }
             }
         }
@@ -664,6 +772,8 @@ void * scrobbling_thread (void * input_data) {
     curl_easy_cleanup(curlHandle);
     curlHandle = nullptr;
 
+    backoff_delay = 0;
+
     scrobbling_enabled = true;
     return nullptr;
 }
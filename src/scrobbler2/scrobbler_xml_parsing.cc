@@ -188,6 +188,65 @@ gboolean read_scrobble_result(String &error_code, String &error_detail,
     return result;
 }
 
+/*
+ * Like read_scrobble_result(), for a track.scrobble request with several
+ * tracks. On success, ignored_codes receives one entry per track, in the
+ * order they were sent: the code of its ignoredMessage, or nullptr if the
+ * track was not ignored.
+ */
+gboolean read_scrobble_batch_result(String &error_code, String &error_detail,
+ Index<String> &ignored_codes) {
+    ignored_codes.clear();
+
+    if (!prepare_data()) {
+        AUDDBG("Could not read received data from last.fm. What's up?\n");
+        return false;
+    }
+
+    String status = check_status(error_code, error_detail);
+
+    if (!status) {
+        AUDDBG("Status was nullptr. Invalid API answer.\n");
+        clean_data();
+        return false;
+    }
+
+    if (!strcmp(status, "failed")) {
+        AUDDBG("Error code: %s. Detail: %s.\n", (const char *)error_code,
+         (const char *)error_detail);
+        clean_data();
+        return false;
+    }
+
+    xmlXPathObjectPtr scrobbles = xmlXPathEvalExpression((xmlChar *) "/lfm/scrobbles/scrobble", context);
+
+    if (scrobbles != nullptr && !xmlXPathNodeSetIsEmpty(scrobbles->nodesetval)) {
+        for (int i = 0; i < scrobbles->nodesetval->nodeNr; i++) {
+            String code;
+
+            for (xmlNodePtr child = scrobbles->nodesetval->nodeTab[i]->children; child; child = child->next) {
+                if (child->type != XML_ELEMENT_NODE || xmlStrcmp(child->name, (xmlChar *) "ignoredMessage"))
+                    continue;
+
+                xmlChar *prop = xmlGetProp(child, (xmlChar *) "code");
+                if (prop && prop[0] && strcmp((const char *) prop, "0"))
+                    code = String((const char *) prop);
+
+                xmlFree(prop);
+            }
+
+            ignored_codes.append(code);
+        }
+    }
+
+    xmlXPathFreeObject(scrobbles);
+
+    AUDDBG("%d scrobble results read.\n", ignored_codes.len());
+
+    clean_data();
+    return true;
+}
+
 //returns
 //FALSE if there was an error with the connection
 gboolean read_authentication_test_result (String &error_code, String &error_detail) {
@@ -50,6 +50,9 @@ enum {
     DRAG_MOVE
 };
 
+/* number of shaped layouts to keep; enough for several screens of rows */
+#define LAYOUT_CACHE_SIZE 1024
+
 void PlaylistWidget::update_title ()
 {
     if (Playlist::n_playlists () > 1)
@@ -133,6 +136,60 @@ void PlaylistWidget::cancel_all ()
     popup_hide ();
 }
 
+PangoLayout * PlaylistWidget::get_layout (const char * text, int width, PangoRectangle * rect)
+{
+    LayoutKey key = {String (text ? text : ""), width};
+    CachedLayout * cached = m_layouts.lookup (key);
+
+    if (! cached)
+    {
+        PangoLayout * layout = gtk_widget_create_pango_layout (gtk_dr (), key.text);
+        pango_layout_set_font_description (layout, m_font.get ());
+
+        if (width >= 0)
+        {
+            pango_layout_set_width (layout, PANGO_SCALE * width);
+            pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_END);
+        }
+
+        cached = m_layouts.add (key, CachedLayout ());
+        cached->layout.capture (layout);
+        pango_layout_get_pixel_extents (layout, nullptr, & cached->rect);
+    }
+
+    cached->last_used = m_draw_count;
+
+    if (rect)
+        * rect = cached->rect;
+
+    return cached->layout.get ();
+}
+
+/* drops the least recently used half of the cache once it is full */
+void PlaylistWidget::trim_layouts ()
+{
+    if (m_layouts.n_items () <= LAYOUT_CACHE_SIZE)
+        return;
+
+    Index<int> ages;
+    m_layouts.iterate ([& ages] (const LayoutKey &, CachedLayout & cached)
+        { ages.append (cached.last_used); });
+
+    ages.sort ([] (const int & a, const int & b)
+        { return a - b; });
+
+    int cutoff = ages[ages.len () - LAYOUT_CACHE_SIZE / 2];
+
+    Index<LayoutKey> old;
+    m_layouts.iterate ([& old, cutoff] (const LayoutKey & key, CachedLayout & cached) {
+        if (cached.last_used < cutoff)
+            old.append (key);
+    });
+
+    for (const LayoutKey & key : old)
+        m_layouts.remove (key);
+}
+
 void PlaylistWidget::draw (cairo_t * cr)
 {
     int active_entry = m_playlist.get_position ();
@@ -184,18 +241,14 @@ void PlaylistWidget::draw (cairo_t * cr)
             char buf[16];
             snprintf (buf, sizeof buf, "%d.", 1 + i);
 
-            layout = gtk_widget_create_pango_layout (gtk_dr (), buf);
-            pango_layout_set_font_description (layout, m_font.get ());
-
             PangoRectangle rect;
-            pango_layout_get_pixel_extents (layout, nullptr, & rect);
+            layout = get_layout (buf, -1, & rect);
             width = aud::max (width, rect.width);
 
             cairo_move_to (cr, left, m_offset + m_row_height * (i - m_first));
             set_cairo_color (cr, skin.colors[(i == active_entry) ?
              SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]);
             pango_cairo_show_layout (cr, layout);
-            g_object_unref (layout);
         }
 
         left += width + 4;
@@ -212,18 +265,14 @@ void PlaylistWidget::draw (cairo_t * cr)
         if (len < 0)
             continue;
 
-        layout = gtk_widget_create_pango_layout (gtk_dr (), str_format_time (len));
-        pango_layout_set_font_description (layout, m_font.get ());
-
         PangoRectangle rect;
-        pango_layout_get_pixel_extents (layout, nullptr, & rect);
+        layout = get_layout (str_format_time (len), -1, & rect);
         width = aud::max (width, rect.width);
 
         cairo_move_to (cr, m_width - right - rect.width, m_offset + m_row_height * (i - m_first));
         set_cairo_color (cr, skin.colors[(i == active_entry) ?
          SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]);
         pango_cairo_show_layout (cr, layout);
-        g_object_unref (layout);
     }
 
     right += width + 6;
@@ -243,11 +292,8 @@ void PlaylistWidget::draw (cairo_t * cr)
             char buf[16];
             snprintf (buf, sizeof buf, "(#%d)", 1 + pos);
 
-            layout = gtk_widget_create_pango_layout (gtk_dr (), buf);
-            pango_layout_set_font_description (layout, m_font.get ());
-
             PangoRectangle rect;
-            pango_layout_get_pixel_extents (layout, nullptr, & rect);
+            layout = get_layout (buf, -1, & rect);
             width = aud::max (width, rect.width);
 
             cairo_move_to (cr, m_width - right - rect.width, m_offset +
@@ -255,7 +301,6 @@ void PlaylistWidget::draw (cairo_t * cr)
             set_cairo_color (cr, skin.colors[(i == active_entry) ?
              SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]);
             pango_cairo_show_layout (cr, layout);
-            g_object_unref (layout);
         }
 
         right += width + 6;
@@ -268,16 +313,12 @@ void PlaylistWidget::draw (cairo_t * cr)
         Tuple tuple = m_playlist.entry_tuple (i, Playlist::NoWait);
         String title = tuple.get_str (Tuple::FormattedTitle);
 
-        layout = gtk_widget_create_pango_layout (gtk_dr (), title);
-        pango_layout_set_font_description (layout, m_font.get ());
-        pango_layout_set_width (layout, PANGO_SCALE * (m_width - left - right));
-        pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_END);
+        layout = get_layout (title, aud::max (m_width - left - right, 0));
 
         cairo_move_to (cr, left, m_offset + m_row_height * (i - m_first));
         set_cairo_color (cr, skin.colors[(i == active_entry) ?
          SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]);
         pango_cairo_show_layout (cr, layout);
-        g_object_unref (layout);
     }
 
     /* focus rectangle */
@@ -307,6 +348,9 @@ void PlaylistWidget::draw (cairo_t * cr)
         set_cairo_color (cr, skin.colors[SKIN_PLEDIT_NORMAL]);
         cairo_stroke (cr);
     }
+
+    m_draw_count ++;
+    trim_layouts ();
 }
 
 PlaylistWidget::PlaylistWidget (int width, int height, const char * font) :
@@ -329,6 +373,7 @@ void PlaylistWidget::resize (int width, int height)
 void PlaylistWidget::set_font (const char * font)
 {
     m_font.capture (pango_font_description_from_string (font));
+    m_layouts.clear ();
 
     PangoLayout * layout = gtk_widget_create_pango_layout (gtk_dr (), "A");
     pango_layout_set_font_description (layout, m_font.get ());
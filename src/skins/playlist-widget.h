@@ -30,6 +30,7 @@
 
 #include <libaudcore/hook.h>
 #include <libaudcore/mainloop.h>
+#include <libaudcore/multihash.h>
 #include <libaudcore/playlist.h>
 
 #include "widget.h"
@@ -38,6 +39,11 @@ class PlaylistSlider;
 
 typedef SmartPtr<PangoFontDescription, pango_font_description_free> PangoFontDescPtr;
 
+static inline void unref_layout (PangoLayout * layout)
+    { g_object_unref (layout); }
+
+typedef SmartPtr<PangoLayout, unref_layout> PangoLayoutPtr;
+
 class PlaylistWidget : public Widget
 {
 public:
@@ -56,6 +62,29 @@ public:
     int hover_end ();
 
 private:
+    /* Shaping text into a PangoLayout is the bulk of the drawing time, so the
+     * layouts of recently drawn cells are kept, keyed by their text and (for
+     * ellipsized titles) width.  Colors are applied when painting, so one
+     * layout serves any selection or playback state. */
+    struct LayoutKey {
+        String text;
+        int width;  /* -1 if not ellipsized */
+
+        bool operator== (const LayoutKey & b) const
+            { return text == b.text && width == b.width; }
+        unsigned hash () const
+            { return text.hash () + width; }
+    };
+
+    struct CachedLayout {
+        PangoLayoutPtr layout;
+        PangoRectangle rect;
+        int last_used;
+    };
+
+    PangoLayout * get_layout (const char * text, int width, PangoRectangle * rect = nullptr);
+    void trim_layouts ();
+
     void draw (cairo_t * cr) override;
     bool button_press (GdkEventButton * event) override;
     bool button_release (GdkEventButton * event) override;
@@ -89,6 +118,9 @@ private:
     PangoFontDescPtr m_font;
     String m_title_text;
 
+    SimpleHash<LayoutKey, CachedLayout> m_layouts;
+    int m_draw_count = 0;
+
     Playlist m_playlist;
     int m_length = 0;
     int m_width = 0, m_height = 0, m_row_height = 1, m_offset = 0, m_rows = 0, m_first = 0;
@@ -8,91 +8,288 @@
 // implied.  In no event shall the authors be liable for any damages arising
 // from the use of this software.
 
-#include <QXmlStreamReader>
+#include <QFile>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QTimer>
 
 #include "icecast-model.h"
 
 static const char *ICECAST_YP = "http://dir.xiph.org/yp.xml";
 
+// rows are added to the model in batches of this many
+static constexpr int INSERT_BATCH = 256;
+
+// slice of the cached listing parsed per main loop iteration
+static constexpr int CACHE_SLICE = 256 * 1024;
+
+static StringBuf cache_path ()
+{
+    return filename_build ({aud_get_path (AudPath::UserDir), "icecast-yp.xml"});
+}
+
 IcecastTunerModel::IcecastTunerModel (QObject * parent) :
     QAbstractListModel (parent)
 {
-    fetch_stations ();
+    m_qnam = new QNetworkAccessManager (this);
+
+    // show the last listing right away, then check for a newer one
+    load_cache ();
 }
 
 IcecastTunerModel::~IcecastTunerModel ()
 {
+    delete m_cache_file;
     m_results.clear ();
 }
 
+void IcecastTunerModel::load_cache ()
+{
+    QFile file ((const char *) cache_path ());
+
+    if (! file.open (QIODevice::ReadOnly))
+    {
+        fetch_stations ();
+        return;
+    }
+
+    AUDINFO ("icecast: loading cached listing\n");
+
+    begin_parse (false);
+    parse_cached (file.readAll (), 0);
+}
+
+void IcecastTunerModel::parse_cached (QByteArray data, int pos)
+{
+    int len = aud::min (CACHE_SLICE, (int) data.size () - pos);
+
+    if (len > 0 && parse (QByteArray::fromRawData (data.constData () + pos, len)))
+    {
+        // parse the rest later so the UI stays responsive
+        QTimer::singleShot (0, this, [this, data, pos, len] () {
+            parse_cached (data, pos + len);
+        });
+        return;
+    }
+
+    bool success = ! m_reader.hasError () && m_results.len () + m_pending.len ();
+    end_parse (success);
+
+    if (! success)
+        aud_set_str ("streamtuner", "icecast_last_modified", "");
+
+    fetch_stations ();
+}
+
 void IcecastTunerModel::fetch_stations ()
 {
-    vfs_async_file_get_contents(ICECAST_YP, [&] (const char *, const Index<char> & buf) {
-        if (! buf.len ())
+    QNetworkRequest request ((QUrl (ICECAST_YP)));
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    request.setAttribute (QNetworkRequest::FollowRedirectsAttribute, true);
+#endif
+
+    // only download the listing again if it has changed
+    String last_modified = aud_get_str ("streamtuner", "icecast_last_modified");
+    if (last_modified[0] && m_results.len ())
+        request.setRawHeader ("If-Modified-Since", (const char *) last_modified);
+
+    QNetworkReply * reply = m_qnam->get (request);
+
+    QObject::connect (reply, & QNetworkReply::readyRead, this, [this, reply] () {
+        int status = reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+        if (status != 200)
             return;
 
-        beginResetModel ();
+        if (! m_cache_file)
+        {
+            AUDINFO ("icecast: receiving listing from YP server\n");
 
-        AUDINFO("icecast: got results from YP server\n");
-
-        // oh, this is going to be fun... parse the XML as fast as possible
-        QXmlStreamReader reader (QByteArray (buf.begin (), buf.len ()));
-        IcecastEntry entry;
-
-        // lets prefab some atoms for fast comparisons
-        QString entry_atom = QString ("entry");
-        QString server_name_atom = QString ("server_name");
-        QString listen_url_atom = QString ("listen_url");
-        QString server_type_atom = QString ("server_type");
-        QString bitrate_atom = QString ("bitrate");
-        QString genre_atom = QString ("genre");
-        QString current_song_atom = QString ("current_song");
-        QString mp3_atom = QString ("audio/mpeg");
-        QString aac_atom = QString ("audio/aacp");
-        QString vorbis_atom = QString ("application/ogg");
-
-        while (! reader.atEnd ()) {
-            auto token_type = reader.readNext ();
-
-            switch (token_type) {
-            case QXmlStreamReader::StartElement:
-                if (! reader.name ().compare (server_name_atom))
-                    entry.title = reader.readElementText ();
-                else if (! reader.name ().compare (listen_url_atom))
-                    entry.stream_uri = reader.readElementText ();
-                else if (! reader.name ().compare (current_song_atom))
-                    entry.current_song = reader.readElementText ();
-                else if (! reader.name ().compare (genre_atom))
-                    entry.genre = reader.readElementText ();
-                else if (! reader.name ().compare (server_type_atom))
-                {
-                    auto server_type = reader.readElementText ();
-
-                    if (! server_type.compare (mp3_atom))
-                        entry.type = IcecastEntry::MP3;
-                    else if (! server_type.compare (aac_atom))
-                        entry.type = IcecastEntry::AAC;
-                    else if (! server_type.compare (vorbis_atom))
-                        entry.type = IcecastEntry::Vorbis;
-                    else
-                        entry.type = IcecastEntry::Other;
-                }
-                else if (! reader.name ().compare (bitrate_atom))
-                    entry.bitrate = reader.readElementText ().toInt ();
+            m_cache_file = new QSaveFile ((const char *) cache_path ());
+            if (! m_cache_file->open (QIODevice::WriteOnly))
+                AUDWARN ("icecast: cannot write %s\n", (const char *) cache_path ());
 
-                break;
-            case QXmlStreamReader::EndElement:
-                if (! reader.name ().compare (entry_atom))
-                    m_results.append (entry);
+            begin_parse (m_results.len () > 0);
+        }
+
+        QByteArray data = reply->readAll ();
+
+        if (m_cache_file->isOpen ())
+            m_cache_file->write (data);
+
+        if (! parse (data))
+            reply->abort ();
+    });
+
+    QObject::connect (reply, & QNetworkReply::finished, this, [this, reply] () {
+        int status = reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+
+        if (status == 304)
+            AUDINFO ("icecast: cached listing is up to date\n");
+        else if (m_cache_file)
+        {
+            bool success = (reply->error () == QNetworkReply::NoError &&
+             ! m_reader.hasError ());
 
+            end_parse (success);
+
+            if (success && m_cache_file->isOpen () && m_cache_file->commit ())
+                aud_set_str ("streamtuner", "icecast_last_modified",
+                 reply->rawHeader ("Last-Modified").constData ());
+            else
+                m_cache_file->cancelWriting ();
+
+            delete m_cache_file;
+            m_cache_file = nullptr;
+        }
+
+        reply->deleteLater ();
+    });
+}
+
+void IcecastTunerModel::begin_parse (bool replace)
+{
+    m_reader.clear ();
+    m_entry = IcecastEntry ();
+    m_field = NoField;
+    m_text.clear ();
+    m_pending.clear ();
+    m_replace = replace;
+}
+
+// feeds the next piece of the listing to the parser; returns false on error
+bool IcecastTunerModel::parse (const QByteArray & data)
+{
+    // lets prefab some atoms for fast comparisons
+    static const QString entry_atom = QString ("entry");
+    static const QString server_name_atom = QString ("server_name");
+    static const QString listen_url_atom = QString ("listen_url");
+    static const QString server_type_atom = QString ("server_type");
+    static const QString bitrate_atom = QString ("bitrate");
+    static const QString genre_atom = QString ("genre");
+    static const QString current_song_atom = QString ("current_song");
+    static const QString mp3_atom = QString ("audio/mpeg");
+    static const QString aac_atom = QString ("audio/aacp");
+    static const QString vorbis_atom = QString ("application/ogg");
+
+    m_reader.addData (data);
+
+    // element text is collected token by token, since an element may be
+    // split across two pieces of data
+    while (! m_reader.atEnd ()) {
+        auto token_type = m_reader.readNext ();
+
+        switch (token_type) {
+        case QXmlStreamReader::StartElement:
+            if (! m_reader.name ().compare (server_name_atom))
+                m_field = TitleField;
+            else if (! m_reader.name ().compare (listen_url_atom))
+                m_field = StreamURIField;
+            else if (! m_reader.name ().compare (current_song_atom))
+                m_field = CurrentSongField;
+            else if (! m_reader.name ().compare (genre_atom))
+                m_field = GenreField;
+            else if (! m_reader.name ().compare (server_type_atom))
+                m_field = TypeField;
+            else if (! m_reader.name ().compare (bitrate_atom))
+                m_field = BitrateField;
+            else
+                m_field = NoField;
+
+            m_text.clear ();
+            break;
+        case QXmlStreamReader::Characters:
+            if (m_field != NoField)
+                m_text += m_reader.text ();
+
+            break;
+        case QXmlStreamReader::EndElement:
+            switch (m_field) {
+            case TitleField:
+                m_entry.title = m_text;
+                break;
+            case StreamURIField:
+                m_entry.stream_uri = m_text;
+                break;
+            case CurrentSongField:
+                m_entry.current_song = m_text;
+                break;
+            case GenreField:
+                m_entry.genre = m_text;
+                break;
+            case TypeField:
+                if (! m_text.compare (mp3_atom))
+                    m_entry.type = IcecastEntry::MP3;
+                else if (! m_text.compare (aac_atom))
+                    m_entry.type = IcecastEntry::AAC;
+                else if (! m_text.compare (vorbis_atom))
+                    m_entry.type = IcecastEntry::Vorbis;
+                else
+                    m_entry.type = IcecastEntry::Other;
+                break;
+            case BitrateField:
+                m_entry.bitrate = m_text.toInt ();
                 break;
             default:
                 break;
             }
+
+            m_field = NoField;
+
+            if (! m_reader.name ().compare (entry_atom))
+            {
+                m_pending.append (std::move (m_entry));
+                m_entry = IcecastEntry ();
+
+                if (! m_replace && m_pending.len () >= INSERT_BATCH)
+                    flush_pending ();
+            }
+
+            break;
+        default:
+            break;
         }
+    }
+
+    if (! m_replace)
+        flush_pending ();
+
+    if (! m_reader.hasError () ||
+     m_reader.error () == QXmlStreamReader::PrematureEndOfDocumentError)
+        return true;
 
+    AUDERR ("icecast: %s\n", m_reader.errorString ().toUtf8 ().constData ());
+    return false;
+}
+
+void IcecastTunerModel::end_parse (bool success)
+{
+    if (m_replace && success)
+    {
+        beginResetModel ();
+        m_results = std::move (m_pending);
         endResetModel ();
-    });
+
+        AUDINFO ("icecast: got %d stations\n", m_results.len ());
+    }
+    else if (! m_replace)
+        flush_pending ();
+
+    m_pending.clear ();
+    m_reader.clear ();
+}
+
+void IcecastTunerModel::flush_pending ()
+{
+    if (! m_pending.len ())
+        return;
+
+    int row = m_results.len ();
+
+    beginInsertRows (QModelIndex (), row, row + m_pending.len () - 1);
+    m_results.move_from (m_pending, 0, -1, -1, true, true);
+    endInsertRows ();
 }
 
 const IcecastEntry & IcecastTunerModel::entry (int idx) const
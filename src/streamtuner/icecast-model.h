@@ -30,6 +30,10 @@
 #include <QVBoxLayout>
 #include <QSplitter>
 #include <QAbstractListModel>
+#include <QXmlStreamReader>
+
+class QNetworkAccessManager;
+class QSaveFile;
 
 struct IcecastEntry {
     QString title;
@@ -71,6 +75,39 @@ public:
     const IcecastEntry & entry (int idx) const;
 
 private:
+    enum Field {
+        NoField,
+        TitleField,
+        GenreField,
+        TypeField,
+        BitrateField,
+        CurrentSongField,
+        StreamURIField
+    };
+
+    void load_cache ();
+    void parse_cached (QByteArray data, int pos);
+
+    void begin_parse (bool replace);
+    bool parse (const QByteArray & data);
+    void end_parse (bool success);
+    void flush_pending ();
+
+    QNetworkAccessManager * m_qnam;
+
+    // incremental parser state
+    QXmlStreamReader m_reader;
+    IcecastEntry m_entry;
+    Field m_field = NoField;
+    QString m_text;
+
+    // parsed entries not yet in the model; when a listing replaces one that
+    // is already shown, they are held back until the whole listing is in
+    Index<IcecastEntry> m_pending;
+    bool m_replace = false;
+
+    QSaveFile * m_cache_file = nullptr;
+
     Index<IcecastEntry> m_results;
 };
 
@@ -120,18 +120,18 @@ void XSFFile::ReadXSF(std::istream &xSF, uint32_t programSizeOffset, uint32_t pr
 			xSF.read(reinterpret_cast<char *>(&this->rawData[reservedSize + 16]), programCompressedSize);
 		else
 		{
-			auto programSectionCompressed = std::vector<uint8_t>(programCompressedSize);
-			xSF.read(reinterpret_cast<char *>(&programSectionCompressed[0]), programCompressedSize);
-      std::memcpy(&this->rawData[reservedSize + 16], &programSectionCompressed[0], programCompressedSize);
+			// inflate straight out of rawData rather than a separate copy
+			const uint8_t *programSectionCompressed = &this->rawData[reservedSize + 16];
+			xSF.read(reinterpret_cast<char *>(&this->rawData[reservedSize + 16]), programCompressedSize);
 
 			auto programSectionUncompressed = std::vector<uint8_t>(programHeaderSize);
 			unsigned long programUncompressedSize = programHeaderSize;
-			uncompress(&programSectionUncompressed[0], &programUncompressedSize, &programSectionCompressed[0], programCompressedSize);
+			uncompress(&programSectionUncompressed[0], &programUncompressedSize, programSectionCompressed, programCompressedSize);
       if (programUncompressedSize) {
         programUncompressedSize = Get32BitsLE(&programSectionUncompressed[programSizeOffset]) + programHeaderSize;
       }
 			this->programSection.resize(programUncompressedSize);
-			uncompress(&this->programSection[0], &programUncompressedSize, &programSectionCompressed[0], programCompressedSize);
+			uncompress(&this->programSection[0], &programUncompressedSize, programSectionCompressed, programCompressedSize);
 		}
 	}
 
@@ -208,7 +208,7 @@ std::vector<uint8_t> &XSFFile::GetReservedSection()
 	return this->reservedSection;
 }
 
-std::vector<uint8_t> XSFFile::GetReservedSection() const
+const std::vector<uint8_t> &XSFFile::GetReservedSection() const
 {
 	return this->reservedSection;
 }
@@ -218,7 +218,7 @@ std::vector<uint8_t> &XSFFile::GetProgramSection()
 	return this->programSection;
 }
 
-std::vector<uint8_t> XSFFile::GetProgramSection() const
+const std::vector<uint8_t> &XSFFile::GetProgramSection() const
 {
 	return this->programSection;
 }
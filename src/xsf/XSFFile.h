@@ -54,9 +54,9 @@ public:
 	void Clear();
 	bool HasFile() const;
 	std::vector<uint8_t> &GetReservedSection();
-	std::vector<uint8_t> GetReservedSection() const;
+	const std::vector<uint8_t> &GetReservedSection() const;
 	std::vector<uint8_t> &GetProgramSection();
-	std::vector<uint8_t> GetProgramSection() const;
+	const std::vector<uint8_t> &GetProgramSection() const;
 	void SetTag(const std::string &name, const std::string &value);
 	bool GetTagExists(const std::string &name) const;
 	std::string GetTagValue(const std::string &name) const;
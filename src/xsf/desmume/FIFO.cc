@@ -25,11 +25,9 @@
 #include "NDSSystem.h"
 
 // ========================================================= IPC FIFO
-IPC_FIFO ipc_fifo[2]; // 0 - ARM9, 1 - ARM7
-
 void IPC_FIFOinit(uint8_t proc)
 {
-	memset(&ipc_fifo[proc], 0, sizeof(IPC_FIFO));
+	memset(&MMU.ipc_fifo[proc], 0, sizeof(IPC_FIFO));
 	T1WriteWord(MMU.MMU_MEM[proc][0x40], 0x184, 0x00000101);
 }
 
@@ -40,7 +38,7 @@ void IPC_FIFOsend(uint8_t proc, uint32_t val)
 		return; // FIFO disabled
 	uint8_t proc_remote = proc ^ 1;
 
-	if (ipc_fifo[proc].size > 15)
+	if (MMU.ipc_fifo[proc].size > 15)
 	{
 		cnt_l |= IPCFIFOCNT_FIFOERROR;
 		T1WriteWord(MMU.MMU_MEM[proc][0x40], 0x184, cnt_l);
@@ -51,13 +49,13 @@ void IPC_FIFOsend(uint8_t proc, uint32_t val)
 
 	cnt_l &= 0xBFFC; // clear send empty bit & full
 	cnt_r &= 0xBCFF; // set recv empty bit & full
-	ipc_fifo[proc].buf[ipc_fifo[proc].tail] = val;
-	++ipc_fifo[proc].tail;
-	++ipc_fifo[proc].size;
-	if (ipc_fifo[proc].tail > 15)
-		ipc_fifo[proc].tail = 0;
+	MMU.ipc_fifo[proc].buf[MMU.ipc_fifo[proc].tail] = val;
+	++MMU.ipc_fifo[proc].tail;
+	++MMU.ipc_fifo[proc].size;
+	if (MMU.ipc_fifo[proc].tail > 15)
+		MMU.ipc_fifo[proc].tail = 0;
 
-	if (ipc_fifo[proc].size > 15)
+	if (MMU.ipc_fifo[proc].size > 15)
 	{
 		cnt_l |= IPCFIFOCNT_SENDFULL; // set send full bit
 		cnt_r |= IPCFIFOCNT_RECVFULL; // set recv full bit
@@ -81,7 +79,7 @@ uint32_t IPC_FIFOrecv(uint8_t proc)
 
 	uint32_t val = 0;
 
-	if (!ipc_fifo[proc_remote].size) // remote FIFO error
+	if (!MMU.ipc_fifo[proc_remote].size) // remote FIFO error
 	{
 		cnt_l |= IPCFIFOCNT_FIFOERROR;
 		T1WriteWord(MMU.MMU_MEM[proc][0x40], 0x184, cnt_l);
@@ -93,13 +91,13 @@ uint32_t IPC_FIFOrecv(uint8_t proc)
 	cnt_l &= 0xBCFF; // clear send full bit & empty
 	cnt_r &= 0xBFFC; // set recv full bit & empty
 
-	val = ipc_fifo[proc_remote].buf[ipc_fifo[proc_remote].head];
-	++ipc_fifo[proc_remote].head;
-	--ipc_fifo[proc_remote].size;
-	if (ipc_fifo[proc_remote].head > 15)
-		ipc_fifo[proc_remote].head = 0;
+	val = MMU.ipc_fifo[proc_remote].buf[MMU.ipc_fifo[proc_remote].head];
+	++MMU.ipc_fifo[proc_remote].head;
+	--MMU.ipc_fifo[proc_remote].size;
+	if (MMU.ipc_fifo[proc_remote].head > 15)
+		MMU.ipc_fifo[proc_remote].head = 0;
 
-	if (!ipc_fifo[proc_remote].size) // FIFO empty
+	if (!MMU.ipc_fifo[proc_remote].size) // FIFO empty
 	{
 		cnt_l |= IPCFIFOCNT_RECVEMPTY;
 		cnt_r |= IPCFIFOCNT_SENDEMPTY;
@@ -127,9 +125,9 @@ void IPC_FIFOcnt(uint8_t proc, uint16_t val)
 
 	if (val & IPCFIFOCNT_SENDCLEAR)
 	{
-		ipc_fifo[proc].head = 0;
-		ipc_fifo[proc].tail = 0;
-		ipc_fifo[proc].size = 0;
+		MMU.ipc_fifo[proc].head = 0;
+		MMU.ipc_fifo[proc].tail = 0;
+		MMU.ipc_fifo[proc].size = 0;
 
 		cnt_l |= IPCFIFOCNT_SENDEMPTY;
 		cnt_r |= IPCFIFOCNT_RECVEMPTY;
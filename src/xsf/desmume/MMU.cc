@@ -64,59 +64,58 @@ static uint64_t isqrt(uint64_t x)
 	return root;
 }
 
-uint32_t partie = 1;
-uint32_t _MMU_MAIN_MEM_MASK = 0x3FFFFF;
-uint32_t _MMU_MAIN_MEM_MASK16 = 0x3FFFFF & ~1;
-uint32_t _MMU_MAIN_MEM_MASK32 = 0x3FFFFF & ~3;
+#define partie (nds_inst->partie)
 
-MMU_struct MMU;
-MMU_struct_new MMU_new;
-MMU_struct_timing MMU_timing;
-
-uint8_t *MMU_struct::MMU_MEM[2][256] =
+// points into this thread's MMU, so it is filled in by MMU_Init
+static void MMU_InitMemMap()
 {
-	//arm9
+	uint8_t *const map[2][256] =
 	{
-		/* 0X*/	DUP16(MMU.ARM9_ITCM),
-		/* 1X*/	//DUP16(MMU.ARM9_ITCM)
-		/* 1X*/	DUP16(MMU.UNUSED_RAM),
-		/* 2X*/	DUP16(MMU.MAIN_MEM),
-		/* 3X*/	DUP16(MMU.SWIRAM),
-		/* 4X*/	DUP16(MMU.ARM9_REG),
-		/* 5X*/	DUP16(MMU.ARM9_VMEM),
-		/* 6X*/	DUP16(MMU.ARM9_LCD),
-		/* 7X*/	DUP16(MMU.ARM9_OAM),
-		/* 8X*/	DUP16(nullptr),
-		/* 9X*/	DUP16(nullptr),
-		/* AX*/	DUP16(MMU.UNUSED_RAM),
-		/* BX*/	DUP16(MMU.UNUSED_RAM),
-		/* CX*/	DUP16(MMU.UNUSED_RAM),
-		/* DX*/	DUP16(MMU.UNUSED_RAM),
-		/* EX*/	DUP16(MMU.UNUSED_RAM),
-		/* FX*/	DUP16(MMU.ARM9_BIOS)
-	},
-	//arm7
-	{
-		/* 0X*/	DUP16(MMU.ARM7_BIOS),
-		/* 1X*/	DUP16(MMU.UNUSED_RAM),
-		/* 2X*/	DUP16(MMU.MAIN_MEM),
-		/* 3X*/	DUP8(MMU.SWIRAM),
-				DUP8(MMU.ARM7_ERAM),
-		/* 4X*/	DUP8(MMU.ARM7_REG),
-				DUP8(MMU.ARM7_WIRAM),
-		/* 5X*/	DUP16(MMU.UNUSED_RAM),
-		/* 6X*/	DUP16(MMU.ARM9_LCD),
-		/* 7X*/	DUP16(MMU.UNUSED_RAM),
-		/* 8X*/	DUP16(nullptr),
-		/* 9X*/	DUP16(nullptr),
-		/* AX*/	DUP16(MMU.UNUSED_RAM),
-		/* BX*/	DUP16(MMU.UNUSED_RAM),
-		/* CX*/	DUP16(MMU.UNUSED_RAM),
-		/* DX*/	DUP16(MMU.UNUSED_RAM),
-		/* EX*/	DUP16(MMU.UNUSED_RAM),
-		/* FX*/	DUP16(MMU.UNUSED_RAM)
-	}
-};
+		//arm9
+		{
+			/* 0X*/	DUP16(MMU.ARM9_ITCM),
+			/* 1X*/	//DUP16(MMU.ARM9_ITCM)
+			/* 1X*/	DUP16(MMU.UNUSED_RAM),
+			/* 2X*/	DUP16(MMU.MAIN_MEM),
+			/* 3X*/	DUP16(MMU.SWIRAM),
+			/* 4X*/	DUP16(MMU.ARM9_REG),
+			/* 5X*/	DUP16(MMU.ARM9_VMEM),
+			/* 6X*/	DUP16(MMU.ARM9_LCD),
+			/* 7X*/	DUP16(MMU.ARM9_OAM),
+			/* 8X*/	DUP16(nullptr),
+			/* 9X*/	DUP16(nullptr),
+			/* AX*/	DUP16(MMU.UNUSED_RAM),
+			/* BX*/	DUP16(MMU.UNUSED_RAM),
+			/* CX*/	DUP16(MMU.UNUSED_RAM),
+			/* DX*/	DUP16(MMU.UNUSED_RAM),
+			/* EX*/	DUP16(MMU.UNUSED_RAM),
+			/* FX*/	DUP16(MMU.ARM9_BIOS)
+		},
+		//arm7
+		{
+			/* 0X*/	DUP16(MMU.ARM7_BIOS),
+			/* 1X*/	DUP16(MMU.UNUSED_RAM),
+			/* 2X*/	DUP16(MMU.MAIN_MEM),
+			/* 3X*/	DUP8(MMU.SWIRAM),
+					DUP8(MMU.ARM7_ERAM),
+			/* 4X*/	DUP8(MMU.ARM7_REG),
+					DUP8(MMU.ARM7_WIRAM),
+			/* 5X*/	DUP16(MMU.UNUSED_RAM),
+			/* 6X*/	DUP16(MMU.ARM9_LCD),
+			/* 7X*/	DUP16(MMU.UNUSED_RAM),
+			/* 8X*/	DUP16(nullptr),
+			/* 9X*/	DUP16(nullptr),
+			/* AX*/	DUP16(MMU.UNUSED_RAM),
+			/* BX*/	DUP16(MMU.UNUSED_RAM),
+			/* CX*/	DUP16(MMU.UNUSED_RAM),
+			/* DX*/	DUP16(MMU.UNUSED_RAM),
+			/* EX*/	DUP16(MMU.UNUSED_RAM),
+			/* FX*/	DUP16(MMU.UNUSED_RAM)
+		}
+	};
+
+	memcpy(MMU.MMU_MEM, map, sizeof(map));
+}
 
 uint32_t MMU_struct::MMU_MASK[2][256] =
 {
@@ -173,15 +172,11 @@ uint32_t MMU_struct::MMU_MASK[2][256] =
 // for all of the below, values = 41 indicate unmapped memory
 static const uint8_t VRAM_PAGE_UNMAPPED = 41;
 
-static const unsigned VRAM_LCDC_PAGES = 41;
-static uint8_t vram_lcdc_map[VRAM_LCDC_PAGES];
-
-// in the range of 0x06000000 - 0x06800000 in 16KB pages (the ARM9 vram mappable area)
-// this maps to 16KB pages in the LCDC buffer which is what will actually contain the data
-uint8_t vram_arm9_map[VRAM_ARM9_PAGES];
-
-// this chooses which banks are mapped in the 128K banks starting at 0x06000000 in ARM7
-static uint8_t vram_arm7_map[2];
+// the maps themselves live in MMU_struct:
+// vram_lcdc_map - the LCDC pages
+// vram_arm9_map - 0x06000000 - 0x06800000 in 16KB pages (the ARM9 vram mappable area),
+//   mapped to 16KB pages in the LCDC buffer which is what will actually contain the data
+// vram_arm7_map - which banks are mapped in the 128K banks starting at 0x06000000 in ARM7
 
 struct TVramBankInfo
 {
@@ -309,14 +304,14 @@ static inline uint32_t MMU_LCDmap(int PROCNUM, uint32_t addr, bool &unmapped, bo
 		// already in LCDC range. just look it up to see whether it is unmapped
 		vram_page = (addr >> 14) & 63;
 		assert(vram_page < VRAM_LCDC_PAGES);
-		vram_page = vram_lcdc_map[vram_page];
+		vram_page = MMU.vram_lcdc_map[vram_page];
 	}
 	else
 	{
 		// map addresses in BG/OBJ range to an LCDC range
 		vram_page = (addr >> 14) & (VRAM_ARM9_PAGES - 1);
 		assert(vram_page < VRAM_ARM9_PAGES);
-		vram_page = vram_arm9_map[vram_page];
+		vram_page = MMU.vram_arm9_map[vram_page];
 	}
 
 	if (vram_page == VRAM_PAGE_UNMAPPED)
@@ -328,7 +323,6 @@ static inline uint32_t MMU_LCDmap(int PROCNUM, uint32_t addr, bool &unmapped, bo
 		return LCDC_HACKY_LOCATION + (vram_page << 14) + ofs;
 }
 
-VramConfiguration vramConfiguration;
 
 // maps the specified bank to LCDC
 static inline void MMU_vram_lcdc(int bank)
@@ -336,7 +330,7 @@ static inline void MMU_vram_lcdc(int bank)
 	for (int i = 0; i < vram_bank_info[bank].num_pages; ++i)
 	{
 		int page = vram_bank_info[bank].page_addr + i;
-		vram_lcdc_map[page] = page;
+		MMU.vram_lcdc_map[page] = page;
 	}
 }
 
@@ -344,7 +338,7 @@ static inline void MMU_vram_lcdc(int bank)
 static inline void MMU_vram_arm9(int bank, int offset)
 {
 	for (int i = 0; i < vram_bank_info[bank].num_pages; ++i)
-		vram_arm9_map[i + offset] = vram_bank_info[bank].page_addr + i;
+		MMU.vram_arm9_map[i + offset] = vram_bank_info[bank].page_addr + i;
 }
 
 static inline uint8_t *MMU_vram_physical(int page)
@@ -376,15 +370,15 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 			switch (mst)
 			{
 				case 0: // LCDC
-					vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
 					MMU_vram_lcdc(bank);
 					break;
 				case 1: // ABG
-					vramConfiguration.banks[bank].purpose = VramConfiguration::ABG;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::ABG;
 					MMU_vram_arm9(bank, VRAM_PAGE_ABG + ofs * 8);
 					break;
 				case 2: // AOBJ
-					vramConfiguration.banks[bank].purpose = VramConfiguration::AOBJ;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::AOBJ;
 					switch (ofs)
 					{
 						case 0:
@@ -393,7 +387,7 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 					}
 					break;
 				case 3: // texture
-					vramConfiguration.banks[bank].purpose = VramConfiguration::TEX;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::TEX;
 					MMU.texInfo.textureSlotAddr[ofs] = MMU_vram_physical(vram_bank_info[bank].page_addr);
 					break;
 				default:
@@ -408,15 +402,15 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 			switch (mst)
 			{
 				case 0: // LCDC
-					vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
 					MMU_vram_lcdc(bank);
 					break;
 				case 1: // ABG
-					vramConfiguration.banks[bank].purpose = VramConfiguration::ABG;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::ABG;
 					MMU_vram_arm9(bank, VRAM_PAGE_ABG + ofs * 8);
 					break;
 				case 2: // arm7
-					vramConfiguration.banks[bank].purpose = VramConfiguration::ARM7;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::ARM7;
 					if (bank == 2)
 						T1WriteByte(MMU.MMU_MEM[ARMCPU_ARM7][0x40], 0x240, T1ReadByte(MMU.MMU_MEM[ARMCPU_ARM7][0x40], 0x240) | 1);
 					if (bank == 3)
@@ -425,22 +419,22 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 					{
 						case 0:
 						case 1:
-							vram_arm7_map[ofs] = vram_bank_info[bank].page_addr;
+							MMU.vram_arm7_map[ofs] = vram_bank_info[bank].page_addr;
 					}
 					break;
 				case 3: // texture
-					vramConfiguration.banks[bank].purpose = VramConfiguration::TEX;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::TEX;
 					MMU.texInfo.textureSlotAddr[ofs] = MMU_vram_physical(vram_bank_info[bank].page_addr);
 					break;
 				case 4: // BGB or BOBJ
 					if (bank == VRAM_BANK_C)
 					{
-						vramConfiguration.banks[bank].purpose = VramConfiguration::BBG;
+						MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::BBG;
 						MMU_vram_arm9(bank, VRAM_PAGE_BBG); // BBG
 					}
 					else
 					{
-						vramConfiguration.banks[bank].purpose = VramConfiguration::BOBJ;
+						MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::BOBJ;
 						MMU_vram_arm9(bank, VRAM_PAGE_BOBJ); // BOBJ
 					}
 					break;
@@ -454,26 +448,26 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 			switch (mst)
 			{
 				case 0: // LCDC
-					vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
 					MMU_vram_lcdc(bank);
 					break;
 				case 1: // ABG
-					vramConfiguration.banks[bank].purpose = VramConfiguration::ABG;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::ABG;
 					MMU_vram_arm9(bank, VRAM_PAGE_ABG);
 					break;
 				case 2: // AOBJ
-					vramConfiguration.banks[bank].purpose = VramConfiguration::AOBJ;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::AOBJ;
 					MMU_vram_arm9(bank, VRAM_PAGE_AOBJ);
 					break;
 				case 3: // texture palette
-					vramConfiguration.banks[bank].purpose = VramConfiguration::TEXPAL;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::TEXPAL;
 					MMU.texInfo.texPalSlot[0] = MMU_vram_physical(vram_bank_info[bank].page_addr);
 					MMU.texInfo.texPalSlot[1] = MMU_vram_physical(vram_bank_info[bank].page_addr + 1);
 					MMU.texInfo.texPalSlot[2] = MMU_vram_physical(vram_bank_info[bank].page_addr + 2);
 					MMU.texInfo.texPalSlot[3] = MMU_vram_physical(vram_bank_info[bank].page_addr + 3);
 					break;
 				case 4: // ABG extended palette
-					vramConfiguration.banks[bank].purpose = VramConfiguration::ABGEXTPAL;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::ABGEXTPAL;
 					MMU.ExtPal[0][0] = MMU_vram_physical(vram_bank_info[bank].page_addr);
 					MMU.ExtPal[0][1] = MMU.ExtPal[0][0]/* + ADDRESS_STEP_8KB*/;
 					MMU.ExtPal[0][2] = MMU.ExtPal[0][1]/* + ADDRESS_STEP_8KB*/;
@@ -494,21 +488,21 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 			switch (mst)
 			{
 				case 0: // LCDC
-					vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
 					MMU_vram_lcdc(bank);
 					break;
 				case 1: // ABG
-					vramConfiguration.banks[bank].purpose = VramConfiguration::ABG;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::ABG;
 					MMU_vram_arm9(bank, VRAM_PAGE_ABG + pageofs);
 					MMU_vram_arm9(bank, VRAM_PAGE_ABG + pageofs + 2); // unexpected mirroring (required by spyro eternal night)
 					break;
 				case 2: // AOBJ
-					vramConfiguration.banks[bank].purpose = VramConfiguration::AOBJ;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::AOBJ;
 					MMU_vram_arm9(bank, VRAM_PAGE_AOBJ + pageofs);
 					MMU_vram_arm9(bank, VRAM_PAGE_AOBJ + pageofs + 2); // unexpected mirroring - I have no proof, but it is inferred from the ABG above
 					break;
 				case 3: // texture palette
-					vramConfiguration.banks[bank].purpose = VramConfiguration::TEXPAL;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::TEXPAL;
 					MMU.texInfo.texPalSlot[pageofs] = MMU_vram_physical(vram_bank_info[bank].page_addr);
 					break;
 				case 4: // ABG extended palette
@@ -516,16 +510,16 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 					{
 						case 0:
 						case 1:
-							vramConfiguration.banks[bank].purpose = VramConfiguration::ABGEXTPAL;
+							MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::ABGEXTPAL;
 							MMU.ExtPal[0][ofs * 2] = MMU_vram_physical(vram_bank_info[bank].page_addr);
 							MMU.ExtPal[0][ofs * 2 + 1] = MMU.ExtPal[0][ofs * 2]/* + ADDRESS_STEP_8KB*/;
 							break;
 						default:
-							vramConfiguration.banks[bank].purpose = VramConfiguration::INVALID;
+							MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::INVALID;
 					}
 					break;
 				case 5: // AOBJ extended palette
-					vramConfiguration.banks[bank].purpose = VramConfiguration::AOBJEXTPAL;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::AOBJEXTPAL;
 					MMU.ObjExtPal[0][0] = MMU_vram_physical(vram_bank_info[bank].page_addr);
 					MMU.ObjExtPal[0][1] = MMU.ObjExtPal[0][1]/* + ADDRESS_STEP_8KB*/;
 					break;
@@ -540,16 +534,16 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 			switch (mst)
 			{
 				case 0: // LCDC
-					vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
 					MMU_vram_lcdc(bank);
 					break;
 				case 1: // BBG
-					vramConfiguration.banks[bank].purpose = VramConfiguration::BBG;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::BBG;
 					MMU_vram_arm9(bank, VRAM_PAGE_BBG);
 					MMU_vram_arm9(bank, VRAM_PAGE_BBG + 4); // unexpected mirroring
 					break;
 				case 2: // BBG extended palette
-					vramConfiguration.banks[bank].purpose = VramConfiguration::BBGEXTPAL;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::BBGEXTPAL;
 					MMU.ExtPal[1][0] = MMU_vram_physical(vram_bank_info[bank].page_addr);
 					MMU.ExtPal[1][1] = MMU.ExtPal[1][0]/* + ADDRESS_STEP_8KB*/;
 					MMU.ExtPal[1][2] = MMU.ExtPal[1][1]/* + ADDRESS_STEP_8KB*/;
@@ -565,21 +559,21 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 			switch (mst)
 			{
 				case 0: // LCDC
-					vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::LCDC;
 					MMU_vram_lcdc(bank);
 					break;
 				case 1: // BBG
-					vramConfiguration.banks[bank].purpose = VramConfiguration::BBG;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::BBG;
 					MMU_vram_arm9(bank, VRAM_PAGE_BBG + 2);
 					MMU_vram_arm9(bank, VRAM_PAGE_BBG + 3); // unexpected mirroring
 					break;
 				case 2: // BOBJ
-					vramConfiguration.banks[bank].purpose = VramConfiguration::BOBJ;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::BOBJ;
 					MMU_vram_arm9(bank, VRAM_PAGE_BOBJ);
 					MMU_vram_arm9(bank, VRAM_PAGE_BOBJ + 1); // FF3 end scene (lens flare sprite) needs this as it renders a sprite off the end of the 16KB and back around
 					break;
 				case 3: // BOBJ extended palette
-					vramConfiguration.banks[bank].purpose = VramConfiguration::BOBJEXTPAL;
+					MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::BOBJEXTPAL;
 					MMU.ObjExtPal[1][0] = MMU_vram_physical(vram_bank_info[bank].page_addr);
 					MMU.ObjExtPal[1][1] = MMU.ObjExtPal[1][1]/* + ADDRESS_STEP_8KB*/;
 					break;
@@ -589,25 +583,25 @@ static inline void MMU_VRAMmapRefreshBank(int bank)
 			break;
 	} // switch(bank)
 
-	vramConfiguration.banks[bank].ofs = ofs;
+	MMU.vramConfiguration.banks[bank].ofs = ofs;
 
 	return;
 
 unsupported_mst:
-	vramConfiguration.banks[bank].purpose = VramConfiguration::INVALID;
+	MMU.vramConfiguration.banks[bank].purpose = VramConfiguration::INVALID;
 }
 
 void MMU_VRAM_unmap_all()
 {
-	vramConfiguration.clear();
+	MMU.vramConfiguration.clear();
 
-	vram_arm7_map[0] = VRAM_PAGE_UNMAPPED;
-	vram_arm7_map[1] = VRAM_PAGE_UNMAPPED;
+	MMU.vram_arm7_map[0] = VRAM_PAGE_UNMAPPED;
+	MMU.vram_arm7_map[1] = VRAM_PAGE_UNMAPPED;
 
 	for (unsigned i = 0; i < VRAM_LCDC_PAGES; ++i)
-		vram_lcdc_map[i] = VRAM_PAGE_UNMAPPED;
+		MMU.vram_lcdc_map[i] = VRAM_PAGE_UNMAPPED;
 	for (int i = 0; i < VRAM_ARM9_PAGES; ++i)
-		vram_arm9_map[i] = VRAM_PAGE_UNMAPPED;
+		MMU.vram_arm9_map[i] = VRAM_PAGE_UNMAPPED;
 
 	for (int i = 0; i < 4; ++i)
 	{
@@ -671,7 +665,7 @@ static inline void MMU_VRAMmapControl(uint8_t block, uint8_t VRAMBankCnt)
 	MMU_VRAMmapRefreshBank(VRAM_BANK_C);
 	MMU_VRAMmapRefreshBank(VRAM_BANK_D);
 
-	//fprintf(stderr, vramConfiguration.describe().c_str());
+	//fprintf(stderr, MMU.vramConfiguration.describe().c_str());
 	//fprintf(stderr, "vram remapped at vcount=%d\n",nds.VCount);
 
 	// -------------------------------
@@ -704,7 +698,7 @@ static inline void MMU_VRAMmapControl(uint8_t block, uint8_t VRAMBankCnt)
 		for (int i = size; i < 128; ++i)
 		{
 			int page = type + i;
-			vram_arm9_map[page] = vram_arm9_map[type + (i & mask)];
+			MMU.vram_arm9_map[page] = MMU.vram_arm9_map[type + (i & mask)];
 		}
 	}
 }
@@ -716,6 +710,7 @@ static inline void MMU_VRAMmapControl(uint8_t block, uint8_t VRAMBankCnt)
 void MMU_Init()
 {
 	memset((void*)&MMU, 0, sizeof(MMU_struct));
+	MMU_InitMemMap();
 
 	MMU.CART_ROM = MMU.UNUSED_RAM;
 
@@ -1484,15 +1479,15 @@ template<int PROCNUM> void DmaController::doCopy()
 		{
 			time_elapsed += _MMU_accesstime<PROCNUM, MMU_AT_DMA, 32, MMU_AD_READ, true>(src, true);
 			time_elapsed += _MMU_accesstime<PROCNUM, MMU_AT_DMA, 32, MMU_AD_WRITE, true>(dst, true);
-			uint32_t temp = _MMU_read32(procnum, MMU_AT_DMA, src);
-			_MMU_write32(procnum, MMU_AT_DMA, dst, temp);
+			uint32_t temp = _MMU_read32(nds_inst, procnum, MMU_AT_DMA, src);
+			_MMU_write32(nds_inst, procnum, MMU_AT_DMA, dst, temp);
 		}
 		else
 		{
 			time_elapsed += _MMU_accesstime<PROCNUM, MMU_AT_DMA, 16, MMU_AD_READ, true>(src, true);
 			time_elapsed += _MMU_accesstime<PROCNUM, MMU_AT_DMA, 16, MMU_AD_WRITE, true>(dst, true);
-			uint16_t temp = _MMU_read16(procnum, MMU_AT_DMA, src);
-			_MMU_write16(procnum, MMU_AT_DMA, dst, temp);
+			uint16_t temp = _MMU_read16(nds_inst, procnum, MMU_AT_DMA, src);
+			_MMU_write16(nds_inst, procnum, MMU_AT_DMA, dst, temp);
 		}
 		dst += dstinc;
 		src += srcinc;
@@ -1588,7 +1583,7 @@ uint32_t DmaController::read32()
 // =========================================================================================================
 // =========================================================================================================
 // ================================================= MMU write 08
-void FASTCALL _MMU_ARM9_write08(uint32_t adr, uint8_t val)
+void FASTCALL _MMU_ARM9_write08(NDS_Instance *nds_inst, uint32_t adr, uint8_t val)
 {
 	adr &= 0x0FFFFFFF;
 
@@ -1680,7 +1675,7 @@ void FASTCALL _MMU_ARM9_write08(uint32_t adr, uint8_t val)
 }
 
 // ================================================= MMU ARM9 write 16
-void FASTCALL _MMU_ARM9_write16(uint32_t adr, uint16_t val)
+void FASTCALL _MMU_ARM9_write16(NDS_Instance *nds_inst, uint32_t adr, uint16_t val)
 {
 	adr &= 0x0FFFFFFE;
 
@@ -1818,7 +1813,7 @@ void FASTCALL _MMU_ARM9_write16(uint32_t adr, uint16_t val)
 }
 
 // ================================================= MMU ARM9 write 32
-void FASTCALL _MMU_ARM9_write32(uint32_t adr, uint32_t val)
+void FASTCALL _MMU_ARM9_write32(NDS_Instance *nds_inst, uint32_t adr, uint32_t val)
 {
 	adr &= 0x0FFFFFFC;
 
@@ -1958,7 +1953,7 @@ void FASTCALL _MMU_ARM9_write32(uint32_t adr, uint32_t val)
 }
 
 // ================================================= MMU ARM9 read 08
-uint8_t FASTCALL _MMU_ARM9_read08(uint32_t adr)
+uint8_t FASTCALL _MMU_ARM9_read08(NDS_Instance *nds_inst, uint32_t adr)
 {
 	adr &= 0x0FFFFFFF;
 
@@ -2027,7 +2022,7 @@ uint8_t FASTCALL _MMU_ARM9_read08(uint32_t adr)
 }
 
 // ================================================= MMU ARM9 read 16
-uint16_t FASTCALL _MMU_ARM9_read16(uint32_t adr)
+uint16_t FASTCALL _MMU_ARM9_read16(NDS_Instance *nds_inst, uint32_t adr)
 {
 	adr &= 0x0FFFFFFE;
 
@@ -2094,7 +2089,7 @@ uint16_t FASTCALL _MMU_ARM9_read16(uint32_t adr)
 }
 
 // ================================================= MMU ARM9 read 32
-uint32_t FASTCALL _MMU_ARM9_read32(uint32_t adr)
+uint32_t FASTCALL _MMU_ARM9_read32(NDS_Instance *nds_inst, uint32_t adr)
 {
 	adr &= 0x0FFFFFFC;
 
@@ -2166,7 +2161,7 @@ uint32_t FASTCALL _MMU_ARM9_read32(uint32_t adr)
 // =========================================================================================================
 // =========================================================================================================
 // ================================================= MMU ARM7 write 08
-void FASTCALL _MMU_ARM7_write08(uint32_t adr, uint8_t val)
+void FASTCALL _MMU_ARM7_write08(NDS_Instance *nds_inst, uint32_t adr, uint8_t val)
 {
 	adr &= 0x0FFFFFFF;
 
@@ -2219,7 +2214,7 @@ void FASTCALL _MMU_ARM7_write08(uint32_t adr, uint8_t val)
 				// hack for patched firmwares
 				if (val == 1)
 				{
-					if (_MMU_ARM7_read08(REG_POSTFLG))
+					if (_MMU_ARM7_read08(nds_inst, REG_POSTFLG))
 						break;
 					_MMU_write32<ARMCPU_ARM9>(0x27FFE24, gameInfo.header.ARM9exe);
 					_MMU_write32<ARMCPU_ARM7>(0x27FFE34, gameInfo.header.ARM7exe);
@@ -2247,7 +2242,7 @@ void FASTCALL _MMU_ARM7_write08(uint32_t adr, uint8_t val)
 }
 
 // ================================================= MMU ARM7 write 16
-void FASTCALL _MMU_ARM7_write16(uint32_t adr, uint16_t val)
+void FASTCALL _MMU_ARM7_write16(NDS_Instance *nds_inst, uint32_t adr, uint16_t val)
 {
 	adr &= 0x0FFFFFFE;
 
@@ -2543,7 +2538,7 @@ void FASTCALL _MMU_ARM7_write16(uint32_t adr, uint16_t val)
 }
 
 // ================================================= MMU ARM7 write 32
-void FASTCALL _MMU_ARM7_write32(uint32_t adr, uint32_t val)
+void FASTCALL _MMU_ARM7_write32(NDS_Instance *nds_inst, uint32_t adr, uint32_t val)
 {
 	adr &= 0x0FFFFFFC;
 
@@ -2623,7 +2618,7 @@ void FASTCALL _MMU_ARM7_write32(uint32_t adr, uint32_t val)
 }
 
 // ================================================= MMU ARM7 read 08
-uint8_t FASTCALL _MMU_ARM7_read08(uint32_t adr)
+uint8_t FASTCALL _MMU_ARM7_read08(NDS_Instance *nds_inst, uint32_t adr)
 {
 	adr &= 0x0FFFFFFF;
 
@@ -2670,7 +2665,7 @@ uint8_t FASTCALL _MMU_ARM7_read08(uint32_t adr)
 }
 
 // ================================================= MMU ARM7 read 16
-uint16_t FASTCALL _MMU_ARM7_read16(uint32_t adr)
+uint16_t FASTCALL _MMU_ARM7_read16(NDS_Instance *nds_inst, uint32_t adr)
 {
 	adr &= 0x0FFFFFFE;
 
@@ -2728,7 +2723,7 @@ uint16_t FASTCALL _MMU_ARM7_read16(uint32_t adr)
 }
 
 // ================================================= MMU ARM7 read 32
-uint32_t FASTCALL _MMU_ARM7_read32(uint32_t adr)
+uint32_t FASTCALL _MMU_ARM7_read32(NDS_Instance *nds_inst, uint32_t adr)
 {
 	adr &= 0x0FFFFFFC;
 
@@ -298,6 +298,62 @@ struct nds_dscard
 #define DUP8(x)  x, x, x, x,  x, x, x, x
 #define DUP16(x) x, x, x, x,  x, x, x, x,  x, x, x, x,  x, x, x, x
 
+#define VRAM_BANKS 9
+#define VRAM_BANK_A 0
+#define VRAM_BANK_B 1
+#define VRAM_BANK_C 2
+#define VRAM_BANK_D 3
+#define VRAM_BANK_E 4
+#define VRAM_BANK_F 5
+#define VRAM_BANK_G 6
+#define VRAM_BANK_H 7
+#define VRAM_BANK_I 8
+
+#define VRAM_PAGE_ABG 0
+#define VRAM_PAGE_BBG 128
+#define VRAM_PAGE_AOBJ 256
+#define VRAM_PAGE_BOBJ 384
+
+struct VramConfiguration
+{
+	enum Purpose
+	{
+		OFF,
+		INVALID,
+		ABG,
+		BBG,
+		AOBJ,
+		BOBJ,
+		LCDC,
+		ARM7,
+		TEX,
+		TEXPAL,
+		ABGEXTPAL,
+		BBGEXTPAL,
+		AOBJEXTPAL,
+		BOBJEXTPAL
+	};
+
+	struct BankInfo
+	{
+		Purpose purpose;
+		int ofs;
+	} banks[VRAM_BANKS];
+
+	void clear()
+	{
+		for (int i = 0; i < VRAM_BANKS; ++i)
+		{
+			banks[i].ofs = 0;
+			banks[i].purpose = OFF;
+		}
+	}
+};
+
+// in 16KB pages; 41 marks an unmapped page
+const int VRAM_LCDC_PAGES = 41;
+const int VRAM_ARM9_PAGES = 512;
+
 struct MMU_struct
 {
 	//ARM9 mem
@@ -358,7 +414,7 @@ struct MMU_struct
 	// (also since the emulator doesn't prevent unaligned accesses)
 	uint8_t MORE_UNUSED_RAM[4];
 
-	static uint8_t *MMU_MEM[2][256];
+	uint8_t *MMU_MEM[2][256];
 	static uint32_t MMU_MASK[2][256];
 
 	uint8_t ARM9_RW_MODE;
@@ -405,6 +461,14 @@ struct MMU_struct
 	memory_chip_t fw;
 
 	nds_dscard dscard[2];
+
+	IPC_FIFO ipc_fifo[2]; // 0 - ARM9, 1 - ARM7
+
+	// vram bank mapping, see MMU_VRAMmapControl
+	uint8_t vram_lcdc_map[VRAM_LCDC_PAGES];
+	uint8_t vram_arm9_map[VRAM_ARM9_PAGES];
+	uint8_t vram_arm7_map[2];
+	VramConfiguration vramConfiguration;
 };
 
 // everything in here is derived from libnds behaviours. no hardware tests yet
@@ -444,8 +508,8 @@ struct MMU_struct_new
 	bool is_dma(uint32_t adr) { return adr >= _REG_DMA_CONTROL_MIN && adr <= _REG_DMA_CONTROL_MAX; }
 };
 
-extern MMU_struct MMU;
-extern MMU_struct_new MMU_new;
+#define MMU (nds_inst->mmu)
+#define MMU_new (nds_inst->mmu_new)
 
 void MMU_Init();
 void MMU_DeInit();
@@ -455,63 +519,6 @@ void MMU_Reset();
 void MMU_setRom(uint8_t *rom, uint32_t mask);
 void MMU_unsetRom();
 
-#define VRAM_BANKS 9
-#define VRAM_BANK_A 0
-#define VRAM_BANK_B 1
-#define VRAM_BANK_C 2
-#define VRAM_BANK_D 3
-#define VRAM_BANK_E 4
-#define VRAM_BANK_F 5
-#define VRAM_BANK_G 6
-#define VRAM_BANK_H 7
-#define VRAM_BANK_I 8
-
-#define VRAM_PAGE_ABG 0
-#define VRAM_PAGE_BBG 128
-#define VRAM_PAGE_AOBJ 256
-#define VRAM_PAGE_BOBJ 384
-
-struct VramConfiguration
-{
-	enum Purpose
-	{
-		OFF,
-		INVALID,
-		ABG,
-		BBG,
-		AOBJ,
-		BOBJ,
-		LCDC,
-		ARM7,
-		TEX,
-		TEXPAL,
-		ABGEXTPAL,
-		BBGEXTPAL,
-		AOBJEXTPAL,
-		BOBJEXTPAL
-	};
-
-	struct BankInfo
-	{
-		Purpose purpose;
-		int ofs;
-	} banks[VRAM_BANKS];
-
-	void clear()
-	{
-		for (int i = 0; i < VRAM_BANKS; ++i)
-		{
-			banks[i].ofs = 0;
-			banks[i].purpose = OFF;
-		}
-	}
-};
-
-extern VramConfiguration vramConfiguration;
-
-const int VRAM_ARM9_PAGES = 512;
-extern uint8_t vram_arm9_map[VRAM_ARM9_PAGES];
-
 template<int PROCNUM, MMU_ACCESS_TYPE AT> uint8_t _MMU_read08(uint32_t addr);
 template<int PROCNUM, MMU_ACCESS_TYPE AT> uint16_t _MMU_read16(uint32_t addr);
 template<int PROCNUM, MMU_ACCESS_TYPE AT> uint32_t _MMU_read32(uint32_t addr);
@@ -526,279 +533,24 @@ template<int PROCNUM> inline void _MMU_write08(uint32_t addr, uint8_t val) { _MM
 template<int PROCNUM> inline void _MMU_write16(uint32_t addr, uint16_t val) { _MMU_write16<PROCNUM, MMU_AT_DATA>(addr,val); }
 template<int PROCNUM> inline void _MMU_write32(uint32_t addr, uint32_t val) { _MMU_write32<PROCNUM, MMU_AT_DATA>(addr,val); }
 
-void FASTCALL _MMU_ARM9_write08(uint32_t adr, uint8_t val);
-void FASTCALL _MMU_ARM9_write16(uint32_t adr, uint16_t val);
-void FASTCALL _MMU_ARM9_write32(uint32_t adr, uint32_t val);
-uint8_t  FASTCALL _MMU_ARM9_read08(uint32_t adr);
-uint16_t FASTCALL _MMU_ARM9_read16(uint32_t adr);
-uint32_t FASTCALL _MMU_ARM9_read32(uint32_t adr);
-
-void FASTCALL _MMU_ARM7_write08(uint32_t adr, uint8_t val);
-void FASTCALL _MMU_ARM7_write16(uint32_t adr, uint16_t val);
-void FASTCALL _MMU_ARM7_write32(uint32_t adr, uint32_t val);
-uint8_t  FASTCALL _MMU_ARM7_read08(uint32_t adr);
-uint16_t FASTCALL _MMU_ARM7_read16(uint32_t adr);
-uint32_t FASTCALL _MMU_ARM7_read32(uint32_t adr);
-
-extern uint32_t partie;
-
-extern uint32_t _MMU_MAIN_MEM_MASK;
-extern uint32_t _MMU_MAIN_MEM_MASK16;
-extern uint32_t _MMU_MAIN_MEM_MASK32;
+void FASTCALL _MMU_ARM9_write08(NDS_Instance *nds_inst, uint32_t adr, uint8_t val);
+void FASTCALL _MMU_ARM9_write16(NDS_Instance *nds_inst, uint32_t adr, uint16_t val);
+void FASTCALL _MMU_ARM9_write32(NDS_Instance *nds_inst, uint32_t adr, uint32_t val);
+uint8_t  FASTCALL _MMU_ARM9_read08(NDS_Instance *nds_inst, uint32_t adr);
+uint16_t FASTCALL _MMU_ARM9_read16(NDS_Instance *nds_inst, uint32_t adr);
+uint32_t FASTCALL _MMU_ARM9_read32(NDS_Instance *nds_inst, uint32_t adr);
+
+void FASTCALL _MMU_ARM7_write08(NDS_Instance *nds_inst, uint32_t adr, uint8_t val);
+void FASTCALL _MMU_ARM7_write16(NDS_Instance *nds_inst, uint32_t adr, uint16_t val);
+void FASTCALL _MMU_ARM7_write32(NDS_Instance *nds_inst, uint32_t adr, uint32_t val);
+uint8_t  FASTCALL _MMU_ARM7_read08(NDS_Instance *nds_inst, uint32_t adr);
+uint16_t FASTCALL _MMU_ARM7_read16(NDS_Instance *nds_inst, uint32_t adr);
+uint32_t FASTCALL _MMU_ARM7_read32(NDS_Instance *nds_inst, uint32_t adr);
+
+#define _MMU_MAIN_MEM_MASK (nds_inst->main_mem_mask)
+#define _MMU_MAIN_MEM_MASK16 (nds_inst->main_mem_mask16)
+#define _MMU_MAIN_MEM_MASK32 (nds_inst->main_mem_mask32)
 void SetupMMU(bool debugConsole, bool dsi);
 
-// ALERT!!!!!!!!!!!!!!
-// the following inline functions dont do the 0x0FFFFFFF mask.
-// this may result in some unexpected behavior
-
-inline uint8_t _MMU_read08(int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr)
-{
-	// special handling for DMA: read 0 from TCM
-	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
-	{
-		if (addr < 0x02000000)
-			return 0; // itcm
-		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
-			return 0; // dtcm
-	}
-
-#ifdef HAVE_LUA
-	CallRegisteredLuaMemHook(addr, 1, /*FIXME*/ 0, LUAMEMHOOK_READ);
-#endif
-
-	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
-		// Returns data from DTCM (ARM9 only)
-		return T1ReadByte(MMU.ARM9_DTCM, addr & 0x3FFF);
-
-	if ((addr & 0x0F000000) == 0x02000000)
-		return T1ReadByte(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK);
-
-	if (PROCNUM == ARMCPU_ARM9)
-		return _MMU_ARM9_read08(addr);
-	else
-		return _MMU_ARM7_read08(addr);
-}
-
-inline uint16_t _MMU_read16(int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr)
-{
-	// special handling for DMA: read 0 from TCM
-	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
-	{
-		if (addr < 0x02000000)
-			return 0; // itcm
-		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
-			return 0; // dtcm
-	}
-
-#ifdef HAVE_LUA
-	CallRegisteredLuaMemHook(addr, 2, /*FIXME*/ 0, LUAMEMHOOK_READ);
-#endif
-
-	// special handling for execution from arm9, since we spend so much time in there
-	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_CODE)
-	{
-		if ((addr & 0x0F000000) == 0x02000000)
-			return T1ReadWord_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK16);
-
-		if (addr < 0x02000000)
-			return T1ReadWord_guaranteedAligned(MMU.ARM9_ITCM, addr&0x7FFE);
-
-		goto dunno;
-	}
-
-	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
-		// Returns data from DTCM (ARM9 only)
-		return T1ReadWord_guaranteedAligned(MMU.ARM9_DTCM, addr & 0x3FFE);
-
-	if ((addr & 0x0F000000) == 0x02000000)
-		return T1ReadWord_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK16);
-
-dunno:
-	if (PROCNUM == ARMCPU_ARM9)
-		return _MMU_ARM9_read16(addr);
-	else
-		return _MMU_ARM7_read16(addr);
-}
-
-inline uint32_t _MMU_read32(int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr)
-{
-	// special handling for DMA: read 0 from TCM
-	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
-	{
-		if (addr < 0x02000000)
-			return 0; // itcm
-		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
-			return 0; // dtcm
-	}
-
-#ifdef HAVE_LUA
-	CallRegisteredLuaMemHook(addr, 4, /*FIXME*/ 0, LUAMEMHOOK_READ);
-#endif
-
-	//s pecial handling for execution from arm9, since we spend so much time in there
-	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_CODE)
-	{
-		if ((addr & 0x0F000000) == 0x02000000)
-			return T1ReadLong_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK32);
-
-		if (addr < 0x02000000)
-			return T1ReadLong_guaranteedAligned(MMU.ARM9_ITCM, addr&0x7FFC);
-
-		// what happens when we execute from DTCM? nocash makes it look like we get 0xFFFFFFFF but i can't seem to verify it
-		// historically, desmume would fall through to its old memory map struct
-		// which would return unused memory (0)
-		// it seems the hardware returns 0 or something benign because in actuality 0xFFFFFFFF is an undefined opcode
-		// and we know our handling for that is solid
-
-		goto dunno;
-	}
-
-	// special handling for execution from arm7. try reading from main memory first
-	if (PROCNUM == ARMCPU_ARM7 && (addr & 0x0F000000) == 0x02000000)
-		return T1ReadLong_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK32);
-
-	// for other arm9 cases, we have to check from dtcm first because it is patched on top of the main memory range
-	if (PROCNUM == ARMCPU_ARM9)
-	{
-		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
-			// Returns data from DTCM (ARM9 only)
-			return T1ReadLong_guaranteedAligned(MMU.ARM9_DTCM, addr & 0x3FFC);
-
-		if ((addr & 0x0F000000) == 0x02000000)
-			return T1ReadLong_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK32);
-	}
-
-dunno:
-	if (PROCNUM == ARMCPU_ARM9)
-		return _MMU_ARM9_read32(addr);
-	else
-		return _MMU_ARM7_read32(addr);
-}
-
-inline void _MMU_write08(int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr, uint8_t val)
-{
-	// special handling for DMA: discard writes to TCM
-	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
-	{
-		if (addr < 0x02000000)
-			return; // itcm
-		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
-			return; // dtcm
-	}
-
-	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
-	{
-		T1WriteByte(MMU.ARM9_DTCM, addr & 0x3FFF, val);
-#ifdef HAVE_LUA
-		CallRegisteredLuaMemHook(addr, 1, val, LUAMEMHOOK_WRITE);
-#endif
-		return;
-	}
-
-	if ((addr & 0x0F000000) == 0x02000000)
-	{
-		T1WriteByte( MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK, val);
-#ifdef HAVE_LUA
-		CallRegisteredLuaMemHook(addr, 1, val, LUAMEMHOOK_WRITE);
-#endif
-		return;
-	}
-
-	if (PROCNUM == ARMCPU_ARM9)
-		_MMU_ARM9_write08(addr, val);
-	else
-		_MMU_ARM7_write08(addr, val);
-#ifdef HAVE_LUA
-	CallRegisteredLuaMemHook(addr, 1, val, LUAMEMHOOK_WRITE);
-#endif
-}
-
-inline void _MMU_write16(int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr, uint16_t val)
-{
-	// special handling for DMA: discard writes to TCM
-	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
-	{
-		if (addr < 0x02000000)
-			return; // itcm
-		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
-			return; // dtcm
-	}
-
-	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
-	{
-		T1WriteWord(MMU.ARM9_DTCM, addr & 0x3FFE, val);
-#ifdef HAVE_LUA
-		CallRegisteredLuaMemHook(addr, 2, val, LUAMEMHOOK_WRITE);
-#endif
-		return;
-	}
-
-	if ((addr & 0x0F000000) == 0x02000000)
-	{
-		T1WriteWord( MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK16, val);
-#ifdef HAVE_LUA
-		CallRegisteredLuaMemHook(addr, 2, val, LUAMEMHOOK_WRITE);
-#endif
-		return;
-	}
-
-	if (PROCNUM == ARMCPU_ARM9)
-		_MMU_ARM9_write16(addr, val);
-	else
-		_MMU_ARM7_write16(addr, val);
-#ifdef HAVE_LUA
-	CallRegisteredLuaMemHook(addr, 2, val, LUAMEMHOOK_WRITE);
-#endif
-}
-
-inline void _MMU_write32(int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr, uint32_t val)
-{
-	// special handling for DMA: discard writes to TCM
-	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
-	{
-		if (addr < 0x02000000)
-			return; // itcm
-		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
-			return; // dtcm
-	}
-
-	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
-	{
-		T1WriteLong(MMU.ARM9_DTCM, addr & 0x3FFC, val);
-#ifdef HAVE_LUA
-		CallRegisteredLuaMemHook(addr, 4, val, LUAMEMHOOK_WRITE);
-#endif
-		return;
-	}
-
-	if ((addr & 0x0F000000) == 0x02000000)
-	{
-		T1WriteLong( MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK32, val);
-#ifdef HAVE_LUA
-		CallRegisteredLuaMemHook(addr, 4, val, LUAMEMHOOK_WRITE);
-#endif
-		return;
-	}
-
-	if (PROCNUM == ARMCPU_ARM9)
-		_MMU_ARM9_write32(addr, val);
-	else
-		_MMU_ARM7_write32(addr, val);
-#ifdef HAVE_LUA
-	CallRegisteredLuaMemHook(addr, 4, val, LUAMEMHOOK_WRITE);
-#endif
-}
-
-#define READ32(a,b)		_MMU_read32<PROCNUM>((b) & 0xFFFFFFFC)
-#define WRITE32(a,b,c)	_MMU_write32<PROCNUM>((b) & 0xFFFFFFFC,c)
-#define READ16(a,b)		_MMU_read16<PROCNUM>((b) & 0xFFFFFFFE)
-#define WRITE16(a,b,c)	_MMU_write16<PROCNUM>((b) & 0xFFFFFFFE,c)
-#define READ8(a,b)		_MMU_read08<PROCNUM>(b)
-#define WRITE8(a,b,c)	_MMU_write08<PROCNUM>(b, c)
-
-template<int PROCNUM, MMU_ACCESS_TYPE AT> inline uint8_t _MMU_read08(uint32_t addr) { return _MMU_read08(PROCNUM, AT, addr); }
-template<int PROCNUM, MMU_ACCESS_TYPE AT> inline uint16_t _MMU_read16(uint32_t addr) { return _MMU_read16(PROCNUM, AT, addr); }
-template<int PROCNUM, MMU_ACCESS_TYPE AT> inline uint32_t _MMU_read32(uint32_t addr) { return _MMU_read32(PROCNUM, AT, addr); }
-template<int PROCNUM, MMU_ACCESS_TYPE AT> inline void _MMU_write08(uint32_t addr, uint8_t val) { _MMU_write08(PROCNUM, AT, addr, val); }
-template<int PROCNUM, MMU_ACCESS_TYPE AT> inline void _MMU_write16(uint32_t addr, uint16_t val) { _MMU_write16(PROCNUM, AT, addr, val); }
-template<int PROCNUM, MMU_ACCESS_TYPE AT> inline void _MMU_write32(uint32_t addr, uint32_t val) { _MMU_write32(PROCNUM, AT, addr, val); }
+// the inline accessors (READ32 and friends) need the complete NDS_Instance,
+// so they follow it at the end of NDSSystem.h
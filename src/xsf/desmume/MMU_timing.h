@@ -220,7 +220,7 @@ template<> inline FetchAccessUnit<1, MMU_AT_CODE> &MMU_struct_timing::armCodeFet
 template<> inline FetchAccessUnit<0, MMU_AT_DATA> &MMU_struct_timing::armDataFetch<0>() { return this->arm9dataFetch; }
 template<> inline FetchAccessUnit<1, MMU_AT_DATA> &MMU_struct_timing::armDataFetch<1>() { return this->arm7dataFetch; }
 
-extern MMU_struct_timing MMU_timing;
+#define MMU_timing (*nds_inst->mmu_timing)
 
 // calculates the time a single memory access takes,
 // in units of cycles of the current processor.
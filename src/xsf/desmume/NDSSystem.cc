@@ -24,42 +24,21 @@
 #include "NDSSystem.h"
 #include "MMU.h"
 #include "cp15.h"
+#include "MMU_timing.h"
 #include "bios.h"
 #include "readwrite.h"
 #include "firmware.h"
 #include "slot1.h"
+#include "SPU.h"
 
 // ===============================================================
 
-TCommonSettings CommonSettings;
-
-GameInfo gameInfo;
-NDSSystem nds;
-static std::unique_ptr<CFIRMWARE> firmware;
-volatile bool execute = false;
-
-int NDS_Init()
-{
-	MMU_Init();
-	nds.VCount = 0;
-
-	armcpu_new(&NDS_ARM7, 1);
-	armcpu_new(&NDS_ARM9, 0);
-
-	if (SPU_Init(SNDCORE_DUMMY, 740))
-		return -1;
-
-	return 0;
-}
-
-void NDS_DeInit()
-{
-	if (MMU.CART_ROM != MMU.UNUSED_RAM)
-		NDS_FreeROM();
-
-	SPU_DeInit();
-	MMU_DeInit();
-}
+// all of the console state is per thread, see NDS_Init below
+#ifdef __GNUC__
+__thread NDS_Instance *nds_inst;
+#else
+thread_local NDS_Instance *nds_inst;
+#endif
 
 bool NDS_SetROM(uint8_t *rom, uint32_t mask)
 {
@@ -147,8 +126,8 @@ enum ESI_DISPCNT
 	ESI_DISPCNT_HStart, ESI_DISPCNT_HStartIRQ, ESI_DISPCNT_HDraw, ESI_DISPCNT_HBlank
 };
 
-uint64_t nds_timer;
-static uint64_t nds_arm9_timer, nds_arm7_timer;
+#define nds_arm9_timer (nds_inst->arm9_timer)
+#define nds_arm7_timer (nds_inst->arm7_timer)
 
 struct TSequenceItem
 {
@@ -318,7 +297,7 @@ struct TSequenceItem_sqrtunit : public TSequenceItem
 	}
 };
 
-static struct Sequencer
+struct Sequencer
 {
 	bool nds_vblankEnded;
 	bool reschedule;
@@ -340,7 +319,46 @@ static struct Sequencer
 
 	void execHardware();
 	uint64_t findNext();
-} sequencer;
+};
+
+#define sequencer (*nds_inst->seq)
+
+NDS_Instance::NDS_Instance() : mmu_timing(new MMU_struct_timing()), seq(new Sequencer())
+{
+}
+
+NDS_Instance::~NDS_Instance() = default;
+
+int NDS_Init()
+{
+	// nds_inst has to be set before the members are constructed, since some
+	// of their constructors already read CommonSettings through it
+	nds_inst = static_cast<NDS_Instance *>(::operator new(sizeof(NDS_Instance)));
+	new(nds_inst) NDS_Instance();
+
+	MMU_Init();
+	nds.VCount = 0;
+
+	armcpu_new(&NDS_ARM7, 1);
+	armcpu_new(&NDS_ARM9, 0);
+
+	if (SPU_Init(SNDCORE_DUMMY, 740))
+		return -1;
+
+	return 0;
+}
+
+void NDS_DeInit()
+{
+	if (MMU.CART_ROM != MMU.UNUSED_RAM)
+		NDS_FreeROM();
+
+	SPU_DeInit();
+	MMU_DeInit();
+
+	delete nds_inst;
+	nds_inst = nullptr;
+}
 
 void NDS_RescheduleTimers()
 {
@@ -694,7 +712,7 @@ template<bool doarm9, bool doarm7> static inline int32_t minarmtime(int32_t arm9
 }
 
 template<bool doarm9, bool doarm7>
-static std::pair<int32_t, int32_t> armInnerLoop(uint64_t nds_timer_base, int32_t s32next, int32_t arm9, int32_t arm7)
+static std::pair<int32_t, int32_t> armInnerLoop(NDS_Instance *nds_inst, uint64_t nds_timer_base, int32_t s32next, int32_t arm9, int32_t arm7)
 {
 	int32_t timer = minarmtime<doarm9, doarm7>(arm9, arm7);
 	while (timer < s32next && !sequencer.reschedule && execute)
@@ -703,7 +721,7 @@ static std::pair<int32_t, int32_t> armInnerLoop(uint64_t nds_timer_base, int32_t
 		{
 			if (!NDS_ARM9.waitIRQ && !nds.freezeBus)
 			{
-				arm9 += armcpu_exec<ARMCPU_ARM9>();
+				arm9 += armcpu_exec<ARMCPU_ARM9>(nds_inst);
 			}
 			else
 				arm9 = std::min(s32next, arm9 + kIrqWait);
@@ -712,7 +730,7 @@ static std::pair<int32_t, int32_t> armInnerLoop(uint64_t nds_timer_base, int32_t
 		{
 			if (!NDS_ARM7.waitIRQ && !nds.freezeBus)
 			{
-				arm7 += armcpu_exec<ARMCPU_ARM7>() << 1;
+				arm7 += armcpu_exec<ARMCPU_ARM7>(nds_inst) << 1;
 			}
 			else
 			{
@@ -720,7 +738,7 @@ static std::pair<int32_t, int32_t> armInnerLoop(uint64_t nds_timer_base, int32_t
 				if (arm7 == s32next)
 				{
 					nds_timer = nds_timer_base + minarmtime<doarm9, false>(arm9, arm7);
-					return armInnerLoop<doarm9, false>(nds_timer_base, s32next, arm9, arm7);
+					return armInnerLoop<doarm9, false>(nds_inst, nds_timer_base, s32next, arm9, arm7);
 				}
 			}
 		}
@@ -734,6 +752,9 @@ static std::pair<int32_t, int32_t> armInnerLoop(uint64_t nds_timer_base, int32_t
 
 template<bool FORCE> void NDS_exec(int32_t)
 {
+	// read this thread's instance once; the cpu loop hands it down from here
+	NDS_Instance *const nds_inst = ::nds_inst;
+
 	sequencer.nds_vblankEnded = false;
 
 	if (nds.sleeping)
@@ -776,7 +797,9 @@ template<bool FORCE> void NDS_exec(int32_t)
 			int32_t arm7 = (nds_arm7_timer - nds_timer) & 0xFFFFFFFF;
 			int32_t s32next = (next - nds_timer) & 0xFFFFFFFF;
 
-			auto arm9arm7 = armInnerLoop<true, true>(nds_timer_base, s32next, arm9, arm7);
+			auto arm9arm7 = CommonSettings.skip_arm9 ?
+				armInnerLoop<false, true>(nds_inst, nds_timer_base, s32next, arm9, arm7) :
+				armInnerLoop<true, true>(nds_inst, nds_timer_base, s32next, arm9, arm7);
 
 			arm9 = arm9arm7.first;
 			arm7 = arm9arm7.second;
@@ -785,7 +808,7 @@ template<bool FORCE> void NDS_exec(int32_t)
 
 			// if we were waiting for an irq, don't wait too long:
 			// let's re-analyze it after this hardware event (this rolls back a big burst of irq waiting which may have been interrupted by a resynch)
-			if (NDS_ARM9.waitIRQ)
+			if (NDS_ARM9.waitIRQ || CommonSettings.skip_arm9)
 				nds_arm9_timer = nds_timer;
 			if (NDS_ARM7.waitIRQ)
 				nds_arm7_timer = nds_timer;
@@ -1006,8 +1029,8 @@ void NDS_Reset()
 	// at any, it's important that this be done long before the user code ever runs
 	_MMU_write08<ARMCPU_ARM9>(REG_WRAMCNT, 3);
 
-	firmware.reset(new CFIRMWARE());
-	fw_success = firmware->load();
+	nds_inst->firmware.reset(new CFIRMWARE());
+	fw_success = nds_inst->firmware->load();
 
 	if (NDS_ARM7.BIOS_loaded && NDS_ARM9.BIOS_loaded && CommonSettings.BootFromFirmware && fw_success)
 	{
@@ -1032,7 +1055,7 @@ void NDS_Reset()
 		}
 
 		// TODO someone describe why here
-		if (firmware->patched)
+		if (nds_inst->firmware->patched)
 		{
 			armcpu_init(&NDS_ARM7, 0x00000008);
 			armcpu_init(&NDS_ARM9, 0xFFFF0008);
@@ -1040,8 +1063,8 @@ void NDS_Reset()
 		else
 		{
 			// set the cpus to an initial state with their respective firmware program entrypoints
-			armcpu_init(&NDS_ARM7, firmware->ARM7bootAddr);
-			armcpu_init(&NDS_ARM9, firmware->ARM9bootAddr);
+			armcpu_init(&NDS_ARM7, nds_inst->firmware->ARM7bootAddr);
+			armcpu_init(&NDS_ARM9, nds_inst->firmware->ARM9bootAddr);
 		}
 
 		// set REG_POSTFLG to the value indicating pre-firmware status
@@ -1139,11 +1162,11 @@ void NDS_Reset()
 	// Write the header checksum to memory (the firmware needs it to see the cart)
 	_MMU_write16<ARMCPU_ARM9>(0x027FF808, T1ReadWord(MMU.CART_ROM, 0x15E));
 
-	if (firmware->patched && CommonSettings.UseExtBIOS && CommonSettings.BootFromFirmware && fw_success)
+	if (nds_inst->firmware->patched && CommonSettings.UseExtBIOS && CommonSettings.BootFromFirmware && fw_success)
 	{
 		// HACK! for flashme
-		_MMU_write32<ARMCPU_ARM9>(0x27FFE24, firmware->ARM9bootAddr);
-		_MMU_write32<ARMCPU_ARM7>(0x27FFE34, firmware->ARM7bootAddr);
+		_MMU_write32<ARMCPU_ARM9>(0x27FFE24, nds_inst->firmware->ARM9bootAddr);
+		_MMU_write32<ARMCPU_ARM7>(0x27FFE34, nds_inst->firmware->ARM7bootAddr);
 	}
 
 	// make system think it's booted from card -- EXTREMELY IMPORTANT!!! Thanks to cReDiAr
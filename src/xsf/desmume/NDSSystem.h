@@ -23,6 +23,7 @@
 #include <cstring>
 #include <stdlib.h>
 #include "armcpu.h"
+#include "cp15.h"
 #include "MMU.h"
 #include "SPU.h"
 #include "mem.h"
@@ -56,7 +57,7 @@ template<typename Type> struct buttonstruct
 	};
 };
 
-extern volatile bool execute;
+#define execute (nds_inst->executing)
 
 struct NDS_header
 {
@@ -110,7 +111,7 @@ struct NDS_header
 	uint8_t reserved[160];
 };
 
-extern uint64_t nds_timer;
+#define nds_timer (nds_inst->timer)
 void NDS_Reschedule();
 void NDS_RescheduleDMA();
 void NDS_RescheduleTimers();
@@ -169,7 +170,7 @@ struct NDS_fw_config_data
 	uint8_t language;
 };
 
-extern NDSSystem nds;
+#define nds (nds_inst->system)
 
 int NDS_Init ();
 
@@ -249,7 +250,7 @@ struct GameInfo
 	bool isHomebrew;
 };
 
-extern GameInfo gameInfo;
+#define gameInfo (nds_inst->game_info)
 
 struct UserButtons : buttonstruct<bool>
 {
@@ -280,10 +281,10 @@ void execHardware_doAllDma(EDMAMode modeNum);
 
 template<bool FORCE> void NDS_exec(int32_t nb = 560190 << 1);
 
-extern struct TCommonSettings
+struct TCommonSettings
 {
 	TCommonSettings() : UseExtBIOS(false), SWIFromBIOS(false), PatchSWI3(false), UseExtFirmware(false), BootFromFirmware(false), ConsoleType(NDS_CONSOLE_TYPE_FAT), rigorous_timing(false), advanced_timing(true),
-		spuInterpolationMode(SPUInterpolation_Linear), manualBackupType(0), spu_captureMuted(false), spu_advanced(false)
+		spuInterpolationMode(SPUInterpolation_Linear), manualBackupType(0), spu_captureMuted(false), spu_advanced(false), skip_arm9(false)
 	{
 		strcpy(this->ARM9BIOS, "biosnds9.bin");
 		strcpy(this->ARM7BIOS, "biosnds7.bin");
@@ -291,8 +292,8 @@ extern struct TCommonSettings
 		NDS_FillDefaultFirmwareConfigData(&this->InternalFirmConf);
 
     bool solo = false;
-    static char* soloEnv = strdup("SOLO_2SF_n");
-    static char* muteEnv = strdup("MUTE_2SF_n");
+    char soloEnv[] = "SOLO_2SF_n";
+    char muteEnv[] = "MUTE_2SF_n";
 		for (int i = 0; i < 16; ++i) {
       if (i < 10) {
         soloEnv[9] = '0' + i;
@@ -345,4 +346,302 @@ extern struct TCommonSettings
 	bool spu_muteChannels[16];
 	bool spu_captureMuted;
 	bool spu_advanced;
-} CommonSettings;
+
+	// run only the arm7; enough for rips whose sound driver no longer needs the arm9 once started
+	bool skip_arm9;
+};
+
+// read all over the cpu and spu code, so it lives with the rest of the console
+// state and only exists between NDS_Init and NDS_DeInit
+#define CommonSettings (nds_inst->settings)
+
+struct MMU_struct_timing;
+struct Sequencer;
+
+// the whole emulated console, allocated for the calling thread by NDS_Init
+struct NDS_Instance
+{
+	NDS_Instance();
+	~NDS_Instance();
+
+	// first, the constructors of the members below already read it
+	TCommonSettings settings;
+
+	MMU_struct mmu;
+	MMU_struct_new mmu_new;
+	std::unique_ptr<MMU_struct_timing> mmu_timing;
+	uint32_t main_mem_mask = 0x3FFFFF;
+	uint32_t main_mem_mask16 = 0x3FFFFF & ~1;
+	uint32_t main_mem_mask32 = 0x3FFFFF & ~3;
+	uint32_t partie = 1;
+
+	armcpu_t arm7, arm9;
+	armcp15_t arm9cp15;
+
+	NDSSystem system;
+	GameInfo game_info;
+	std::unique_ptr<CFIRMWARE> firmware;
+	std::unique_ptr<Sequencer> seq;
+	uint64_t timer = 0, arm9_timer = 0, arm7_timer = 0;
+	volatile bool executing = false;
+
+	SPU_Context spu_context;
+	SampleCache sample_cache;
+};
+
+// ALERT!!!!!!!!!!!!!!
+// the following inline functions dont do the 0x0FFFFFFF mask.
+// this may result in some unexpected behavior
+
+inline uint8_t _MMU_read08(NDS_Instance *nds_inst, int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr)
+{
+	// special handling for DMA: read 0 from TCM
+	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
+	{
+		if (addr < 0x02000000)
+			return 0; // itcm
+		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
+			return 0; // dtcm
+	}
+
+#ifdef HAVE_LUA
+	CallRegisteredLuaMemHook(addr, 1, /*FIXME*/ 0, LUAMEMHOOK_READ);
+#endif
+
+	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
+		// Returns data from DTCM (ARM9 only)
+		return T1ReadByte(MMU.ARM9_DTCM, addr & 0x3FFF);
+
+	if ((addr & 0x0F000000) == 0x02000000)
+		return T1ReadByte(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK);
+
+	if (PROCNUM == ARMCPU_ARM9)
+		return _MMU_ARM9_read08(nds_inst, addr);
+	else
+		return _MMU_ARM7_read08(nds_inst, addr);
+}
+
+inline uint16_t _MMU_read16(NDS_Instance *nds_inst, int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr)
+{
+	// special handling for DMA: read 0 from TCM
+	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
+	{
+		if (addr < 0x02000000)
+			return 0; // itcm
+		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
+			return 0; // dtcm
+	}
+
+#ifdef HAVE_LUA
+	CallRegisteredLuaMemHook(addr, 2, /*FIXME*/ 0, LUAMEMHOOK_READ);
+#endif
+
+	// special handling for execution from arm9, since we spend so much time in there
+	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_CODE)
+	{
+		if ((addr & 0x0F000000) == 0x02000000)
+			return T1ReadWord_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK16);
+
+		if (addr < 0x02000000)
+			return T1ReadWord_guaranteedAligned(MMU.ARM9_ITCM, addr&0x7FFE);
+
+		goto dunno;
+	}
+
+	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
+		// Returns data from DTCM (ARM9 only)
+		return T1ReadWord_guaranteedAligned(MMU.ARM9_DTCM, addr & 0x3FFE);
+
+	if ((addr & 0x0F000000) == 0x02000000)
+		return T1ReadWord_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK16);
+
+dunno:
+	if (PROCNUM == ARMCPU_ARM9)
+		return _MMU_ARM9_read16(nds_inst, addr);
+	else
+		return _MMU_ARM7_read16(nds_inst, addr);
+}
+
+inline uint32_t _MMU_read32(NDS_Instance *nds_inst, int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr)
+{
+	// special handling for DMA: read 0 from TCM
+	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
+	{
+		if (addr < 0x02000000)
+			return 0; // itcm
+		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
+			return 0; // dtcm
+	}
+
+#ifdef HAVE_LUA
+	CallRegisteredLuaMemHook(addr, 4, /*FIXME*/ 0, LUAMEMHOOK_READ);
+#endif
+
+	//s pecial handling for execution from arm9, since we spend so much time in there
+	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_CODE)
+	{
+		if ((addr & 0x0F000000) == 0x02000000)
+			return T1ReadLong_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK32);
+
+		if (addr < 0x02000000)
+			return T1ReadLong_guaranteedAligned(MMU.ARM9_ITCM, addr&0x7FFC);
+
+		// what happens when we execute from DTCM? nocash makes it look like we get 0xFFFFFFFF but i can't seem to verify it
+		// historically, desmume would fall through to its old memory map struct
+		// which would return unused memory (0)
+		// it seems the hardware returns 0 or something benign because in actuality 0xFFFFFFFF is an undefined opcode
+		// and we know our handling for that is solid
+
+		goto dunno;
+	}
+
+	// special handling for execution from arm7. try reading from main memory first
+	if (PROCNUM == ARMCPU_ARM7 && (addr & 0x0F000000) == 0x02000000)
+		return T1ReadLong_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK32);
+
+	// for other arm9 cases, we have to check from dtcm first because it is patched on top of the main memory range
+	if (PROCNUM == ARMCPU_ARM9)
+	{
+		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
+			// Returns data from DTCM (ARM9 only)
+			return T1ReadLong_guaranteedAligned(MMU.ARM9_DTCM, addr & 0x3FFC);
+
+		if ((addr & 0x0F000000) == 0x02000000)
+			return T1ReadLong_guaranteedAligned(MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK32);
+	}
+
+dunno:
+	if (PROCNUM == ARMCPU_ARM9)
+		return _MMU_ARM9_read32(nds_inst, addr);
+	else
+		return _MMU_ARM7_read32(nds_inst, addr);
+}
+
+inline void _MMU_write08(NDS_Instance *nds_inst, int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr, uint8_t val)
+{
+	// special handling for DMA: discard writes to TCM
+	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
+	{
+		if (addr < 0x02000000)
+			return; // itcm
+		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
+			return; // dtcm
+	}
+
+	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
+	{
+		T1WriteByte(MMU.ARM9_DTCM, addr & 0x3FFF, val);
+#ifdef HAVE_LUA
+		CallRegisteredLuaMemHook(addr, 1, val, LUAMEMHOOK_WRITE);
+#endif
+		return;
+	}
+
+	if ((addr & 0x0F000000) == 0x02000000)
+	{
+		T1WriteByte( MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK, val);
+#ifdef HAVE_LUA
+		CallRegisteredLuaMemHook(addr, 1, val, LUAMEMHOOK_WRITE);
+#endif
+		return;
+	}
+
+	if (PROCNUM == ARMCPU_ARM9)
+		_MMU_ARM9_write08(nds_inst, addr, val);
+	else
+		_MMU_ARM7_write08(nds_inst, addr, val);
+#ifdef HAVE_LUA
+	CallRegisteredLuaMemHook(addr, 1, val, LUAMEMHOOK_WRITE);
+#endif
+}
+
+inline void _MMU_write16(NDS_Instance *nds_inst, int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr, uint16_t val)
+{
+	// special handling for DMA: discard writes to TCM
+	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
+	{
+		if (addr < 0x02000000)
+			return; // itcm
+		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
+			return; // dtcm
+	}
+
+	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
+	{
+		T1WriteWord(MMU.ARM9_DTCM, addr & 0x3FFE, val);
+#ifdef HAVE_LUA
+		CallRegisteredLuaMemHook(addr, 2, val, LUAMEMHOOK_WRITE);
+#endif
+		return;
+	}
+
+	if ((addr & 0x0F000000) == 0x02000000)
+	{
+		T1WriteWord( MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK16, val);
+#ifdef HAVE_LUA
+		CallRegisteredLuaMemHook(addr, 2, val, LUAMEMHOOK_WRITE);
+#endif
+		return;
+	}
+
+	if (PROCNUM == ARMCPU_ARM9)
+		_MMU_ARM9_write16(nds_inst, addr, val);
+	else
+		_MMU_ARM7_write16(nds_inst, addr, val);
+#ifdef HAVE_LUA
+	CallRegisteredLuaMemHook(addr, 2, val, LUAMEMHOOK_WRITE);
+#endif
+}
+
+inline void _MMU_write32(NDS_Instance *nds_inst, int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr, uint32_t val)
+{
+	// special handling for DMA: discard writes to TCM
+	if (PROCNUM == ARMCPU_ARM9 && AT == MMU_AT_DMA)
+	{
+		if (addr < 0x02000000)
+			return; // itcm
+		if ((addr & ~0x3FFF) == MMU.DTCMRegion)
+			return; // dtcm
+	}
+
+	if (PROCNUM == ARMCPU_ARM9 && (addr & ~0x3FFF) == MMU.DTCMRegion)
+	{
+		T1WriteLong(MMU.ARM9_DTCM, addr & 0x3FFC, val);
+#ifdef HAVE_LUA
+		CallRegisteredLuaMemHook(addr, 4, val, LUAMEMHOOK_WRITE);
+#endif
+		return;
+	}
+
+	if ((addr & 0x0F000000) == 0x02000000)
+	{
+		T1WriteLong( MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK32, val);
+#ifdef HAVE_LUA
+		CallRegisteredLuaMemHook(addr, 4, val, LUAMEMHOOK_WRITE);
+#endif
+		return;
+	}
+
+	if (PROCNUM == ARMCPU_ARM9)
+		_MMU_ARM9_write32(nds_inst, addr, val);
+	else
+		_MMU_ARM7_write32(nds_inst, addr, val);
+#ifdef HAVE_LUA
+	CallRegisteredLuaMemHook(addr, 4, val, LUAMEMHOOK_WRITE);
+#endif
+}
+
+// these pick up whichever nds_inst is in scope, see types.h
+#define READ32(a,b)		_MMU_read32(nds_inst, PROCNUM, MMU_AT_DATA, (b) & 0xFFFFFFFC)
+#define WRITE32(a,b,c)	_MMU_write32(nds_inst, PROCNUM, MMU_AT_DATA, (b) & 0xFFFFFFFC,c)
+#define READ16(a,b)		_MMU_read16(nds_inst, PROCNUM, MMU_AT_DATA, (b) & 0xFFFFFFFE)
+#define WRITE16(a,b,c)	_MMU_write16(nds_inst, PROCNUM, MMU_AT_DATA, (b) & 0xFFFFFFFE,c)
+#define READ8(a,b)		_MMU_read08(nds_inst, PROCNUM, MMU_AT_DATA, b)
+#define WRITE8(a,b,c)	_MMU_write08(nds_inst, PROCNUM, MMU_AT_DATA, b, c)
+
+template<int PROCNUM, MMU_ACCESS_TYPE AT> inline uint8_t _MMU_read08(uint32_t addr) { return _MMU_read08(nds_inst, PROCNUM, AT, addr); }
+template<int PROCNUM, MMU_ACCESS_TYPE AT> inline uint16_t _MMU_read16(uint32_t addr) { return _MMU_read16(nds_inst, PROCNUM, AT, addr); }
+template<int PROCNUM, MMU_ACCESS_TYPE AT> inline uint32_t _MMU_read32(uint32_t addr) { return _MMU_read32(nds_inst, PROCNUM, AT, addr); }
+template<int PROCNUM, MMU_ACCESS_TYPE AT> inline void _MMU_write08(uint32_t addr, uint8_t val) { _MMU_write08(nds_inst, PROCNUM, AT, addr, val); }
+template<int PROCNUM, MMU_ACCESS_TYPE AT> inline void _MMU_write16(uint32_t addr, uint16_t val) { _MMU_write16(nds_inst, PROCNUM, AT, addr, val); }
+template<int PROCNUM, MMU_ACCESS_TYPE AT> inline void _MMU_write32(uint32_t addr, uint32_t val) { _MMU_write32(nds_inst, PROCNUM, AT, addr, val); }
@@ -50,18 +50,9 @@ static inline u8 read08(u32 addr) { return _MMU_read08<ARMCPU_ARM7,MMU_AT_DEBUG>
 #define K_ADPCM_LOOPING_RECOVERY_INDEX 99999
 #define COSINE_INTERPOLATION_RESOLUTION 8192
 
-SPU_struct *SPU_core = 0;
-int SPU_currentCoreNum = SNDCORE_DUMMY;
-static int volume = 100;
-SampleCache spuSampleCache;
-
-static size_t buffersize = 0;
-static ESynchMode synchmode = ESynchMode_Synchronous;
-static ESynchMethod synchmethod = ESynchMethod_0;
-static ISynchronizingAudioBuffer* synchronizer = metaspu_construct(synchmethod);
-
-static int SNDCoreId=-1;
-static SoundInterface_struct *SNDCore=NULL;
+// SPU.cc's own state, see SPU_Context
+#define spu (nds_inst->spu_context)
+
 extern SoundInterface_struct *SNDCoreList[];
 
 static const int format_shift[] = { 2, 1, 3, 0 };
@@ -80,18 +71,12 @@ static const s16 wavedutytbl[8][8] = {
 
 static const double ARM7_CLOCK = 33513982;
 
-double DESMUME_SAMPLE_RATE = 48000;
-static double samples_per_hline = (DESMUME_SAMPLE_RATE / 59.8261f) / 263.0f;
-static double sampleLength = DESMUME_SAMPLE_RATE / 32728.498;
-
 void SetDesmumeSampleRate(double rate) {
   DESMUME_SAMPLE_RATE = rate;
-  sampleLength = DESMUME_SAMPLE_RATE / 32728.498;
-  samples_per_hline = (DESMUME_SAMPLE_RATE / 59.8261f) / 263.0f;
+  spu.sampleLength = DESMUME_SAMPLE_RATE / 32728.498;
+  spu.samples_per_hline = (DESMUME_SAMPLE_RATE / 59.8261f) / 263.0f;
 }
 
-static double samples = 0;
-
 template<typename T>
 static FORCEINLINE T MinMax(T val, T min, T max)
 {
@@ -109,11 +94,11 @@ int SPU_ChangeSoundCore(int coreid, int buffersize)
 {
   int i;
 
-  ::buffersize = buffersize;
+  spu.buffersize = buffersize;
 
   // Make sure the old core is freed
-  if (SNDCore)
-    SNDCore->DeInit();
+  if (spu.SNDCore)
+    spu.SNDCore->DeInit();
 
   // So which core do we want?
   if (coreid == SNDCORE_DEFAULT)
@@ -127,43 +112,43 @@ int SPU_ChangeSoundCore(int coreid, int buffersize)
     if (SNDCoreList[i]->id == coreid)
     {
       // Set to current core
-      SNDCore = SNDCoreList[i];
+      spu.SNDCore = SNDCoreList[i];
       break;
     }
   }
 
-  SNDCoreId = coreid;
+  spu.SNDCoreId = coreid;
 
   //If the user picked the dummy core, disable the user spu
-  if(SNDCore == &SNDDummy)
+  if(spu.SNDCore == &SNDDummy)
     return 0;
 
   //If the core wasnt found in the list for some reason, disable the user spu
-  if (SNDCore == NULL)
+  if (spu.SNDCore == NULL)
     return -1;
 
   // Since it failed, instead of it being fatal, disable the user spu
-  if (SNDCore->Init(buffersize * 2) == -1)
+  if (spu.SNDCore->Init(buffersize * 2) == -1)
   {
-    SNDCore = 0;
+    spu.SNDCore = 0;
     return -1;
   }
 
-  SNDCore->SetVolume(volume);
+  spu.SNDCore->SetVolume(spu.volume);
 
-  SPU_SetSynchMode(synchmode,synchmethod);
+  SPU_SetSynchMode(spu.synchmode,spu.synchmethod);
 
   return 0;
 }
 
 SoundInterface_struct *SPU_SoundCore()
 {
-  return SNDCore;
+  return spu.SNDCore;
 }
 
 void SPU_ReInit(bool fakeBoot)
 {
-  SPU_Init(SNDCoreId, buffersize);
+  SPU_Init(spu.SNDCoreId, spu.buffersize);
 
   // Firmware set BIAS to 0x200
   if (fakeBoot)
@@ -172,48 +157,48 @@ void SPU_ReInit(bool fakeBoot)
 
 int SPU_Init(int coreid, int buffersize)
 {
-  SPU_core = new SPU_struct((int)ceil(samples_per_hline));
+  SPU_core = new SPU_struct((int)ceil(spu.samples_per_hline));
   SPU_Reset();
 
-  SPU_SetSynchMode(synchmode, synchmethod);
+  SPU_SetSynchMode(spu.synchmode, spu.synchmethod);
 
   return SPU_ChangeSoundCore(coreid, buffersize);
 }
 
 void SPU_Pause(int pause)
 {
-  if (SNDCore == NULL) return;
+  if (spu.SNDCore == NULL) return;
 
   if(pause)
-    SNDCore->MuteAudio();
+    spu.SNDCore->MuteAudio();
   else
-    SNDCore->UnMuteAudio();
+    spu.SNDCore->UnMuteAudio();
 }
 
 void SPU_SetSynchMode(int mode, int method)
 {
-  synchmode = (ESynchMode)mode;
-  if(synchmethod != (ESynchMethod)method)
+  spu.synchmode = (ESynchMode)mode;
+  if(!spu.synchronizer || spu.synchmethod != (ESynchMethod)method)
   {
-    synchmethod = (ESynchMethod)method;
-    delete synchronizer;
+    spu.synchmethod = (ESynchMethod)method;
+    delete spu.synchronizer;
     //grr does this need to be locked? spu might need a lock method
     // or maybe not, maybe the platform-specific code that calls this function can deal with it.
-    synchronizer = metaspu_construct(synchmethod);
+    spu.synchronizer = metaspu_construct(spu.synchmethod);
   }
 }
 
 void SPU_ClearOutputBuffer()
 {
-  if(SNDCore && SNDCore->ClearBuffer)
-    SNDCore->ClearBuffer();
+  if(spu.SNDCore && spu.SNDCore->ClearBuffer)
+    spu.SNDCore->ClearBuffer();
 }
 
 void SPU_SetVolume(int volume)
 {
-  ::volume = volume;
-  if (SNDCore)
-    SNDCore->SetVolume(volume);
+  spu.volume = volume;
+  if (spu.SNDCore)
+    spu.SNDCore->SetVolume(volume);
 }
 
 
@@ -229,8 +214,30 @@ void SPU_Reset(void)
   for (i = 0x400; i < 0x51D; i++)
     T1WriteByte(MMU.ARM7_REG, i, 0);
 
-  samples = 0;
+  spu.samples = 0;
+}
+
+void SPU_WriteByte(u32 addr, u8 val)
+{
+  addr &= 0xFFF;
+
+  SPU_core->WriteByte(addr,val);
 }
+void SPU_WriteWord(u32 addr, u16 val)
+{
+  addr &= 0xFFF;
+
+  SPU_core->WriteWord(addr,val);
+}
+void SPU_WriteLong(u32 addr, u32 val)
+{
+  addr &= 0xFFF;
+
+  SPU_core->WriteLong(addr,val);
+}
+u8 SPU_ReadByte(u32 addr) { return SPU_core->ReadByte(addr & 0x0FFF); }
+u16 SPU_ReadWord(u32 addr) { return SPU_core->ReadWord(addr & 0x0FFF); }
+u32 SPU_ReadLong(u32 addr) { return SPU_core->ReadLong(addr & 0x0FFF); }
 
 //------------------------------------------
 
@@ -269,11 +276,16 @@ SPU_struct::~SPU_struct()
 
 void SPU_DeInit(void)
 {
-  if(SNDCore)
-    SNDCore->DeInit();
-  SNDCore = 0;
+  if(spu.SNDCore)
+    spu.SNDCore->DeInit();
+  spu.SNDCore = 0;
 
   delete SPU_core; SPU_core=0;
+
+  // SPU_Context doesn't free these itself
+  delete spu.synchronizer; spu.synchronizer=0;
+  free(spu.postProcessBuffer); spu.postProcessBuffer=0;
+  spu.postProcessBufferSize=0;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1334,15 +1346,14 @@ static void SPU_MixAudio(bool actuallyMix, SPU_struct *SPU, int length)
 //emulates one hline of the cpu core.
 //this will produce a variable number of samples, calculated to keep a 44100hz output
 //in sync with the emulator framerate
-int spu_core_samples = 0;
 void SPU_Emulate_core()
 {
   bool needToMix = true;
   SoundInterface_struct *soundProcessor = SPU_SoundCore();
 
-  samples += samples_per_hline;
-  spu_core_samples = (int)(samples);
-  samples -= spu_core_samples;
+  spu.samples += spu.samples_per_hline;
+  spu_core_samples = (int)(spu.samples);
+  spu.samples -= spu_core_samples;
 
   SPU_MixAudio(needToMix, SPU_core, spu_core_samples);
 
@@ -1353,18 +1364,16 @@ void SPU_Emulate_core()
 
   if (soundProcessor->FetchSamples != NULL)
   {
-    soundProcessor->FetchSamples(SPU_core->outbuf, spu_core_samples, synchmode, synchronizer);
+    soundProcessor->FetchSamples(SPU_core->outbuf, spu_core_samples, spu.synchmode, spu.synchronizer);
   }
   else
   {
-    SPU_DefaultFetchSamples(SPU_core->outbuf, spu_core_samples, synchmode, synchronizer);
+    SPU_DefaultFetchSamples(SPU_core->outbuf, spu_core_samples, spu.synchmode, spu.synchronizer);
   }
 }
 
 void SPU_Emulate_user(bool mix)
 {
-  static s16 *postProcessBuffer = NULL;
-  static size_t postProcessBufferSize = 0;
   size_t freeSampleCount = 0;
   size_t processedSampleCount = 0;
   SoundInterface_struct *soundProcessor = SPU_SoundCore();
@@ -1382,29 +1391,29 @@ void SPU_Emulate_user(bool mix)
     return;
   }
 
-  if (freeSampleCount > buffersize)
+  if (freeSampleCount > spu.buffersize)
   {
-    freeSampleCount = buffersize;
+    freeSampleCount = spu.buffersize;
   }
 
   // If needed, resize the post-process buffer to guarantee that
   // we can store all the sound data.
-  if (postProcessBufferSize < freeSampleCount * 2 * sizeof(s16))
+  if (spu.postProcessBufferSize < freeSampleCount * 2 * sizeof(s16))
   {
-    postProcessBufferSize = freeSampleCount * 2 * sizeof(s16);
-    postProcessBuffer = (s16 *)realloc(postProcessBuffer, postProcessBufferSize);
+    spu.postProcessBufferSize = freeSampleCount * 2 * sizeof(s16);
+    spu.postProcessBuffer = (s16 *)realloc(spu.postProcessBuffer, spu.postProcessBufferSize);
   }
 
   if (soundProcessor->PostProcessSamples != NULL)
   {
-    processedSampleCount = soundProcessor->PostProcessSamples(postProcessBuffer, freeSampleCount, synchmode, synchronizer);
+    processedSampleCount = soundProcessor->PostProcessSamples(spu.postProcessBuffer, freeSampleCount, spu.synchmode, spu.synchronizer);
   }
   else
   {
-    processedSampleCount = SPU_DefaultPostProcessSamples(postProcessBuffer, freeSampleCount, synchmode, synchronizer);
+    processedSampleCount = SPU_DefaultPostProcessSamples(spu.postProcessBuffer, freeSampleCount, spu.synchmode, spu.synchronizer);
   }
 
-  soundProcessor->UpdateAudio(postProcessBuffer, processedSampleCount);
+  soundProcessor->UpdateAudio(spu.postProcessBuffer, processedSampleCount);
 }
 
 void SPU_DefaultFetchSamples(s16 *sampleBuffer, size_t sampleCount, ESynchMode synchMode, ISynchronizingAudioBuffer *theSynchronizer)
@@ -73,7 +73,7 @@ struct SoundInterface_struct
 
 extern SoundInterface_struct SNDDummy;
 extern SoundInterface_struct SNDFile;
-extern int SPU_currentCoreNum;
+#define SPU_currentCoreNum (nds_inst->spu_context.currentCoreNum)
 
 struct channel_struct
 {
@@ -221,8 +221,33 @@ public:
    void ShutUp();
 };
 
-extern SPU_struct *SPU_core;
-extern int spu_core_samples;
+// what used to be SPU.cc's globals, one set per console in NDS_Instance
+struct SPU_Context
+{
+	SPU_struct *core = nullptr;
+	int currentCoreNum = SNDCORE_DUMMY;
+	int core_samples = 0;
+	int volume = 100;
+
+	size_t buffersize = 0;
+	ESynchMode synchmode = ESynchMode_Synchronous;
+	ESynchMethod synchmethod = ESynchMethod_0;
+	ISynchronizingAudioBuffer *synchronizer = nullptr; // created by SPU_SetSynchMode
+
+	int SNDCoreId = -1;
+	SoundInterface_struct *SNDCore = nullptr;
+
+	double sample_rate = 48000;
+	double samples_per_hline = (48000.0 / 59.8261f) / 263.0f;
+	double sampleLength = 48000.0 / 32728.498;
+	double samples = 0;
+
+	s16 *postProcessBuffer = nullptr;
+	size_t postProcessBufferSize = 0;
+};
+
+#define SPU_core (nds_inst->spu_context.core)
+#define spu_core_samples (nds_inst->spu_context.core_samples)
 
 int SPU_ChangeSoundCore(int coreid, int buffersize);
 SoundInterface_struct *SPU_SoundCore();
@@ -236,35 +261,20 @@ void SPU_ClearOutputBuffer(void);
 void SPU_Reset(void);
 void SPU_DeInit(void);
 void SPU_KeyOn(int channel);
-static FORCEINLINE void SPU_WriteByte(u32 addr, u8 val)
-{
-	addr &= 0xFFF;
-
-	SPU_core->WriteByte(addr,val);
-}
-static FORCEINLINE void SPU_WriteWord(u32 addr, u16 val)
-{
-	addr &= 0xFFF;
-
-	SPU_core->WriteWord(addr,val);
-}
-static FORCEINLINE void SPU_WriteLong(u32 addr, u32 val)
-{
-	addr &= 0xFFF;
-
-	SPU_core->WriteLong(addr,val);
-}
-static FORCEINLINE u8 SPU_ReadByte(u32 addr) { return SPU_core->ReadByte(addr & 0x0FFF); }
-static FORCEINLINE u16 SPU_ReadWord(u32 addr) { return SPU_core->ReadWord(addr & 0x0FFF); }
-static FORCEINLINE u32 SPU_ReadLong(u32 addr) { return SPU_core->ReadLong(addr & 0x0FFF); }
+void SPU_WriteByte(u32 addr, u8 val);
+void SPU_WriteWord(u32 addr, u16 val);
+void SPU_WriteLong(u32 addr, u32 val);
+u8 SPU_ReadByte(u32 addr);
+u16 SPU_ReadWord(u32 addr);
+u32 SPU_ReadLong(u32 addr);
 void SPU_Emulate_core(void);
 void SPU_Emulate_user(bool mix = true);
 void SPU_DefaultFetchSamples(s16 *sampleBuffer, size_t sampleCount, ESynchMode synchMode, ISynchronizingAudioBuffer *theSynchronizer);
 size_t SPU_DefaultPostProcessSamples(s16 *postProcessBuffer, size_t requestedSampleCount, ESynchMode synchMode, ISynchronizingAudioBuffer *theSynchronizer);
 
-extern double DESMUME_SAMPLE_RATE;
+#define DESMUME_SAMPLE_RATE (nds_inst->spu_context.sample_rate)
 void SetDesmumeSampleRate(double rate);
 
-extern SampleCache spuSampleCache;
+#define spuSampleCache (nds_inst->sample_cache)
 
 #endif
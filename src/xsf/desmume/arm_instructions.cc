@@ -235,7 +235,7 @@
 //   Undefined instruction
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_UND(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_UND(NDS_Instance *nds_inst, uint32_t)
 {
 	TRAPUNDEF(cpu);
 	return 1;
@@ -272,110 +272,110 @@ TEMPLATE static uint32_t FASTCALL OP_UND(uint32_t)
 	cpu->CPSR.bits.Z = !cpu->R[REG_POS(i, 12)]; \
 	return a;
 
-TEMPLATE static uint32_t FASTCALL OP_AND_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_AND(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_AND(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_AND(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_AND(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_AND(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_AND(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_AND(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_AND(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_AND(1, 3);
 }
 
 
-TEMPLATE static uint32_t FASTCALL OP_AND_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_IMM;
 	OP_ANDS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_REG;
 	OP_ANDS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_IMM;
 	OP_ANDS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_REG;
 	OP_ANDS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_IMM;
 	OP_ANDS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_REG;
 	OP_ANDS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_IMM;
 	OP_ANDS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_REG;
 	OP_ANDS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_AND_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_IMM_VALUE;
 	OP_ANDS(1, 3);
@@ -411,110 +411,110 @@ TEMPLATE static uint32_t FASTCALL OP_AND_S_IMM_VAL(uint32_t i)
 	cpu->CPSR.bits.Z = !cpu->R[REG_POS(i, 12)]; \
 	return a;
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_EOR(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_EOR(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_EOR(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_EOR(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_EOR(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_EOR(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_EOR(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_EOR(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_EOR(1, 3);
 }
 
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_IMM;
 	OP_EORS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_REG;
 	OP_EORS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_IMM;
 	OP_EORS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_REG;
 	OP_EORS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_IMM;
 	OP_EORS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_REG;
 	OP_EORS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_IMM;
 	OP_EORS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_REG;
 	OP_EORS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_EOR_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_IMM_VALUE;
 	OP_EORS(1, 3);
@@ -551,118 +551,118 @@ TEMPLATE static uint32_t FASTCALL OP_EOR_S_IMM_VAL(uint32_t i)
 	cpu->CPSR.bits.V = OverflowFromSUB(cpu->R[REG_POS(i,12)], v, shift_op); \
 	return a;
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_SUB(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_SUB(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_SUB(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_SUB(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_SUB(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_SUB(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_SUB(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_SUB(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_SUB(1, 3);
 }
 
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_IMM;
 	OP_SUBS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_REG;
 	OP_SUBS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_IMM;
 	OP_SUBS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_REG;
 	OP_SUBS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_IMM;
 	OP_SUBS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_REG;
 	OP_SUBS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_IMM;
 	OP_SUBS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_REG;
 	OP_SUBS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	IMM_VALUE;
@@ -700,117 +700,117 @@ TEMPLATE static uint32_t FASTCALL OP_SUB_S_IMM_VAL(uint32_t i)
 	cpu->CPSR.bits.V = OverflowFromSUB(cpu->R[REG_POS(i, 12)], shift_op, v); \
 	return a;
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_RSB(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_RSB(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_RSB(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_RSB(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_RSB(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_RSB(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_RSB(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_RSB(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_RSB(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_IMM;
 	OP_RSBS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_REG;
 	OP_RSBS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_IMM;
 	OP_RSBS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_REG;
 	OP_RSBS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_IMM;
 	OP_RSBS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_REG;
 	OP_RSBS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_IMM;
 	OP_RSBS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_REG;
 	OP_RSBS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSB_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSB_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	IMM_VALUE;
@@ -848,117 +848,117 @@ TEMPLATE static uint32_t FASTCALL OP_RSB_S_IMM_VAL(uint32_t i)
 	cpu->CPSR.bits.V = OverflowFromADD(cpu->R[REG_POS(i, 12)], v, shift_op); \
 	return a;
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_ADD(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_ADD(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_ADD(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_ADD(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_ADD(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_ADD(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_ADD(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_ADD(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_ADD(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_IMM;
 	OP_ADDS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_REG;
 	OP_ADDS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_IMM;
 	OP_ADDS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_REG;
 	OP_ADDS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_IMM;
 	OP_ADDS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_REG;
 	OP_ADDS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_IMM;
 	OP_ADDS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_REG;
 	OP_ADDS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	IMM_VALUE;
@@ -1006,118 +1006,118 @@ TEMPLATE static uint32_t FASTCALL OP_ADD_S_IMM_VAL(uint32_t i)
 	return a; \
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_ADC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_ADC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_ADC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_ADC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_ADC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_ADC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_ADC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_ADC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_ADC(1, 3);
 }
 
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_IMM;
 	OP_ADCS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_REG;
 	OP_ADCS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_IMM;
 	OP_ADCS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_REG;
 	OP_ADCS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_IMM;
 	OP_ADCS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i,16)];
 	ASR_REG;
 	OP_ADCS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_IMM;
 	OP_ADCS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_REG;
 	OP_ADCS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i,16)];
 	IMM_VALUE;
@@ -1166,118 +1166,118 @@ TEMPLATE static uint32_t FASTCALL OP_ADC_S_IMM_VAL(uint32_t i)
 	return a; \
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_SBC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_SBC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_SBC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_SBC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_SBC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_SBC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_SBC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_SBC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_SBC(1, 3);
 }
 
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_IMM;
 	OP_SBCS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_REG;
 	OP_SBCS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_IMM;
 	OP_SBCS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_REG;
 	OP_SBCS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_IMM;
 	OP_SBCS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_REG;
 	OP_SBCS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i,16)];
 	ROR_IMM;
 	OP_SBCS(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_REG;
 	OP_SBCS(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	IMM_VALUE;
@@ -1326,117 +1326,117 @@ TEMPLATE static uint32_t FASTCALL OP_SBC_S_IMM_VAL(uint32_t i)
 	return a; \
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_RSC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_RSC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_RSC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_RSC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_RSC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_RSC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_RSC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_RSC(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_RSC(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_IMM;
 	OP_RSCS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSL_REG;
 	OP_RSCS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i,16)];
 	LSR_IMM;
 	OP_RSCS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	LSR_REG;
 	OP_RSCS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_IMM;
 	OP_RSCS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ASR_REG;
 	OP_RSCS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_IMM;
 	OP_RSCS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	ROR_REG;
 	OP_RSCS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_RSC_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_RSC_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 16)];
 	IMM_VALUE;
@@ -1456,55 +1456,55 @@ TEMPLATE static uint32_t FASTCALL OP_RSC_S_IMM_VAL(uint32_t i)
 	return a; \
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TST_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_IMM;
 	OP_TST(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TST_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_REG;
 	OP_TST(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TST_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_IMM;
 	OP_TST(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TST_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_REG;
 	OP_TST(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TST_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_IMM;
 	OP_TST(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TST_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_REG;
 	OP_TST(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TST_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_IMM;
 	OP_TST(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TST_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_REG;
 	OP_TST(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TST_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_IMM_VALUE;
 	OP_TST(1);
@@ -1523,55 +1523,55 @@ TEMPLATE static uint32_t FASTCALL OP_TST_IMM_VAL(uint32_t i)
 	return a; \
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TEQ_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TEQ_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_IMM;
 	OP_TEQ(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TEQ_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TEQ_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_REG;
 	OP_TEQ(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TEQ_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TEQ_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_IMM;
 	OP_TEQ(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TEQ_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TEQ_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_REG;
 	OP_TEQ(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TEQ_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TEQ_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_IMM;
 	OP_TEQ(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TEQ_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TEQ_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_REG;
 	OP_TEQ(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TEQ_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TEQ_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_IMM;
 	OP_TEQ(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TEQ_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TEQ_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_REG;
 	OP_TEQ(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_TEQ_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TEQ_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_IMM_VALUE;
 	OP_TEQ(1);
@@ -1591,55 +1591,55 @@ TEMPLATE static uint32_t FASTCALL OP_TEQ_IMM_VAL(uint32_t i)
 	return a; \
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_CMP(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_CMP(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_CMP(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_CMP(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_CMP(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_CMP(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_CMP(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_CMP(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_CMP(1);
@@ -1659,55 +1659,55 @@ TEMPLATE static uint32_t FASTCALL OP_CMP_IMM_VAL(uint32_t i)
 	return a; \
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMN_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_CMN(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMN_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_CMN(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMN_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_CMN(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMN_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_CMN(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMN_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_CMN(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMN_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_CMN(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMN_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_CMN(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMN_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_CMN(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMN_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_CMN(1);
@@ -1745,110 +1745,110 @@ TEMPLATE static uint32_t FASTCALL OP_CMN_IMM_VAL(uint32_t i)
 	return a; \
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_ORR(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_ORR(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_ORR(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_ORR(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_ORR(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_ORR(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_ORR(1, 3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_ORR(2, 4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_ORR(1, 3);
 }
 
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_IMM;
 	OP_ORRS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_REG;
 	OP_ORRS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_IMM;
 	OP_ORRS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_REG;
 	OP_ORRS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_IMM;
 	OP_ORRS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_REG;
 	OP_ORRS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_IMM;
 	OP_ORRS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_REG;
 	OP_ORRS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ORR_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_IMM_VALUE;
 	OP_ORRS(1,3);
@@ -1884,7 +1884,7 @@ TEMPLATE static uint32_t FASTCALL OP_ORR_S_IMM_VAL(uint32_t i)
 	cpu->CPSR.bits.Z = !cpu->R[REG_POS(i, 12)]; \
 	return a;
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (i == 0xE1A00000) // nop: MOV R0, R0
 		return 1;
@@ -1893,7 +1893,7 @@ TEMPLATE static uint32_t FASTCALL OP_MOV_LSL_IMM(uint32_t i)
 	OP_MOV(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	if (REG_POS(i, 0) == 15)
@@ -1901,13 +1901,13 @@ TEMPLATE static uint32_t FASTCALL OP_MOV_LSL_REG(uint32_t i)
 	OP_MOV(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_MOV(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	if (REG_POS(i, 0) == 15)
@@ -1915,43 +1915,43 @@ TEMPLATE static uint32_t FASTCALL OP_MOV_LSR_REG(uint32_t i)
 	OP_MOV(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_MOV(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_MOV(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_MOV(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_MOV(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_MOV(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_IMM;
 	OP_MOVS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_REG;
 	if (REG_POS(i, 0) == 15)
@@ -1959,13 +1959,13 @@ TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSL_REG(uint32_t i)
 	OP_MOVS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_IMM;
 	OP_MOVS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_REG;
 	if (REG_POS(i, 0) == 15)
@@ -1973,31 +1973,31 @@ TEMPLATE static uint32_t FASTCALL OP_MOV_S_LSR_REG(uint32_t i)
 	OP_MOVS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_IMM;
 	OP_MOVS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_REG;
 	OP_MOVS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_IMM;
 	OP_MOVS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_REG;
 	OP_MOVS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_IMM_VALUE;
 	OP_MOVS(1,3);
@@ -2033,110 +2033,110 @@ TEMPLATE static uint32_t FASTCALL OP_MOV_S_IMM_VAL(uint32_t i)
 	cpu->CPSR.bits.Z = !cpu->R[REG_POS(i, 12)]; \
 	return a;
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_BIC(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_BIC(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_BIC(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_BIC(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_BIC(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_BIC(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_BIC(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_BIC(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_BIC(1,3);
 }
 
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_IMM;
 	OP_BICS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_REG;
 	OP_BICS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_IMM;
 	OP_BICS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_REG;
 	OP_BICS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_IMM;
 	OP_BICS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_REG;
 	OP_BICS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_IMM;
 	OP_BICS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_REG;
 	OP_BICS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BIC_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_IMM_VALUE;
 	OP_BICS(1,3);
@@ -2172,109 +2172,109 @@ TEMPLATE static uint32_t FASTCALL OP_BIC_S_IMM_VAL(uint32_t i)
 	cpu->CPSR.bits.Z = !cpu->R[REG_POS(i, 12)]; \
 	return a;
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_MVN(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_REG;
 	OP_MVN(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_MVN(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_REG;
 	OP_MVN(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_MVN(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_REG;
 	OP_MVN(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_MVN(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_REG;
 	OP_MVN(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	IMM_VALUE;
 	OP_MVN(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_S_LSL_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_S_LSL_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_IMM;
 	OP_MVNS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_S_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_S_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSL_REG;
 	OP_MVNS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_S_LSR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_S_LSR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_IMM;
 	OP_MVNS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_S_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_S_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_LSR_REG;
 	OP_MVNS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_S_ASR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_S_ASR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_IMM;
 	OP_MVNS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_S_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_S_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ASR_REG;
 	OP_MVNS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_S_ROR_IMM(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_S_ROR_IMM(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_IMM;
 	OP_MVNS(1,3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_S_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_S_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_ROR_REG;
 	OP_MVNS(2,4);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MVN_S_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN_S_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	S_IMM_VALUE;
 	OP_MVNS(1,3);
@@ -2296,7 +2296,7 @@ TEMPLATE static uint32_t FASTCALL OP_MVN_S_IMM_VAL(uint32_t i)
 		return c + 3; \
 	return c + 4;
 
-TEMPLATE static uint32_t FASTCALL OP_MUL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MUL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 8)];
 	cpu->R[REG_POS(i, 16)] = cpu->R[REG_POS(i, 0)] * v;
@@ -2304,7 +2304,7 @@ TEMPLATE static uint32_t FASTCALL OP_MUL(uint32_t i)
 	MUL_Mxx_END(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MLA(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MLA(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 8)];
 	cpu->R[REG_POS(i, 16)] = cpu->R[REG_POS(i, 0)] * v + cpu->R[REG_POS(i, 12)];
@@ -2312,7 +2312,7 @@ TEMPLATE static uint32_t FASTCALL OP_MLA(uint32_t i)
 	MUL_Mxx_END(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MUL_S(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MUL_S(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 8)];
 	cpu->R[REG_POS(i, 16)] = cpu->R[REG_POS(i, 0)] * v;
@@ -2323,7 +2323,7 @@ TEMPLATE static uint32_t FASTCALL OP_MUL_S(uint32_t i)
 	MUL_Mxx_END(1);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MLA_S(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MLA_S(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 8)];
 	cpu->R[REG_POS(i, 16)] = cpu->R[REG_POS(i, 0)] * v + cpu->R[REG_POS(i, 12)];
@@ -2350,7 +2350,7 @@ TEMPLATE static uint32_t FASTCALL OP_MLA_S(uint32_t i)
 		return c + 3; \
 	return c + 4;
 
-TEMPLATE static uint32_t FASTCALL OP_UMULL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_UMULL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 8)];
 	uint64_t res = static_cast<uint64_t>(cpu->R[REG_POS(i, 0)]) * static_cast<uint64_t>(v);
@@ -2361,7 +2361,7 @@ TEMPLATE static uint32_t FASTCALL OP_UMULL(uint32_t i)
 	MUL_UMxxL_END(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_UMLAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_UMLAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 8)];
 	uint64_t res = static_cast<uint64_t>(cpu->R[REG_POS(i, 0)]) * static_cast<uint64_t>(v);
@@ -2375,7 +2375,7 @@ TEMPLATE static uint32_t FASTCALL OP_UMLAL(uint32_t i)
 	MUL_UMxxL_END(3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_UMULL_S(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_UMULL_S(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 8)];
 	uint64_t res = static_cast<uint64_t>(cpu->R[REG_POS(i, 0)]) * static_cast<uint64_t>(v);
@@ -2389,7 +2389,7 @@ TEMPLATE static uint32_t FASTCALL OP_UMULL_S(uint32_t i)
 	MUL_UMxxL_END(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_UMLAL_S(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_UMLAL_S(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_POS(i, 8)];
 	uint64_t res = static_cast<uint64_t>(cpu->R[REG_POS(i, 0)]) * static_cast<uint64_t>(v);
@@ -2423,7 +2423,7 @@ TEMPLATE static uint32_t FASTCALL OP_UMLAL_S(uint32_t i)
 		return c + 3; \
 	return c + 4;
 
-TEMPLATE static uint32_t FASTCALL OP_SMULL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMULL(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t v = static_cast<int32_t>(cpu->R[REG_POS(i, 8)]);
 	int64_t res = v * static_cast<int64_t>(static_cast<int32_t>(cpu->R[REG_POS(i, 0)]));
@@ -2434,7 +2434,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMULL(uint32_t i)
 	MUL_SMxxL_END(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMLAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t v = static_cast<int32_t>(cpu->R[REG_POS(i, 8)]);
 	int64_t res = v * static_cast<int64_t>(static_cast<int32_t>(cpu->R[REG_POS(i, 0)]));
@@ -2446,7 +2446,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLAL(uint32_t i)
 	MUL_SMxxL_END(3);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMULL_S(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMULL_S(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t v = static_cast<int32_t>(cpu->R[REG_POS(i, 8)]);
 	int64_t res = v * static_cast<int64_t>(static_cast<int32_t>(cpu->R[REG_POS(i, 0)]));
@@ -2460,7 +2460,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMULL_S(uint32_t i)
 	MUL_SMxxL_END(2);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMLAL_S(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLAL_S(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t v = static_cast<int32_t>(cpu->R[REG_POS(i, 8)]);
 	int64_t res = v * static_cast<int64_t>(static_cast<int32_t>(cpu->R[REG_POS(i, 0)]));
@@ -2479,7 +2479,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLAL_S(uint32_t i)
 //   SWP / SWPB
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_SWP(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SWP(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	uint32_t tmp = ROR(READ32(cpu->mem_if->data, adr), (adr & 3) << 3);
@@ -2492,7 +2492,7 @@ TEMPLATE static uint32_t FASTCALL OP_SWP(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(4, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SWPB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SWPB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	uint8_t tmp = READ8(cpu->mem_if->data, adr);
@@ -2509,7 +2509,7 @@ TEMPLATE static uint32_t FASTCALL OP_SWPB(uint32_t i)
 //   LDRH
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF;
 	cpu->R[REG_POS(i, 12)] = static_cast<uint32_t>(READ16(cpu->mem_if->data, adr));
@@ -2517,7 +2517,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF;
 	cpu->R[REG_POS(i, 12)] = static_cast<uint32_t>(READ16(cpu->mem_if->data, adr));
@@ -2525,7 +2525,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 12)] = static_cast<uint32_t>(READ16(cpu->mem_if->data, adr));
@@ -2533,7 +2533,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 12)] = static_cast<uint32_t>(READ16(cpu->mem_if->data, adr));
@@ -2541,7 +2541,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_M_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2550,7 +2550,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2559,7 +2559,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2568,7 +2568,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2577,7 +2577,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_PRE_INDE_M_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] += IMM_OFF;
@@ -2586,7 +2586,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] -= IMM_OFF;
@@ -2595,7 +2595,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] += cpu->R[REG_POS(i, 0)];
@@ -2604,7 +2604,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] -= cpu->R[REG_POS(i, 0)];
@@ -2617,7 +2617,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_POS_INDE_M_REG_OFF(uint32_t i)
 //   STRH
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF;
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_POS(i, 12)]));
@@ -2625,7 +2625,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF;
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_POS(i, 12)]));
@@ -2633,7 +2633,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + cpu->R[REG_POS(i, 0)];
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_POS(i, 12)]));
@@ -2641,7 +2641,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - cpu->R[REG_POS(i, 0)];
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_POS(i, 12)]));
@@ -2649,7 +2649,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_M_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2658,7 +2658,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2667,7 +2667,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2676,7 +2676,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2685,7 +2685,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_PRE_INDE_M_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_POS(i, 12)]));
@@ -2694,7 +2694,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_POS(i, 12)]));
@@ -2703,7 +2703,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_POS(i, 12)]));
@@ -2712,7 +2712,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_POS(i, 12)]));
@@ -2725,7 +2725,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_POS_INDE_M_REG_OFF(uint32_t i)
 //   LDRSH
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF;
 	cpu->R[REG_POS(i, 12)] = static_cast<int32_t>(static_cast<int16_t>(READ16(cpu->mem_if->data, adr)));
@@ -2733,7 +2733,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF;
 	cpu->R[REG_POS(i, 12)] = static_cast<int32_t>(static_cast<int16_t>(READ16(cpu->mem_if->data, adr)));
@@ -2741,7 +2741,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 12)] = static_cast<int32_t>(static_cast<int16_t>(READ16(cpu->mem_if->data, adr)));
@@ -2749,7 +2749,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 12)] = static_cast<int32_t>(static_cast<int16_t>(READ16(cpu->mem_if->data, adr)));
@@ -2757,7 +2757,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_M_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2766,7 +2766,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2775,7 +2775,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2784,7 +2784,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2793,7 +2793,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_PRE_INDE_M_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] += IMM_OFF;
@@ -2802,7 +2802,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] -= IMM_OFF;
@@ -2811,7 +2811,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] += cpu->R[REG_POS(i, 0)];
@@ -2820,7 +2820,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] -= cpu->R[REG_POS(i, 0)];
@@ -2833,7 +2833,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_POS_INDE_M_REG_OFF(uint32_t i)
 //   LDRSB
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF;
 	cpu->R[REG_POS(i, 12)] = static_cast<int32_t>(static_cast<int8_t>(READ8(cpu->mem_if->data, adr)));
@@ -2841,7 +2841,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF;
 	cpu->R[REG_POS(i, 12)] = static_cast<int32_t>(static_cast<int8_t>(READ8(cpu->mem_if->data, adr)));
@@ -2849,7 +2849,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 12)] = static_cast<int32_t>(static_cast<int8_t>(READ8(cpu->mem_if->data, adr)));
@@ -2857,7 +2857,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 12)] = static_cast<int32_t>(static_cast<int8_t>(READ8(cpu->mem_if->data, adr)));
@@ -2865,7 +2865,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_M_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2874,7 +2874,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2883,7 +2883,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2892,7 +2892,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - cpu->R[REG_POS(i, 0)];
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -2901,7 +2901,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_PRE_INDE_M_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] += IMM_OFF;
@@ -2910,7 +2910,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] -= IMM_OFF;
@@ -2919,7 +2919,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_P_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_P_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] += cpu->R[REG_POS(i, 0)];
@@ -2928,7 +2928,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_P_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_M_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_M_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] -= cpu->R[REG_POS(i, 0)];
@@ -2941,14 +2941,14 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_POS_INDE_M_REG_OFF(uint32_t i)
 //   MRS / MSR
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_MRS_CPSR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MRS_CPSR(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_POS(i, 12)] = cpu->CPSR.val;
 
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MRS_SPSR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MRS_SPSR(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_POS(i, 12)] = cpu->SPSR.val;
 
@@ -2983,7 +2983,7 @@ TEMPLATE static uint32_t FASTCALL OP_MRS_SPSR(uint32_t i)
 #define v5TE_STATE_MASK		0x00000020
 #endif
 
-TEMPLATE static uint32_t FASTCALL OP_MSR_CPSR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MSR_CPSR(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t operand = cpu->R[REG_POS(i, 0)];
 
@@ -3019,7 +3019,7 @@ TEMPLATE static uint32_t FASTCALL OP_MSR_CPSR(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MSR_SPSR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MSR_SPSR(NDS_Instance *nds_inst, uint32_t i)
 {
 	//fprintf(stderr, "OP_MSR_SPSR\n");
 	uint32_t operand = cpu->R[REG_POS(i, 0)];
@@ -3027,7 +3027,7 @@ TEMPLATE static uint32_t FASTCALL OP_MSR_SPSR(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MSR_CPSR_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MSR_CPSR_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	//fprintf(stderr, "OP_MSR_CPSR_IMM_VAL\n");
 	IMM_VALUE;
@@ -3035,7 +3035,7 @@ TEMPLATE static uint32_t FASTCALL OP_MSR_CPSR_IMM_VAL(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MSR_SPSR_IMM_VAL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MSR_SPSR_IMM_VAL(NDS_Instance *nds_inst, uint32_t i)
 {
 	//fprintf(stderr, "OP_MSR_SPSR_IMM_VAL\n");
 	IMM_VALUE;
@@ -3047,7 +3047,7 @@ TEMPLATE static uint32_t FASTCALL OP_MSR_SPSR_IMM_VAL(uint32_t i)
 //   Branch
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_BX(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BX(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = cpu->R[REG_POS(i, 0)];
 
@@ -3057,7 +3057,7 @@ TEMPLATE static uint32_t FASTCALL OP_BX(uint32_t i)
 	return 3;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BLX_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BLX_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = cpu->R[REG_POS(i, 0)];
 
@@ -3070,7 +3070,7 @@ TEMPLATE static uint32_t FASTCALL OP_BLX_REG(uint32_t i)
 
 static inline uint32_t SIGNEXTEND_24(uint32_t i) { return static_cast<uint32_t>((static_cast<int32_t>(i) << 8) >> 8); }
 
-TEMPLATE static uint32_t FASTCALL OP_B(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_B(NDS_Instance *nds_inst, uint32_t i)
 {
 	/*static const uint32_t mov_r12_r12 = 0xE1A0C00C;
 	const uint32_t last = _MMU_read32<PROCNUM,MMU_AT_DEBUG>(cpu->instruct_adr-4);
@@ -3094,7 +3094,7 @@ TEMPLATE static uint32_t FASTCALL OP_B(uint32_t i)
 	return 3;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t off = SIGNEXTEND_24(i);
 	if (CONDITION(i) == 0xF)
@@ -3123,7 +3123,7 @@ const uint8_t CLZ_TAB[]=
 	4, 4, 4, 4, 4, 4, 4, 4		// 1XXX
 };
 
-TEMPLATE static uint32_t FASTCALL OP_CLZ(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CLZ(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rm = cpu->R[REG_POS(i, 0)];
 
@@ -3151,7 +3151,7 @@ TEMPLATE static uint32_t FASTCALL OP_CLZ(uint32_t i)
 //   QADD / QDADD / QSUB / QDSUB
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_QADD(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_QADD(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t res = cpu->R[REG_POS(i, 16)] + cpu->R[REG_POS(i, 0)];
 
@@ -3171,7 +3171,7 @@ TEMPLATE static uint32_t FASTCALL OP_QADD(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_QSUB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_QSUB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t res = cpu->R[REG_POS(i, 0)] - cpu->R[REG_POS(i, 16)];
 
@@ -3191,7 +3191,7 @@ TEMPLATE static uint32_t FASTCALL OP_QSUB(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_QDADD(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_QDADD(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t mul = cpu->R[REG_POS(i, 16)] << 1;
 
@@ -3218,7 +3218,7 @@ TEMPLATE static uint32_t FASTCALL OP_QDADD(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_QDSUB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_QDSUB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t mul = cpu->R[REG_POS(i, 16)] << 1;
 
@@ -3252,7 +3252,7 @@ TEMPLATE static uint32_t FASTCALL OP_QDSUB(uint32_t i)
 static inline int32_t HWORD(uint32_t i) { return static_cast<int32_t>(static_cast<int32_t>(i) >> 16); }
 static inline int32_t LWORD(uint32_t i) { return static_cast<int32_t>(static_cast<int32_t>(i << 16) >> 16); }
 
-TEMPLATE static uint32_t FASTCALL OP_SMUL_B_B(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMUL_B_B(NDS_Instance *nds_inst, uint32_t i)
 {
 	// checked
 	cpu->R[REG_POS(i, 16)] = static_cast<uint32_t>(LWORD(cpu->R[REG_POS(i, 0)]) * LWORD(cpu->R[REG_POS(i, 8)]));
@@ -3260,21 +3260,21 @@ TEMPLATE static uint32_t FASTCALL OP_SMUL_B_B(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMUL_B_T(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMUL_B_T(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_POS(i, 16)] = static_cast<uint32_t>(LWORD(cpu->R[REG_POS(i, 0)]) * HWORD(cpu->R[REG_POS(i, 8)]));
 
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMUL_T_B(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMUL_T_B(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_POS(i, 16)] = static_cast<uint32_t>(HWORD(cpu->R[REG_POS(i, 0)]) * LWORD(cpu->R[REG_POS(i, 8)]));
 
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMUL_T_T(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMUL_T_T(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_POS(i, 16)] = static_cast<uint32_t>(HWORD(cpu->R[REG_POS(i, 0)]) * HWORD(cpu->R[REG_POS(i, 8)]));
 
@@ -3285,7 +3285,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMUL_T_T(uint32_t i)
 //   SMLA
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_SMLA_B_B(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLA_B_B(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = static_cast<uint32_t>(static_cast<int16_t>(cpu->R[REG_POS(i, 0)]) * static_cast<int16_t>(cpu->R[REG_POS(i, 8)]));
 
@@ -3297,7 +3297,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLA_B_B(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMLA_B_T(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLA_B_T(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = static_cast<uint32_t>(LWORD(cpu->R[REG_POS(i, 0)]) * HWORD(cpu->R[REG_POS(i, 8)]));
 	uint32_t a = cpu->R[REG_POS(i, 12)];
@@ -3310,7 +3310,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLA_B_T(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMLA_T_B(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLA_T_B(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = static_cast<uint32_t>(HWORD(cpu->R[REG_POS(i, 0)]) * LWORD(cpu->R[REG_POS(i, 8)]));
 	uint32_t a = cpu->R[REG_POS(i, 12)];
@@ -3323,7 +3323,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLA_T_B(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMLA_T_T(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLA_T_T(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = static_cast<uint32_t>(HWORD(cpu->R[REG_POS(i, 0)]) * HWORD(cpu->R[REG_POS(i, 8)]));
 	uint32_t a = cpu->R[REG_POS(i, 12)];
@@ -3340,7 +3340,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLA_T_T(uint32_t i)
 //   SMLAL
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_SMLAL_B_B(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLAL_B_B(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t tmp = static_cast<int64_t>(LWORD(cpu->R[REG_POS(i, 0)]) * LWORD(cpu->R[REG_POS(i, 8)]));
 	uint64_t res = static_cast<uint64_t>(tmp) + cpu->R[REG_POS(i, 12)];
@@ -3351,7 +3351,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLAL_B_B(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMLAL_B_T(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLAL_B_T(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t tmp = static_cast<int64_t>(LWORD(cpu->R[REG_POS(i, 0)]) * HWORD(cpu->R[REG_POS(i, 8)]));
 	uint64_t res = static_cast<uint64_t>(tmp) + cpu->R[REG_POS(i, 12)];
@@ -3362,7 +3362,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLAL_B_T(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMLAL_T_B(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLAL_T_B(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t tmp = static_cast<int64_t>(HWORD(cpu->R[REG_POS(i, 0)]) * static_cast<int64_t>(LWORD(cpu->R[REG_POS(i, 8)])));
 	uint64_t res = static_cast<uint64_t>(tmp) + cpu->R[REG_POS(i, 12)];
@@ -3373,7 +3373,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLAL_T_B(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMLAL_T_T(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLAL_T_T(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t tmp = static_cast<int64_t>(HWORD(cpu->R[REG_POS(i, 0)]) * HWORD(cpu->R[REG_POS(i, 8)]));
 	uint64_t res = static_cast<uint64_t>(tmp) + cpu->R[REG_POS(i, 12)];
@@ -3388,7 +3388,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLAL_T_T(uint32_t i)
 //   SMULW
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_SMULW_B(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMULW_B(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t tmp = static_cast<int64_t>(LWORD(cpu->R[REG_POS(i, 8)])) * static_cast<int64_t>(static_cast<int32_t>(cpu->R[REG_POS(i, 0)]));
 
@@ -3397,7 +3397,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMULW_B(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMULW_T(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMULW_T(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t tmp = static_cast<int64_t>(HWORD(cpu->R[REG_POS(i, 8)])) * static_cast<int64_t>(static_cast<int32_t>(cpu->R[REG_POS(i, 0)]));
 
@@ -3410,7 +3410,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMULW_T(uint32_t i)
 //   SMLAW
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_SMLAW_B(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLAW_B(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t tmp = static_cast<int64_t>(LWORD(cpu->R[REG_POS(i, 8)])) * static_cast<int64_t>(static_cast<int32_t>(cpu->R[REG_POS(i, 0)]));
 	uint32_t a = cpu->R[REG_POS(i, 12)];
@@ -3425,7 +3425,7 @@ TEMPLATE static uint32_t FASTCALL OP_SMLAW_B(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SMLAW_T(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SMLAW_T(NDS_Instance *nds_inst, uint32_t i)
 {
 	int64_t tmp = static_cast<int64_t>(HWORD(cpu->R[REG_POS(i, 8)])) * static_cast<int64_t>(static_cast<int32_t>(cpu->R[REG_POS(i, 0)]));
 	uint32_t a = cpu->R[REG_POS(i, 12)];
@@ -3502,195 +3502,195 @@ TEMPLATE static uint32_t FASTCALL OP_SMLAW_T(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_READ>(a, adr);
 
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF_12;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF_12;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSL_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSL_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSL_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSL_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_ASR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_ASR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_ASR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_ASR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_ROR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_ROR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_ROR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_ROR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
 	OP_LDR(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF_12;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF_12;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSL_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSL_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSL_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSL_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_ASR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_ASR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_ASR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_ASR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_ROR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_ROR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_ROR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_ROR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
 	OP_LDR_W(3, 5);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	OP_LDR_W2(3, 5, IMM_OFF_12);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	OP_LDR_W2(3, 5, -IMM_OFF_12);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSL_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSL_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_LDR_W2(3, 5, shift_op);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSL_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSL_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	OP_LDR_W2(3, 5, -shift_op);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_LSR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_LDR_W2(3, 5, shift_op);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_LSR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	OP_LDR_W2(3, 5, -shift_op);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_ASR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_ASR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_LDR_W2(3, 5, shift_op);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_ASR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_ASR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	OP_LDR_W2(3, 5, -shift_op);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_P_ROR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_P_ROR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_LDR_W2(3, 5, shift_op);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_M_ROR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_M_ROR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	OP_LDR_W2(3, 5, -shift_op);
@@ -3699,7 +3699,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDR_M_ROR_IMM_OFF_POSTIND(uint32_t i)
 // -----------------------------------------------------------------------------
 //   LDREX
 // -----------------------------------------------------------------------------
-TEMPLATE static uint32_t FASTCALL OP_LDREX(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDREX(NDS_Instance *nds_inst, uint32_t i)
 {
 	fprintf(stderr, "LDREX\n");
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -3711,7 +3711,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDREX(uint32_t i)
 //   LDRB
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF_12;
 	cpu->R[REG_POS(i, 12)] = static_cast<uint32_t>(READ8(cpu->mem_if->data, adr));
@@ -3719,7 +3719,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF_12;
 	cpu->R[REG_POS(i, 12)] = static_cast<uint32_t>(READ8(cpu->mem_if->data, adr));
@@ -3727,7 +3727,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSL_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSL_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -3736,7 +3736,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSL_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSL_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSL_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -3745,7 +3745,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSL_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -3754,7 +3754,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -3763,7 +3763,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ASR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ASR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -3772,7 +3772,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ASR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ASR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ASR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -3781,7 +3781,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ASR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ROR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ROR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -3790,7 +3790,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ROR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ROR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ROR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -3799,7 +3799,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ROR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF_12;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -3808,7 +3808,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF_12;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -3817,7 +3817,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSL_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSL_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -3827,7 +3827,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSL_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSL_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSL_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -3837,7 +3837,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSL_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -3847,7 +3847,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -3857,7 +3857,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ASR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ASR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -3867,7 +3867,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ASR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ASR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ASR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -3877,7 +3877,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ASR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ROR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ROR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -3887,7 +3887,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ROR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ROR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ROR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -3897,7 +3897,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ROR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] = adr + IMM_OFF_12;
@@ -3906,7 +3906,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	cpu->R[REG_POS(i, 16)] = adr - IMM_OFF_12;
@@ -3915,7 +3915,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSL_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSL_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -3925,7 +3925,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSL_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSL_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSL_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -3935,7 +3935,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSL_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -3945,7 +3945,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_LSR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -3955,7 +3955,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_LSR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ASR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ASR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -3965,7 +3965,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ASR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ASR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ASR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -3975,7 +3975,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ASR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ROR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ROR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -3985,7 +3985,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_P_ROR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ROR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ROR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -3999,7 +3999,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_M_ROR_IMM_OFF_POSTIND(uint32_t i)
 //   STR
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF_12;
 	WRITE32(cpu->mem_if->data, adr, cpu->R[REG_POS(i, 12)]);
@@ -4007,7 +4007,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF_12;
 	WRITE32(cpu->mem_if->data, adr, cpu->R[REG_POS(i, 12)]);
@@ -4015,7 +4015,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_LSL_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_LSL_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4024,7 +4024,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_LSL_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_LSL_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_LSL_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4033,7 +4033,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_LSL_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_LSR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_LSR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4042,7 +4042,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_LSR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_LSR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_LSR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4051,7 +4051,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_LSR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_ASR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_ASR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4060,7 +4060,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_ASR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_ASR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_ASR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4069,7 +4069,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_ASR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_ROR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_ROR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4078,7 +4078,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_ROR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_ROR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_ROR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4087,7 +4087,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_ROR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF_12;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -4096,7 +4096,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF_12;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -4105,7 +4105,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_LSL_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_LSL_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4115,7 +4115,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_LSL_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_LSL_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_LSL_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4125,7 +4125,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_LSL_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_LSR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_LSR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4135,7 +4135,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_LSR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_LSR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_LSR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4145,7 +4145,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_LSR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_ASR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_ASR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4155,7 +4155,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_ASR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_ASR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_ASR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4165,7 +4165,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_ASR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_ROR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_ROR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4175,7 +4175,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_ROR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_ROR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_ROR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4185,7 +4185,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_ROR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	WRITE32(cpu->mem_if->data, adr, cpu->R[REG_POS(i, 12)]);
@@ -4194,7 +4194,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	WRITE32(cpu->mem_if->data, adr, cpu->R[REG_POS(i, 12)]);
@@ -4203,7 +4203,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_LSL_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_LSL_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4213,7 +4213,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_LSL_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_LSL_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_LSL_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4223,7 +4223,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_LSL_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_LSR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_LSR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4233,7 +4233,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_LSR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_LSR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_LSR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4243,7 +4243,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_LSR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_ASR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_ASR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4253,7 +4253,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_ASR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_ASR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_ASR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4263,7 +4263,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_ASR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_P_ROR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_P_ROR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4273,7 +4273,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_P_ROR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_M_ROR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_M_ROR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4286,7 +4286,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_M_ROR_IMM_OFF_POSTIND(uint32_t i)
 // -----------------------------------------------------------------------------
 //   STREX
 // -----------------------------------------------------------------------------
-TEMPLATE static uint32_t FASTCALL OP_STREX(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STREX(NDS_Instance *nds_inst, uint32_t i)
 {
 	fprintf(stderr, "STREX\n");
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4300,7 +4300,7 @@ TEMPLATE static uint32_t FASTCALL OP_STREX(uint32_t i)
 //   STRB
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF_12;
 	WRITE8(cpu->mem_if->data, adr, static_cast<uint8_t>(cpu->R[REG_POS(i, 12)]));
@@ -4308,7 +4308,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF_12;
 	WRITE8(cpu->mem_if->data, adr, static_cast<uint8_t>(cpu->R[REG_POS(i, 12)]));
@@ -4316,7 +4316,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSL_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSL_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4325,7 +4325,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSL_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSL_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSL_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4334,7 +4334,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSL_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4343,7 +4343,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4352,7 +4352,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_ASR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_ASR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4361,7 +4361,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_ASR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_ASR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_ASR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4370,7 +4370,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_ASR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_ROR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_ROR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4379,7 +4379,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_ROR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_ROR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_ROR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4388,7 +4388,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_ROR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + IMM_OFF_12;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -4397,7 +4397,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - IMM_OFF_12;
 	cpu->R[REG_POS(i, 16)] = adr;
@@ -4406,7 +4406,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSL_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSL_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4416,7 +4416,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSL_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSL_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSL_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4426,7 +4426,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSL_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4436,7 +4436,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4446,7 +4446,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_ASR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_ASR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4456,7 +4456,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_ASR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_ASR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_ASR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4466,7 +4466,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_ASR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_ROR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_ROR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] + shift_op;
@@ -4476,7 +4476,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_ROR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_ROR_IMM_OFF_PREIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_ROR_IMM_OFF_PREIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)] - shift_op;
@@ -4486,7 +4486,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_ROR_IMM_OFF_PREIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	WRITE8(cpu->mem_if->data, adr, static_cast<uint8_t>(cpu->R[REG_POS(i, 12)]));
@@ -4495,7 +4495,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
 	WRITE8(cpu->mem_if->data, adr, static_cast<uint8_t>(cpu->R[REG_POS(i, 12)]));
@@ -4504,7 +4504,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSL_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSL_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4514,7 +4514,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSL_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSL_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSL_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSL_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4524,7 +4524,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSL_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4534,7 +4534,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_LSR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	LSR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4544,7 +4544,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_LSR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_ASR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_ASR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4554,7 +4554,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_ASR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_ASR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_ASR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ASR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4564,7 +4564,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_ASR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_P_ROR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_P_ROR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4574,7 +4574,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_P_ROR_IMM_OFF_POSTIND(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_M_ROR_IMM_OFF_POSTIND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_M_ROR_IMM_OFF_POSTIND(NDS_Instance *nds_inst, uint32_t i)
 {
 	ROR_IMM;
 	uint32_t adr = cpu->R[REG_POS(i, 16)];
@@ -4620,7 +4620,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_M_ROR_IMM_OFF_POSTIND(uint32_t i)
 		c += MMU_memAccessCycles<PROCNUM, 32, MMU_AD_READ>(start); \
 	}
 
-TEMPLATE static uint32_t FASTCALL OP_LDMIA(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMIA(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -4676,7 +4676,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMIA(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMIB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMIB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -4718,7 +4718,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMIB(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMDA(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMDA(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -4759,7 +4759,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMDA(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMDB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMDB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -4800,7 +4800,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMDB(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMIA_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMIA_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -4850,7 +4850,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMIA_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(BIT15(i) ? 4 : 2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMIB_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMIB_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -4901,7 +4901,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMIB_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(BIT15(i) ? 4 : 2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMDA_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMDA_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -4951,7 +4951,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMDA_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMDB_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMDB_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5002,7 +5002,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMDB_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMIA2(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMIA2(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5054,7 +5054,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMIA2(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMIB2(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMIB2(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5106,7 +5106,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMIB2(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMDA2(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMDA2(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i,16)];
@@ -5164,7 +5164,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMDA2(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMDB2(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMDB2(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i,16)];
@@ -5223,7 +5223,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMDB2(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMIA2_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMIA2_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i,16)];
@@ -5279,7 +5279,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMIA2_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMIB2_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMIB2_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5338,7 +5338,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMIB2_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMDA2_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMDA2_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i,16)];
@@ -5399,7 +5399,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMDA2_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMDB2_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMDB2_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5466,7 +5466,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMDB2_W(uint32_t i)
 //   STMIA / STMIB / STMDA / STMDB
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_STMIA(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMIA(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5483,7 +5483,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMIA(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMIB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMIB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5500,7 +5500,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMIB(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMDA(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMDA(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5517,7 +5517,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMDA(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMDB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMDB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5534,7 +5534,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMDB(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMIA_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMIA_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5553,7 +5553,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMIA_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMIB_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMIB_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5571,7 +5571,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMIB_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMDA_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMDA_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5590,7 +5590,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMDA_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMDB_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMDB_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t c = 0;
 	uint32_t start = cpu->R[REG_POS(i, 16)];
@@ -5609,7 +5609,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMDB_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMIA2(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMIA2(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (cpu->CPSR.bits.mode == USR)
 		return 2;
@@ -5632,7 +5632,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMIA2(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMIB2(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMIB2(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (cpu->CPSR.bits.mode == USR)
 		return 2;
@@ -5655,7 +5655,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMIB2(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMDA2(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMDA2(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (cpu->CPSR.bits.mode == USR)
 		return 2;
@@ -5678,7 +5678,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMDA2(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMDB2(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMDB2(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (cpu->CPSR.bits.mode == USR)
 		return 2;
@@ -5701,7 +5701,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMDB2(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMIA2_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMIA2_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (cpu->CPSR.bits.mode == USR)
 		return 2;
@@ -5726,7 +5726,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMIA2_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMIB2_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMIB2_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (cpu->CPSR.bits.mode == USR)
 		return 2;
@@ -5751,7 +5751,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMIB2_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMDA2_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMDA2_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (cpu->CPSR.bits.mode == USR)
 		return 2;
@@ -5776,7 +5776,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMDA2_W(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(1, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STMDB2_W(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMDB2_W(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (cpu->CPSR.bits.mode == USR)
 		return 2;
@@ -5805,7 +5805,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMDB2_W(uint32_t i)
 //   LDRD / STRD
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LDRD_STRD_POST_INDEX(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRD_STRD_POST_INDEX(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rd_num = REG_POS(i, 12);
 	uint32_t addr = cpu->R[REG_POS(i, 16)];
@@ -5847,7 +5847,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRD_STRD_POST_INDEX(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(3, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRD_STRD_OFFSET_PRE_INDEX(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRD_STRD_OFFSET_PRE_INDEX(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rd_num = REG_POS(i, 12);
 	uint32_t addr = cpu->R[REG_POS(i, 16)];
@@ -5900,43 +5900,43 @@ TEMPLATE static uint32_t FASTCALL OP_LDRD_STRD_OFFSET_PRE_INDEX(uint32_t i)
 //   the NDS has no coproc that responses to a STC, no feedback is given to the arm
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_STC_P_IMM_OFF(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_STC_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_STC_P_IMM_OFF\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STC_M_IMM_OFF(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_STC_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_STC_M_IMM_OFF\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STC_P_PREIND(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_STC_P_PREIND(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_STC_P_PREIND\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STC_M_PREIND(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_STC_M_PREIND(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_STC_M_PREIND\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STC_P_POSTIND(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_STC_P_POSTIND(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_STC_P_POSTIND: cp_num %i\n", (i>>8)&0x0F);
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STC_M_POSTIND(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_STC_M_POSTIND(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_STC_M_POSTIND\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STC_OPTION(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_STC_OPTION(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_STC_OPTION\n");
 	return TRAPUNDEF(cpu);
@@ -5947,43 +5947,43 @@ TEMPLATE static uint32_t FASTCALL OP_STC_OPTION(uint32_t)
 //   the NDS has no coproc that responses to a LDC, no feedback is given to the arm
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LDC_P_IMM_OFF(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_LDC_P_IMM_OFF(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_LDC_P_IMM_OFF\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDC_M_IMM_OFF(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_LDC_M_IMM_OFF(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_LDC_M_IMM_OFF\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDC_P_PREIND(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_LDC_P_PREIND(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_LDC_P_PREIND\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDC_M_PREIND(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_LDC_M_PREIND(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_LDC_M_PREIND\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDC_P_POSTIND(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_LDC_P_POSTIND(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_LDC_P_POSTIND\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDC_M_POSTIND(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_LDC_M_POSTIND(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_LDC_M_POSTIND\n");
 	return TRAPUNDEF(cpu);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDC_OPTION(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_LDC_OPTION(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("OP_LDC_OPTION\n");
 	return TRAPUNDEF(cpu);
@@ -5993,7 +5993,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDC_OPTION(uint32_t)
 //   MCR / MRC
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_MCR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MCR(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t cpnum = REG_POS(i, 8);
 
@@ -6005,7 +6005,7 @@ TEMPLATE static uint32_t FASTCALL OP_MCR(uint32_t i)
 	return 2;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MRC(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MRC(NDS_Instance *nds_inst, uint32_t i)
 {
 	//if (PROCNUM != 0) return 1;
 
@@ -6043,7 +6043,7 @@ TEMPLATE static uint32_t FASTCALL OP_MRC(uint32_t i)
 //   SWI
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_SWI(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SWI(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t swinum = (i >> 16) & 0xFF;
 
@@ -6084,7 +6084,7 @@ TEMPLATE static uint32_t FASTCALL OP_SWI(uint32_t i)
 //   BKPT
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_BKPT(uint32_t /*i*/)
+TEMPLATE static uint32_t FASTCALL OP_BKPT(NDS_Instance *nds_inst, uint32_t /*i*/)
 {
 	/* ARM-ref
 	if (not overridden by debug hardware)
@@ -6130,7 +6130,7 @@ TEMPLATE static uint32_t FASTCALL OP_BKPT(uint32_t /*i*/)
 //   CDP
 // -----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_CDP(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_CDP(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("Stopped (OP_CDP) \n");
 	return TRAPUNDEF(cpu);
@@ -30,19 +30,16 @@
 #include "lua-engine.h"
 #endif
 
-template<uint32_t> static uint32_t armcpu_prefetch();
+template<uint32_t> static uint32_t armcpu_prefetch(NDS_Instance *nds_inst);
 
 static inline uint32_t armcpu_prefetch(armcpu_t *armcpu)
 {
 	if (!armcpu->proc_ID)
-		return armcpu_prefetch<0>();
+		return armcpu_prefetch<0>(nds_inst);
 	else
-		return armcpu_prefetch<1>();
+		return armcpu_prefetch<1>(nds_inst);
 }
 
-armcpu_t NDS_ARM7;
-armcpu_t NDS_ARM9;
-
 int armcpu_new(armcpu_t *armcpu, uint32_t id)
 {
 	armcpu->proc_ID = id;
@@ -91,6 +88,10 @@ void armcpu_init(armcpu_t *armcpu, uint32_t adr)
 
 	armcpu->next_instruction = adr;
 
+	armcpu->fetch_page = 0xFFFFFFFF;
+	armcpu->fetch_mask = 0;
+	armcpu->fetch_mem = nullptr;
+
 	armcpu_prefetch(armcpu);
 }
 
@@ -186,6 +187,16 @@ uint32_t armcpu_switchMode(armcpu_t *armcpu, uint8_t mode)
 	return oldmode;
 }
 
+void setIF(int PROCNUM, uint32_t flag)
+{
+	// don't set generated bits!!!
+	assert(!(flag&0x00200000));
+
+	MMU.reg_IF_bits[PROCNUM] |= flag;
+
+	NDS_Reschedule();
+}
+
 uint32_t armcpu_Wait4IRQ(armcpu_t *cpu)
 {
 	cpu->waitIRQ = true;
@@ -193,7 +204,41 @@ uint32_t armcpu_Wait4IRQ(armcpu_t *cpu)
 	return 1;
 }
 
-template<uint32_t PROCNUM> static inline uint32_t armcpu_prefetch()
+// Code is almost always fetched from main memory, ITCM or (on the arm7) WRAM,
+// whose host mapping never changes while the system runs. Remember which page
+// the cpu is executing from so sequential fetches read the host memory
+// directly instead of decoding the address through _MMU_read32/16 each time.
+// Since the memory itself is still read on every fetch, self-modifying code and
+// DMA into the code region need no invalidation. A cache of decoded handlers
+// with write invalidation on top of this measured no faster, so there isn't one.
+template<uint32_t PROCNUM> static void armcpu_fetch_page(NDS_Instance *nds_inst, armcpu_t *armcpu, uint32_t adr)
+{
+	armcpu->fetch_page = adr >> 20;
+
+	if ((adr & 0x0F000000) == 0x02000000)
+	{
+		armcpu->fetch_mask = _MMU_MAIN_MEM_MASK;
+		armcpu->fetch_mem = MMU.MAIN_MEM;
+	}
+	else if (PROCNUM == ARMCPU_ARM9 && adr < 0x02000000)
+	{
+		armcpu->fetch_mask = 0x7FFF;
+		armcpu->fetch_mem = MMU.ARM9_ITCM;
+	}
+	else if (PROCNUM == ARMCPU_ARM7 && (adr & 0x0F000000) == 0x03000000)
+	{
+		armcpu->fetch_mask = MMU.MMU_MASK[ARMCPU_ARM7][(adr >> 20) & 0xFF];
+		armcpu->fetch_mem = MMU.MMU_MEM[ARMCPU_ARM7][(adr >> 20) & 0xFF];
+	}
+	else
+	{
+		// bios (with its read protection) and i/o go through the MMU
+		armcpu->fetch_mask = 0;
+		armcpu->fetch_mem = nullptr;
+	}
+}
+
+template<uint32_t PROCNUM> static inline uint32_t armcpu_prefetch(NDS_Instance *nds_inst)
 {
 	armcpu_t *const armcpu = &ARMPROC;
 	uint32_t curInstruction = armcpu->next_instruction;
@@ -206,7 +251,12 @@ template<uint32_t PROCNUM> static inline uint32_t armcpu_prefetch()
 		armcpu->instruct_adr = curInstruction;
 		armcpu->next_instruction = curInstruction + 4;
 		armcpu->R[15] = curInstruction + 8;
-		armcpu->instruction = _MMU_read32<PROCNUM, MMU_AT_CODE>(curInstruction);
+		if ((curInstruction >> 20) != armcpu->fetch_page)
+			armcpu_fetch_page<PROCNUM>(nds_inst, armcpu, curInstruction);
+		if (armcpu->fetch_mem)
+			armcpu->instruction = T1ReadLong_guaranteedAligned(armcpu->fetch_mem, curInstruction & armcpu->fetch_mask);
+		else
+			armcpu->instruction = _MMU_read32(nds_inst, PROCNUM, MMU_AT_CODE, curInstruction);
 
 		return MMU_codeFetchCycles<PROCNUM, 32>(curInstruction);
 	}
@@ -216,7 +266,12 @@ template<uint32_t PROCNUM> static inline uint32_t armcpu_prefetch()
 	armcpu->instruct_adr = curInstruction;
 	armcpu->next_instruction = curInstruction + 2;
 	armcpu->R[15] = curInstruction + 4;
-	armcpu->instruction = _MMU_read16<PROCNUM, MMU_AT_CODE>(curInstruction);
+	if ((curInstruction >> 20) != armcpu->fetch_page)
+		armcpu_fetch_page<PROCNUM>(nds_inst, armcpu, curInstruction);
+	if (armcpu->fetch_mem)
+		armcpu->instruction = T1ReadWord_guaranteedAligned(armcpu->fetch_mem, curInstruction & armcpu->fetch_mask);
+	else
+		armcpu->instruction = _MMU_read16(nds_inst, PROCNUM, MMU_AT_CODE, curInstruction);
 
 	if (!PROCNUM)
 	{
@@ -313,7 +368,7 @@ uint32_t TRAPUNDEF(armcpu_t *cpu)
 	}
 }
 
-template<int PROCNUM> uint32_t armcpu_exec()
+template<int PROCNUM> uint32_t armcpu_exec(NDS_Instance *nds_inst)
 {
 	// Usually, fetching and executing are processed parallelly.
 	// So this function stores the cycles of each process to
@@ -338,23 +393,23 @@ template<int PROCNUM> uint32_t armcpu_exec()
 #ifdef HAVE_LUA
 			CallRegisteredLuaMemHook(ARMPROC.instruct_adr, 4, ARMPROC.instruction, LUAMEMHOOK_EXEC); // should report even if condition=false?
 #endif
-			cExecute = arm_instructions_set[PROCNUM][INSTRUCTION_INDEX(ARMPROC.instruction)](ARMPROC.instruction);
+			cExecute = arm_instructions_set[PROCNUM][INSTRUCTION_INDEX(ARMPROC.instruction)](nds_inst, ARMPROC.instruction);
 		}
 		else
 			cExecute = 1; // If condition=false: 1S cycle
-		cFetch = armcpu_prefetch<PROCNUM>();
+		cFetch = armcpu_prefetch<PROCNUM>(nds_inst);
 		return MMU_fetchExecuteCycles<PROCNUM>(cExecute, cFetch);
 	}
 
 #ifdef HAVE_LUA
 	CallRegisteredLuaMemHook(ARMPROC.instruct_adr, 2, ARMPROC.instruction, LUAMEMHOOK_EXEC);
 #endif
-	cExecute = thumb_instructions_set[PROCNUM][ARMPROC.instruction>>6](ARMPROC.instruction);
+	cExecute = thumb_instructions_set[PROCNUM][ARMPROC.instruction>>6](nds_inst, ARMPROC.instruction);
 
-	cFetch = armcpu_prefetch<PROCNUM>();
+	cFetch = armcpu_prefetch<PROCNUM>(nds_inst);
 	return MMU_fetchExecuteCycles<PROCNUM>(cExecute, cFetch);
 }
 
 // these templates needed to be instantiated manually
-template uint32_t armcpu_exec<0>();
-template uint32_t armcpu_exec<1>();
+template uint32_t armcpu_exec<0>(NDS_Instance *nds_inst);
+template uint32_t armcpu_exec<1>(NDS_Instance *nds_inst);
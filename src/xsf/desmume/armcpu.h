@@ -208,6 +208,12 @@ struct armcpu_t
 	// flag indicating if the processor is stalled (for debugging)
 	int stalled;
 
+	// host memory backing the 1MB page code is currently fetched from,
+	// or nullptr if fetches from that page have to go through the MMU
+	uint32_t fetch_page;
+	uint32_t fetch_mask;
+	const uint8_t *fetch_mem;
+
 #if defined(_M_X64) || defined(__x86_64__)
 	uint8_t cond_table[16 * 16];
 #endif
@@ -222,20 +228,12 @@ void armcpu_exception(armcpu_t *cpu, uint32_t number);
 uint32_t TRAPUNDEF(armcpu_t* cpu);
 uint32_t armcpu_Wait4IRQ(armcpu_t *cpu);
 
-extern armcpu_t NDS_ARM7, NDS_ARM9;
-
-template<int PROCNUM> uint32_t armcpu_exec();
+#define NDS_ARM7 (nds_inst->arm7)
+#define NDS_ARM9 (nds_inst->arm9)
 
-inline void setIF(int PROCNUM, uint32_t flag)
-{
-	// don't set generated bits!!!
-	assert(!(flag&0x00200000));
+template<int PROCNUM> uint32_t armcpu_exec(NDS_Instance *nds_inst);
 
-	MMU.reg_IF_bits[PROCNUM] |= flag;
-
-	extern void NDS_Reschedule();
-	NDS_Reschedule();
-}
+void setIF(int PROCNUM, uint32_t flag);
 
 inline void NDS_makeIrq(int PROCNUM, uint32_t num)
 {
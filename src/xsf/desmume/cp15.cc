@@ -18,9 +18,7 @@
 
 #include <cstdlib>
 #include "cp15.h"
-#include "MMU.h"
-
-armcp15_t cp15;
+#include "NDSSystem.h"
 
 bool armcp15_t::reset(armcpu_t *c)
 {
@@ -107,5 +107,5 @@ public:
 	bool isAccessAllowed(uint32_t address,uint32_t access);
 };
 
-extern armcp15_t cp15;
+#define cp15 (nds_inst->arm9cp15)
 void maskPrecalc();
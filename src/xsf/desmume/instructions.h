@@ -17,7 +17,7 @@
 
 #pragma once
 
-typedef uint32_t (FASTCALL *OpFunc)(uint32_t i);
+typedef uint32_t (FASTCALL *OpFunc)(NDS_Instance *nds_inst, uint32_t i);
 extern const OpFunc arm_instructions_set[2][4096];
 extern const char *arm_instruction_names[4096];
 extern const OpFunc thumb_instructions_set[2][1024];
@@ -32,7 +32,7 @@ static inline uint32_t REG_NUM(uint32_t i, uint32_t n) { return (i >> n) & 0x7;
 //-----------------------------------------------------------------------------
 //   Undefined instruction
 //-----------------------------------------------------------------------------
-TEMPLATE static uint32_t FASTCALL OP_UND_THUMB(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_UND_THUMB(NDS_Instance *nds_inst, uint32_t)
 {
 	//INFO("THUMB%c: Undefined instruction: 0x%08X (%s) PC=0x%08X\n", cpu->proc_ID?'7':'9', cpu->instruction, decodeIntruction(true, cpu->instruction), cpu->instruct_adr);
 	TRAPUNDEF(cpu);
@@ -43,7 +43,7 @@ TEMPLATE static uint32_t FASTCALL OP_UND_THUMB(uint32_t)
 //   LSL
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LSL_0(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LSL_0(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_NUM(i, 0)] = cpu->R[REG_NUM(i, 3)];
 	cpu->CPSR.bits.N = BIT31(cpu->R[REG_NUM(i, 0)]);
@@ -52,7 +52,7 @@ TEMPLATE static uint32_t FASTCALL OP_LSL_0(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LSL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LSL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = (i >> 6) & 0x1F;
 	cpu->CPSR.bits.C = BIT_N(cpu->R[REG_NUM(i, 3)], 32 - v);
@@ -63,7 +63,7 @@ TEMPLATE static uint32_t FASTCALL OP_LSL(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LSL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LSL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_NUM(i, 3)] & 0xFF;
 
@@ -97,7 +97,7 @@ TEMPLATE static uint32_t FASTCALL OP_LSL_REG(uint32_t i)
 //   LSR
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LSR_0(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LSR_0(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->CPSR.bits.C = BIT31(cpu->R[REG_NUM(i, 3)]);
 	cpu->R[REG_NUM(i, 0)] = 0;
@@ -107,7 +107,7 @@ TEMPLATE static uint32_t FASTCALL OP_LSR_0(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LSR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LSR(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = (i >> 6) & 0x1F;
 	cpu->CPSR.bits.C = BIT_N(cpu->R[REG_NUM(i, 3)], v - 1);
@@ -118,7 +118,7 @@ TEMPLATE static uint32_t FASTCALL OP_LSR(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LSR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LSR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_NUM(i, 3)] & 0xFF;
 
@@ -152,7 +152,7 @@ TEMPLATE static uint32_t FASTCALL OP_LSR_REG(uint32_t i)
 //   ASR
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_ASR_0(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ASR_0(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->CPSR.bits.C = BIT31(cpu->R[REG_NUM(i, 3)]);
 	cpu->R[REG_NUM(i, 0)] = BIT31(cpu->R[REG_NUM(i, 3)]) * 0xFFFFFFFF;
@@ -162,7 +162,7 @@ TEMPLATE static uint32_t FASTCALL OP_ASR_0(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ASR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ASR(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = (i >> 6) & 0x1F;
 	cpu->CPSR.bits.C = BIT_N(cpu->R[REG_NUM(i, 3)], v-1);
@@ -173,7 +173,7 @@ TEMPLATE static uint32_t FASTCALL OP_ASR(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ASR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ASR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_NUM(i, 3)] & 0xFF;
 
@@ -204,7 +204,7 @@ TEMPLATE static uint32_t FASTCALL OP_ASR_REG(uint32_t i)
 //   ADD
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_IMM3(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_IMM3(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t imm3 = (i >> 6) & 0x07;
 	uint32_t Rn = cpu->R[REG_NUM(i, 3)];
@@ -228,7 +228,7 @@ TEMPLATE static uint32_t FASTCALL OP_ADD_IMM3(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_IMM8(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_IMM8(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t imm8 = i & 0xFF;
 	uint32_t Rd = cpu->R[REG_NUM(i, 8)];
@@ -242,7 +242,7 @@ TEMPLATE static uint32_t FASTCALL OP_ADD_IMM8(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rn = cpu->R[REG_NUM(i, 3)];
 	uint32_t Rm = cpu->R[REG_NUM(i, 6)];
@@ -256,7 +256,7 @@ TEMPLATE static uint32_t FASTCALL OP_ADD_REG(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_SPE(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_SPE(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rd = REG_NUM(i, 0) | ((i >> 4) & 8);
 
@@ -271,14 +271,14 @@ TEMPLATE static uint32_t FASTCALL OP_ADD_SPE(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_2PC(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_2PC(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_NUM(i, 8)] = (cpu->R[15] & 0xFFFFFFFC) + ((i & 0xFF) << 2);
 
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADD_2SP(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADD_2SP(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_NUM(i, 8)] = cpu->R[13] + ((i & 0xFF) << 2);
 
@@ -289,7 +289,7 @@ TEMPLATE static uint32_t FASTCALL OP_ADD_2SP(uint32_t i)
 //   SUB
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_IMM3(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_IMM3(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t imm3 = (i >> 6) & 0x07;
 	uint32_t Rn = cpu->R[REG_NUM(i, 3)];
@@ -304,7 +304,7 @@ TEMPLATE static uint32_t FASTCALL OP_SUB_IMM3(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_IMM8(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_IMM8(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t imm8 = i & 0xFF;
 	uint32_t Rd = cpu->R[REG_NUM(i, 8)];
@@ -319,7 +319,7 @@ TEMPLATE static uint32_t FASTCALL OP_SUB_IMM8(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_SUB_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SUB_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rn = cpu->R[REG_NUM(i, 3)];
 	uint32_t Rm = cpu->R[REG_NUM(i, 6)];
@@ -338,7 +338,7 @@ TEMPLATE static uint32_t FASTCALL OP_SUB_REG(uint32_t i)
 //   MOV
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_IMM8(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_IMM8(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_NUM(i, 8)] = i & 0xFF;
 	cpu->CPSR.bits.N = BIT31(cpu->R[REG_NUM(i, 8)]);
@@ -347,7 +347,7 @@ TEMPLATE static uint32_t FASTCALL OP_MOV_IMM8(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_MOV_SPE(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MOV_SPE(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rd = REG_NUM(i, 0) | ((i >> 4) & 8);
 
@@ -365,7 +365,7 @@ TEMPLATE static uint32_t FASTCALL OP_MOV_SPE(uint32_t i)
 //-----------------------------------------------------------------------------
 //   CMP
 //-----------------------------------------------------------------------------
-TEMPLATE static uint32_t FASTCALL OP_CMP_IMM8(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_IMM8(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = cpu->R[REG_NUM(i, 8)] - (i & 0xFF);
 
@@ -377,7 +377,7 @@ TEMPLATE static uint32_t FASTCALL OP_CMP_IMM8(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = cpu->R[REG_NUM(i, 0)] - cpu->R[REG_NUM(i, 3)];
 
@@ -389,7 +389,7 @@ TEMPLATE static uint32_t FASTCALL OP_CMP(uint32_t i)
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_CMP_SPE(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMP_SPE(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rn = (i & 7) | ((i >> 4) & 8);
 
@@ -407,7 +407,7 @@ TEMPLATE static uint32_t FASTCALL OP_CMP_SPE(uint32_t i)
 //   AND
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_AND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_AND(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_NUM(i, 0)] &= cpu->R[REG_NUM(i, 3)];
 	cpu->CPSR.bits.N = BIT31(cpu->R[REG_NUM(i, 0)]);
@@ -419,7 +419,7 @@ TEMPLATE static uint32_t FASTCALL OP_AND(uint32_t i)
 //   EOR
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_EOR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_EOR(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_NUM(i, 0)] ^= cpu->R[REG_NUM(i, 3)];
 	cpu->CPSR.bits.N = BIT31(cpu->R[REG_NUM(i, 0)]);
@@ -432,7 +432,7 @@ TEMPLATE static uint32_t FASTCALL OP_EOR(uint32_t i)
 //   ADC
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_ADC_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADC_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rd = cpu->R[REG_NUM(i, 0)];
 	uint32_t Rm = cpu->R[REG_NUM(i, 3)];
@@ -458,7 +458,7 @@ TEMPLATE static uint32_t FASTCALL OP_ADC_REG(uint32_t i)
 //   SBC
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_SBC_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SBC_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rd = cpu->R[REG_NUM(i, 0)];
 	uint32_t Rm = cpu->R[REG_NUM(i, 3)];
@@ -485,7 +485,7 @@ TEMPLATE static uint32_t FASTCALL OP_SBC_REG(uint32_t i)
 //   ROR
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_ROR_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ROR_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_NUM(i, 3)] & 0xFF;
 
@@ -517,7 +517,7 @@ TEMPLATE static uint32_t FASTCALL OP_ROR_REG(uint32_t i)
 //   TST
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_TST(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_TST(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = cpu->R[REG_NUM(i, 0)] & cpu->R[REG_NUM(i, 3)];
 	cpu->CPSR.bits.N = BIT31(tmp);
@@ -530,7 +530,7 @@ TEMPLATE static uint32_t FASTCALL OP_TST(uint32_t i)
 //   NEG
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_NEG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_NEG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rm = cpu->R[REG_NUM(i, 3)];
 
@@ -548,7 +548,7 @@ TEMPLATE static uint32_t FASTCALL OP_NEG(uint32_t i)
 //   CMN
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_CMN(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_CMN(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t tmp = cpu->R[REG_NUM(i, 0)] + cpu->R[REG_NUM(i, 3)];
 
@@ -564,7 +564,7 @@ TEMPLATE static uint32_t FASTCALL OP_CMN(uint32_t i)
 //   ORR
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_ORR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ORR(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_NUM(i, 0)] |= cpu->R[REG_NUM(i, 3)];
 
@@ -578,7 +578,7 @@ TEMPLATE static uint32_t FASTCALL OP_ORR(uint32_t i)
 //   BIC
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_BIC(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BIC(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_NUM(i, 0)] &= ~cpu->R[REG_NUM(i, 3)];
 
@@ -592,7 +592,7 @@ TEMPLATE static uint32_t FASTCALL OP_BIC(uint32_t i)
 //   MVN
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_MVN(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MVN(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[REG_NUM(i, 0)] = ~cpu->R[REG_NUM(i, 3)];
 
@@ -618,7 +618,7 @@ TEMPLATE static uint32_t FASTCALL OP_MVN(uint32_t i)
 		return c + 3; \
 	return c + 4;
 
-TEMPLATE static uint32_t FASTCALL OP_MUL_REG(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_MUL_REG(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t v = cpu->R[REG_NUM(i, 3)];
 
@@ -645,7 +645,7 @@ TEMPLATE static uint32_t FASTCALL OP_MUL_REG(uint32_t i)
 //   STRB / LDRB
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + ((i >> 6) & 0x1F);
 	WRITE8(cpu->mem_if->data, adr, static_cast<uint8_t>(cpu->R[REG_NUM(i, 0)]));
@@ -653,7 +653,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRB_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRB_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + ((i>>6)&0x1F);
 	cpu->R[REG_NUM(i, 0)] = static_cast<uint32_t>(READ8(cpu->mem_if->data, adr));
@@ -661,7 +661,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRB_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRB_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRB_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + cpu->R[REG_NUM(i, 6)];
 	WRITE8(cpu->mem_if->data, adr, static_cast<uint8_t>(cpu->R[REG_NUM(i, 0)]));
@@ -669,7 +669,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRB_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 8, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static  uint32_t FASTCALL OP_LDRB_REG_OFF(uint32_t i)
+TEMPLATE static  uint32_t FASTCALL OP_LDRB_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + cpu->R[REG_NUM(i, 6)];
 	cpu->R[REG_NUM(i, 0)] = static_cast<uint32_t>(READ8(cpu->mem_if->data, adr));
@@ -681,7 +681,7 @@ TEMPLATE static  uint32_t FASTCALL OP_LDRB_REG_OFF(uint32_t i)
 //   LDRSB
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSB_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSB_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + cpu->R[REG_NUM(i, 6)];
 	cpu->R[REG_NUM(i, 0)] = static_cast<uint32_t>(static_cast<int8_t>(READ8(cpu->mem_if->data, adr)));
@@ -693,7 +693,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSB_REG_OFF(uint32_t i)
 //   STRH / LDRH
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + ((i >> 5) & 0x3E);
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_NUM(i, 0)]));
@@ -701,7 +701,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + ((i >> 5) & 0x3E);
 	cpu->R[REG_NUM(i, 0)] = static_cast<uint32_t>(READ16(cpu->mem_if->data, adr));
@@ -709,7 +709,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STRH_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STRH_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + cpu->R[REG_NUM(i, 6)];
 	WRITE16(cpu->mem_if->data, adr, static_cast<uint16_t>(cpu->R[REG_NUM(i, 0)]));
@@ -717,7 +717,7 @@ TEMPLATE static uint32_t FASTCALL OP_STRH_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 16, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDRH_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRH_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + cpu->R[REG_NUM(i, 6)];
 	cpu->R[REG_NUM(i, 0)] = static_cast<uint32_t>(READ16(cpu->mem_if->data, adr));
@@ -729,7 +729,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRH_REG_OFF(uint32_t i)
 //   LDRSH
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_LDRSH_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDRSH_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + cpu->R[REG_NUM(i, 6)];
 	cpu->R[REG_NUM(i, 0)] = static_cast<uint32_t>(static_cast<int16_t>(READ16(cpu->mem_if->data, adr)));
@@ -741,7 +741,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDRSH_REG_OFF(uint32_t i)
 //   STR / LDR
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_STR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + ((i >> 4) & 0x7C);
 	WRITE32(cpu->mem_if->data, adr, cpu->R[REG_NUM(i, 0)]);
@@ -749,7 +749,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_IMM_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_IMM_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + ((i >> 4) & 0x7C);
 	uint32_t tempValue = READ32(cpu->mem_if->data, adr);
@@ -760,7 +760,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDR_IMM_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 6)] + cpu->R[REG_NUM(i, 3)];
 	WRITE32(cpu->mem_if->data, adr, cpu->R[REG_NUM(i, 0)]);
@@ -768,7 +768,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_REG_OFF(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_REG_OFF(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 3)] + cpu->R[REG_NUM(i, 6)];
 	uint32_t tempValue = READ32(cpu->mem_if->data, adr);
@@ -779,7 +779,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDR_REG_OFF(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_STR_SPREL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STR_SPREL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[13] + ((i & 0xFF) << 2);
 	WRITE32(cpu->mem_if->data, adr, cpu->R[REG_NUM(i, 8)]);
@@ -787,7 +787,7 @@ TEMPLATE static uint32_t FASTCALL OP_STR_SPREL(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_WRITE>(2, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_SPREL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_SPREL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[13] + ((i & 0xFF) << 2);
 	cpu->R[REG_NUM(i, 8)] = READ32(cpu->mem_if->data, adr);
@@ -795,7 +795,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDR_SPREL(uint32_t i)
 	return MMU_aluMemAccessCycles<PROCNUM, 32, MMU_AD_READ>(3, adr);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDR_PCREL(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDR_PCREL(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = (cpu->R[15] & 0xFFFFFFFC) + ((i & 0xFF) << 2);
 
@@ -808,14 +808,14 @@ TEMPLATE static uint32_t FASTCALL OP_LDR_PCREL(uint32_t i)
 //   Adjust SP
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_ADJUST_P_SP(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADJUST_P_SP(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[13] += (i & 0x7F) << 2;
 
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_ADJUST_M_SP(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_ADJUST_M_SP(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[13] -= (i & 0x7F) << 2;
 
@@ -826,7 +826,7 @@ TEMPLATE static uint32_t FASTCALL OP_ADJUST_M_SP(uint32_t i)
 //   PUSH / POP
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_PUSH(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_PUSH(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[13] - 4;
 	uint32_t c = 0;
@@ -843,7 +843,7 @@ TEMPLATE static uint32_t FASTCALL OP_PUSH(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(3, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_PUSH_LR(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_PUSH_LR(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[13] - 4;
 	uint32_t c = 0;
@@ -864,7 +864,7 @@ TEMPLATE static uint32_t FASTCALL OP_PUSH_LR(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(4, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_POP(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_POP(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[13];
 	uint32_t c = 0;
@@ -888,7 +888,7 @@ TEMPLATE static uint32_t FASTCALL OP_POP(uint32_t i)
 // In T variants of ARMv4, bit[0] of the loaded value is ignored and execution continues in Thumb state, as
 // though the following instruction had been executed:
 // MOV PC,(loaded_value)
-TEMPLATE static uint32_t FASTCALL OP_POP_PC(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_POP_PC(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[13];
 	uint32_t c = 0;
@@ -917,7 +917,7 @@ TEMPLATE static uint32_t FASTCALL OP_POP_PC(uint32_t i)
 //   STMIA / LDMIA
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_STMIA_THUMB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_STMIA_THUMB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t adr = cpu->R[REG_NUM(i, 8)];
 	uint32_t c = 0;
@@ -946,7 +946,7 @@ TEMPLATE static uint32_t FASTCALL OP_STMIA_THUMB(uint32_t i)
 	return MMU_aluMemCycles<PROCNUM>(2, c);
 }
 
-TEMPLATE static uint32_t FASTCALL OP_LDMIA_THUMB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_LDMIA_THUMB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t regIndex = REG_NUM(i, 8);
 	uint32_t adr = cpu->R[regIndex];
@@ -981,7 +981,7 @@ TEMPLATE static uint32_t FASTCALL OP_LDMIA_THUMB(uint32_t i)
 //   BKPT
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_BKPT_THUMB(uint32_t)
+TEMPLATE static uint32_t FASTCALL OP_BKPT_THUMB(NDS_Instance *nds_inst, uint32_t)
 {
 	fprintf(stderr, "THUMB%c: OP_BKPT triggered\n", PROCNUM?'7':'9');
 	Status_Reg tmp = cpu->CPSR;
@@ -1000,7 +1000,7 @@ TEMPLATE static uint32_t FASTCALL OP_BKPT_THUMB(uint32_t)
 //   SWI
 //-----------------------------------------------------------------------------
 
-TEMPLATE static uint32_t FASTCALL OP_SWI_THUMB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_SWI_THUMB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t swinum = i & 0xFF;
 
@@ -1050,7 +1050,7 @@ TEMPLATE static uint32_t FASTCALL OP_SWI_THUMB(uint32_t i)
 static inline uint32_t SIGNEEXT_IMM11(uint32_t i) { return (i & 0x7FF) | (BIT10(i) * 0xFFFFF800); }
 static inline uint32_t SIGNEXTEND_11(uint32_t i) { return static_cast<uint32_t>((static_cast<int32_t>(i) << 21) >> 21); }
 
-TEMPLATE static uint32_t FASTCALL OP_B_COND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_B_COND(NDS_Instance *nds_inst, uint32_t i)
 {
 	if (!TEST_COND((i >> 8) & 0xF, 0, cpu->CPSR))
 		return 1;
@@ -1060,14 +1060,14 @@ TEMPLATE static uint32_t FASTCALL OP_B_COND(uint32_t i)
 	return 3;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_B_UNCOND(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_B_UNCOND(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[15] += SIGNEEXT_IMM11(i) << 1;
 	cpu->next_instruction = cpu->R[15];
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BLX(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BLX(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[15] = (cpu->R[14] + ((i & 0x7FF) << 1)) & 0xFFFFFFFC;
 	cpu->R[14] = cpu->next_instruction | 1;
@@ -1076,13 +1076,13 @@ TEMPLATE static uint32_t FASTCALL OP_BLX(uint32_t i)
 	return 3;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BL_10(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BL_10(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[14] = cpu->R[15] + (SIGNEXTEND_11(i) << 12);
 	return 1;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BL_11(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BL_11(NDS_Instance *nds_inst, uint32_t i)
 {
 	cpu->R[15] = (cpu->R[14] + ((i & 0x7FF) << 1));
 	cpu->R[14] = cpu->next_instruction | 1;
@@ -1090,7 +1090,7 @@ TEMPLATE static uint32_t FASTCALL OP_BL_11(uint32_t i)
 	return 4;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BX_THUMB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BX_THUMB(NDS_Instance *nds_inst, uint32_t i)
 {
 	// When using PC as operand with BX opcode, switch to ARM state and jump to (instruct_adr+4)
 	// Reference: http://nocash.emubase.de/gbatek.htm#thumb5hiregisteroperationsbranchexchange
@@ -1130,7 +1130,7 @@ TEMPLATE static uint32_t FASTCALL OP_BX_THUMB(uint32_t i)
 	return 3;
 }
 
-TEMPLATE static uint32_t FASTCALL OP_BLX_THUMB(uint32_t i)
+TEMPLATE static uint32_t FASTCALL OP_BLX_THUMB(NDS_Instance *nds_inst, uint32_t i)
 {
 	uint32_t Rm = cpu->R[REG_POS(i, 3)];
 	cpu->CPSR.bits.T = BIT0(Rm);
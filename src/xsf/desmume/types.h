@@ -31,6 +31,20 @@ using u8 = uint8_t;
 using s8 = int8_t;
 #define FORCEINLINE inline
 
+// The emulated console is per thread, so several tracks can play at once. All
+// of its state is one NDS_Instance (NDSSystem.h), allocated by NDS_Init, and
+// the old global names (MMU, nds, NDS_ARM9, CommonSettings, ...) are macros
+// over nds_inst. Outside the cpu loop that is this thread's pointer below.
+// NDS_exec reads it once and hands it down to the instruction handlers and
+// the memory accessors as a parameter of the same name, so there the macros
+// resolve to that parameter and never touch TLS.
+struct NDS_Instance;
+#ifdef __GNUC__
+extern __thread NDS_Instance *nds_inst;
+#else
+extern thread_local NDS_Instance *nds_inst;
+#endif
+
 #ifdef _WINDOWS
 # define HAVE_LIBAGG
 # define ENABLE_SSE
@@ -39,28 +39,29 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <iostream>
 
+#include <glib.h>
+#include <glib/gstdio.h>
+
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
 #include <libaudcore/audstrings.h>
 #include <libaudcore/runtime.h>
+#include <libaudcore/vfs.h>
 
 #include "desmume/NDSSystem.h"
 #include "spu/samplecache.h"
 #include "sndif2sf.h"
 #include "XSFFile.h"
 
-#if _WIN32
-#include <windows.h>
-#define sleep Sleep
-#else
-#include <unistd.h>
-#endif
-
 class XSFPlugin : public InputPlugin
 {
 public:
@@ -88,80 +89,79 @@ public:
 
 EXPORT XSFPlugin aud_plugin_instance;
 
-class vfsfile_istream : public std::istream {
-  class vfsfile_streambuf : public std::basic_streambuf<char> {
+/* A file for XSFFile to parse, mapped into memory if it is local and read
+ * through VFS otherwise.  Either way it is parsed straight out of memory. */
+class xsf_file_istream : public std::istream {
+  class memory_streambuf : public std::basic_streambuf<char> {
   public:
-    vfsfile_streambuf(const char* filename) : source(new VFSFile(filename, "rb")), owned(source) {}
-    vfsfile_streambuf(VFSFile* source) : source(source), owned(nullptr) {}
+    void set(char* begin, char* end) {
+      setg(begin, begin, end);
+    }
 
   protected:
-    std::streamsize xsgetn(char* s, std::streamsize count) {
-      return source->fread(s, 1, count);
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in) {
+      char* base = (dir == std::ios_base::beg) ? eback() : (dir == std::ios_base::end) ? egptr() : gptr();
+      if (off < eback() - base || off > egptr() - base) {
+        return pos_type(off_type(-1));
+      }
+      setg(eback(), base + off, egptr());
+      return pos_type(gptr() - eback());
     }
 
-    traits_type::int_type underflow() {
-      if (source && *source) {
-        uint8_t result[1];
-        int ok = source->fread(reinterpret_cast<char*>(result), 1, 1);
-        if (ok) {
-          if (source->fseek(-1, VFS_SEEK_CUR)) {
-            return traits_type::eof();
-          }
-          return result[0];
-        }
-      } else {
-      }
-      return traits_type::eof();
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) {
+      return seekoff(off_type(pos), std::ios_base::beg, which);
     }
+  };
 
-    traits_type::int_type uflow() {
-      if (source && *source) {
-        uint8_t result[1];
-        int ok = source->fread(reinterpret_cast<char*>(result), 1, 1);
-        if (ok) {
-          return result[0];
-        }
-      }
-      return traits_type::eof();
+public:
+  xsf_file_istream(const char* filename, VFSFile* file = nullptr) : std::istream(nullptr) {
+    StringBuf path = uri_to_filename(filename);
+    int fd = path ? g_open(path, O_RDONLY, 0) : -1;
+
+    if (fd >= 0) {
+      map = g_mapped_file_new_from_fd(fd, false, nullptr);
+      close(fd);
     }
 
-    traits_type::pos_type seekoff(traits_type::off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in) {
-      if (!source || !*source) {
-        return traits_type::off_type(-1);
-      }
-      int err = 1;
-      if (dir == std::ios_base::beg) {
-        err = source->fseek(off, VFS_SEEK_SET);
-      } else if (dir == std::ios_base::end) {
-        err = source->fseek(off, VFS_SEEK_END);
+    char* begin;
+    size_t len;
+    if (map) {
+      begin = g_mapped_file_get_contents(map);
+      len = g_mapped_file_get_length(map);
+    } else {
+      if (file) {
+        data = file->read_all();
       } else {
-        err = source->fseek(off, VFS_SEEK_CUR);
-      }
-      if (err) {
-        return traits_type::off_type(-1);
+        VFSFile vfs(filename, "r");
+        if (vfs)
+          data = vfs.read_all();
       }
-      return source->ftell();
+      begin = data.begin();
+      len = data.len();
     }
 
-    traits_type::pos_type seekpos(traits_type::pos_type pos, std::ios_base::openmode which = std::ios_base::in) {
-      return seekoff(pos, std::ios_base::beg, which);
-    }
+    buf.set(begin, begin + len);
+    rdbuf(&buf);
+    if (!len)
+      setstate(std::ios_base::failbit);
+  }
 
-  private:
-    VFSFile* source;
-    std::unique_ptr<VFSFile> owned;
-  };
+  ~xsf_file_istream() {
+    if (map)
+      g_mapped_file_unref(map);
+  }
 
-public:
-  vfsfile_istream(const char* source) : std::istream(new vfsfile_streambuf(source)) {}
-  vfsfile_istream(VFSFile* source) : std::istream(new vfsfile_streambuf(source)) {}
-  ~vfsfile_istream() { delete rdbuf(nullptr); }
+private:
+  memory_streambuf buf;
+  GMappedFile* map = nullptr;
+  Index<char> data;
 };
 
 /* xsf_get_lib: called to load secondary files */
-static String dirpath;
+static thread_local String dirpath;
 
 bool ignore_length;
+static std::atomic<SPUInterpolationMode> interp_mode; // set from the UI thread
 
 #define CFG_ID "xsf"
 
@@ -171,6 +171,7 @@ const char* const XSFPlugin::defaults[] =
   "fade", "5000",
   "sample_rate", "32728",
   "interpolation_mode", "none",
+  "skip_arm9", "FALSE",
   nullptr
 };
 
@@ -180,16 +181,73 @@ bool XSFPlugin::init()
 	return true;
 }
 
-Index<char> xsf_get_lib(char *filename)
+/* Minipsfs of one rip share their libraries, so the parsed (and inflated)
+ * libraries are kept for the next track.  Entries are checked against the
+ * size and modification time of the file; that can only be done for local
+ * files, so others are parsed again every time. */
+struct LibCacheEntry
 {
-	VFSFile file(filename_build({dirpath, filename}), "r");
-	return file ? file.read_all() : Index<char>();
+  String path;
+  int64_t size, mtime;
+  std::shared_ptr<const XSFFile> lib;
+};
+
+static constexpr int lib_cache_max = 4;
+
+static std::mutex lib_cache_mutex;
+static Index<LibCacheEntry> lib_cache;
+
+static std::shared_ptr<const XSFFile> xsf_get_lib(const char *filename)
+{
+  StringBuf uri = filename_build({dirpath, filename});
+  StringBuf path = uri_to_filename(uri);
+
+  GStatBuf st;
+  bool cacheable = path && g_stat(path, &st) == 0;
+
+  if (cacheable) {
+    std::lock_guard<std::mutex> lock(lib_cache_mutex);
+
+    for (int i = 0; i < lib_cache.len(); i++) {
+      LibCacheEntry &entry = lib_cache[i];
+      if (strcmp(entry.path, path))
+        continue;
+
+      if (entry.size == st.st_size && entry.mtime == st.st_mtime) {
+        // move it to the back, so the oldest entry is dropped first
+        LibCacheEntry hit = std::move(entry);
+        lib_cache.remove(i, 1);
+        lib_cache.append(std::move(hit));
+        return lib_cache[lib_cache.len() - 1].lib;
+      }
+
+      lib_cache.remove(i, 1);
+      break;
+    }
+  }
+
+  xsf_file_istream vs(uri);
+  if (!vs)
+    return nullptr;
+
+  auto lib = std::make_shared<XSFFile>(vs, 4, 8);
+
+  if (cacheable) {
+    std::lock_guard<std::mutex> lock(lib_cache_mutex);
+
+    if (lib_cache.len() >= lib_cache_max)
+      lib_cache.remove(0, 1);
+
+    lib_cache.append(LibCacheEntry{String(path), (int64_t)st.st_size, (int64_t)st.st_mtime, lib});
+  }
+
+  return lib;
 }
 
 bool XSFPlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image)
 {
   try {
-    vfsfile_istream vs(&file);
+    xsf_file_istream vs(filename, &file);
     if (!vs) {
       return false;
     }
@@ -225,15 +283,19 @@ static void xsf_reset(int frameSkip)
   spuSampleCache.clear();
   execute = true;
 
+  // the arm9 has to get the sequence started even if it is skipped afterwards,
+  // and without _frames there is no telling when that has happened
+  CommonSettings.skip_arm9 = false;
   if (frameSkip > 0) {
     for (int i = 0; i < frameSkip; ++i) {
       NDS_exec<false>();
     }
+    CommonSettings.skip_arm9 = aud_get_bool(CFG_ID, "skip_arm9");
   }
   buffer_rope.clear();
 }
 
-bool map2SF(std::vector<uint8_t>& rom, XSFFile* xsf)
+bool map2SF(std::vector<uint8_t>& rom, const XSFFile* xsf)
 {
   if (!xsf->IsValidType(0x24))
     return false;
@@ -250,15 +312,14 @@ bool map2SF(std::vector<uint8_t>& rom, XSFFile* xsf)
   return true;
 }
 
-bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, int level)
+bool recursiveLoad2SF(std::vector<uint8_t>& rom, const XSFFile* xsf, int level)
 {
   if (level <= 10 && xsf->GetTagExists("_lib"))
   {
-    vfsfile_istream vs(filename_build({ dirpath, xsf->GetTagValue("_lib").c_str() }));
-    if (!vs)
+    auto libxsf = xsf_get_lib(xsf->GetTagValue("_lib").c_str());
+    if (!libxsf)
       return false;
-    XSFFile libxsf(vs, 4, 8);
-    if (!recursiveLoad2SF(rom, &libxsf, level + 1))
+    if (!recursiveLoad2SF(rom, libxsf.get(), level + 1))
       return false;
   }
 
@@ -271,11 +332,10 @@ bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, int level)
     ss << "_lib" << (n++);
     found = xsf->GetTagExists(ss.str());
     if (found) {
-      vfsfile_istream vs(filename_build({ dirpath, xsf->GetTagValue(ss.str()).c_str() }));
-      if (!vs)
+      auto libxsf = xsf_get_lib(xsf->GetTagValue(ss.str()).c_str());
+      if (!libxsf)
         return false;
-      XSFFile libxsf(vs, 4, 8);
-      if (!recursiveLoad2SF(rom, &libxsf, level + 1))
+      if (!recursiveLoad2SF(rom, libxsf.get(), level + 1))
         return false;
     }
   }
@@ -292,13 +352,14 @@ void setInterp() {
   } else if (interp == "sharp") {
     interpMode = 3;
   }
-  CommonSettings.spuInterpolationMode = (SPUInterpolationMode)interpMode;
+  interp_mode = (SPUInterpolationMode)interpMode;
 }
 
 bool XSFPlugin::play(const char *filename, VFSFile &file)
 {
 	int length = -1;
 	bool error = false;
+	bool initialized = false;
   int fade = aud_get_int(CFG_ID, "fade");
   int frameSkip = -1;
 	float pos = 0.0;
@@ -308,16 +369,10 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
 	if (!slash)
 		return false;
 
-  while (execute && !check_stop()) {
-    std::cerr << "waiting for thread to finish..." << std::endl;
-    sleep(100);
-  }
-
 	dirpath = String(str_copy(filename, slash + 1 - filename));
 
-	Index<char> buf = file.read_all();
   try {
-    vfsfile_istream vs(&file);
+    xsf_file_istream vs(filename, &file);
     if (!vs) {
       return false;
     }
@@ -332,6 +387,7 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
 
     if (NDS_Init())
       return false;
+    initialized = true;
 
     int sampleRate = aud_get_int(CFG_ID, "sample_rate");
     if (sampleRate < 11025 || sampleRate > 96000)
@@ -350,6 +406,7 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
     CommonSettings.rigorous_timing = true;
     CommonSettings.spu_advanced = true;
     CommonSettings.advanced_timing = true;
+    CommonSettings.spuInterpolationMode = interp_mode;
 
     xsf_reset(frameSkip);
 
@@ -360,6 +417,7 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
     while (!check_stop() && (pos < length || ignore_length))
     {
       int seek_value = check_seek();
+      CommonSettings.spuInterpolationMode = interp_mode;
 
       if (seek_value >= 0)
       {
@@ -403,10 +461,12 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
     error = true;
   }
 
-  MMU_unsetRom();
-  NDS_DeInit();
+  // the file may have been rejected before the emulator was set up
+  if (initialized) {
+    MMU_unsetRom();
+    NDS_DeInit();
+  }
 	dirpath = String();
-  execute = false;
 	return !error;
 }
 
@@ -443,7 +503,8 @@ const PreferencesWidget XSFPlugin::widgets[] = {
   WidgetCheck(N_("Ignore length from file"), WidgetBool(CFG_ID, "ignore_length", [] { ignore_length = aud_get_bool(CFG_ID, "ignore_length"); } )),
   WidgetSpin(N_("Default fade time:"), WidgetInt(CFG_ID, "fade"), { 0, 15000, 100, N_("ms") }),
   WidgetCombo(N_("Sample rate:"), WidgetInt(CFG_ID, "sample_rate"), {{ sampleRateItems }}),
-  WidgetCombo(N_("Interpolation mode:"), WidgetString(CFG_ID, "interpolation_mode", setInterp), {{ interpItems }})
+  WidgetCombo(N_("Interpolation mode:"), WidgetString(CFG_ID, "interpolation_mode", setInterp), {{ interpItems }}),
+  WidgetCheck(N_("Skip ARM9 emulation after startup (faster, not all rips play)"), WidgetBool(CFG_ID, "skip_arm9"))
 };
 
 const PluginPreferences XSFPlugin::prefs = {{widgets}};
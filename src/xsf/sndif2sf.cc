@@ -32,9 +32,9 @@
 #include "desmume/NDSSystem.h"
 #include <vector>
 
-std::list<std::vector<std::uint8_t>> buffer_rope;
+thread_local std::list<std::vector<std::uint8_t>> buffer_rope;
 
-static struct
+static thread_local struct
 {
   std::vector<uint8_t> buf;
   unsigned filled, used;
@@ -36,4 +36,4 @@
 
 extern const int SNDIFID_2SF;
 extern SoundInterface_struct SNDIF_2SF;
-extern std::list<std::vector<std::uint8_t>> buffer_rope;
+extern thread_local std::list<std::vector<std::uint8_t>> buffer_rope;
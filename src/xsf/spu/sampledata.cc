@@ -22,7 +22,7 @@
 #include "sampledata.h"
 #include "adpcmdecoder.h"
 #include "interpolator.h"
-#include "../desmume/MMU.h"
+#include "../desmume/NDSSystem.h"
 
 SampleData::SampleData()
 : std::vector<int32_t>(), baseAddr(0), loopStart(0), loopLength(0)